@@ -46,6 +46,26 @@ one of the application files:
 	#define configAPPLICATION_PROVIDES_cOutputBuffer 1
 #endif
 
+/* The maximum number of words, including the command itself, that can be
+passed to a command that uses an argv callback. */
+#ifndef configCLI_MAX_ARGUMENTS
+	#define configCLI_MAX_ARGUMENTS 8
+#endif
+
+/* The size of the buffer into which the words of an argv command are copied.
+Must be at least as long as the longest command line. */
+#ifndef configCLI_ARGUMENT_BUFFER_SIZE
+	#define configCLI_ARGUMENT_BUFFER_SIZE 100
+#endif
+
+/* The number of commands, including help, that can be held in the sorted
+index used for tab completion.  Commands registered after the index is full
+still run, they just cannot be completed.  When configSUPPORT_DYNAMIC_ALLOCATION
+is 0 this is also the most commands that can be registered at all. */
+#ifndef configCLI_MAX_COMMANDS
+	#define configCLI_MAX_COMMANDS 24
+#endif
+
 typedef struct xCOMMAND_INPUT_LIST
 {
 	const CLI_Command_Definition_t *pxCommandLineDefinition;
@@ -63,6 +83,33 @@ static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, c
  */
 static int8_t prvGetNumberOfParameters( const char *pcCommandString );
 
+/*
+ * Return pdTRUE if pcCommandInput starts with the word pcCommand, followed by
+ * either the end of the string or a space.
+ */
+static BaseType_t prvIsCommand( const char *pcCommandInput, const char *pcCommand );
+
+/*
+ * Return the registered command that pcCommandInput starts with, or NULL.  The
+ * line of an argv command is split into pcBuffer and pxArgv, and *pxArgc
+ * receives the number of words.  *pxParametersOk is set to pdFALSE if the
+ * command was found but its parameter count is wrong.
+ */
+static const CLI_Definition_List_Item_t *prvFindCommand( const char *pcCommandInput, char *pcBuffer, size_t xBufferLen, char *pxArgv[], BaseType_t *pxArgc, BaseType_t *pxParametersOk );
+
+/*
+ * Call the callback of a command found by prvFindCommand(), the argv one if
+ * it has one.
+ */
+static BaseType_t prvCallCommand( const CLI_Definition_List_Item_t *pxCommand, const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t xArgCount, char *pxArgv[] );
+
+/*
+ * Return the first position in the sorted command index whose name compares
+ * greater than or equal to (or, if xAfter is pdTRUE, greater than) the first
+ * xPrefixLength characters of pcPrefix.
+ */
+static UBaseType_t prvSearchIndex( const char *pcPrefix, size_t xPrefixLength, BaseType_t xAfter );
+
 /* The definition of the "help" command.  This command is always at the front
 of the list of registered commands. */
 static const CLI_Command_Definition_t xHelpCommand =
@@ -81,6 +128,28 @@ static CLI_Definition_List_Item_t xRegisteredCommands =
 	NULL			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
 };
 
+/* The registered commands sorted by name, so every command starting with a
+given prefix sits in one contiguous run that a binary search can find. */
+static const CLI_Command_Definition_t *pxCommandIndex[ configCLI_MAX_COMMANDS ] = { &xHelpCommand };
+static UBaseType_t uxIndexedCommands = 1;
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	/* Without a heap the list items come from a fixed pool, one per command
+	that can be registered on top of help. */
+	static CLI_Definition_List_Item_t xListItemPool[ configCLI_MAX_COMMANDS - 1 ];
+	static UBaseType_t uxListItemsUsed = 0;
+#endif
+
+/* Outcome of the last command processed, see FreeRTOS_CLIGetLastStatus(). */
+static BaseType_t xLastStatus = pdCLI_STATUS_OK;
+
+/* The words of the command line passed to an argv command.  The line is split
+once, when the command is found, and the words stay valid until the command
+returns pdFALSE. */
+static char cArgumentBuffer[ configCLI_ARGUMENT_BUFFER_SIZE ];
+static char *pcArgv[ configCLI_MAX_ARGUMENTS ];
+static BaseType_t xArgc = 0;
+
 /* A buffer into which command outputs can be written is declared here, rather
 than in the command console implementation, to allow multiple command consoles
 to share the same buffer.  For example, an application may allow access to the
@@ -107,12 +176,36 @@ BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const p
 static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
 CLI_Definition_List_Item_t *pxNewListItem;
 BaseType_t xReturn = pdFAIL;
+UBaseType_t uxPosition;
 
 	/* Check the parameter is not NULL. */
 	configASSERT( pxCommandToRegister );
 
+	/* A command left out of the completion index could still be run but not
+	completed, so a full index fails the registration. */
+	if( uxIndexedCommands >= configCLI_MAX_COMMANDS )
+	{
+		return pdFAIL;
+	}
+
 	/* Create a new list item that will reference the command being registered. */
-	pxNewListItem = ( CLI_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Definition_List_Item_t ) );
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		pxNewListItem = ( CLI_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Definition_List_Item_t ) );
+	}
+	#else
+	{
+		pxNewListItem = NULL;
+		taskENTER_CRITICAL();
+		{
+			if( uxListItemsUsed < ( sizeof( xListItemPool ) / sizeof( xListItemPool[ 0 ] ) ) )
+			{
+				pxNewListItem = &xListItemPool[ uxListItemsUsed++ ];
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	#endif
 	configASSERT( pxNewListItem );
 
 	if( pxNewListItem != NULL )
@@ -133,6 +226,12 @@ BaseType_t xReturn = pdFAIL;
 
 			/* Set the end of list marker to the new list item. */
 			pxLastCommandInList = pxNewListItem;
+
+			/* Insert the command into the sorted completion index. */
+			uxPosition = prvSearchIndex( pxCommandToRegister->pcCommand, strlen( pxCommandToRegister->pcCommand ) + 1, pdFALSE );
+			memmove( &pxCommandIndex[ uxPosition + 1 ], &pxCommandIndex[ uxPosition ], ( uxIndexedCommands - uxPosition ) * sizeof( pxCommandIndex[ 0 ] ) );
+			pxCommandIndex[ uxPosition ] = pxCommandToRegister;
+			uxIndexedCommands++;
 		}
 		taskEXIT_CRITICAL();
 
@@ -147,8 +246,6 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char *
 {
 static const CLI_Definition_List_Item_t *pxCommand = NULL;
 BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
-size_t xCommandStringLength;
 
 	/* Note:  This function is not re-entrant.  It must not be called from more
 	thank one task. */
@@ -156,48 +253,22 @@ size_t xCommandStringLength;
 	if( pxCommand == NULL )
 	{
 		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
-		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
-
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
-			{
-				if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
-				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-						{
-							xReturn = pdFALSE;
-						}
-					}
-
-					break;
-				}
-			}
-		}
+		pxCommand = prvFindCommand( pcCommandInput, cArgumentBuffer, sizeof( cArgumentBuffer ), pcArgv, &xArgc, &xReturn );
 	}
 
 	if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
 	{
 		/* The command was found, but the number of parameters with the command
 		was incorrect. */
+		xLastStatus = pdCLI_STATUS_BAD_PARAMETERS;
 		strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
 		pxCommand = NULL;
 	}
 	else if( pxCommand != NULL )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		xLastStatus = pdCLI_STATUS_OK;
+		xReturn = prvCallCommand( pxCommand, pcCommandInput, pcWriteBuffer, xWriteBufferLen, xArgc, pcArgv );
 
 		/* If xReturn is pdFALSE, then no further strings will be returned
 		after this one, and	pxCommand can be reset to NULL ready to search
@@ -210,6 +281,7 @@ size_t xCommandStringLength;
 	else
 	{
 		/* pxCommand was NULL, the command was not found. */
+		xLastStatus = pdCLI_STATUS_NOT_FOUND;
 		strncpy( pcWriteBuffer, "Command not recognised.  Enter 'help' to view a list of available commands.\r\n\r\n", xWriteBufferLen );
 		xReturn = pdFALSE;
 	}
@@ -218,6 +290,28 @@ size_t xCommandStringLength;
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t FreeRTOS_CLIDispatch( const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen, char *pcBuffer, size_t xBufferLen, char *pxArgv[] )
+{
+const CLI_Definition_List_Item_t *pxCommand;
+BaseType_t xArgCount = 0, xParametersOk = pdTRUE;
+
+	pxCommand = prvFindCommand( pcCommandInput, pcBuffer, xBufferLen, pxArgv, &xArgCount, &xParametersOk );
+
+	if( ( pxCommand == NULL ) || ( xParametersOk == pdFALSE ) )
+	{
+		return pdFALSE;
+	}
+
+	return prvCallCommand( pxCommand, pcCommandInput, pcWriteBuffer, xWriteBufferLen, xArgCount, pxArgv );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIGetLastStatus( void )
+{
+	return xLastStatus;
+}
+/*-----------------------------------------------------------*/
+
 char *FreeRTOS_CLIGetOutputBuffer( void )
 {
 	return cOutputBuffer;
@@ -348,4 +442,385 @@ BaseType_t xLastCharacterWasSpace = pdFALSE;
 	as the first word should be the command itself. */
 	return cParameters;
 }
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsCommand( const char *pcCommandInput, const char *pcCommand )
+{
+	/* Walk both strings together, so the registered name is only read once
+	rather than once by strlen() and again by strncmp(). */
+	while( ( *pcCommand != 0x00 ) && ( *pcCommand == *pcCommandInput ) )
+	{
+		pcCommand++;
+		pcCommandInput++;
+	}
+
+	if( ( *pcCommand == 0x00 ) && ( ( *pcCommandInput == ' ' ) || ( *pcCommandInput == 0x00 ) ) )
+	{
+		return pdTRUE;
+	}
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Definition_List_Item_t *prvFindCommand( const char *pcCommandInput, char *pcBuffer, size_t xBufferLen, char *pxArgv[], BaseType_t *pxArgc, BaseType_t *pxParametersOk )
+{
+const CLI_Definition_List_Item_t *pxCommand;
+
+	/* Search for the command string in the list of registered commands. */
+	for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+	{
+		/* To ensure the string lengths match exactly, so as not to pick up
+		a sub-string of a longer command, prvIsCommand() checks the byte
+		after the expected end of the string is either the end of the
+		string or a space before a parameter. */
+		if( prvIsCommand( pcCommandInput, pxCommand->pxCommandLineDefinition->pcCommand ) != pdFALSE )
+		{
+			if( pxCommand->pxCommandLineDefinition->pxArgvCommandInterpreter != NULL )
+			{
+				/* Split the line once.  The parameter count check then
+				uses argc rather than scanning the line again. */
+				*pxArgc = FreeRTOS_CLITokenise( pcCommandInput, pcBuffer, xBufferLen, pxArgv, configCLI_MAX_ARGUMENTS );
+
+				if( *pxArgc < 1 )
+				{
+					*pxParametersOk = pdFALSE;
+				}
+				else if( ( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 ) &&
+						 ( ( *pxArgc - 1 ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters ) )
+				{
+					*pxParametersOk = pdFALSE;
+				}
+			}
+			/* The command has been found.  Check it has the expected
+			number of parameters.  If cExpectedNumberOfParameters is -1,
+			then there could be a variable number of parameters and no
+			check is made. */
+			else if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
+			{
+				if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+				{
+					*pxParametersOk = pdFALSE;
+				}
+			}
+
+			break;
+		}
+	}
+
+	return pxCommand;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCallCommand( const CLI_Definition_List_Item_t *pxCommand, const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t xArgCount, char *pxArgv[] )
+{
+	if( pxCommand->pxCommandLineDefinition->pxArgvCommandInterpreter != NULL )
+	{
+		return pxCommand->pxCommandLineDefinition->pxArgvCommandInterpreter( pcWriteBuffer, xWriteBufferLen, xArgCount, pxArgv );
+	}
+
+	return pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvSearchIndex( const char *pcPrefix, size_t xPrefixLength, BaseType_t xAfter )
+{
+UBaseType_t uxLow = 0, uxHigh = uxIndexedCommands, uxMiddle;
+int iCompare;
+
+	while( uxLow < uxHigh )
+	{
+		uxMiddle = ( uxLow + uxHigh ) / 2;
+		iCompare = strncmp( pxCommandIndex[ uxMiddle ]->pcCommand, pcPrefix, xPrefixLength );
+
+		if( ( iCompare < 0 ) || ( ( xAfter != pdFALSE ) && ( iCompare == 0 ) ) )
+		{
+			uxLow = uxMiddle + 1;
+		}
+		else
+		{
+			uxHigh = uxMiddle;
+		}
+	}
+
+	return uxLow;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t FreeRTOS_CLIFindCompletions( const char *pcPrefix, size_t xPrefixLength, UBaseType_t *puxFirst, size_t *pxCommonLength )
+{
+UBaseType_t uxFirst, uxEnd;
+const char *pcFirst, *pcLast;
+size_t xCommon = xPrefixLength;
+
+	uxFirst = prvSearchIndex( pcPrefix, xPrefixLength, pdFALSE );
+	uxEnd = prvSearchIndex( pcPrefix, xPrefixLength, pdTRUE );
+
+	if( uxEnd > uxFirst )
+	{
+		/* The index is sorted, so the prefix shared by the whole run is the
+		prefix shared by its first and last entries. */
+		pcFirst = pxCommandIndex[ uxFirst ]->pcCommand;
+		pcLast = pxCommandIndex[ uxEnd - 1 ]->pcCommand;
+
+		while( ( pcFirst[ xCommon ] != 0x00 ) && ( pcFirst[ xCommon ] == pcLast[ xCommon ] ) )
+		{
+			xCommon++;
+		}
+	}
+
+	*puxFirst = uxFirst;
+	*pxCommonLength = xCommon;
+
+	return uxEnd - uxFirst;
+}
+/*-----------------------------------------------------------*/
+
+const char *FreeRTOS_CLIGetCommandName( UBaseType_t uxIndex )
+{
+	return ( uxIndex < uxIndexedCommands ) ? pxCommandIndex[ uxIndex ]->pcCommand : NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLITokenise( const char *pcCommandString, char *pcBuffer, size_t xBufferLen, char *pxArgv[], UBaseType_t uxMaxArgs )
+{
+BaseType_t xWords = 0;
+char *pcOut = pcBuffer;
+char * const pcLastByte = pcBuffer + xBufferLen - 1;
+char cQuote, cChar;
+
+	for( ;; )
+	{
+		/* Find the start of the next word. */
+		while( *pcCommandString == ' ' )
+		{
+			pcCommandString++;
+		}
+
+		if( *pcCommandString == 0x00 )
+		{
+			break;
+		}
+
+		if( ( UBaseType_t ) xWords >= uxMaxArgs )
+		{
+			return -1;
+		}
+
+		pxArgv[ xWords++ ] = pcOut;
+		cQuote = 0x00;
+
+		/* Copy the word.  A space only ends it outside quotes. */
+		while( ( *pcCommandString != 0x00 ) && ( ( cQuote != 0x00 ) || ( *pcCommandString != ' ' ) ) )
+		{
+			cChar = *pcCommandString++;
+
+			if( ( cChar == '\\' ) && ( *pcCommandString != 0x00 ) )
+			{
+				/* Escaped, so the next character is taken as it is. */
+				cChar = *pcCommandString++;
+			}
+			else if( ( cQuote == 0x00 ) && ( ( cChar == '"' ) || ( cChar == '\'' ) ) )
+			{
+				cQuote = cChar;
+				continue;
+			}
+			else if( cChar == cQuote )
+			{
+				cQuote = 0x00;
+				continue;
+			}
+
+			/* Always leave room for the terminator. */
+			if( pcOut >= pcLastByte )
+			{
+				return -1;
+			}
+
+			*pcOut++ = cChar;
+		}
+
+		if( ( cQuote != 0x00 ) || ( pcOut > pcLastByte ) )
+		{
+			return -1;
+		}
+
+		*pcOut++ = 0x00;
+	}
+
+	return xWords;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIParseHex( const char *pcArgument, uint32_t *pulValue )
+{
+uint32_t ulValue = 0;
+UBaseType_t uxDigits = 0;
+char cChar;
+
+	if( ( pcArgument[ 0 ] == '0' ) && ( ( pcArgument[ 1 ] == 'x' ) || ( pcArgument[ 1 ] == 'X' ) ) )
+	{
+		pcArgument += 2;
+	}
+
+	while( ( cChar = *pcArgument++ ) != 0x00 )
+	{
+		if( ( cChar >= '0' ) && ( cChar <= '9' ) )
+		{
+			cChar -= '0';
+		}
+		else if( ( cChar >= 'a' ) && ( cChar <= 'f' ) )
+		{
+			cChar -= 'a' - 10;
+		}
+		else if( ( cChar >= 'A' ) && ( cChar <= 'F' ) )
+		{
+			cChar -= 'A' - 10;
+		}
+		else
+		{
+			return pdFAIL;
+		}
+
+		if( ++uxDigits > 8 )
+		{
+			return pdFAIL;
+		}
+
+		ulValue = ( ulValue << 4 ) | ( uint32_t ) cChar;
+	}
+
+	if( uxDigits == 0 )
+	{
+		return pdFAIL;
+	}
+
+	*pulValue = ulValue;
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIParseInt( const char *pcArgument, int32_t *plValue )
+{
+uint32_t ulMagnitude = 0, ulLimit = ( uint32_t ) INT32_MAX, ulDigit;
+BaseType_t xNegative = pdFALSE;
+
+	if( ( pcArgument[ 0 ] == '0' ) && ( ( pcArgument[ 1 ] == 'x' ) || ( pcArgument[ 1 ] == 'X' ) ) )
+	{
+		if( FreeRTOS_CLIParseHex( pcArgument, &ulMagnitude ) == pdFAIL )
+		{
+			return pdFAIL;
+		}
+
+		*plValue = ( int32_t ) ulMagnitude;
+		return pdPASS;
+	}
+
+	if( ( *pcArgument == '-' ) || ( *pcArgument == '+' ) )
+	{
+		xNegative = ( *pcArgument == '-' ) ? pdTRUE : pdFALSE;
+		pcArgument++;
+	}
+
+	if( xNegative != pdFALSE )
+	{
+		ulLimit++;
+	}
+
+	if( *pcArgument == 0x00 )
+	{
+		return pdFAIL;
+	}
+
+	while( *pcArgument != 0x00 )
+	{
+		if( ( *pcArgument < '0' ) || ( *pcArgument > '9' ) )
+		{
+			return pdFAIL;
+		}
+
+		ulDigit = ( uint32_t ) ( *pcArgument++ - '0' );
+
+		if( ulMagnitude > ( ulLimit - ulDigit ) / 10 )
+		{
+			return pdFAIL;
+		}
+
+		ulMagnitude = ( ulMagnitude * 10 ) + ulDigit;
+	}
+
+	*plValue = ( xNegative != pdFALSE ) ? ( int32_t ) ( 0u - ulMagnitude ) : ( int32_t ) ulMagnitude;
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIParseFixed( const char *pcArgument, UBaseType_t uxFractionBits, int32_t *plValue )
+{
+uint32_t ulInteger = 0, ulFraction = 0, ulScale = 1, ulLimit, ulDigit;
+uint64_t ullValue;
+BaseType_t xNegative = pdFALSE, xDigits = 0;
+
+	if( uxFractionBits > 30 )
+	{
+		return pdFAIL;
+	}
+
+	if( ( *pcArgument == '-' ) || ( *pcArgument == '+' ) )
+	{
+		xNegative = ( *pcArgument == '-' ) ? pdTRUE : pdFALSE;
+		pcArgument++;
+	}
+
+	/* Anything larger cannot fit once shifted. Checked before each digit is
+	added, as in FreeRTOS_CLIParseInt(), so ulInteger never wraps. */
+	ulLimit = ( ( uint32_t ) INT32_MAX >> uxFractionBits ) + 1;
+
+	while( ( *pcArgument >= '0' ) && ( *pcArgument <= '9' ) )
+	{
+		ulDigit = ( uint32_t ) ( *pcArgument++ - '0' );
+
+		if( ulInteger > ( ulLimit - ulDigit ) / 10 )
+		{
+			return pdFAIL;
+		}
+
+		ulInteger = ( ulInteger * 10 ) + ulDigit;
+		xDigits++;
+	}
+
+	if( *pcArgument == '.' )
+	{
+		pcArgument++;
+
+		while( ( *pcArgument >= '0' ) && ( *pcArgument <= '9' ) )
+		{
+			/* Nine digits is already finer than a 30-bit fraction, so any
+			further digits are checked but not used. */
+			if( ulScale < 1000000000UL )
+			{
+				ulFraction = ( ulFraction * 10 ) + ( uint32_t ) ( *pcArgument - '0' );
+				ulScale *= 10;
+			}
+
+			pcArgument++;
+			xDigits++;
+		}
+	}
+
+	if( ( *pcArgument != 0x00 ) || ( xDigits == 0 ) )
+	{
+		return pdFAIL;
+	}
+
+	ullValue = ( ( uint64_t ) ulInteger << uxFractionBits ) +
+			   ( ( ( ( uint64_t ) ulFraction << uxFractionBits ) + ( ulScale / 2 ) ) / ulScale );
+
+	if( ullValue > ( uint64_t ) INT32_MAX + ( ( xNegative != pdFALSE ) ? 1 : 0 ) )
+	{
+		return pdFAIL;
+	}
+
+	*plValue = ( xNegative != pdFALSE ) ? ( int32_t ) ( 0u - ( uint32_t ) ullValue ) : ( int32_t ) ullValue;
+	return pdPASS;
+}
 
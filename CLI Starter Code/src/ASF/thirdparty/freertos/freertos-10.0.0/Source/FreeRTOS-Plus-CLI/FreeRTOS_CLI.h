@@ -35,6 +35,13 @@ the pcWriteBuffer buffer, and pcCommandString is the entire string as input by
 the user (from which parameters can be extracted).*/
 typedef BaseType_t (*pdCOMMAND_LINE_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/* The prototype of a callback that receives the command line already split
+into words.  argv[ 0 ] is the command itself and argc counts it, so a command
+with two parameters is called with argc == 3.  Words are null terminated, have
+their quotes and escapes removed, and stay valid until the command returns
+pdFALSE. */
+typedef BaseType_t (*pdCOMMAND_LINE_ARGV_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[] );
+
 /* The structure that defines command line commands.  A command line command
 should be defined by declaring a const structure of this type. */
 typedef struct xCOMMAND_LINE_INPUT
@@ -43,16 +50,24 @@ typedef struct xCOMMAND_LINE_INPUT
 	const char * const pcHelpString;			/* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
 	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;	/* A pointer to the callback function that will return the output generated by the command. */
 	int8_t cExpectedNumberOfParameters;			/* Commands expect a fixed number of parameters, which may be zero. */
+	const pdCOMMAND_LINE_ARGV_CALLBACK pxArgvCommandInterpreter;	/* Optional.  When set it is called instead of pxCommandInterpreter, which can then be NULL. */
 } CLI_Command_Definition_t;
 
 /* For backward compatibility. */
 #define xCommandLineInput CLI_Command_Definition_t
 
+/* Outcome of the last command passed to FreeRTOS_CLIProcessCommand(), as
+returned by FreeRTOS_CLIGetLastStatus(). */
+#define pdCLI_STATUS_OK					( 0 )	/* The command was found and its callback ran. */
+#define pdCLI_STATUS_NOT_FOUND			( 1 )	/* No registered command has that name. */
+#define pdCLI_STATUS_BAD_PARAMETERS		( 2 )	/* The command was found but the parameter count was wrong. */
+
 /*
  * Register the command passed in using the pxCommandToRegister parameter.
  * Registering a command adds the command to the list of commands that are
  * handled by the command interpreter.  Once a command has been registered it
- * can be executed from the command line.
+ * can be executed from the command line.  Returns pdFAIL, and registers
+ * nothing, once configCLI_MAX_COMMANDS commands (help included) are registered.
  */
 BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister );
 
@@ -69,6 +84,24 @@ BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const p
  */
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  );
 
+/*
+ * Return one of the pdCLI_STATUS_ values for the last command passed to
+ * FreeRTOS_CLIProcessCommand().  Lets a caller that does not parse the text
+ * output, such as a scripted console, report whether the command ran.
+ */
+BaseType_t FreeRTOS_CLIGetLastStatus( void );
+
+/*
+ * Look up the command pcCommandInput starts with, check its parameters and call
+ * it once, as FreeRTOS_CLIProcessCommand() does for the first string of its
+ * output.  The line of an argv command is split into pcBuffer and pxArgv, which
+ * must hold configCLI_MAX_ARGUMENTS entries.  Returns pdFALSE if the command is
+ * not found or has the wrong number of parameters, otherwise the callback's
+ * return value.  Nothing static is used, so this may be called from within a
+ * command, such as a benchmark timing the lookup.
+ */
+BaseType_t FreeRTOS_CLIDispatch( const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen, char *pcBuffer, size_t xBufferLen, char *pxArgv[] );
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -89,6 +122,52 @@ char *FreeRTOS_CLIGetOutputBuffer( void );
  */
 const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
 
+/*
+ * Find the registered commands whose names start with the xPrefixLength
+ * characters at pcPrefix, for tab completion.  Commands are kept in a sorted
+ * index, so the matches are found with a binary search and are always a
+ * contiguous run of index positions, starting at *puxFirst.  *pxCommonLength
+ * receives the length of the longest prefix shared by every match, which is
+ * how far the word can be completed.  Returns the number of matches.  Runs in
+ * bounded time and does not allocate.
+ */
+UBaseType_t FreeRTOS_CLIFindCompletions( const char *pcPrefix, size_t xPrefixLength, UBaseType_t *puxFirst, size_t *pxCommonLength );
+
+/*
+ * Return the name of the command at position uxIndex of the sorted command
+ * index, or NULL if uxIndex is past the end.
+ */
+const char *FreeRTOS_CLIGetCommandName( UBaseType_t uxIndex );
+
+/*
+ * Split pcCommandString into words in a single pass.  Words are separated by
+ * spaces.  Single or double quotes group words that contain spaces, and a
+ * backslash makes the next character literal (for example "\ " or "\"").
+ * The words are copied, unquoted and null terminated, into pcBuffer, and
+ * pointers to them are placed in pxArgv.  Returns the number of words, or -1
+ * if there are more than uxMaxArgs words, pcBuffer is too small or a quote is
+ * not closed.
+ */
+BaseType_t FreeRTOS_CLITokenise( const char *pcCommandString, char *pcBuffer, size_t xBufferLen, char *pxArgv[], UBaseType_t uxMaxArgs );
+
+/*
+ * Typed parameter parsers for argv commands.  Each returns pdPASS and writes
+ * *pxValue if the whole of pcArgument is valid, otherwise returns pdFAIL and
+ * leaves *pxValue unchanged.
+ *
+ * FreeRTOS_CLIParseInt() accepts an optional sign followed by decimal digits,
+ * or "0x" followed by up to 8 hex digits, taken as a 32-bit two's complement
+ * value so that "0xFFFFFFFF" is -1.
+ * FreeRTOS_CLIParseHex() accepts hex digits, with or without "0x".
+ * FreeRTOS_CLIParseFixed() accepts a decimal number with an optional fraction
+ * ("-1.25") and returns it as a signed fixed point value with uxFractionBits
+ * fractional bits, rounded to nearest.  For example "1.5" with 8 fractional
+ * bits gives 384.
+ */
+BaseType_t FreeRTOS_CLIParseInt( const char *pcArgument, int32_t *plValue );
+BaseType_t FreeRTOS_CLIParseHex( const char *pcArgument, uint32_t *pulValue );
+BaseType_t FreeRTOS_CLIParseFixed( const char *pcArgument, UBaseType_t uxFractionBits, int32_t *plValue );
+
 #endif /* COMMAND_INTERPRETER_H */
 
 
@@ -0,0 +1,796 @@
+/**************************************************************************/ /**
+ * @file      Benchmark.c
+ * @brief     On-target micro-benchmark framework and the built-in benchmarks
+ *            for the primitives the firmware depends on.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Benchmark.h"
+#include "SerialConsole/SerialConsole.h"
+#include "FreeRTOS_CLI.h"
+#include "MemPool/MemPool.h"
+#include "Trace/Trace.h"
+#include "IrqMonitor/IrqMonitor.h"
+#include "WorkQueue/WorkQueue.h"
+#include "StackMonitor/StackMonitor.h"
+#include "HitDetect/HitDetect.h"
+#include "Fusion/Fusion.h"
+#include "Codec/Codec.h"
+#include "Stroke/Stroke.h"
+#include "conf_irq_priorities.h"
+#include "conf_ramfunc.h"
+#if defined(QEMU_TARGET)
+#include "qemu_board.h"
+#endif
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define BENCHMARK_TC TC3							  ///< TC used as the extended cycle counter
+#define BENCHMARK_TC_IRQn TC3_IRQn					  ///< Its interrupt line
+#define BENCHMARK_SWI_IRQn I2S_IRQn					  ///< Unused peripheral IRQ, pended by software for the ISR latency benchmark
+#define BENCHMARK_SWI_Handler I2S_Handler			  ///< Vector of BENCHMARK_SWI_IRQn
+#define BENCHMARK_CBUF_SIZE 64						  ///< Size of the scratch circular buffer
+#define BENCHMARK_MEMCPY_SIZE 256					  ///< Bytes copied by the memcpy benchmark
+#define BENCHMARK_HELPER_STACK configMINIMAL_STACK_SIZE ///< Stack of the context switch partner task
+#define BENCHMARK_CLI_LINE "cmd 12 0x1F 'two words' -3.5" ///< Command line used by the CLI parameter benchmarks
+#define BENCHMARK_CLI_PARAMS 4						  ///< Parameters in BENCHMARK_CLI_LINE
+#define BENCHMARK_CLI_OLD_LINE "bench_old 12 0x1F 'two words' -3.5"	///< BENCHMARK_CLI_LINE for the cli_dispatch_old command
+#define BENCHMARK_CLI_ARGV_LINE "bench_argv 12 0x1F 'two words' -3.5" ///< BENCHMARK_CLI_LINE for the cli_dispatch_argv command
+#define BENCHMARK_POOL_BLOCK_SIZE 8					  ///< Bytes per block of the pool_alloc_free pool
+#define BENCHMARK_POOL_BLOCK_COUNT 2				  ///< Blocks in it. Alloc and free cost the same for any count
+#define BENCHMARK_FETCH_BYTES 32					  ///< Bytes checksummed by the fetch_flash and fetch_ram benchmarks
+
+#if CODEC_MAX_PACKET_BYTES > BENCHMARK_MEMCPY_SIZE
+#error "The codec_block benchmark codes into the memcpy destination"
+#endif
+#if STROKE_ARENA_BYTES > BENCHMARK_MEMCPY_SIZE
+#error "The stroke_infer benchmark runs in the memcpy destination"
+#endif
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvStartCycleCounter(void);
+static uint32_t prvElapsed(uint32_t ulTcStart, uint32_t ulTcEnd, uint32_t ulStStart, uint32_t ulStEnd);
+static void prvSortSamples(uint32_t *pulSamples, uint32_t ulCount);
+static void prvSwitchPartnerTask(void *pvParameters);
+static void prvRegisterBuiltins(void);
+static void prvWorkGive(void *pvContext);
+static BaseType_t prvCliOldCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvCliArgvCommand(char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[]);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static const Benchmark_Definition_t *pxBenchmarks[BENCHMARK_MAX_REGISTERED]; ///< Registered benchmarks
+static UBaseType_t uxBenchmarkCount = 0;									 ///< Number of entries used in pxBenchmarks
+#if !defined(QEMU_TARGET)
+static volatile uint32_t ulOverflowCount = 0;								 ///< High half of the TC3 cycle counter
+#endif
+static uint32_t ulSamples[BENCHMARK_SAMPLES];								 ///< Scratch space for one run, kept off the CLI stack
+
+static volatile uint32_t ulSwiStampTc;	///< TC3 timestamp taken at the top of BENCHMARK_SWI_Handler
+static volatile uint32_t ulSwiStampSt;	///< SysTick->VAL taken at the top of BENCHMARK_SWI_Handler
+
+static cbuf_handle_t cbufBench;				   ///< Scratch buffer for the circular buffer benchmarks
+static uint8_t ucCbufStorage[BENCHMARK_CBUF_SIZE]; ///< Storage for cbufBench
+static uint8_t ucMemcpySrc[BENCHMARK_MEMCPY_SIZE];
+static uint8_t ucMemcpyDst[BENCHMARK_MEMCPY_SIZE];
+static SemaphoreHandle_t xGiveTakeSemaphore = NULL; ///< Semaphore for the give/take benchmark
+static SemaphoreHandle_t xPingSemaphore = NULL;	 ///< Given by the benchmark to wake the partner task
+static SemaphoreHandle_t xPongSemaphore = NULL;	 ///< Given back by the partner task
+static StaticSemaphore_t xGiveTakeSemaphoreBuffer;
+static StaticSemaphore_t xPingSemaphoreBuffer;
+static StaticSemaphore_t xPongSemaphoreBuffer;
+static StackType_t xPartnerStack[BENCHMARK_HELPER_STACK];
+static StaticTask_t xPartnerTaskBuffer;
+static char cCliArgBuffer[sizeof(BENCHMARK_CLI_LINE)]; ///< Tokenised words for the cli_argv benchmark
+static char *pcCliArgv[BENCHMARK_CLI_PARAMS + 1];
+static char cCliDispatchBuffer[sizeof(BENCHMARK_CLI_ARGV_LINE)]; ///< Tokenised words for the cli_dispatch benchmarks
+static char *pcCliDispatchArgv[configCLI_MAX_ARGUMENTS];
+static char cCliDispatchOutput[8]; ///< Output buffer of the cli_dispatch commands, which write nothing
+static bool bCliDispatchRegistered = false;
+
+/**
+ * Commands the cli_dispatch benchmarks look up and call, one per callback type.
+ * Registered on first use, so they sit at the end of the command list, where a
+ * lookup costs the most. The parameter counts are those the CLI checks:
+ * prvGetNumberOfParameters() counts the quoted words apart, the tokeniser does not.
+ */
+static const CLI_Command_Definition_t xCliOldCommand = {"bench_old", "bench_old: Target of the cli_dispatch_old benchmark\r\n",
+														 prvCliOldCommand, BENCHMARK_CLI_PARAMS + 1, NULL};
+static const CLI_Command_Definition_t xCliArgvCommand = {"bench_argv", "bench_argv: Target of the cli_dispatch_argv benchmark\r\n",
+														  NULL, BENCHMARK_CLI_PARAMS, prvCliArgvCommand};
+MEMPOOL_DEFINE(xBenchPool, "bench", BENCHMARK_POOL_BLOCK_SIZE, BENCHMARK_POOL_BLOCK_COUNT); ///< Pool of the pool_alloc_free benchmark
+static WORKQUEUE_DEFINE(xBenchWork, "bench", prvWorkGive, NULL, WORK_PRIORITY_HIGH); ///< Item of the work_submit benchmark
+static HitDetector_t xBenchDetector; ///< Detector of the hit_block benchmark, apart from the pipeline one
+static ImuBlock_t xBenchBlock;		 ///< Block it is fed
+static Fusion_t xBenchFusion;		 ///< Filter of the fusion_update benchmark, apart from the pipeline one
+static ImuSample_t xBenchSample;	 ///< Sample it is fed
+static Codec_t xBenchCodec;			 ///< Encoder of the codec_block benchmark, fed xBenchBlock
+
+/** Features of a forehand, the input of the stroke_infer benchmark */
+static const q7_t cBenchStroke[STROKE_FEATURES] = {-26, -19, 48, -22, -16, 40, -26, -19, 17, -10, -9,
+												   49, 7, -12, -4, -4, -19, -8, 41, 4, 5, 9};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Starts the cycle counter and registers the built-in benchmarks.
+ */
+void BenchmarkInit(void)
+{
+	cbufBench = circular_buf_init(ucCbufStorage, BENCHMARK_CBUF_SIZE);
+	xGiveTakeSemaphore = xSemaphoreCreateBinaryStatic(&xGiveTakeSemaphoreBuffer);
+
+	prvStartCycleCounter();
+
+	NVIC_SetPriority(BENCHMARK_SWI_IRQn, IRQ_PRIORITY_BENCHMARK_SWI);
+	NVIC_EnableIRQ(BENCHMARK_SWI_IRQn);
+
+	WorkQueueRegister(&xBenchWork);
+	MemPoolRegister(&xBenchPool);
+	prvRegisterBuiltins();
+}
+
+/**
+ * @brief Adds a benchmark to the table.
+ */
+BaseType_t BenchmarkRegister(const Benchmark_Definition_t *const pxBenchmark)
+{
+	BaseType_t xReturn = pdFAIL;
+
+	if (pxBenchmark != NULL && uxBenchmarkCount < BENCHMARK_MAX_REGISTERED)
+	{
+		pxBenchmarks[uxBenchmarkCount++] = pxBenchmark;
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+
+/**
+ * @brief Reads the 32-bit cycle counter.
+ * @details If the counter wrapped while interrupts were masked the overflow
+ *          interrupt has not run yet, so the pending flag is folded in here.
+ */
+RAMFUNC_HOT uint32_t BenchmarkGetCycles(void)
+{
+#if defined(QEMU_TARGET)
+	return QemuBoardGetCycles();
+#else
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t ulHigh = ulOverflowCount;
+	uint32_t ulLow = BENCHMARK_TC->COUNT16.COUNT.reg;
+
+	if (BENCHMARK_TC->COUNT16.INTFLAG.reg & TC_INTFLAG_OVF)
+	{
+		ulLow = BENCHMARK_TC->COUNT16.COUNT.reg; // Re-read so low and high agree
+		ulHigh++;
+	}
+
+	__set_PRIMASK(ulPrimask);
+
+	return (ulHigh << 16) | ulLow;
+#endif
+}
+
+UBaseType_t BenchmarkGetCount(void)
+{
+	return uxBenchmarkCount;
+}
+
+const Benchmark_Definition_t *BenchmarkGet(UBaseType_t uxIndex)
+{
+	return (uxIndex < uxBenchmarkCount) ? pxBenchmarks[uxIndex] : NULL;
+}
+
+const Benchmark_Definition_t *BenchmarkFind(const char *pcName, size_t xNameLen)
+{
+	for (UBaseType_t i = 0; i < uxBenchmarkCount; i++)
+	{
+		if (strlen(pxBenchmarks[i]->pcName) == xNameLen && strncmp(pxBenchmarks[i]->pcName, pcName, xNameLen) == 0)
+		{
+			return pxBenchmarks[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Times BENCHMARK_SAMPLES runs of a benchmark.
+ */
+void BenchmarkRun(const Benchmark_Definition_t *pxBenchmark, BenchmarkResult_t *pxResult)
+{
+	uint32_t ulOverhead = UINT32_MAX;
+	uint32_t ulTcStart, ulTcEnd, ulStStart, ulStEnd;
+
+	// Cost of the timestamps themselves, taken as the best of a few empty runs
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		ulTcStart = BenchmarkGetCycles();
+		ulStStart = SysTick->VAL;
+		ulStEnd = SysTick->VAL;
+		ulTcEnd = BenchmarkGetCycles();
+		uint32_t ulEmpty = prvElapsed(ulTcStart, ulTcEnd, ulStStart, ulStEnd);
+		ulOverhead = (ulEmpty < ulOverhead) ? ulEmpty : ulOverhead;
+	}
+
+	if (pxBenchmark->pxSetup != NULL)
+	{
+		pxBenchmark->pxSetup(pxBenchmark->pvContext);
+	}
+
+	for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++)
+	{
+		if (pxBenchmark->bSelfTimed)
+		{
+			ulSamples[i] = pxBenchmark->pxBody(pxBenchmark->pvContext);
+		}
+		else
+		{
+			ulTcStart = BenchmarkGetCycles();
+			ulStStart = SysTick->VAL;
+			pxBenchmark->pxBody(pxBenchmark->pvContext);
+			ulStEnd = SysTick->VAL;
+			ulTcEnd = BenchmarkGetCycles();
+
+			uint32_t ulCycles = prvElapsed(ulTcStart, ulTcEnd, ulStStart, ulStEnd);
+			ulSamples[i] = (ulCycles > ulOverhead) ? (ulCycles - ulOverhead) : 0;
+		}
+	}
+
+	prvSortSamples(ulSamples, BENCHMARK_SAMPLES);
+	pxResult->ulMin = ulSamples[0];
+	pxResult->ulMedian = ulSamples[BENCHMARK_SAMPLES / 2];
+	pxResult->ulMax = ulSamples[BENCHMARK_SAMPLES - 1];
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvStartCycleCounter(void)
+ * @brief		Runs TC3 as a 16-bit counter at the CPU clock (GCLK0, no prescaler).
+ *				The overflow interrupt extends it to 32 bits.
+ * @note		COUNT is put in continuous read synchronization so reads do not stall
+ *****************************************************************************/
+static void prvStartCycleCounter(void)
+{
+#if defined(QEMU_TARGET)
+	QemuBoardStartCycleCounter();
+#else
+	struct system_gclk_chan_config gclkConfig;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_TC3);
+	system_gclk_chan_get_config_defaults(&gclkConfig);
+	gclkConfig.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(TC3_GCLK_ID, &gclkConfig);
+	system_gclk_chan_enable(TC3_GCLK_ID);
+
+	BENCHMARK_TC->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+	while (BENCHMARK_TC->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY)
+		;
+
+	BENCHMARK_TC->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV1;
+	BENCHMARK_TC->COUNT16.READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(TC_COUNT16_COUNT_OFFSET);
+	BENCHMARK_TC->COUNT16.INTENSET.reg = TC_INTENSET_OVF;
+
+	NVIC_SetPriority(BENCHMARK_TC_IRQn, IRQ_PRIORITY_CYCLE_COUNTER);
+	NVIC_EnableIRQ(BENCHMARK_TC_IRQn);
+
+	BENCHMARK_TC->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+	while (BENCHMARK_TC->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY)
+		;
+#endif
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvElapsed(...)
+ * @brief		Cycles between two timestamp pairs. The TC3 window encloses the SysTick
+ *				window, so when the TC3 delta is shorter than one SysTick period the
+ *				SysTick delta is unambiguous and is used for its exact resolution.
+ *****************************************************************************/
+static uint32_t prvElapsed(uint32_t ulTcStart, uint32_t ulTcEnd, uint32_t ulStStart, uint32_t ulStEnd)
+{
+	uint32_t ulTc = ulTcEnd - ulTcStart;
+	uint32_t ulPeriod = SysTick->LOAD + 1;
+
+	if (ulTc < ulPeriod)
+	{
+		// SysTick counts down
+		return (ulStStart >= ulStEnd) ? (ulStStart - ulStEnd) : (ulStStart + ulPeriod - ulStEnd);
+	}
+
+	return ulTc;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSortSamples(uint32_t *pulSamples, uint32_t ulCount)
+ * @brief		Insertion sort. The sample count is small and fixed
+ *****************************************************************************/
+static void prvSortSamples(uint32_t *pulSamples, uint32_t ulCount)
+{
+	for (uint32_t i = 1; i < ulCount; i++)
+	{
+		uint32_t ulKey = pulSamples[i];
+		uint32_t j = i;
+
+		while (j > 0 && pulSamples[j - 1] > ulKey)
+		{
+			pulSamples[j] = pulSamples[j - 1];
+			j--;
+		}
+
+		pulSamples[j] = ulKey;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSwitchPartnerTask(void *pvParameters)
+ * @brief		Partner of the context switch benchmark. Hands every ping straight
+ *				back as a pong.
+ *****************************************************************************/
+static void prvSwitchPartnerTask(void *pvParameters)
+{
+	for (;;)
+	{
+		xSemaphoreTake(xPingSemaphore, portMAX_DELAY);
+		xSemaphoreGive(xPongSemaphore);
+	}
+}
+
+/******************************************************************************
+ * Built-in Benchmarks
+ ******************************************************************************/
+
+static uint32_t prvBenchCbufPut(void *pvContext)
+{
+	circular_buf_put(cbufBench, 0x55);
+	return 0;
+}
+
+static uint32_t prvBenchCbufFill(void *pvContext)
+{
+	circular_buf_reset(cbufBench);
+	for (uint32_t i = 0; i < BENCHMARK_CBUF_SIZE; i++)
+	{
+		circular_buf_put(cbufBench, (uint8_t)i);
+	}
+	return 0;
+}
+
+static uint32_t prvBenchCbufGet(void *pvContext)
+{
+	uint8_t ucData;
+	circular_buf_get(cbufBench, &ucData);
+	return 0;
+}
+
+/**
+ * Formats an empty message, so levels that pass the filter measure the
+ * vsnprintf path without putting text on the console.
+ */
+static uint32_t prvBenchLogMessage(void *pvContext)
+{
+	LogMessage((enum eDebugLogLevels)(uintptr_t)pvContext, "%s", "");
+	return 0;
+}
+
+/**
+ * Writes a VT100 "reset attributes" sequence: four real bytes through the TX
+ * ring buffer that do not change what the terminal shows.
+ */
+static uint32_t prvBenchConsoleWrite(void *pvContext)
+{
+	SerialConsoleWriteString("\x1b[0m");
+	return 0;
+}
+
+static uint32_t prvBenchSemaphore(void *pvContext)
+{
+	xSemaphoreGive(xGiveTakeSemaphore);
+	xSemaphoreTake(xGiveTakeSemaphore, 0);
+	return 0;
+}
+
+static uint32_t prvBenchSwitchSetup(void *pvContext)
+{
+	if (xPingSemaphore == NULL)
+	{
+		xPingSemaphore = xSemaphoreCreateBinaryStatic(&xPingSemaphoreBuffer);
+		xPongSemaphore = xSemaphoreCreateBinaryStatic(&xPongSemaphoreBuffer);
+		TaskHandle_t xPartner = xTaskCreateStatic(prvSwitchPartnerTask, "BENCH", BENCHMARK_HELPER_STACK, NULL, uxTaskPriorityGet(NULL),
+												 xPartnerStack, &xPartnerTaskBuffer);
+		StackMonitorRegister(xPartner, BENCHMARK_HELPER_STACK);
+	}
+	return 0;
+}
+
+/**
+ * One ping-pong round trip: two context switches plus a give/take pair on
+ * each side. Compare with sem_give_take to isolate the switch cost.
+ */
+static uint32_t prvBenchContextSwitch(void *pvContext)
+{
+	uint32_t ulTcStart = BenchmarkGetCycles();
+	uint32_t ulStStart = SysTick->VAL;
+
+	xSemaphoreGive(xPingSemaphore);
+	xSemaphoreTake(xPongSemaphore, portMAX_DELAY);
+
+	uint32_t ulStEnd = SysTick->VAL;
+	uint32_t ulTcEnd = BenchmarkGetCycles();
+
+	return prvElapsed(ulTcStart, ulTcEnd, ulStStart, ulStEnd);
+}
+
+/**
+ * Cycles from pending BENCHMARK_SWI_IRQn in software to the first instruction
+ * of its handler that can take a timestamp.
+ */
+static uint32_t prvBenchIsrLatency(void *pvContext)
+{
+	ulSwiStampTc = 0;
+	uint32_t ulTcStart = BenchmarkGetCycles();
+	uint32_t ulStStart = SysTick->VAL;
+
+	NVIC_SetPendingIRQ(BENCHMARK_SWI_IRQn);
+	__DSB();
+	__ISB();
+
+	return prvElapsed(ulTcStart, ulSwiStampTc, ulStStart, ulSwiStampSt);
+}
+
+static uint32_t prvBenchMemcpy(void *pvContext)
+{
+	memcpy(ucMemcpyDst, ucMemcpySrc, BENCHMARK_MEMCPY_SIZE);
+	return 0;
+}
+
+/**
+ * What a FreeRTOS_CLIGetParameter() handler pays to read every parameter:
+ * each call rescans the line from the start.
+ */
+static uint32_t prvBenchCliGetParameter(void *pvContext)
+{
+	BaseType_t xLen;
+	for (UBaseType_t i = 1; i <= BENCHMARK_CLI_PARAMS; i++)
+	{
+		FreeRTOS_CLIGetParameter(BENCHMARK_CLI_LINE, i, &xLen);
+	}
+	return 0;
+}
+
+/**
+ * What an argv handler pays for the same line: one tokenising pass, after
+ * which every parameter is an array lookup.
+ */
+static uint32_t prvBenchCliArgv(void *pvContext)
+{
+	FreeRTOS_CLITokenise(BENCHMARK_CLI_LINE, cCliArgBuffer, sizeof(cCliArgBuffer), pcCliArgv, BENCHMARK_CLI_PARAMS + 1);
+	return 0;
+}
+
+static uint32_t prvBenchCliDispatchSetup(void *pvContext)
+{
+	if (!bCliDispatchRegistered)
+	{
+		/* Without a free command slot the lookup fails and only its cost is timed */
+		bCliDispatchRegistered = (FreeRTOS_CLIRegisterCommand(&xCliOldCommand) == pdPASS) &&
+								 (FreeRTOS_CLIRegisterCommand(&xCliArgvCommand) == pdPASS);
+	}
+	return 0;
+}
+
+/**
+ * Whole path from a typed line to a handler that has read its parameters:
+ * command lookup, parameter count check, and the call. The context is the
+ * line, naming one of the commands above.
+ */
+static uint32_t prvBenchCliDispatch(void *pvContext)
+{
+	return (uint32_t)FreeRTOS_CLIDispatch((const char *)pvContext, cCliDispatchOutput, sizeof(cCliDispatchOutput), cCliDispatchBuffer,
+										  sizeof(cCliDispatchBuffer), pcCliDispatchArgv);
+}
+
+static BaseType_t prvCliOldCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+	BaseType_t xLen;
+	for (UBaseType_t i = 1; i <= BENCHMARK_CLI_PARAMS; i++)
+	{
+		FreeRTOS_CLIGetParameter(pcCommandString, i, &xLen);
+	}
+	pcWriteBuffer[0] = '\0';
+	return pdFALSE;
+}
+
+static BaseType_t prvCliArgvCommand(char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	pcWriteBuffer[0] = '\0';
+	return pdFALSE;
+}
+
+/**
+ * One alloc/free pair on the benchmark's own pool. Both are O(1), so this
+ * does not depend on the block size or how many blocks are already in use.
+ */
+static uint32_t prvBenchPoolAllocFree(void *pvContext)
+{
+	MemPoolFree(&xBenchPool, MemPoolAlloc(&xBenchPool));
+	return 0;
+}
+
+/**
+ * Work queue round trip: submit, switch to the daemon task, run the item,
+ * and switch back when it gives the semaphore. Needs the CLI task above the
+ * daemon task (CLI_PRIORITY > configTIMER_TASK_PRIORITY).
+ */
+static uint32_t prvBenchWorkSubmit(void *pvContext)
+{
+	WorkQueueSubmit(&xBenchWork);
+	xSemaphoreTake(xGiveTakeSemaphore, portMAX_DELAY);
+	return 0;
+}
+
+static void prvWorkGive(void *pvContext)
+{
+	xSemaphoreGive(xGiveTakeSemaphore);
+}
+
+/**
+ * Cost the trace hooks add to every context switch and queue operation.
+ * Records into the live ring, and measures only the early return while
+ * tracing is stopped.
+ */
+static uint32_t prvBenchTraceRecord(void *pvContext)
+{
+	vTraceRecord(TRACE_EVENT_SECTION_BEGIN, 0xFF, 0);
+	return 0;
+}
+
+/**
+ * Bitwise CRC-8 of the memcpy source: a short, branchy loop whose speed
+ * depends on instruction fetch. Inlined into both fetch benchmarks so the
+ * only difference between them is where the code runs from.
+ */
+static inline __attribute__((always_inline)) uint32_t prvFetchLoop(void)
+{
+	uint8_t ucCrc = 0;
+
+	for (uint32_t i = 0; i < BENCHMARK_FETCH_BYTES; i++)
+	{
+		ucCrc ^= ucMemcpySrc[i];
+		for (uint32_t ulBit = 0; ulBit < 8; ulBit++)
+		{
+			ucCrc = (ucCrc & 0x80) ? (uint8_t)((ucCrc << 1) ^ 0x07) : (uint8_t)(ucCrc << 1);
+		}
+	}
+
+	return ucCrc;
+}
+
+/**
+ * The fetch loop run from flash, with the wait states of the current clock profile.
+ */
+static uint32_t prvBenchFetchFlash(void *pvContext)
+{
+	return prvFetchLoop();
+}
+
+/**
+ * The same loop run from SRAM. Equal to fetch_flash when RAMFUNC_ENABLED is 0.
+ */
+RAMFUNC_HOT static uint32_t prvBenchFetchRam(void *pvContext)
+{
+	return prvFetchLoop();
+}
+
+/**
+ * A full block at rest with a short spike in the middle, so the envelope and
+ * peak tracking paths run too.
+ */
+static uint32_t prvBenchHitSetup(void *pvContext)
+{
+	HitDetectReset(&xBenchDetector);
+	memset(&xBenchBlock, 0, sizeof(xBenchBlock));
+	xBenchBlock.usCount = IMU_BLOCK_SAMPLES;
+	for (uint16_t i = 0; i < IMU_BLOCK_SAMPLES; i++)
+	{
+		xBenchBlock.xSamples[i].sAccel[2] = IMU_ACCEL_LSB_PER_G;
+	}
+	xBenchBlock.xSamples[IMU_BLOCK_SAMPLES / 2].sAccel[0] = 8 * IMU_ACCEL_LSB_PER_G;
+	return 0;
+}
+
+/**
+ * One block through the hit detector, against HIT_BLOCK_BUDGET_CYCLES.
+ */
+static uint32_t prvBenchHitBlock(void *pvContext)
+{
+	Hit_t xHits[HIT_MAX_PER_BLOCK];
+
+	return HitDetectProcess(&xBenchDetector, &xBenchBlock, xHits);
+}
+
+/**
+ * A tilted sensor turning about all three axes, so the gyro integration and
+ * the accelerometer step both run on every update.
+ */
+static uint32_t prvBenchFusionSetup(void *pvContext)
+{
+	memset(&xBenchSample, 0, sizeof(xBenchSample));
+	xBenchSample.sAccel[0] = IMU_ACCEL_LSB_PER_G / 2;
+	xBenchSample.sAccel[2] = IMU_ACCEL_LSB_PER_G * 7 / 8;
+	FusionReset(&xBenchFusion);
+	FusionUpdate(&xBenchFusion, &xBenchSample);
+
+	xBenchSample.sGyro[0] = 30 * IMU_GYRO_LSB_PER_10_DPS;
+	xBenchSample.sGyro[1] = -20 * IMU_GYRO_LSB_PER_10_DPS;
+	xBenchSample.sGyro[2] = 10 * IMU_GYRO_LSB_PER_10_DPS;
+	return 0;
+}
+
+/**
+ * One orientation update, the cost per sample of the fusion stage.
+ */
+static uint32_t prvBenchFusionUpdate(void *pvContext)
+{
+	FusionUpdate(&xBenchFusion, &xBenchSample);
+	return (uint32_t)xBenchFusion.lQ[0];
+}
+
+/**
+ * A block in motion: every channel on its own slope with a small ripple, so
+ * the residuals take a few bits and both predictions are tried.
+ */
+static uint32_t prvBenchCodecSetup(void *pvContext)
+{
+	CodecReset(&xBenchCodec);
+	memset(&xBenchBlock, 0, sizeof(xBenchBlock));
+	xBenchBlock.usCount = IMU_BLOCK_SAMPLES;
+	for (uint16_t i = 0; i < IMU_BLOCK_SAMPLES; i++)
+	{
+		ImuSample_t *pxSample = &xBenchBlock.xSamples[i];
+
+		for (uint8_t c = 0; c < 3; c++)
+		{
+			int16_t sRipple = (int16_t)(((i * 7 + c * 3) & 15) - 8);
+
+			pxSample->sAccel[c] = (int16_t)(IMU_ACCEL_LSB_PER_G / 2 + 40 * (c + 1) * i + sRipple);
+			pxSample->sGyro[c] = (int16_t)(-300 * (c + 1) * i + sRipple);
+			pxSample->sAccelAux[c] = (int16_t)(pxSample->sAccel[c] + 2 * sRipple);
+		}
+	}
+	return 0;
+}
+
+/**
+ * One block through the encoder, against CODEC_BLOCK_BUDGET_CYCLES. Every
+ * CODEC_KEY_PACKETS-th run is a key packet; the median is not.
+ */
+static uint32_t prvBenchCodecBlock(void *pvContext)
+{
+	return (uint32_t)CodecEncode(&xBenchCodec, &xBenchBlock, ucMemcpyDst, sizeof(ucMemcpyDst), NULL);
+}
+
+/**
+ * One inference of the pipeline classifier's model, the cost per hit of the
+ * stroke stage beyond its window features. The arena is the memcpy
+ * destination. Nothing to run without a valid model.
+ */
+static uint32_t prvBenchStrokeInfer(void *pvContext)
+{
+	const StrokeModel_t *pxModel = StrokeGetModel();
+
+	return (pxModel != NULL) ? StrokeInfer(pxModel, cBenchStroke, (q7_t *)ucMemcpyDst, NULL) : 0;
+}
+
+static const Benchmark_Definition_t xBenchCbufPut = {"cbuf_put", NULL, prvBenchCbufPut, NULL, false};
+static const Benchmark_Definition_t xBenchCbufGet = {"cbuf_get", prvBenchCbufFill, prvBenchCbufGet, NULL, false};
+static const Benchmark_Definition_t xBenchLogInfo = {"log_info", NULL, prvBenchLogMessage, (void *)LOG_INFO_LVL, false};
+static const Benchmark_Definition_t xBenchLogDebug = {"log_debug", NULL, prvBenchLogMessage, (void *)LOG_DEBUG_LVL, false};
+static const Benchmark_Definition_t xBenchLogWarning = {"log_warning", NULL, prvBenchLogMessage, (void *)LOG_WARNING_LVL, false};
+static const Benchmark_Definition_t xBenchLogError = {"log_error", NULL, prvBenchLogMessage, (void *)LOG_ERROR_LVL, false};
+static const Benchmark_Definition_t xBenchLogFatal = {"log_fatal", NULL, prvBenchLogMessage, (void *)LOG_FATAL_LVL, false};
+static const Benchmark_Definition_t xBenchConsoleWrite = {"console_write", NULL, prvBenchConsoleWrite, NULL, false};
+static const Benchmark_Definition_t xBenchSemaphore = {"sem_give_take", NULL, prvBenchSemaphore, NULL, false};
+static const Benchmark_Definition_t xBenchContextSwitch = {"ctx_switch", prvBenchSwitchSetup, prvBenchContextSwitch, NULL, true};
+static const Benchmark_Definition_t xBenchIsrLatency = {"isr_latency", NULL, prvBenchIsrLatency, NULL, true};
+static const Benchmark_Definition_t xBenchMemcpy = {"memcpy256", NULL, prvBenchMemcpy, NULL, false};
+static const Benchmark_Definition_t xBenchCliGetParameter = {"cli_getparam", NULL, prvBenchCliGetParameter, NULL, false};
+static const Benchmark_Definition_t xBenchCliArgv = {"cli_argv", NULL, prvBenchCliArgv, NULL, false};
+static const Benchmark_Definition_t xBenchCliDispatchOld = {"cli_dispatch_old", prvBenchCliDispatchSetup, prvBenchCliDispatch,
+															 (void *)BENCHMARK_CLI_OLD_LINE, false};
+static const Benchmark_Definition_t xBenchCliDispatchArgv = {"cli_dispatch_argv", prvBenchCliDispatchSetup, prvBenchCliDispatch,
+															  (void *)BENCHMARK_CLI_ARGV_LINE, false};
+static const Benchmark_Definition_t xBenchPoolAllocFree = {"pool_alloc_free", NULL, prvBenchPoolAllocFree, NULL, false};
+static const Benchmark_Definition_t xBenchWorkSubmit = {"work_submit", NULL, prvBenchWorkSubmit, NULL, false};
+static const Benchmark_Definition_t xBenchTraceRecord = {"trace_record", NULL, prvBenchTraceRecord, NULL, false};
+static const Benchmark_Definition_t xBenchFetchFlash = {"fetch_flash", NULL, prvBenchFetchFlash, NULL, false};
+static const Benchmark_Definition_t xBenchFetchRam = {"fetch_ram", NULL, prvBenchFetchRam, NULL, false};
+static const Benchmark_Definition_t xBenchHitBlock = {"hit_block", prvBenchHitSetup, prvBenchHitBlock, NULL, false};
+static const Benchmark_Definition_t xBenchFusionUpdate = {"fusion_update", prvBenchFusionSetup, prvBenchFusionUpdate, NULL, false};
+static const Benchmark_Definition_t xBenchCodecBlock = {"codec_block", prvBenchCodecSetup, prvBenchCodecBlock, NULL, false};
+static const Benchmark_Definition_t xBenchStrokeInfer = {"stroke_infer", NULL, prvBenchStrokeInfer, NULL, false};
+
+/** The built-in benchmarks, in the order "bench all" runs them */
+static const Benchmark_Definition_t *const pxBuiltins[] = {
+	&xBenchCbufPut,
+	&xBenchCbufGet,
+	&xBenchLogInfo,
+	&xBenchLogDebug,
+	&xBenchLogWarning,
+	&xBenchLogError,
+	&xBenchLogFatal,
+	&xBenchConsoleWrite,
+	&xBenchSemaphore,
+	&xBenchContextSwitch,
+	&xBenchIsrLatency,
+	&xBenchMemcpy,
+	&xBenchCliGetParameter,
+	&xBenchCliArgv,
+	&xBenchCliDispatchOld,
+	&xBenchCliDispatchArgv,
+	&xBenchPoolAllocFree,
+	&xBenchWorkSubmit,
+	&xBenchTraceRecord,
+	&xBenchFetchFlash,
+	&xBenchFetchRam,
+	&xBenchHitBlock,
+	&xBenchFusionUpdate,
+	&xBenchCodecBlock,
+	&xBenchStrokeInfer,
+};
+
+static void prvRegisterBuiltins(void)
+{
+	BaseType_t xRegistered;
+
+	for (size_t i = 0; i < sizeof(pxBuiltins) / sizeof(pxBuiltins[0]); i++)
+	{
+		/* Stops here rather than leave a benchmark out: raise BENCHMARK_MAX_REGISTERED */
+		xRegistered = BenchmarkRegister(pxBuiltins[i]);
+		configASSERT(xRegistered == pdPASS);
+	}
+}
+
+/******************************************************************************
+ * Interrupt Handlers
+ ******************************************************************************/
+
+#if !defined(QEMU_TARGET)
+/**
+ * @brief TC3 overflow: extends the cycle counter to 32 bits. COUNT restarted from 0
+ *        at the overflow, so its value at entry is the interrupt latency in cycles
+ *        (while that stays under 65536 cycles; a longer mask loses an overflow anyway).
+ */
+void TC3_Handler(void)
+{
+	uint16_t usEntry = BENCHMARK_TC->COUNT16.COUNT.reg;
+
+	BENCHMARK_TC->COUNT16.INTFLAG.reg = TC_INTFLAG_OVF;
+	ulOverflowCount++;
+
+	IrqMonitorRecord(IRQ_MONITOR_CYCLE_COUNTER, usEntry, (uint16_t)(BENCHMARK_TC->COUNT16.COUNT.reg - usEntry));
+}
+#endif
+
+/**
+ * @brief Software pended interrupt used by the isr_latency benchmark.
+ */
+RAMFUNC_HOT void BENCHMARK_SWI_Handler(void)
+{
+	ulSwiStampSt = SysTick->VAL;
+	ulSwiStampTc = BenchmarkGetCycles();
+}
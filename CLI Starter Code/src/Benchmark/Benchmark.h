@@ -0,0 +1,120 @@
+/**************************************************************************/ /**
+ * @file      Benchmark.h
+ * @brief     On-target micro-benchmark framework. Named benchmarks are
+ *            registered once and timed in CPU cycles from the CLI with
+ *            "bench <name|all>".
+ * @details   The Cortex-M0+ has no DWT cycle counter, so the timebase is
+ *            built from two sources:
+ *            --SysTick->VAL, which counts CPU cycles exactly but wraps every
+ *              RTOS tick (configCPU_CLOCK_HZ / configTICK_RATE_HZ cycles)
+ *            --TC3 clocked from GCLK0 plus a software overflow counter, which
+ *              gives a free running 32-bit cycle count
+ *            Short measurements use the SysTick delta, anything longer than
+ *            one tick falls back to the TC3 delta.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define BENCHMARK_MAX_REGISTERED 28 ///< Maximum number of benchmarks that can be registered
+#define BENCHMARK_SAMPLES 31        ///< Timed runs per benchmark. Odd so the median is a real sample
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Function run by a benchmark. For normal benchmarks the return value is
+ *        ignored and the call itself is timed. Self timed benchmarks return the
+ *        number of cycles they measured.
+ */
+typedef uint32_t (*BenchmarkFunction_t)(void *pvContext);
+
+/**
+ * @brief Definition of a benchmark. Must stay valid after registration, so
+ *        declare it const at file scope.
+ */
+typedef struct
+{
+	const char *const pcName;		  ///< Name used by "bench <name>". Lower case, no spaces
+	const BenchmarkFunction_t pxSetup; ///< Optional, called once before the timed runs. May be NULL
+	const BenchmarkFunction_t pxBody;  ///< Function that is measured
+	void *const pvContext;			  ///< Argument passed to pxSetup and pxBody
+	const bool bSelfTimed;			  ///< True if pxBody returns its own cycle count
+} Benchmark_Definition_t;
+
+/**
+ * @brief Result of running a benchmark, in CPU cycles.
+ */
+typedef struct
+{
+	uint32_t ulMin;
+	uint32_t ulMedian;
+	uint32_t ulMax;
+} BenchmarkResult_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void BenchmarkInit(void)
+ * @brief		Starts the TC3 cycle counter and registers the built-in benchmarks
+ * @note		Call once from the daemon task startup hook, before the CLI runs
+ *****************************************************************************/
+void BenchmarkInit(void);
+
+/**
+ * @fn			BaseType_t BenchmarkRegister(const Benchmark_Definition_t *const pxBenchmark)
+ * @brief		Adds a benchmark to the table used by the "bench" command
+ * @param[in]	pxBenchmark Benchmark definition. Must outlive the program
+ * @return		pdPASS if registered, pdFAIL if the table is full
+ *****************************************************************************/
+BaseType_t BenchmarkRegister(const Benchmark_Definition_t *const pxBenchmark);
+
+/**
+ * @fn			uint32_t BenchmarkGetCycles(void)
+ * @brief		Returns the free running 32-bit CPU cycle count (TC3 + overflow counter)
+ * @note		Safe to call from tasks and interrupts
+ *****************************************************************************/
+uint32_t BenchmarkGetCycles(void);
+
+/**
+ * @fn			UBaseType_t BenchmarkGetCount(void)
+ * @brief		Returns the number of registered benchmarks
+ *****************************************************************************/
+UBaseType_t BenchmarkGetCount(void);
+
+/**
+ * @fn			const Benchmark_Definition_t *BenchmarkGet(UBaseType_t uxIndex)
+ * @brief		Returns the registered benchmark at uxIndex, or NULL if out of range
+ *****************************************************************************/
+const Benchmark_Definition_t *BenchmarkGet(UBaseType_t uxIndex);
+
+/**
+ * @fn			const Benchmark_Definition_t *BenchmarkFind(const char *pcName, size_t xNameLen)
+ * @brief		Looks up a benchmark by name
+ * @param[in]	pcName Name to look for. Does not need to be null terminated
+ * @param[in]	xNameLen Number of characters in pcName
+ * @return		The benchmark, or NULL if no benchmark has that name
+ *****************************************************************************/
+const Benchmark_Definition_t *BenchmarkFind(const char *pcName, size_t xNameLen);
+
+/**
+ * @fn			void BenchmarkRun(const Benchmark_Definition_t *pxBenchmark, BenchmarkResult_t *pxResult)
+ * @brief		Runs the setup once, then times BENCHMARK_SAMPLES runs of the body
+ * @details		The cost of taking the timestamps is measured once and subtracted
+ *				from every sample of a harness timed benchmark.
+ * @param[in]	pxBenchmark Benchmark to run
+ * @param[out]	pxResult Min/median/max cycles
+ *****************************************************************************/
+void BenchmarkRun(const Benchmark_Definition_t *pxBenchmark, BenchmarkResult_t *pxResult);
+
+#endif /* BENCHMARK_H */
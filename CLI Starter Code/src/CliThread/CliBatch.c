@@ -0,0 +1,183 @@
+/**************************************************************************/ /**
+ * @file      CliBatch.c
+ * @brief     Batch input mode for the CLI console. See CliBatch.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "CliBatch.h"
+#include "SerialConsole.h"
+#include "FreeRTOS_CLI.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CLI_BATCH_STATUS_LENGTH 8 ///< Longest status, "NOTFOUND"
+#define CLI_BATCH_U32_DIGITS 10	  ///< Digits of the largest uint32_t, 4294967295
+
+/// Longest status frame, "@4294967295 NOTFOUND 4294967295\r\n" and its terminator
+#define CLI_BATCH_FRAME_LENGTH (1 + CLI_BATCH_U32_DIGITS + 1 + CLI_BATCH_STATUS_LENGTH + 1 + CLI_BATCH_U32_DIGITS + 2 + 1)
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvWriteFrame(const char *pcStatus, uint32_t ulMicroseconds);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static bool bBatchEnabled = false;
+static uint32_t ulSequence = 0;			  ///< Number of the next status frame
+static char pcCommand[MAX_INPUT_LENGTH_CLI]; ///< Command being collected
+static uint8_t ucLength = 0;
+static bool bCommandComplete = false; ///< pcCommand was returned and is cleared on the next character
+static bool bTooLong = false;		  ///< Command overflowed, drop characters until the separator
+static char cQuote = 0;				  ///< Quote character while inside a quoted word
+static bool bEscaped = false;		  ///< Previous character was a backslash
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Enters or leaves batch mode.
+ */
+void CliBatchEnable(bool bEnable)
+{
+	bBatchEnabled = bEnable;
+	ulSequence = 0;
+	ucLength = 0;
+	bCommandComplete = false;
+	bTooLong = false;
+	cQuote = 0;
+	bEscaped = false;
+}
+
+/**
+ * @brief Returns true while the console is in batch mode.
+ */
+bool CliBatchIsEnabled(void)
+{
+	return bBatchEnabled;
+}
+
+/**
+ * @brief Splits the batch input into commands.
+ */
+const char *CliBatchProcessChar(char cRxedChar)
+{
+	bool bSeparator;
+
+	if (bCommandComplete)
+	{
+		ucLength = 0;
+		bCommandComplete = false;
+	}
+
+	// Only split on ';' where the tokeniser would not treat it as part of a word
+	bSeparator = (cRxedChar == '\r' || cRxedChar == '\n' || (cRxedChar == ';' && cQuote == 0 && !bEscaped));
+
+	if (bEscaped)
+	{
+		bEscaped = false;
+	}
+	else if (cRxedChar == '\\')
+	{
+		bEscaped = true;
+	}
+	else if (cQuote != 0)
+	{
+		cQuote = (cRxedChar == cQuote) ? 0 : cQuote;
+	}
+	else if (cRxedChar == '"' || cRxedChar == '\'')
+	{
+		cQuote = cRxedChar;
+	}
+
+	if (!bSeparator)
+	{
+		if (bTooLong || (ucLength == 0 && cRxedChar == ' ') || (uint8_t)cRxedChar < ASCII_WHITESPACE)
+		{
+			return NULL;
+		}
+
+		if (ucLength >= MAX_INPUT_LENGTH_CLI - 1)
+		{
+			bTooLong = true;
+			return NULL;
+		}
+
+		pcCommand[ucLength++] = cRxedChar;
+		return NULL;
+	}
+
+	// End of a command. Quotes never carry over to the next one
+	cQuote = 0;
+	bEscaped = false;
+
+	if (bTooLong)
+	{
+		bTooLong = false;
+		ucLength = 0;
+		prvWriteFrame("TOOLONG", 0);
+		return NULL;
+	}
+
+	while (ucLength > 0 && pcCommand[ucLength - 1] == ' ')
+	{
+		ucLength--;
+	}
+
+	if (ucLength == 0)
+	{
+		return NULL;
+	}
+
+	pcCommand[ucLength] = 0;
+	bCommandComplete = true;
+	return pcCommand;
+}
+
+/**
+ * @brief Sends the status frame for the command that just finished.
+ */
+void CliBatchWriteStatus(uint32_t ulCycles)
+{
+	const char *pcStatus;
+	uint32_t ulCyclesPerMicrosecond = configCPU_CLOCK_HZ / 1000000UL;
+
+	switch (FreeRTOS_CLIGetLastStatus())
+	{
+		case pdCLI_STATUS_NOT_FOUND:
+			pcStatus = "NOTFOUND";
+			break;
+
+		case pdCLI_STATUS_BAD_PARAMETERS:
+			pcStatus = "BADARGS";
+			break;
+
+		default:
+			pcStatus = "OK";
+			break;
+	}
+
+	prvWriteFrame(pcStatus, ulCycles / ((ulCyclesPerMicrosecond > 0) ? ulCyclesPerMicrosecond : 1));
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvWriteFrame(const char *pcStatus, uint32_t ulMicroseconds)
+ * @brief		Sends one "@<sequence> <status> <microseconds>" frame
+ *****************************************************************************/
+static void prvWriteFrame(const char *pcStatus, uint32_t ulMicroseconds)
+{
+	char pcFrame[CLI_BATCH_FRAME_LENGTH];
+
+	snprintf(pcFrame, sizeof(pcFrame), "@%lu %s %lu\r\n", ulSequence++, pcStatus, ulMicroseconds);
+	SerialConsoleWriteString(pcFrame);
+}
@@ -0,0 +1,60 @@
+/**************************************************************************/ /**
+ * @file      CliBatch.h
+ * @brief     Batch input mode for the CLI console, for scripts and test rigs.
+ * @details   "batch on" switches the console from the interactive line editor
+ *            to batch mode:
+ *            --Nothing is echoed and there is no line editing
+ *            --Commands are separated by ';', '\r' or '\n'. A ';' inside
+ *              quotes or after a backslash does not split the line
+ *            --After each command's output one status frame is sent:
+ *                  @<sequence> <status> <microseconds>\r\n
+ *              where status is OK, NOTFOUND, BADARGS or TOOLONG and the time
+ *              covers the whole command, including all of its output calls
+ *            --"batch off" returns to interactive mode (and gets a frame)
+ *            A script can be sent in one go without waiting for each frame:
+ *            the UART receive ring buffers up to RX_BUFFER_SIZE bytes ahead of
+ *            the command being run.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CLI_BATCH_H
+#define CLI_BATCH_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "CliThread.h"
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void CliBatchEnable(bool bEnable)
+ * @brief		Enters or leaves batch mode. Entering resets the sequence number to 0
+ *****************************************************************************/
+void CliBatchEnable(bool bEnable);
+
+/**
+ * @fn			bool CliBatchIsEnabled(void)
+ * @brief		Returns true while the console is in batch mode
+ *****************************************************************************/
+bool CliBatchIsEnabled(void);
+
+/**
+ * @fn			const char *CliBatchProcessChar(char cRxedChar)
+ * @brief		Feeds one received character to the batch command splitter
+ * @details		Leading spaces and empty commands are dropped. A command longer than
+ *				MAX_INPUT_LENGTH_CLI - 1 is discarded and answered with a TOOLONG frame.
+ * @param[in]	cRxedChar Character received from the console
+ * @return		The next complete command, or NULL. Valid until the next call.
+ *****************************************************************************/
+const char *CliBatchProcessChar(char cRxedChar);
+
+/**
+ * @fn			void CliBatchWriteStatus(uint32_t ulCycles)
+ * @brief		Sends the status frame for the command that just finished
+ * @param[in]	ulCycles CPU cycles the command took, from BenchmarkGetCycles()
+ *****************************************************************************/
+void CliBatchWriteStatus(uint32_t ulCycles);
+
+#endif /* CLI_BATCH_H */
@@ -0,0 +1,698 @@
+/**************************************************************************/ /**
+ * @file      CliLineEditor.c
+ * @brief     Line editor and command history for the CLI console.
+ * @details   The history is a ring of bytes in a static arena. Each line is
+ *            stored as [length][characters][length]: the leading length lets
+ *            the oldest line be dropped from the tail, the trailing one lets
+ *            the newest lines be walked back from the head. Lines are not
+ *            null terminated in the arena and may wrap around its end.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "CliLineEditor.h"
+#include "SerialConsole.h"
+#include "FreeRTOS_CLI.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CTRL_KEY(c) ((c) & 0x1F) ///< Code sent by Ctrl + letter
+#define VT100_ERASE_TO_EOL "\x1b[K"
+#define VT100_INSERT_CHAR "\x1b[@"
+#define VT100_DELETE_CHAR "\x1b[P"
+#define VT100_SEQUENCE_MAX 8 ///< Longest cursor move sequence, "\x1b[99D"
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+enum eEscapeStates
+{
+	ESCAPE_NONE = 0, ///< Not inside an escape sequence
+	ESCAPE_START,	 ///< ESC received
+	ESCAPE_CSI		 ///< ESC [ or ESC O received, collecting parameter digits
+};
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvWrite(const char *pcString);
+static void prvBell(void);
+static void prvMoveCursor(uint8_t ucTarget);
+static void prvInsertChar(char cChar);
+static void prvDeleteChar(void);
+static void prvBackspace(void);
+static void prvReplaceLine(const char *pcNew, uint8_t ucNewLength);
+static void prvProcessEscape(char cFinal, uint8_t ucParameter);
+static void prvTabComplete(bool bListCandidates);
+static void prvHistoryAdd(const char *pcText, uint8_t ucLength);
+static uint8_t prvHistoryCopy(uint8_t ucIndex, char *pcOut);
+static void prvHistoryRecall(int16_t sIndex);
+static void prvSearchProcessChar(char cChar);
+static int16_t prvSearchFrom(int16_t sStart);
+static void prvSearchDraw(void);
+static void prvSearchEnd(bool bKeepMatch);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static char pcLine[MAX_INPUT_LENGTH_CLI];	 ///< Line being edited, always null terminated
+static char pcScratch[MAX_INPUT_LENGTH_CLI]; ///< Holds a line read back from the history
+static uint8_t ucLength = 0;				 ///< Characters in pcLine
+static uint8_t ucCursor = 0;				 ///< Cursor position in pcLine, 0..ucLength
+static bool bLineComplete = false;			 ///< pcLine was returned and is cleared on the next character
+static char cPreviousChar = 0;				 ///< Used to treat "\r\n" as one line ending
+static bool bLastKeyWasTab = false;
+
+static enum eEscapeStates eEscapeState = ESCAPE_NONE;
+static uint8_t ucEscapeParameter = 0; ///< Numeric parameter of the sequence, e.g. 3 in "ESC [ 3 ~"
+
+static uint8_t ucHistoryArena[CLI_HISTORY_ARENA_SIZE];
+static uint16_t usHistoryHead = 0;	///< Where the next line is written
+static uint16_t usHistoryUsed = 0;	///< Bytes of the arena in use
+static uint8_t ucHistoryCount = 0;	///< Lines in the history
+static int16_t sHistoryBrowse = -1; ///< Line shown by Up/Down, 0 is the newest, -1 is a new line
+
+static bool bSearching = false;
+static char pcSearch[CLI_SEARCH_MAX_LENGTH + 1];
+static uint8_t ucSearchLength = 0;
+static int16_t sSearchMatch = -1; ///< History line matching pcSearch, -1 if none
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Feeds one character to the editor and returns the line when it is complete.
+ */
+const char *CliLineEditorProcessChar(char cRxedChar)
+{
+	char cPrevious = cPreviousChar;
+	cPreviousChar = cRxedChar;
+
+	if (bLineComplete)
+	{
+		ucLength = 0;
+		ucCursor = 0;
+		pcLine[0] = 0;
+		bLineComplete = false;
+	}
+
+	// A second TAB in a row lists the candidates instead of completing
+	bool bDoubleTab = bLastKeyWasTab && cRxedChar == ASCII_TAB;
+	bLastKeyWasTab = (cRxedChar == ASCII_TAB) && !bDoubleTab;
+
+	if (bSearching)
+	{
+		if (cRxedChar != '\r' && cRxedChar != '\n')
+		{
+			prvSearchProcessChar(cRxedChar);
+			return NULL;
+		}
+		prvSearchEnd(true);
+	}
+
+	if (eEscapeState == ESCAPE_START)
+	{
+		eEscapeState = (cRxedChar == '[' || cRxedChar == 'O') ? ESCAPE_CSI : ESCAPE_NONE;
+		ucEscapeParameter = 0;
+		return NULL;
+	}
+
+	if (eEscapeState == ESCAPE_CSI)
+	{
+		if (cRxedChar >= '0' && cRxedChar <= '9')
+		{
+			ucEscapeParameter = (uint8_t)(ucEscapeParameter * 10 + (cRxedChar - '0'));
+		}
+		else
+		{
+			eEscapeState = ESCAPE_NONE;
+			prvProcessEscape(cRxedChar, ucEscapeParameter);
+		}
+		return NULL;
+	}
+
+	if (cRxedChar == '\r' || cRxedChar == '\n')
+	{
+		if (cRxedChar == '\n' && cPrevious == '\r')
+		{
+			return NULL; // Second half of a "\r\n" line ending
+		}
+
+		prvWrite("\r\n");
+		sHistoryBrowse = -1;
+		bLineComplete = true;
+
+		if (ucLength == 0)
+		{
+			return NULL;
+		}
+
+		prvHistoryAdd(pcLine, ucLength);
+		return pcLine;
+	}
+
+	switch (cRxedChar)
+	{
+		case ASCII_BACKSPACE:
+		case ASCII_DELETE:
+			prvBackspace();
+			break;
+
+		case ASCII_ESC:
+			eEscapeState = ESCAPE_START;
+			break;
+
+		case ASCII_TAB:
+			prvTabComplete(bDoubleTab);
+			break;
+
+		case CTRL_KEY('A'):
+			prvMoveCursor(0);
+			break;
+
+		case CTRL_KEY('E'):
+			prvMoveCursor(ucLength);
+			break;
+
+		case CTRL_KEY('C'):
+			prvWrite("^C\r\n");
+			ucLength = 0;
+			ucCursor = 0;
+			pcLine[0] = 0;
+			sHistoryBrowse = -1;
+			break;
+
+		case CTRL_KEY('R'):
+			bSearching = true;
+			ucSearchLength = 0;
+			pcSearch[0] = 0;
+			sSearchMatch = -1;
+			prvSearchDraw();
+			break;
+
+		default:
+			if ((uint8_t)cRxedChar >= ASCII_WHITESPACE)
+			{
+				prvInsertChar(cRxedChar);
+			}
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Empties the history.
+ */
+void CliLineEditorClearHistory(void)
+{
+	usHistoryHead = 0;
+	usHistoryUsed = 0;
+	ucHistoryCount = 0;
+	sHistoryBrowse = -1;
+}
+
+/******************************************************************************
+ * Local Functions - Terminal Output
+ ******************************************************************************/
+
+static void prvWrite(const char *pcString)
+{
+	SerialConsoleWriteString((char *)pcString);
+}
+
+static void prvBell(void)
+{
+	char bell[2] = {ASCII_BELL, 0x00};
+	prvWrite(bell);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvMoveCursor(uint8_t ucTarget)
+ * @brief		Moves the terminal cursor to position ucTarget of the line.
+ * @details		A single step left is a plain backspace and a single step right
+ *				re-sends the character under the cursor, one byte each. Longer
+ *				moves use ESC[nD / ESC[nC.
+ *****************************************************************************/
+static void prvMoveCursor(uint8_t ucTarget)
+{
+	char pcSequence[VT100_SEQUENCE_MAX];
+
+	if (ucTarget < ucCursor)
+	{
+		if (ucCursor - ucTarget == 1)
+		{
+			pcSequence[0] = ASCII_BACKSPACE;
+			pcSequence[1] = 0;
+		}
+		else
+		{
+			snprintf(pcSequence, sizeof(pcSequence), "\x1b[%uD", (unsigned)(ucCursor - ucTarget));
+		}
+		prvWrite(pcSequence);
+	}
+	else if (ucTarget > ucCursor)
+	{
+		if (ucTarget - ucCursor == 1)
+		{
+			pcSequence[0] = pcLine[ucCursor];
+			pcSequence[1] = 0;
+		}
+		else
+		{
+			snprintf(pcSequence, sizeof(pcSequence), "\x1b[%uC", (unsigned)(ucTarget - ucCursor));
+		}
+		prvWrite(pcSequence);
+	}
+
+	ucCursor = ucTarget;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvInsertChar(char cChar)
+ * @brief		Inserts a character at the cursor. Mid-line the terminal opens a
+ *				gap with ESC[@ rather than having the rest of the line reprinted.
+ *****************************************************************************/
+static void prvInsertChar(char cChar)
+{
+	char pcEcho[2] = {cChar, 0x00};
+
+	if (ucLength >= MAX_INPUT_LENGTH_CLI - 1)
+	{
+		prvBell();
+		return;
+	}
+
+	memmove(&pcLine[ucCursor + 1], &pcLine[ucCursor], ucLength - ucCursor + 1);
+	pcLine[ucCursor] = cChar;
+	ucLength++;
+
+	if (ucCursor != ucLength - 1)
+	{
+		prvWrite(VT100_INSERT_CHAR);
+	}
+	prvWrite(pcEcho);
+	ucCursor++;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvDeleteChar(void)
+ * @brief		Deletes the character under the cursor (Delete key)
+ *****************************************************************************/
+static void prvDeleteChar(void)
+{
+	if (ucCursor >= ucLength)
+	{
+		return;
+	}
+
+	memmove(&pcLine[ucCursor], &pcLine[ucCursor + 1], ucLength - ucCursor);
+	ucLength--;
+	prvWrite(VT100_DELETE_CHAR);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvBackspace(void)
+ * @brief		Deletes the character before the cursor
+ *****************************************************************************/
+static void prvBackspace(void)
+{
+	if (ucCursor == 0)
+	{
+		return;
+	}
+
+	memmove(&pcLine[ucCursor - 1], &pcLine[ucCursor], ucLength - ucCursor + 1);
+	ucCursor--;
+	ucLength--;
+
+	if (ucCursor == ucLength)
+	{
+		char erase[4] = {ASCII_BACKSPACE, ASCII_WHITESPACE, ASCII_BACKSPACE, 0x00};
+		prvWrite(erase);
+	}
+	else
+	{
+		char erase[5] = {ASCII_BACKSPACE, ASCII_ESC, '[', 'P', 0x00};
+		prvWrite(erase);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvReplaceLine(const char *pcNew, uint8_t ucNewLength)
+ * @brief		Replaces the line with pcNew (null terminated), for example when
+ *				recalling history. Only the part after the prefix shared with the
+ *				current line is sent, followed by an erase to end of line if the
+ *				new line is shorter.
+ *****************************************************************************/
+static void prvReplaceLine(const char *pcNew, uint8_t ucNewLength)
+{
+	uint8_t ucCommon = 0;
+
+	while (ucCommon < ucLength && ucCommon < ucNewLength && pcLine[ucCommon] == pcNew[ucCommon])
+	{
+		ucCommon++;
+	}
+
+	prvMoveCursor(ucCommon);
+	prvWrite(&pcNew[ucCommon]);
+	if (ucNewLength < ucLength)
+	{
+		prvWrite(VT100_ERASE_TO_EOL);
+	}
+
+	memcpy(pcLine, pcNew, ucNewLength + 1);
+	ucLength = ucNewLength;
+	ucCursor = ucNewLength;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvProcessEscape(char cFinal, uint8_t ucParameter)
+ * @brief		Acts on a complete "ESC [ <parameter> <final>" sequence.
+ *				Both the VT100 (ESC [ A) and application mode (ESC O A) arrow
+ *				keys are accepted, as are the two common Home/End encodings.
+ *****************************************************************************/
+static void prvProcessEscape(char cFinal, uint8_t ucParameter)
+{
+	switch (cFinal)
+	{
+		case 'A': // Up
+			prvHistoryRecall(sHistoryBrowse + 1);
+			break;
+
+		case 'B': // Down
+			prvHistoryRecall(sHistoryBrowse - 1);
+			break;
+
+		case 'C': // Right
+			if (ucCursor < ucLength)
+			{
+				prvMoveCursor(ucCursor + 1);
+			}
+			break;
+
+		case 'D': // Left
+			if (ucCursor > 0)
+			{
+				prvMoveCursor(ucCursor - 1);
+			}
+			break;
+
+		case 'H': // Home
+			prvMoveCursor(0);
+			break;
+
+		case 'F': // End
+			prvMoveCursor(ucLength);
+			break;
+
+		case '~':
+			if (ucParameter == 1 || ucParameter == 7)
+			{
+				prvMoveCursor(0);
+			}
+			else if (ucParameter == 4 || ucParameter == 8)
+			{
+				prvMoveCursor(ucLength);
+			}
+			else if (ucParameter == 3)
+			{
+				prvDeleteChar();
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvTabComplete(bool bListCandidates)
+ * @brief		Completes the command name being typed against the registered commands.
+ * @details		Only the first word is completed, and only with the cursor at the end
+ *				of the line. A unique match is completed in full and followed by a
+ *				space; several matches are extended to their common prefix. If nothing
+ *				can be added the terminal bell is rung, or, on a double TAB, the
+ *				candidates are listed and the line is reprinted. The lookup is a binary
+ *				search over the CLI's sorted command index, so it runs in bounded time
+ *				and does not allocate.
+ * @param[in]	bListCandidates True on the second TAB in a row
+ *****************************************************************************/
+static void prvTabComplete(bool bListCandidates)
+{
+	UBaseType_t uxFirst, uxMatches;
+	size_t xCommon;
+	uint8_t ucStart = ucLength;
+
+	if (ucCursor != ucLength || memchr(pcLine, ' ', ucLength) != NULL)
+	{
+		prvBell(); // Parameters are not completed
+		return;
+	}
+
+	uxMatches = FreeRTOS_CLIFindCompletions(pcLine, ucLength, &uxFirst, &xCommon);
+
+	if (uxMatches > 0 && (xCommon > ucLength || uxMatches == 1))
+	{
+		const char *pcName = FreeRTOS_CLIGetCommandName(uxFirst);
+
+		while (ucLength < xCommon && ucLength < MAX_INPUT_LENGTH_CLI - 2)
+		{
+			pcLine[ucLength] = pcName[ucLength];
+			ucLength++;
+		}
+
+		if (uxMatches == 1)
+		{
+			pcLine[ucLength++] = ' ';
+		}
+
+		pcLine[ucLength] = 0;
+		ucCursor = ucLength;
+		prvWrite(&pcLine[ucStart]);
+	}
+	else if (uxMatches > 1 && bListCandidates)
+	{
+		prvWrite("\r\n");
+		for (UBaseType_t i = uxFirst; i < uxFirst + uxMatches; i++)
+		{
+			prvWrite(FreeRTOS_CLIGetCommandName(i));
+			prvWrite("  ");
+		}
+		prvWrite("\r\n");
+		prvWrite(pcLine);
+	}
+	else
+	{
+		prvBell();
+	}
+}
+
+/******************************************************************************
+ * Local Functions - History
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvHistoryAdd(const char *pcText, uint8_t ucLength)
+ * @brief		Appends a line to the history, dropping the oldest lines until it
+ *				fits. A line equal to the newest entry is not stored twice.
+ *****************************************************************************/
+static void prvHistoryAdd(const char *pcText, uint8_t ucTextLength)
+{
+	uint16_t usNeeded = ucTextLength + 2;
+
+	if (ucTextLength == 0 || usNeeded > CLI_HISTORY_ARENA_SIZE)
+	{
+		return;
+	}
+
+	if (ucHistoryCount > 0 && prvHistoryCopy(0, pcScratch) == ucTextLength && memcmp(pcScratch, pcText, ucTextLength) == 0)
+	{
+		return;
+	}
+
+	while (CLI_HISTORY_ARENA_SIZE - usHistoryUsed < usNeeded)
+	{
+		uint16_t usTail = (usHistoryHead + CLI_HISTORY_ARENA_SIZE - usHistoryUsed) % CLI_HISTORY_ARENA_SIZE;
+		usHistoryUsed -= ucHistoryArena[usTail] + 2;
+		ucHistoryCount--;
+	}
+
+	ucHistoryArena[usHistoryHead] = ucTextLength;
+	for (uint8_t i = 0; i < ucTextLength; i++)
+	{
+		ucHistoryArena[(usHistoryHead + 1 + i) % CLI_HISTORY_ARENA_SIZE] = (uint8_t)pcText[i];
+	}
+	ucHistoryArena[(usHistoryHead + 1 + ucTextLength) % CLI_HISTORY_ARENA_SIZE] = ucTextLength;
+
+	usHistoryHead = (usHistoryHead + usNeeded) % CLI_HISTORY_ARENA_SIZE;
+	usHistoryUsed += usNeeded;
+	ucHistoryCount++;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t prvHistoryCopy(uint8_t ucIndex, char *pcOut)
+ * @brief		Copies history line ucIndex (0 is the newest) into pcOut and null
+ *				terminates it. The caller must check ucIndex < ucHistoryCount.
+ * @return		Length of the line
+ *****************************************************************************/
+static uint8_t prvHistoryCopy(uint8_t ucIndex, char *pcOut)
+{
+	uint16_t usEnd = usHistoryHead; // One past the trailing length of the line
+	uint16_t usStart;
+	uint8_t ucTextLength;
+
+	for (;;)
+	{
+		ucTextLength = ucHistoryArena[(usEnd + CLI_HISTORY_ARENA_SIZE - 1) % CLI_HISTORY_ARENA_SIZE];
+		usStart = (usEnd + CLI_HISTORY_ARENA_SIZE - 1 - ucTextLength) % CLI_HISTORY_ARENA_SIZE;
+		if (ucIndex-- == 0)
+		{
+			break;
+		}
+		usEnd = (usStart + CLI_HISTORY_ARENA_SIZE - 1) % CLI_HISTORY_ARENA_SIZE;
+	}
+
+	for (uint8_t i = 0; i < ucTextLength; i++)
+	{
+		pcOut[i] = (char)ucHistoryArena[(usStart + i) % CLI_HISTORY_ARENA_SIZE];
+	}
+	pcOut[ucTextLength] = 0;
+
+	return ucTextLength;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvHistoryRecall(int16_t sIndex)
+ * @brief		Shows history line sIndex, or an empty line for -1
+ *****************************************************************************/
+static void prvHistoryRecall(int16_t sIndex)
+{
+	if (sIndex < -1 || sIndex >= ucHistoryCount)
+	{
+		prvBell();
+		return;
+	}
+
+	sHistoryBrowse = sIndex;
+	if (sIndex < 0)
+	{
+		pcScratch[0] = 0;
+		prvReplaceLine(pcScratch, 0);
+	}
+	else
+	{
+		uint8_t ucTextLength = prvHistoryCopy((uint8_t)sIndex, pcScratch);
+		prvReplaceLine(pcScratch, ucTextLength);
+	}
+}
+
+/******************************************************************************
+ * Local Functions - Reverse Search
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvSearchProcessChar(char cChar)
+ * @brief		Handles a key while Ctrl-R search is active
+ *****************************************************************************/
+static void prvSearchProcessChar(char cChar)
+{
+	if (cChar == CTRL_KEY('R'))
+	{
+		int16_t sMatch = prvSearchFrom(sSearchMatch + 1);
+		if (sMatch >= 0)
+		{
+			sSearchMatch = sMatch;
+		}
+		else
+		{
+			prvBell();
+		}
+	}
+	else if (cChar == ASCII_BACKSPACE || cChar == ASCII_DELETE)
+	{
+		if (ucSearchLength > 0)
+		{
+			pcSearch[--ucSearchLength] = 0;
+			sSearchMatch = prvSearchFrom(0);
+		}
+	}
+	else if (cChar == ASCII_ESC || cChar == CTRL_KEY('G'))
+	{
+		prvSearchEnd(false);
+		return;
+	}
+	else if ((uint8_t)cChar < ASCII_WHITESPACE)
+	{
+		prvSearchEnd(true);
+		return;
+	}
+	else if (ucSearchLength < CLI_SEARCH_MAX_LENGTH)
+	{
+		pcSearch[ucSearchLength++] = cChar;
+		pcSearch[ucSearchLength] = 0;
+		sSearchMatch = prvSearchFrom((sSearchMatch < 0) ? 0 : sSearchMatch);
+	}
+
+	prvSearchDraw();
+}
+
+/**************************************************************************/ /**
+ * @fn			static int16_t prvSearchFrom(int16_t sStart)
+ * @brief		Finds the newest history line at or older than sStart that contains
+ *				pcSearch. Leaves the match in pcScratch.
+ * @return		Index of the match, or -1
+ *****************************************************************************/
+static int16_t prvSearchFrom(int16_t sStart)
+{
+	for (int16_t i = sStart; i < ucHistoryCount; i++)
+	{
+		prvHistoryCopy((uint8_t)i, pcScratch);
+		if (strstr(pcScratch, pcSearch) != NULL)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSearchDraw(void)
+ * @brief		Shows the search prompt and the current match
+ *****************************************************************************/
+static void prvSearchDraw(void)
+{
+	prvWrite("\r" VT100_ERASE_TO_EOL "(reverse-i-search)`");
+	prvWrite(pcSearch);
+	prvWrite("': ");
+	if (sSearchMatch >= 0)
+	{
+		prvHistoryCopy((uint8_t)sSearchMatch, pcScratch);
+		prvWrite(pcScratch);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSearchEnd(bool bKeepMatch)
+ * @brief		Leaves search mode, optionally loading the match into the line,
+ *				and redraws the line with the cursor at its end.
+ *****************************************************************************/
+static void prvSearchEnd(bool bKeepMatch)
+{
+	bSearching = false;
+
+	if (bKeepMatch && sSearchMatch >= 0)
+	{
+		ucLength = prvHistoryCopy((uint8_t)sSearchMatch, pcLine);
+		sHistoryBrowse = sSearchMatch;
+	}
+
+	ucCursor = ucLength;
+	prvWrite("\r" VT100_ERASE_TO_EOL);
+	prvWrite(pcLine);
+}
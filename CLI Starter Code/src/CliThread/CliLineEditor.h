@@ -0,0 +1,53 @@
+/**************************************************************************/ /**
+ * @file      CliLineEditor.h
+ * @brief     Line editor for the CLI console: cursor movement, insert/delete
+ *            mid-line, TAB completion, a multi-entry command history and
+ *            Ctrl-R reverse search.
+ * @details   Keys handled:
+ *            --Left/Right, Home/End (also Ctrl-A/Ctrl-E): move the cursor
+ *            --Backspace, Delete: remove the character before/under the cursor
+ *            --Up/Down: walk the history, newest first
+ *            --Ctrl-R: reverse search the history. Ctrl-R again finds an older
+ *              match, Enter runs it, ESC or Ctrl-G cancels, any other control
+ *              key keeps it on the line for editing
+ *            --TAB: complete the command name, double TAB lists candidates
+ *            --Ctrl-C: drop the line
+ *            The terminal is updated with the shortest VT100 sequence that
+ *            does the job (insert/delete character, relative cursor moves,
+ *            erase to end of line) instead of reprinting the line.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CLI_LINE_EDITOR_H
+#define CLI_LINE_EDITOR_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "CliThread.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CLI_HISTORY_ARENA_SIZE 512 ///< Bytes of history storage. Each line costs its length + 2
+#define CLI_SEARCH_MAX_LENGTH 16   ///< Longest Ctrl-R search string
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			const char *CliLineEditorProcessChar(char cRxedChar)
+ * @brief		Feeds one received character to the line editor
+ * @param[in]	cRxedChar Character received from the console
+ * @return		The completed command line when Enter ends a non-empty line, otherwise
+ *				NULL. The line stays valid until the next call.
+ *****************************************************************************/
+const char *CliLineEditorProcessChar(char cRxedChar);
+
+/**
+ * @fn			void CliLineEditorClearHistory(void)
+ * @brief		Forgets every line in the history
+ *****************************************************************************/
+void CliLineEditorClearHistory(void);
+
+#endif /* CLI_LINE_EDITOR_H */
@@ -11,9 +11,29 @@
  ******************************************************************************/
 #include "CliThread.h"
 #include "SerialConsole.h"
+#include "CliLineEditor.h"
+#include "CliBatch.h"
+#include "Benchmark/Benchmark.h"
+#include "ClockProfile/ClockProfile.h"
+#include "MemPool/MemPool.h"
+#include "LowPower/LowPower.h"
+#include "Trace/Trace.h"
+#include "IrqMonitor/IrqMonitor.h"
+#include "WorkQueue/WorkQueue.h"
+#include "StackMonitor/StackMonitor.h"
+#include "Imu/Imu.h"
+#include "Pipeline/Pipeline.h"
+#include "HitDetect/HitDetect.h"
+#include "Fusion/Fusion.h"
+#include "SessionStats/SessionStats.h"
+#include "SessionStats/SessionRollup.h"
+#include "Codec/Codec.h"
+#include "Stroke/Stroke.h"
+#include <stdlib.h>
 #define FW_VERSION "0.0.1"
 
 SemaphoreHandle_t xRxNotificationSemaphore;
+static StaticSemaphore_t xRxNotificationSemaphoreBuffer;
 
 
 
@@ -89,6 +109,175 @@ static const CLI_Command_Definition_t xTicksCommand =
 	0
 };
 
+static const CLI_Command_Definition_t xBenchCommand =
+{
+	"bench",
+	"bench <name|all>: Runs an on-target benchmark and prints min/median/max CPU cycles.\r\n",
+	NULL,
+	1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Benchmark
+};
+
+static const CLI_Command_Definition_t xBatchCommand =
+{
+	"batch",
+	"batch <on|off>: Script mode. No echo, commands split by ; or newline, one \"@<seq> <status> <us>\" frame each.\r\n",
+	NULL,
+	1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Batch
+};
+
+static const CLI_Command_Definition_t xClockCommand =
+{
+	"clock",
+	"clock [high|low|auto]: CPU clock profile, or fix it at 48 MHz (high) or 8 MHz (low), or let the IMU activity pick it\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_ClockProfile
+};
+
+static const CLI_Command_Definition_t xPoolsCommand =
+{
+	"pools",
+	"pools: Lists the memory pools with block size, blocks in use, high-water mark and failed allocations.\r\n",
+	NULL,
+	0,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_MemPools
+};
+
+static const CLI_Command_Definition_t xSleepCommand =
+{
+	"sleep",
+	"sleep [reset]: Shows the time spent running, in IDLE and in STANDBY, and ticks lost to late wakes, or clears it.\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_SleepStats
+};
+
+static const CLI_Command_Definition_t xTraceCommand =
+{
+	"trace",
+	"trace <start|stop|clear|dump>: Kernel trace recorder. dump stops it and prints the ring for tools/trace2chrome.py\r\n",
+	NULL,
+	1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Trace
+};
+
+static const CLI_Command_Definition_t xIrqCommand =
+{
+	"irq",
+	"irq [reset|hist <name>]: Shows interrupt latency and duration in CPU cycles, a log2 histogram of one interrupt, or clears them.\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Irq
+};
+
+static const CLI_Command_Definition_t xWorkCommand =
+{
+	"work",
+	"work [reset]: Shows the work queue items, their runs and latency in CPU cycles, or clears the counters.\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Work
+};
+
+static const CLI_Command_Definition_t xStacksCommand =
+{
+	"stacks",
+	"stacks: Shows the size and measured peak of every task stack and of the main (interrupt) stack, in bytes.\r\n",
+	NULL,
+	0,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Stacks
+};
+
+static const CLI_Command_Definition_t xImuCommand =
+{
+	"imu",
+	"imu [reset | quiet <ms> | rate <auto|Hz>]: IMU counters and latest sample, clear them, quiet period (0: never), or rate\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_GetImuData
+};
+
+static const CLI_Command_Definition_t xPipeCommand =
+{
+	"pipe",
+	"pipe [reset | synth <on|off>]: Frame pipeline counters and latency (cycles), clear, or the 10x synthetic source\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Pipe
+};
+
+static const CLI_Command_Definition_t xHitsCommand =
+{
+	"hits",
+	"hits [reset]: Hit count, noise floor and threshold (mg), last hit, detector cycles per block, or clear them\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Hits
+};
+
+static const CLI_Command_Definition_t xOrientCommand =
+{
+	"orient",
+	"orient [reset]: Shows the orientation quaternion (x10000) and the gravity direction (mg), or restarts the filter.\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Orient
+};
+
+static const CLI_Command_Definition_t xStatsCommand =
+{
+	"stats",
+	"stats [reset | record]: Session hit statistics (mg, ms), new session, or the upload record in hex\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Stats
+};
+
+static const CLI_Command_Definition_t xCodecCommand =
+{
+	"codec",
+	"codec [on | off | reset | dump]: Stream codec counters, start or stop recording, clear, or dump the queue in hex\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Codec
+};
+
+static const CLI_Command_Definition_t xStrokeCommand =
+{
+	"stroke",
+	"stroke [reset]: Strokes classified, inference cycles, model footprint and last stroke, or clear the counters\r\n",
+	NULL,
+	-1,
+	(const pdCOMMAND_LINE_ARGV_CALLBACK)CLI_Stroke
+};
+
+/** Every command, registered in this order. help is built in, so configCLI_MAX_COMMANDS must exceed the count */
+static const CLI_Command_Definition_t *const pxCliCommands[] =
+{
+	&xClearScreen,
+	&xResetCommand,
+	&xVersionCommand,
+	&xTicksCommand,
+	&xBenchCommand,
+	&xBatchCommand,
+	&xClockCommand,
+	&xPoolsCommand,
+	&xSleepCommand,
+	&xTraceCommand,
+	&xIrqCommand,
+	&xWorkCommand,
+	&xStacksCommand,
+	&xImuCommand,
+	&xPipeCommand,
+	&xHitsCommand,
+	&xOrientCommand,
+	&xStatsCommand,
+	&xCodecCommand,
+	&xStrokeCommand,
+};
+
 
 /******************************************************************************
  * Forward Declarations
@@ -104,24 +293,30 @@ static void FreeRTOS_read(char *character);
 
 void vCommandConsoleTask(void *pvParameters)
 {
+	BaseType_t xRegistered;
+
     // REGISTER COMMANDS HERE
-	xRxNotificationSemaphore = xSemaphoreCreateBinary();
-    FreeRTOS_CLIRegisterCommand(&xClearScreen);
-    FreeRTOS_CLIRegisterCommand(&xResetCommand);
-	FreeRTOS_CLIRegisterCommand(&xVersionCommand);
-	FreeRTOS_CLIRegisterCommand(&xTicksCommand);
+	xRxNotificationSemaphore = xSemaphoreCreateBinaryStatic(&xRxNotificationSemaphoreBuffer);
+	for (size_t i = 0; i < sizeof(pxCliCommands) / sizeof(pxCliCommands[0]); i++)
+	{
+		/* "help" copies each help string whole into the output buffer */
+		configASSERT(strlen(pxCliCommands[i]->pcHelpString) < MAX_OUTPUT_LENGTH_CLI);
+		/* Stops here rather than leave a command out: raise configCLI_MAX_COMMANDS */
+		xRegistered = FreeRTOS_CLIRegisterCommand(pxCliCommands[i]);
+		configASSERT(xRegistered == pdPASS);
+	}
 
 	
 	
 
-    uint8_t cRxedChar[2], cInputIndex = 0;
+    uint8_t cRxedChar[2];
+    const char *pcCommand;
     BaseType_t xMoreDataToFollow;
-    /* The input and output buffers are declared static to keep them off the stack. */
-    static char pcOutputString[MAX_OUTPUT_LENGTH_CLI], pcInputString[MAX_INPUT_LENGTH_CLI];
-    static char pcLastCommand[MAX_INPUT_LENGTH_CLI];
-    static bool isEscapeCode = false;
-    static char pcEscapeCodes[4];
-    static uint8_t pcEscapeCodePos = 0;
+    bool bBatch;
+    uint32_t ulStartCycles;
+    /* The output buffer is declared static to keep it off the stack. The line
+    being typed is owned by the line editor. */
+    static char pcOutputString[MAX_OUTPUT_LENGTH_CLI];
 
     // Any semaphores/mutexes/etc you needed to be initialized, you can do them here
 
@@ -131,7 +326,6 @@ void vCommandConsoleTask(void *pvParameters)
 
     /* Send a welcome message to the user knows they are connected. */
     SerialConsoleWriteString(pcWelcomeMessage);
-    char rxChar;
     for (;;)
     {
         /* This implementation reads a single character at a time.  Wait in the
@@ -139,129 +333,53 @@ void vCommandConsoleTask(void *pvParameters)
 
         FreeRTOS_read(&cRxedChar);
 
-        if (cRxedChar[0] == '\n' || cRxedChar[0] == '\r')
+        /* Editing keys, history and completion are handled by the line editor.
+        It returns the command string once Enter ends a non-empty line. In
+        batch mode the input is split into commands without any echo. */
+        bBatch = CliBatchIsEnabled();
+        if (bBatch)
         {
-            /* A newline character was received, so the input command string is
-            complete and can be processed.  Transmit a line separator, just to
-            make the output easier to read. */
-            SerialConsoleWriteString("\r\n");
-            // Copy for last command
-            isEscapeCode = false;
-            pcEscapeCodePos = 0;
-            strncpy(pcLastCommand, pcInputString, MAX_INPUT_LENGTH_CLI - 1);
-            pcLastCommand[MAX_INPUT_LENGTH_CLI - 1] = 0; // Ensure null termination
-
-            /* The command interpreter is called repeatedly until it returns
-            pdFALSE.  See the "Implementing a command" documentation for an
-            explanation of why this is. */
-            do
-            {
-                /* Send the command string to the command interpreter.  Any
-                output generated by the command interpreter will be placed in the
-                pcOutputString buffer. */
-                xMoreDataToFollow = FreeRTOS_CLIProcessCommand(
-                    pcInputString,        /* The command string.*/
-                    pcOutputString,       /* The output buffer. */
-                    MAX_OUTPUT_LENGTH_CLI /* The size of the output buffer. */
-                );
-
-                /* Write the output generated by the command interpreter to the
-                console. */
-                // Ensure it is null terminated
-                pcOutputString[MAX_OUTPUT_LENGTH_CLI - 1] = 0;
-                SerialConsoleWriteString(pcOutputString);
-
-            } while (xMoreDataToFollow != pdFALSE);
-
-            /* All the strings generated by the input command have been sent.
-            Processing of the command is complete.  Clear the input string ready
-            to receive the next command. */
-            cInputIndex = 0;
-            memset(pcInputString, 0x00, MAX_INPUT_LENGTH_CLI);
+            pcCommand = CliBatchProcessChar(cRxedChar[0]);
         }
         else
         {
-            /* The if() clause performs the processing after a newline character
-    is received.  This else clause performs the processing if any other
-    character is received. */
-
-            if (true == isEscapeCode)
-            {
-
-                if (pcEscapeCodePos < CLI_PC_ESCAPE_CODE_SIZE)
-                {
-                    pcEscapeCodes[pcEscapeCodePos++] = cRxedChar[0];
-                }
-                else
-                {
-                    isEscapeCode = false;
-                    pcEscapeCodePos = 0;
-                }
-
-                if (pcEscapeCodePos >= CLI_PC_MIN_ESCAPE_CODE_SIZE)
-                {
-
-                    // UP ARROW SHOW LAST COMMAND
-                    if (strcasecmp(pcEscapeCodes, "oa"))
-                    {
-                        /// Delete current line and add prompt (">")
-                        sprintf(pcInputString, "%c[2K\r>", 27);
-                        SerialConsoleWriteString(pcInputString);
-                        /// Clear input buffer
-                        cInputIndex = 0;
-                        memset(pcInputString, 0x00, MAX_INPUT_LENGTH_CLI);
-                        /// Send last command
-                        strncpy(pcInputString, pcLastCommand, MAX_INPUT_LENGTH_CLI - 1);
-                        cInputIndex = (strlen(pcInputString) < MAX_INPUT_LENGTH_CLI - 1) ? strlen(pcLastCommand) : MAX_INPUT_LENGTH_CLI - 1;
-                        SerialConsoleWriteString(pcInputString);
-                    }
-
-                    isEscapeCode = false;
-                    pcEscapeCodePos = 0;
-                }
-            }
-            /* The if() clause performs the processing after a newline character
-            is received.  This else clause performs the processing if any other
-            character is received. */
-
-            else if (cRxedChar[0] == '\r')
-            {
-                /* Ignore carriage returns. */
-            }
-            else if (cRxedChar[0] == ASCII_BACKSPACE || cRxedChar[0] == ASCII_DELETE)
-            {
-                char erase[4] = {0x08, 0x20, 0x08, 0x00};
-                SerialConsoleWriteString(erase);
-                /* Backspace was pressed.  Erase the last character in the input
-                buffer - if there are any. */
-                if (cInputIndex > 0)
-                {
-                    cInputIndex--;
-                    pcInputString[cInputIndex] = 0;
-                }
-            }
-            // ESC
-            else if (cRxedChar[0] == ASCII_ESC)
-            {
-                isEscapeCode = true; // Next characters will be code arguments
-                pcEscapeCodePos = 0;
-            }
-            else
-            {
-                /* A character was entered.  It was not a new line, backspace
-                or carriage return, so it is accepted as part of the input and
-                placed into the input buffer.  When a n is entered the complete
-                string will be passed to the command interpreter. */
-                if (cInputIndex < MAX_INPUT_LENGTH_CLI)
-                {
-                    pcInputString[cInputIndex] = cRxedChar[0];
-                    cInputIndex++;
-                }
-
-                // Order Echo
-                cRxedChar[1] = 0;
-                SerialConsoleWriteString(&cRxedChar[0]);
-            }
+            pcCommand = CliLineEditorProcessChar(cRxedChar[0]);
+        }
+
+        if (pcCommand == NULL)
+        {
+            continue;
+        }
+
+        ulStartCycles = BenchmarkGetCycles();
+        TraceSectionBegin(TRACE_SECTION_CLI_COMMAND);
+
+        /* The command interpreter is called repeatedly until it returns
+        pdFALSE.  See the "Implementing a command" documentation for an
+        explanation of why this is. */
+        do
+        {
+            /* Send the command string to the command interpreter.  Any
+            output generated by the command interpreter will be placed in the
+            pcOutputString buffer. */
+            xMoreDataToFollow = FreeRTOS_CLIProcessCommand(
+                pcCommand,            /* The command string.*/
+                pcOutputString,       /* The output buffer. */
+                MAX_OUTPUT_LENGTH_CLI /* The size of the output buffer. */
+            );
+
+            /* Write the output generated by the command interpreter to the
+            console. */
+            // Ensure it is null terminated
+            pcOutputString[MAX_OUTPUT_LENGTH_CLI - 1] = 0;
+            SerialConsoleWriteString(pcOutputString);
+
+        } while (xMoreDataToFollow != pdFALSE);
+
+        TraceSectionEnd(TRACE_SECTION_CLI_COMMAND);
+        if (bBatch)
+        {
+            CliBatchWriteStatus(BenchmarkGetCycles() - ulStartCycles);
         }
     }
 }
@@ -275,20 +393,24 @@ void vCommandConsoleTask(void *pvParameters)
  * When the semaphore is given by `usart_read_callback()`, this function reads the
  * character from the RX circular buffer (`cbufRx`) using `SerialConsoleReadCharacter()`
  * and stores it into the memory pointed to by `character`.
- * @note
+ * @note		The binary semaphore only records that at least one character
+ *				arrived, so characters received while a command was running are
+ *				read straight from the buffer and the task only blocks once it is
+ *				empty. Otherwise pasted or scripted input would stall with
+ *				characters left in the buffer.
  *****************************************************************************/
 static void FreeRTOS_read(char *character)
 {
 	// Wait indefinitely for a character to be available
-	if (xRxNotificationSemaphore != NULL && character != NULL)
+	while (xRxNotificationSemaphore != NULL && character != NULL)
 	{
-		if (xSemaphoreTake(xRxNotificationSemaphore, portMAX_DELAY) == pdTRUE)
+		if (SerialConsoleReadCharacter((uint8_t *)character) != -1)
 		{
-			if (SerialConsoleReadCharacter((uint8_t *)character) != -1)
-			{
-				return;
-			}
+			LowPowerNotifyActivity();
+			return;
 		}
+
+		xSemaphoreTake(xRxNotificationSemaphore, portMAX_DELAY);
 	}
 
 	*character = 0; // fallback, just in case
@@ -317,3 +439,1153 @@ BaseType_t CLI_ResetDevice(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const
     return pdFALSE;
 }
 
+
+
+/**
+ * @brief Runs one benchmark by name, or every registered benchmark with "all".
+ *
+ * With "all" one benchmark is run per call, so each result is printed as soon
+ * as it is ready and the output buffer only has to hold one line.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, always 2.
+ * @param[in] argv argv[1] is the benchmark name or "all".
+ *
+ * @return pdTRUE while there are more benchmarks to run, pdFALSE otherwise.
+ */
+BaseType_t CLI_Benchmark(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextBenchmark = 0; // Position in the table while running "all"
+	const Benchmark_Definition_t *pxBenchmark;
+	BenchmarkResult_t xResult;
+	BaseType_t xMoreDataToFollow = pdFALSE;
+
+	if (strcmp(argv[1], "all") == 0)
+	{
+		pxBenchmark = BenchmarkGet(uxNextBenchmark++);
+		if (uxNextBenchmark < BenchmarkGetCount())
+		{
+			xMoreDataToFollow = pdTRUE;
+		}
+		else
+		{
+			uxNextBenchmark = 0;
+		}
+	}
+	else
+	{
+		pxBenchmark = BenchmarkFind(argv[1], strlen(argv[1]));
+	}
+
+	if (pxBenchmark == NULL)
+	{
+		uxNextBenchmark = 0;
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Unknown benchmark. Use \"bench all\" to run them all.\r\n");
+		return pdFALSE;
+	}
+
+	BenchmarkRun(pxBenchmark, &xResult);
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-14s min %6lu  med %6lu  max %6lu cycles\r\n",
+			 pxBenchmark->pcName, xResult.ulMin, xResult.ulMedian, xResult.ulMax);
+
+	return xMoreDataToFollow;
+}
+
+/**
+ * @brief Switches batch mode on or off.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, always 2.
+ * @param[in] argv argv[1] is "on" or "off".
+ *
+ * @return pdFALSE to indicate no more output to print.
+ */
+BaseType_t CLI_Batch(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	if (strcmp(argv[1], "on") == 0)
+	{
+		CliBatchEnable(true);
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Batch mode on\r\n");
+	}
+	else if (strcmp(argv[1], "off") == 0)
+	{
+		CliBatchEnable(false);
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Batch mode off\r\n");
+	}
+	else
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: batch <on|off>\r\n");
+	}
+
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the CPU clock profile, fixes one, or hands it back to the IMU activity.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, 1 or 2.
+ * @param[in] argv argv[1], if given, is the profile name or "auto".
+ *
+ * @return pdFALSE to indicate no more output to print.
+ */
+BaseType_t CLI_ClockProfile(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	enum eClockProfiles eProfile;
+
+	if (argc > 2)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: clock [high|low|auto]\r\n");
+		return pdFALSE;
+	}
+
+	if (argc == 2 && strcmp(argv[1], "auto") == 0)
+	{
+		if (ClockProfileSetAuto(true) != pdPASS)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Could not switch to the requested clock profile\r\n");
+			return pdFALSE;
+		}
+	}
+	else if (argc == 2)
+	{
+		for (eProfile = CLOCK_PROFILE_HIGH; eProfile < N_CLOCK_PROFILES; eProfile++)
+		{
+			if (strcmp(argv[1], ClockProfileGetName(eProfile)) == 0)
+			{
+				break;
+			}
+		}
+
+		if (eProfile == N_CLOCK_PROFILES || ClockProfileSetAuto(false) != pdPASS || ClockProfileSet(eProfile) != pdPASS)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Could not switch to clock profile \"%s\"\r\n", argv[1]);
+			return pdFALSE;
+		}
+	}
+
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Clock profile: %s (%s), %lu Hz, %lu switches\r\n",
+			 ClockProfileGetName(ClockProfileGet()), ClockProfileIsAuto() ? "auto" : "fixed", configCPU_CLOCK_HZ,
+			 ClockProfileGetSwitchCount());
+
+	return pdFALSE;
+}
+
+/**
+ * @brief Lists the registered memory pools, one per call after a header line.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, always 1.
+ * @param[in] argv Unused.
+ *
+ * @return pdTRUE while there are more pools to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_MemPools(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextPool = 0; // 0 prints the header, n prints pool n - 1
+	const MemPool_t *pxPool;
+
+	if (uxNextPool == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-10s %5s %5s %5s %5s %8s %8s\r\n",
+				 "pool", "size", "count", "used", "peak", "failures", "badfree");
+		if (MemPoolGetCount() > 0)
+		{
+			uxNextPool = 1;
+			return pdTRUE;
+		}
+		return pdFALSE;
+	}
+
+	// The counters are sampled without masking interrupts, a row may be one update stale
+	pxPool = MemPoolGet(uxNextPool - 1);
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-10s %5lu %5lu %5lu %5lu %8lu %8lu\r\n",
+			 pxPool->pcName, (uint32_t)pxPool->xBlockSize, (uint32_t)pxPool->uxBlockCount, (uint32_t)pxPool->uxInUse,
+			 (uint32_t)pxPool->uxHighWater, pxPool->ulFailures, pxPool->ulInvalidFrees);
+
+	if (uxNextPool++ < MemPoolGetCount())
+	{
+		return pdTRUE;
+	}
+
+	uxNextPool = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the sleep statistics, one state per call and then the late
+ *        wakes, or clears them.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, 1 or 2.
+ * @param[in] argv argv[1], if given, is "reset".
+ *
+ * @return pdTRUE while there are more lines to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_SleepStats(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static LowPowerStats_t xStats; // Snapshot taken on the first call, so all lines add up
+	static enum eSleepStates eNextState = SLEEP_STATE_RUN;
+	uint32_t ulPermille;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0))
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: sleep [reset]\r\n");
+		return pdFALSE;
+	}
+
+	if (argc == 2)
+	{
+		LowPowerResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Sleep statistics cleared\r\n");
+		return pdFALSE;
+	}
+
+	if (eNextState == SLEEP_STATE_RUN)
+	{
+		LowPowerGetStats(&xStats);
+	}
+
+	if (eNextState < N_SLEEP_STATES)
+	{
+		ulPermille = (xStats.ullTotalCounts == 0) ? 0 : (uint32_t)((xStats.ullStateCounts[eNextState] * 1000) / xStats.ullTotalCounts);
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-8s %3lu.%lu%%  %10lu ms  %8lu sleeps\r\n",
+				 LowPowerGetStateName(eNextState), ulPermille / 10, ulPermille % 10,
+				 (uint32_t)((xStats.ullStateCounts[eNextState] * 1000) / LOWPOWER_RTC_HZ), xStats.ulEntries[eNextState]);
+		eNextState++;
+		return pdTRUE;
+	}
+
+	// Time the tick count lost: the overshoot of sleeps that woke late
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "late wakes %lu, %lu ticks dropped\r\n", xStats.ulLateWakes,
+			 xStats.ulDroppedTicks);
+	eNextState = SLEEP_STATE_RUN;
+	return pdFALSE;
+}
+
+/**
+ * @brief Starts, stops, clears or dumps the trace recorder.
+ *
+ * The dump is one line per call: a header, one "# task" line per named task,
+ * the events four to a line and a "# end" line. Each event is 16 hex digits:
+ * timestamp (8), event (2), aux (2) and param (4). See Trace.h.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, always 2.
+ * @param[in] argv argv[1] is the action.
+ *
+ * @return pdTRUE while there is more of the dump to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_Trace(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static enum { DUMP_HEADER, DUMP_TASKS, DUMP_EVENTS } eDumpStage = DUMP_HEADER;
+	static uint32_t ulNext = 0; // Next task number or event index
+	TraceEvent_t xEvent;
+	size_t xLen = 0;
+
+	if (strcmp(argv[1], "dump") != 0)
+	{
+		if (strcmp(argv[1], "start") == 0)
+		{
+			TraceStart();
+		}
+		else if (strcmp(argv[1], "stop") == 0)
+		{
+			TraceStop();
+		}
+		else if (strcmp(argv[1], "clear") == 0)
+		{
+			TraceClear();
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: trace <start|stop|clear|dump>\r\n");
+			return pdFALSE;
+		}
+
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Trace %s, %lu events, %lu lost\r\n",
+				 TraceIsRunning() ? "running" : "stopped", TraceGetCount(), TraceGetLost());
+		return pdFALSE;
+	}
+
+	switch (eDumpStage)
+	{
+	case DUMP_HEADER:
+		// Stop first so the dump does not trace itself over the events being printed
+		TraceStop();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "# trace v%d events %lu lost %lu\r\n",
+				 TRACE_FORMAT_VERSION, TraceGetCount(), TraceGetLost());
+		eDumpStage = DUMP_TASKS;
+		ulNext = 0;
+		return pdTRUE;
+
+	case DUMP_TASKS:
+		for (; ulNext < TRACE_MAX_TASKS; ulNext++)
+		{
+			if (TraceGetTaskName(ulNext) != NULL)
+			{
+				snprintf((char *)pcWriteBuffer, xWriteBufferLen, "# task %lu %s\r\n", ulNext, TraceGetTaskName(ulNext));
+				ulNext++;
+				return pdTRUE;
+			}
+		}
+		eDumpStage = DUMP_EVENTS;
+		ulNext = 0;
+		/* fall through */
+
+	case DUMP_EVENTS:
+		for (uint32_t i = 0; i < 4 && TraceGetEvent(ulNext, &xEvent); i++, ulNext++)
+		{
+			xLen += snprintf((char *)pcWriteBuffer + xLen, xWriteBufferLen - xLen, "%s%08lx%02x%02x%04x",
+							 (i == 0) ? "" : " ", xEvent.ulTimestamp, xEvent.ucEvent, xEvent.ucAux, xEvent.usParam);
+		}
+
+		if (xLen > 0)
+		{
+			snprintf((char *)pcWriteBuffer + xLen, xWriteBufferLen - xLen, "\r\n");
+			return pdTRUE;
+		}
+		break;
+	}
+
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "# end\r\n");
+	eDumpStage = DUMP_HEADER;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the interrupt monitor, one line per call, or clears it.
+ *
+ * Without arguments, prints one line per interrupt: priority, runs, and the
+ * min/max latency and duration. "hist <name>" prints the non-empty log2
+ * buckets of one interrupt. Interrupts without a hardware event timestamp
+ * show "-" for latency. See IrqMonitor.h.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, 1 to 3.
+ * @param[in] argv argv[1], if given, is "reset" or "hist", argv[2] the interrupt name.
+ *
+ * @return pdTRUE while there are more lines to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_Irq(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static IrqHistogram_t xLatency, xDuration; // Snapshot of the interrupt being printed
+	static enum eIrqMonitors eHistMonitor = N_IRQ_MONITORS;
+	static uint32_t ulNext = 0; // 0 for the header, then monitor or bucket + 1
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		IrqMonitorReset();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Interrupt statistics cleared\r\n");
+		return pdFALSE;
+	}
+
+	if (argc == 3 && strcmp(argv[1], "hist") == 0)
+	{
+		if (ulNext == 0)
+		{
+			for (eHistMonitor = 0; eHistMonitor < N_IRQ_MONITORS; eHistMonitor++)
+			{
+				if (strcmp(argv[2], IrqMonitorGetName(eHistMonitor)) == 0)
+				{
+					break;
+				}
+			}
+			if (eHistMonitor == N_IRQ_MONITORS)
+			{
+				snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Unknown interrupt \"%s\"\r\n", argv[2]);
+				return pdFALSE;
+			}
+
+			IrqMonitorGet(eHistMonitor, &xLatency, &xDuration);
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-8s cycles >=   latency  duration\r\n",
+					 IrqMonitorGetName(eHistMonitor));
+			ulNext = 1;
+			return pdTRUE;
+		}
+
+		for (; ulNext <= IRQ_MONITOR_BUCKETS; ulNext++)
+		{
+			uint32_t ulBucket = ulNext - 1;
+			if (xLatency.ulBuckets[ulBucket] != 0 || xDuration.ulBuckets[ulBucket] != 0)
+			{
+				snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%8s %9lu  %8lu  %8lu\r\n", "",
+						 IrqMonitorBucketFloor(ulBucket), xLatency.ulBuckets[ulBucket], xDuration.ulBuckets[ulBucket]);
+				ulNext++;
+				return pdTRUE;
+			}
+		}
+
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%lu runs\r\n", xDuration.ulCount);
+		ulNext = 0;
+		return pdFALSE;
+	}
+
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: irq [reset|hist <name>]\r\n");
+		return pdFALSE;
+	}
+
+	if (ulNext == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "irq      pri      runs  latency min/max  duration min/max\r\n");
+		ulNext = 1;
+		return pdTRUE;
+	}
+
+	enum eIrqMonitors eMonitor = (enum eIrqMonitors)(ulNext - 1);
+	IrqMonitorGet(eMonitor, &xLatency, &xDuration);
+	if (xLatency.ulCount == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-8s %3lu %9lu  %7s %-7s  %8lu %-7lu\r\n",
+				 IrqMonitorGetName(eMonitor), IrqMonitorGetPriority(eMonitor), xDuration.ulCount, "-", "",
+				 xDuration.ulMin, xDuration.ulMax);
+	}
+	else
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-8s %3lu %9lu  %7lu/%-7lu  %8lu/%-7lu\r\n",
+				 IrqMonitorGetName(eMonitor), IrqMonitorGetPriority(eMonitor), xDuration.ulCount, xLatency.ulMin,
+				 xLatency.ulMax, xDuration.ulMin, xDuration.ulMax);
+	}
+
+	if (ulNext++ < N_IRQ_MONITORS)
+	{
+		return pdTRUE;
+	}
+
+	ulNext = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the work queue items, one line per call, or clears their counters.
+ *
+ * Latency is from submission (or the end of the delay) to the start of the
+ * run, averaged over the runs. "merged" counts submissions that found the
+ * item already queued. See WorkQueue.h.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, 1 or 2.
+ * @param[in] argv argv[1], if given, is "reset".
+ *
+ * @return pdTRUE while there are more lines to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_Work(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static const char *const pcPriorities[N_WORK_PRIORITIES] = {"high", "normal", "low"};
+	static const char *const pcStates[] = {"idle", "delayed", "queued", "running"};
+	static UBaseType_t uxNextItem = 0; // 0 prints the header, n prints item n - 1
+	const WorkItem_t *pxItem;
+	WorkStats_t xStats;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		WorkQueueResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Work queue statistics cleared\r\n");
+		return pdFALSE;
+	}
+
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: work [reset]\r\n");
+		return pdFALSE;
+	}
+
+	if (uxNextItem == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "work       pri    state        runs   merged  latency avg/max   run max  (%lu post failures)\r\n",
+				 WorkQueueGetPostFailures());
+		if (WorkQueueGetCount() > 0)
+		{
+			uxNextItem = 1;
+			return pdTRUE;
+		}
+		return pdFALSE;
+	}
+
+	pxItem = WorkQueueGet(uxNextItem - 1);
+	WorkQueueGetStats(pxItem, &xStats);
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-10s %-6s %-8s %8lu %8lu  %7lu/%-8lu %8lu\r\n",
+			 pxItem->pcName, pcPriorities[pxItem->ePriority], pcStates[pxItem->eState], xStats.ulRuns,
+			 xStats.ulCoalesced, (xStats.ulRuns > 0) ? (uint32_t)(xStats.ullLatencyTotal / xStats.ulRuns) : 0,
+			 xStats.ulLatencyMax, xStats.ulDurationMax);
+
+	if (uxNextItem++ < WorkQueueGetCount())
+	{
+		return pdTRUE;
+	}
+
+	uxNextItem = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the stacks, one per call.
+ *
+ * The peak is the deepest use since reset, found from the fill pattern. See
+ * StackMonitor.h, and tools/stack_depth.py for the static worst case.
+ *
+ * @param[in] pcWriteBuffer Buffer to write the output string to.
+ * @param[in] xWriteBufferLen Size of the output buffer.
+ * @param[in] argc Number of words on the command line, always 1.
+ * @param[in] argv Not used.
+ *
+ * @return pdTRUE while there are more lines to print, pdFALSE otherwise.
+ */
+BaseType_t CLI_Stacks(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextStack = 0; // 0 prints the header, n prints stack n - 1
+	StackUsage_t xUsage;
+
+	if (uxNextStack == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-10s %6s %6s %6s %5s\r\n", "stack", "size", "peak", "free", "used");
+		uxNextStack = 1;
+		return pdTRUE;
+	}
+
+	StackMonitorGet(uxNextStack - 1, &xUsage);
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%-10s %6lu %6lu %6lu %4lu%%\r\n", xUsage.pcName, xUsage.ulSize,
+			 xUsage.ulPeak, xUsage.ulSize - xUsage.ulPeak, (xUsage.ulPeak * 100) / xUsage.ulSize);
+
+	if (uxNextStack++ < StackMonitorGetCount())
+	{
+		return pdTRUE;
+	}
+
+	uxNextStack = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the IMU task state and counters, the acquisition states and wake latency, the counters per rate,
+ * then the latest sample, clears the counters, sets the quiet period, or fixes the rate.
+ *
+ * @param[in] argc,argv Optional "reset", "quiet" and a period in ms, or "rate" and "auto" or a rate in Hz.
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_GetImuData(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static const char *const pcStates[] = {"starting", "sensors not found", "running"};
+	static UBaseType_t uxNextLine = 0;
+	ImuStats_t xStats;
+	ImuSample_t xSample;
+	int32_t lValue;
+	int8_t cShift;
+	bool bAuto;
+	uint32_t ulStreaming, ulRunning;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		ImuResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "IMU counters cleared\r\n");
+		return pdFALSE;
+	}
+	if (argc == 3 && strcmp(argv[1], "quiet") == 0)
+	{
+		if (FreeRTOS_CLIParseInt(argv[2], &lValue) != pdPASS || lValue < 0)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: imu quiet <ms>\r\n");
+			return pdFALSE;
+		}
+		ImuSetQuietPeriod((uint32_t)lValue);
+		if (lValue == 0)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "IMU streams all the time\r\n");
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "IMU stops after %ld ms still\r\n", (long)lValue);
+		}
+		return pdFALSE;
+	}
+	if (argc == 3 && strcmp(argv[1], "rate") == 0)
+	{
+		cShift = IMU_RATE_AUTO;
+		if (strcmp(argv[2], "auto") != 0)
+		{
+			if (FreeRTOS_CLIParseInt(argv[2], &lValue) == pdPASS)
+			{
+				for (int8_t c = IMU_RATE_SHIFT_MIN; c <= IMU_RATE_SHIFT_MAX; c++)
+				{
+					cShift = (IMU_RATE_HZ(c) == lValue) ? c : cShift;
+				}
+			}
+			if (cShift == IMU_RATE_AUTO)
+			{
+				snprintf((char *)pcWriteBuffer, xWriteBufferLen, "rates: %u to %u Hz, doubling\r\n",
+						 IMU_RATE_HZ(IMU_RATE_SHIFT_MIN), IMU_RATE_HZ(IMU_RATE_SHIFT_MAX));
+				return pdFALSE;
+			}
+		}
+		ImuSetRate(cShift);
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "IMU rate %s from the next block\r\n",
+				 (cShift == IMU_RATE_AUTO) ? "follows the activity" : "fixed");
+		return pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: imu [reset | quiet <ms> | rate <auto|Hz>]\r\n");
+		return pdFALSE;
+	}
+
+	ImuGetStats(&xStats);
+	switch (uxNextLine)
+	{
+	case 0:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "IMU %s: %lu blocks, %lu samples, %lu wakes, %lu timeouts\r\n",
+				 pcStates[ImuGetState()], xStats.ulBlocks, xStats.ulSamples, xStats.ulWakes, xStats.ulTimeouts);
+		uxNextLine = 1;
+		return pdTRUE;
+
+	case 1:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "IMU FIFO overrun: %lu (mpu %lu, lis %lu), skew drops %lu, bus errors %lu\r\n",
+				 xStats.ulMpuOverruns + xStats.ulLisOverruns, xStats.ulMpuOverruns, xStats.ulLisOverruns,
+				 xStats.ulSkewDrops, xStats.ulBusErrors);
+		uxNextLine = 2;
+		return pdTRUE;
+
+	case 2:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "acquisition %s, quiet period %lu ms: %lu quiet stops, %lu motion wakes\r\n",
+				 ImuGetAcqStateName(ImuGetAcqState()), ImuGetQuietPeriod(), xStats.ulQuietStops, xStats.ulMotionWakes);
+		uxNextLine = 3;
+		return pdTRUE;
+
+	case 3:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "time streaming %lu ms (%lu), waiting %lu ms (%lu), waking %lu ms (%lu)\r\n",
+				 xStats.ulStateTicks[IMU_ACQ_STREAMING] * portTICK_PERIOD_MS, xStats.ulStateEntries[IMU_ACQ_STREAMING],
+				 xStats.ulStateTicks[IMU_ACQ_WAITING] * portTICK_PERIOD_MS, xStats.ulStateEntries[IMU_ACQ_WAITING],
+				 xStats.ulStateTicks[IMU_ACQ_WAKING] * portTICK_PERIOD_MS, xStats.ulStateEntries[IMU_ACQ_WAKING]);
+		uxNextLine = 4;
+		return pdTRUE;
+
+	case 4:
+		if (xStats.ulMotionWakes == 0)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "wake latency: no motion wake yet\r\n");
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+					 "wake latency min/mean/max %lu/%lu/%lu ms, lost the first sample %lu of %lu, %lu samples\r\n",
+					 xStats.ulWakeLatencyMin, xStats.ulWakeLatencyTotal / xStats.ulMotionWakes, xStats.ulWakeLatencyMax,
+					 xStats.ulWakeLostFirst, xStats.ulMotionWakes, xStats.ulWakeLostSamples);
+		}
+		uxNextLine = 5;
+		return pdTRUE;
+
+	case 5:
+		cShift = ImuGetRate(&bAuto);
+		ulStreaming = xStats.ulStateTicks[IMU_ACQ_STREAMING];
+		ulRunning = ulStreaming + xStats.ulStateTicks[IMU_ACQ_WAITING] + xStats.ulStateTicks[IMU_ACQ_WAKING];
+		ulStreaming = (ulStreaming > 0) ? ulStreaming : 1;
+		ulRunning = (ulRunning > 0) ? ulRunning : 1;
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "rate %u Hz %s, %lu changes, average %lu.%02lu Hz streaming, %lu.%02lu Hz overall\r\n",
+				 IMU_RATE_HZ(cShift), bAuto ? "auto" : "fixed", xStats.ulRateChanges,
+				 (uint32_t)((uint64_t)xStats.ulSamples * configTICK_RATE_HZ / ulStreaming),
+				 (uint32_t)((uint64_t)xStats.ulSamples * configTICK_RATE_HZ * 100 / ulStreaming % 100),
+				 (uint32_t)((uint64_t)xStats.ulSamples * configTICK_RATE_HZ / ulRunning),
+				 (uint32_t)((uint64_t)xStats.ulSamples * configTICK_RATE_HZ * 100 / ulRunning % 100));
+		uxNextLine = 6;
+		return pdTRUE;
+
+	default:
+		if (uxNextLine < 6 + N_IMU_RATES)
+		{
+			// One line per rate, lowest first
+			UBaseType_t uxRate = uxNextLine - 6;
+
+			cShift = (int8_t)(IMU_RATE_SHIFT_MIN + (int8_t)uxRate);
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%5u Hz: %lu ms, %lu samples, %lu wakes\r\n", IMU_RATE_HZ(cShift),
+					 xStats.ulRateTicks[uxRate] * portTICK_PERIOD_MS, xStats.ulRateSamples[uxRate], xStats.ulRateWakes[uxRate]);
+			uxNextLine++;
+			return pdTRUE;
+		}
+		if (ImuGetLatest(&xSample) != pdPASS)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no sample yet\r\n");
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+					 "accel %ld %ld %ld mg, gyro %ld %ld %ld x0.1 dps, aux %ld %ld %ld mg\r\n",
+					 (long)xSample.sAccel[0] * 1000 / IMU_ACCEL_LSB_PER_G, (long)xSample.sAccel[1] * 1000 / IMU_ACCEL_LSB_PER_G,
+					 (long)xSample.sAccel[2] * 1000 / IMU_ACCEL_LSB_PER_G, (long)xSample.sGyro[0] * 100 / IMU_GYRO_LSB_PER_10_DPS,
+					 (long)xSample.sGyro[1] * 100 / IMU_GYRO_LSB_PER_10_DPS, (long)xSample.sGyro[2] * 100 / IMU_GYRO_LSB_PER_10_DPS,
+					 (long)xSample.sAccelAux[0] * 1000 / IMU_ACCEL_LSB_PER_G, (long)xSample.sAccelAux[1] * 1000 / IMU_ACCEL_LSB_PER_G,
+					 (long)xSample.sAccelAux[2] * 1000 / IMU_ACCEL_LSB_PER_G);
+		}
+		uxNextLine = 0;
+		return pdFALSE;
+	}
+}
+
+/**
+ * @brief Shows the pipeline counters, clears them, or starts and stops the synthetic source.
+ *
+ * @param[in] argc,argv Optional "reset", or "synth" and "on" or "off".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Pipe(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextLine = 0;
+	PipelineStats_t xStats;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		PipelineResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "pipeline counters cleared\r\n");
+		return pdFALSE;
+	}
+	if (argc == 3 && strcmp(argv[1], "synth") == 0 && (strcmp(argv[2], "on") == 0 || strcmp(argv[2], "off") == 0))
+	{
+		PipelineSetSynthetic(strcmp(argv[2], "on") == 0);
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "synthetic source %s\r\n", argv[2]);
+		return pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: pipe [reset | synth <on|off>]\r\n");
+		return pdFALSE;
+	}
+
+	PipelineGetStats(&xStats);
+	if (uxNextLine == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "pipeline (%s): %lu frames, %lu gaps, %lu stalls, %lu synthetic\r\n",
+				 PipelineIsSynthetic() ? "synthetic" : "imu", xStats.ulFrames, xStats.ulGaps, xStats.ulStalls,
+				 xStats.ulSynthetic);
+		uxNextLine = 1;
+		return pdTRUE;
+	}
+
+	if (xStats.ulFrames == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no frame processed yet\r\n");
+	}
+	else
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "latency min/mean/max %lu/%lu/%lu cycles, stages max %lu cycles\r\n",
+				 xStats.ulLatencyMin, (uint32_t)(xStats.ullLatencyTotal / xStats.ulFrames), xStats.ulLatencyMax,
+				 xStats.ulStagesMax);
+	}
+	uxNextLine = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the pipeline hit detector, or clears its counters.
+ *
+ * @param[in] argc,argv Optional "reset".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Hits(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextLine = 0;
+	HitStats_t xStats;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		HitDetectResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "hit counters cleared\r\n");
+		return pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: hits [reset]\r\n");
+		return pdFALSE;
+	}
+
+	HitDetectGetStats(&xStats);
+	switch (uxNextLine)
+	{
+	case 0:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "hits: %lu in %lu blocks, floor %ld mg, threshold %ld mg\r\n",
+				 xStats.ulHits, xStats.ulBlocks, (long)xStats.sFloor * 1000 / HIT_LSB_PER_G,
+				 (long)xStats.sThreshold * 1000 / HIT_LSB_PER_G);
+		uxNextLine = 1;
+		return pdTRUE;
+
+	case 1:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "block max %lu cycles (budget %lu), %lu over budget\r\n",
+				 xStats.ulCyclesMax, (uint32_t)HIT_BLOCK_BUDGET_CYCLES, xStats.ulOverBudget);
+		uxNextLine = 2;
+		return pdTRUE;
+
+	default:
+		if (!xStats.bHaveLast)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no hit yet\r\n");
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "last hit: %ld mg at tick %lu\r\n",
+					 (long)xStats.xLast.sPeak * 1000 / HIT_LSB_PER_G, (uint32_t)xStats.xLast.xTick);
+		}
+		uxNextLine = 0;
+		return pdFALSE;
+	}
+}
+
+/**
+ * @brief Shows the pipeline orientation filter, or restarts it.
+ *
+ * @param[in] argc,argv Optional "reset".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Orient(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextLine = 0;
+	Fusion_t xFusion;
+	int32_t lGravity[3];
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		FusionRestart();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "orientation filter restarted\r\n");
+		return pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: orient [reset]\r\n");
+		return pdFALSE;
+	}
+
+	FusionGet(&xFusion);
+	if (!xFusion.bAligned)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "orientation: waiting for gravity, %lu updates\r\n", xFusion.ulUpdates);
+		uxNextLine = 0;
+		return pdFALSE;
+	}
+
+	if (uxNextLine == 0)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "orientation: q = %ld %ld %ld %ld, %lu updates, %lu without gravity\r\n",
+				 (long)(((int64_t)xFusion.lQ[0] * 10000) >> 30), (long)(((int64_t)xFusion.lQ[1] * 10000) >> 30),
+				 (long)(((int64_t)xFusion.lQ[2] * 10000) >> 30), (long)(((int64_t)xFusion.lQ[3] * 10000) >> 30),
+				 xFusion.ulUpdates, xFusion.ulGated);
+		uxNextLine = 1;
+		return pdTRUE;
+	}
+
+	FusionGravity(&xFusion, lGravity);
+	snprintf((char *)pcWriteBuffer, xWriteBufferLen, "gravity: x %ld, y %ld, z %ld mg\r\n",
+			 (long)(((int64_t)lGravity[0] * 1000) >> 30), (long)(((int64_t)lGravity[1] * 1000) >> 30),
+			 (long)(((int64_t)lGravity[2] * 1000) >> 30));
+	uxNextLine = 0;
+	return pdFALSE;
+}
+
+/**
+ * @brief Shows the session statistics, starts a new session, or dumps the upload record.
+ *
+ * @param[in] argc,argv Optional "reset" or "record".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Stats(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextLine = 0;
+	static SessionStats_t xStats; // One snapshot for all the lines
+	static uint8_t ucRecord[STATS_RECORD_BYTES];
+	bool bRecord = (argc == 2 && strcmp(argv[1], "record") == 0);
+	int iLength = 0;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		SessionStatsReset();
+		SessionRollupNow();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "new session started\r\n");
+		return pdFALSE;
+	}
+	if (argc != 1 && !bRecord)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: stats [reset | record]\r\n");
+		return pdFALSE;
+	}
+
+	if (bRecord)
+	{
+		// The record the upload would send, from the last rollup. 32 bytes per line
+		UBaseType_t uxOffset = uxNextLine * 32;
+
+		if (uxNextLine == 0 && !SessionRollupGet(ucRecord, NULL))
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no record yet\r\n");
+			return pdFALSE;
+		}
+		for (UBaseType_t i = uxOffset; i < uxOffset + 32 && i < STATS_RECORD_BYTES; i++)
+		{
+			iLength += snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "%02x", ucRecord[i]);
+		}
+		snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "\r\n");
+		uxNextLine = (uxOffset + 32 < STATS_RECORD_BYTES) ? uxNextLine + 1 : 0;
+		return (uxNextLine != 0) ? pdTRUE : pdFALSE;
+	}
+
+	if (uxNextLine == 0)
+	{
+		SessionStatsGet(&xStats);
+	}
+
+	switch (uxNextLine)
+	{
+	case 0:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "session: %lu hits in %lu rallies over %lu s\r\n", xStats.ulHits,
+				 xStats.ulRallies, (uint32_t)((xStats.xNow - xStats.xStart) / configTICK_RATE_HZ));
+		uxNextLine = 1;
+		return pdTRUE;
+
+	case 1:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "force mg: mean %u, sd %u, min %u, max %u\r\n", xStats.xForce.usMean,
+				 xStats.xForce.usStdDev, xStats.xForce.usMin, xStats.xForce.usMax);
+		uxNextLine = 2;
+		return pdTRUE;
+
+	case 2:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "interval ms: %lu, mean %u, sd %u, min %u, max %u\r\n",
+				 xStats.xInterval.ulCount, xStats.xInterval.usMean, xStats.xInterval.usStdDev, xStats.xInterval.usMin,
+				 xStats.xInterval.usMax);
+		uxNextLine = 3;
+		return pdTRUE;
+
+	case 3:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "last %u hits: %u.%u per min, force %u to %u mg\r\n",
+				 xStats.usWindowHits, xStats.usWindowRate / 10, xStats.usWindowRate % 10, xStats.usWindowForceMin,
+				 xStats.usWindowForceMax);
+		uxNextLine = 4;
+		return pdTRUE;
+
+	case 4:
+	default:
+	{
+		const uint16_t *pusBins = (uxNextLine == 4) ? xStats.usForceBins : xStats.usIntervalBins;
+
+		if (uxNextLine == 4)
+		{
+			iLength = snprintf((char *)pcWriteBuffer, xWriteBufferLen, "force/g:");
+		}
+		else
+		{
+			iLength = snprintf((char *)pcWriteBuffer, xWriteBufferLen, "interval/%ums:", 1u << STATS_INTERVAL_BIN_SHIFT);
+		}
+		for (uint8_t i = 0; i < STATS_BINS && iLength < (int)xWriteBufferLen; i++)
+		{
+			iLength += snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, " %u", pusBins[i]);
+		}
+		if (iLength < (int)xWriteBufferLen)
+		{
+			snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "\r\n");
+		}
+		uxNextLine = (uxNextLine == 4) ? 5 : 0;
+		return (uxNextLine != 0) ? pdTRUE : pdFALSE;
+	}
+	}
+}
+
+/**
+ * @brief Shows the codec counters, switches recording, or drains the packet queue in hex.
+ *
+ * @param[in] argc,argv Optional "on", "off", "reset" or "dump".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Codec(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static UBaseType_t uxNextLine = 0;
+	CodecStats_t xStats;
+	uint64_t ullRaw;
+	uint32_t ulRatio;
+
+	if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0))
+	{
+		CodecSetRecording(argv[1][1] == 'n');
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "codec recording %s\r\n", argv[1]);
+		return pdFALSE;
+	}
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		CodecResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "codec counters cleared\r\n");
+		return pdFALSE;
+	}
+	if (argc == 2 && strcmp(argv[1], "dump") == 0)
+	{
+		// 32 bytes per line until the queue is empty. Packets are queued whole, so it ends on one
+		uint8_t ucBytes[32];
+		size_t xBytes = CodecRead(ucBytes, sizeof(ucBytes));
+		int iLength = 0;
+
+		pcWriteBuffer[0] = '\0';
+		if (xBytes == 0)
+		{
+			if (uxNextLine == 0)
+			{
+				snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no packets queued\r\n");
+			}
+			uxNextLine = 0;
+			return pdFALSE;
+		}
+		for (size_t i = 0; i < xBytes; i++)
+		{
+			iLength += snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "%02x", ucBytes[i]);
+		}
+		snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "\r\n");
+		uxNextLine = (xBytes == sizeof(ucBytes)) ? uxNextLine + 1 : 0;
+		return (uxNextLine != 0) ? pdTRUE : pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: codec [on | off | reset | dump]\r\n");
+		return pdFALSE;
+	}
+
+	CodecGetStats(&xStats);
+	switch (uxNextLine)
+	{
+	case 0:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "codec: %s, %lu blocks, %lu samples, %lu key packets\r\n",
+				 xStats.bRecording ? "recording" : "stopped", xStats.ulBlocks, xStats.ulSamples, xStats.ulKeys);
+		uxNextLine = 1;
+		return pdTRUE;
+
+	case 1:
+		ullRaw = (uint64_t)xStats.ulSamples * CODEC_RAW_SAMPLE_BYTES;
+		ulRatio = (xStats.ulBytes > 0) ? (uint32_t)(ullRaw * 100 / xStats.ulBytes) : 0;
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "bytes: %lu raw, %lu coded, ratio %lu.%02lu, %u queued, %lu packets dropped\r\n", (uint32_t)ullRaw,
+				 xStats.ulBytes, ulRatio / 100, ulRatio % 100, xStats.usQueued, xStats.ulDropped);
+		uxNextLine = 2;
+		return pdTRUE;
+
+	case 2:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "channel blocks: %lu delta, %lu linear, %lu verbatim\r\n",
+				 xStats.ulModes[CODEC_MODE_DELTA], xStats.ulModes[CODEC_MODE_LINEAR], xStats.ulModes[CODEC_MODE_VERBATIM]);
+		uxNextLine = 3;
+		return pdTRUE;
+
+	default:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "block mean %lu, max %lu cycles (budget %lu), %lu over budget\r\n",
+				 (xStats.ulBlocks > 0) ? (uint32_t)(xStats.ullCyclesTotal / xStats.ulBlocks) : 0, xStats.ulCyclesMax,
+				 (uint32_t)CODEC_BLOCK_BUDGET_CYCLES, xStats.ulOverBudget);
+		uxNextLine = 0;
+		return pdFALSE;
+	}
+}
+
+/**
+ * @brief Shows the stroke classifier counters, inference time, model and last stroke, or clears the counters.
+ *
+ * @param[in] argc,argv Optional "reset".
+ *
+ * @return pdTRUE while lines remain, pdFALSE after the last one.
+ */
+BaseType_t CLI_Stroke(int8_t *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t argc, char *argv[])
+{
+	static const char *const pcStrokeNames[N_STROKES + 1] = {"forehand", "backhand", "smash", "drop", "unclassified"};
+	static UBaseType_t uxNextLine = 0;
+	StrokeStats_t xStats;
+	const StrokeModel_t *pxModel;
+	uint32_t ulClassified = 0;
+	int iLength;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		StrokeResetStats();
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "stroke counters cleared\r\n");
+		return pdFALSE;
+	}
+	if (argc != 1)
+	{
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen, "usage: stroke [reset]\r\n");
+		return pdFALSE;
+	}
+
+	StrokeGetStats(&xStats);
+	for (uint8_t s = 0; s <= N_STROKES; s++)
+	{
+		ulClassified += xStats.ulStrokes[s];
+	}
+	switch (uxNextLine)
+	{
+	case 0:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "strokes: %lu hits, %lu forehand, %lu backhand, %lu smash, %lu drop, %lu unclassified, %lu dropped\r\n",
+				 xStats.ulHits, xStats.ulStrokes[STROKE_FOREHAND], xStats.ulStrokes[STROKE_BACKHAND],
+				 xStats.ulStrokes[STROKE_SMASH], xStats.ulStrokes[STROKE_DROP], xStats.ulStrokes[N_STROKES],
+				 xStats.ulDropped);
+		uxNextLine = 1;
+		return pdTRUE;
+
+	case 1:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "per hit: last %lu, mean %lu, max %lu cycles (budget %lu), %lu over budget, %lu windows cut short\r\n",
+				 xStats.ulCyclesLast, (ulClassified > 0) ? (uint32_t)(xStats.ullCyclesTotal / ulClassified) : 0,
+				 xStats.ulCyclesMax, (uint32_t)STROKE_BUDGET_CYCLES, xStats.ulOverBudget, xStats.ulTruncated);
+		uxNextLine = 2;
+		return pdTRUE;
+
+	case 2:
+		snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+				 "decided up to %lu ms after the hit start, window %u ms before to %u ms after\r\n", xStats.ulDelayMax,
+				 STROKE_BEFORE_MS, STROKE_AFTER_MS);
+		uxNextLine = 3;
+		return pdTRUE;
+
+	case 3:
+		pxModel = StrokeGetModel();
+		if (pxModel == NULL)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "model: not valid, %u bytes in flash; %u bytes of RAM\r\n",
+					 usStrokeModelBytes, (unsigned)StrokeGetRamBytes());
+		}
+		else
+		{
+			iLength = snprintf((char *)pcWriteBuffer, xWriteBufferLen, "model: %u", pxModel->xLayers[0].ucInputs);
+			for (uint8_t l = 0; l < pxModel->ucLayers; l++)
+			{
+				iLength += snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength, "-%u",
+									pxModel->xLayers[l].ucOutputs);
+			}
+			snprintf((char *)pcWriteBuffer + iLength, xWriteBufferLen - iLength,
+					 ", %u bytes of flash; %u bytes of RAM, arena %u of them\r\n", pxModel->usBytes,
+					 (unsigned)StrokeGetRamBytes(), STROKE_ARENA_BYTES);
+		}
+		uxNextLine = 4;
+		return pdTRUE;
+
+	default:
+		if (!xStats.bHaveLast)
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen, "no stroke yet\r\n");
+		}
+		else
+		{
+			snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+					 "last: %s at tick %lu, scores %d %d %d %d, %u samples, decided at tick %lu\r\n",
+					 pcStrokeNames[xStats.xLast.ucStroke], (uint32_t)xStats.xLast.xHit.xTick, xStats.xLast.cScores[0],
+					 xStats.xLast.cScores[1], xStats.xLast.cScores[2], xStats.xLast.cScores[3],
+					 xStats.xLast.usSamples, (uint32_t)xStats.xLast.xDecided);
+		}
+		uxNextLine = 0;
+		return pdFALSE;
+	}
+}
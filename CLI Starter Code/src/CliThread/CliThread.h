@@ -21,14 +21,14 @@
 #define MAX_OUTPUT_LENGTH_CLI   130	//STUDENT FILL
 
 #define CLI_MSG_LEN						16
-#define CLI_PC_ESCAPE_CODE_SIZE			4
-#define CLI_PC_MIN_ESCAPE_CODE_SIZE		2
 
 
 #define ASCII_BACKSPACE					0x08
 #define ASCII_DELETE                    0x7F
 #define ASCII_WHITESPACE				0x20
 #define ASCII_ESC						27
+#define ASCII_TAB						0x09
+#define ASCII_BELL						0x07
 
 
 BaseType_t xCliClearTerminalScreen( char *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
@@ -43,10 +43,25 @@ extern SemaphoreHandle_t xRxNotificationSemaphore;
 
 void vCommandConsoleTask( void *pvParameters );
 
-BaseType_t CLI_GetImuData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
+BaseType_t CLI_GetImuData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
 BaseType_t CLI_OTAU( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_NeotrellisSetLed( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_NeotrellProcessButtonBuffer( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_DistanceSensorGetDistance( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_ResetDevice( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
-BaseType_t CLI_SendDummyGameData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
\ No newline at end of file
+BaseType_t CLI_SendDummyGameData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
+BaseType_t CLI_Benchmark( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Batch( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_ClockProfile( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_MemPools( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_SleepStats( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Trace( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Irq( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Work( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Stacks( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Pipe( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Hits( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Orient( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Stats( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Codec( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
+BaseType_t CLI_Stroke( int8_t *pcWriteBuffer,size_t xWriteBufferLen,BaseType_t argc,char *argv[] );
\ No newline at end of file
@@ -0,0 +1,279 @@
+/**************************************************************************/ /**
+ * @file      ClockProfile.c
+ * @brief     CPU clock profiles. See ClockProfile.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "ClockProfile.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CLOCK_PROFILE_BOOT CLOCK_PROFILE_HIGH ///< Profile set up by system_init() from conf_clocks.h
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef struct
+{
+	const char *const pcName;
+	const enum system_clock_source eSource; ///< GCLK0 source
+	const uint8_t ucFlashWaitStates;		///< NVM read wait states needed at this frequency (3.3 V)
+} ClockProfile_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static BaseType_t prvSwitch(enum eClockProfiles eProfile);
+static BaseType_t prvEnableDfll(void);
+static void prvNotify(enum eClockProfileEvents eEvent, uint32_t ulCpuHz);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static const ClockProfile_t xProfiles[N_CLOCK_PROFILES] =
+{
+	[CLOCK_PROFILE_HIGH] = {"high", SYSTEM_CLOCK_SOURCE_DFLL, 1},
+	[CLOCK_PROFILE_LOW] = {"low", SYSTEM_CLOCK_SOURCE_OSC8M, 0},
+};
+
+static ClockProfileCallback_t pxCallbacks[CLOCK_PROFILE_MAX_CALLBACKS];
+static UBaseType_t uxCallbackCount = 0;
+static enum eClockProfiles eCurrentProfile = CLOCK_PROFILE_BOOT;
+static enum eClockProfiles eRequestedProfile = CLOCK_PROFILE_BOOT; ///< Last ClockProfileRequest()
+static bool bAutoProfile = true;
+static uint32_t ulSwitchCount = 0;
+static SemaphoreHandle_t xSwitchLock = NULL;
+static StaticSemaphore_t xSwitchLockBuffer;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Creates the switch lock.
+ */
+void ClockProfileInit(void)
+{
+	xSwitchLock = xSemaphoreCreateMutexStatic(&xSwitchLockBuffer);
+	configASSERT(xSwitchLock != NULL);
+}
+
+/**
+ * @brief Registers a function to be told about clock changes.
+ */
+BaseType_t ClockProfileRegisterCallback(ClockProfileCallback_t pxCallback)
+{
+	if (pxCallback == NULL || uxCallbackCount >= CLOCK_PROFILE_MAX_CALLBACKS)
+	{
+		return pdFAIL;
+	}
+
+	pxCallbacks[uxCallbackCount++] = pxCallback;
+	return pdPASS;
+}
+
+/**
+ * @brief Switches to a clock profile.
+ */
+BaseType_t ClockProfileSet(enum eClockProfiles eProfile)
+{
+	BaseType_t xResult;
+
+	if (eProfile >= N_CLOCK_PROFILES)
+	{
+		return pdFAIL;
+	}
+
+	xSemaphoreTake(xSwitchLock, portMAX_DELAY);
+	xResult = prvSwitch(eProfile);
+	xSemaphoreGive(xSwitchLock);
+
+	return xResult;
+}
+
+/**
+ * @brief Records the profile the activity needs, and switches in the automatic mode.
+ */
+BaseType_t ClockProfileRequest(enum eClockProfiles eProfile)
+{
+	BaseType_t xResult = pdPASS;
+
+	if (eProfile >= N_CLOCK_PROFILES)
+	{
+		return pdFAIL;
+	}
+
+	xSemaphoreTake(xSwitchLock, portMAX_DELAY);
+	eRequestedProfile = eProfile;
+	if (bAutoProfile)
+	{
+		xResult = prvSwitch(eProfile);
+	}
+	xSemaphoreGive(xSwitchLock);
+
+	return xResult;
+}
+
+/**
+ * @brief Turns the automatic mode on or off.
+ */
+BaseType_t ClockProfileSetAuto(bool bAuto)
+{
+	BaseType_t xResult = pdPASS;
+
+	xSemaphoreTake(xSwitchLock, portMAX_DELAY);
+	bAutoProfile = bAuto;
+	if (bAuto)
+	{
+		xResult = prvSwitch(eRequestedProfile);
+	}
+	xSemaphoreGive(xSwitchLock);
+
+	return xResult;
+}
+
+/**
+ * @brief Returns true in the automatic mode.
+ */
+bool ClockProfileIsAuto(void)
+{
+	return bAutoProfile;
+}
+
+/**
+ * @brief Returns the active clock profile.
+ */
+enum eClockProfiles ClockProfileGet(void)
+{
+	return eCurrentProfile;
+}
+
+/**
+ * @brief Returns the name of a clock profile.
+ */
+const char *ClockProfileGetName(enum eClockProfiles eProfile)
+{
+	if (eProfile >= N_CLOCK_PROFILES)
+	{
+		return NULL;
+	}
+
+	return xProfiles[eProfile].pcName;
+}
+
+/**
+ * @brief Returns the number of profile switches since boot.
+ */
+uint32_t ClockProfileGetSwitchCount(void)
+{
+	return ulSwitchCount;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvSwitch(enum eClockProfiles eProfile)
+ * @brief		Moves GCLK0 to a valid profile, with the switch lock held
+ * @return		pdPASS, or pdFAIL if the DFLL did not lock
+ *****************************************************************************/
+static BaseType_t prvSwitch(enum eClockProfiles eProfile)
+{
+	struct system_gclk_gen_config xGenConfig;
+	uint32_t ulCpuHz;
+
+	if (eProfile == eCurrentProfile)
+	{
+		return pdPASS;
+	}
+
+	// Bring the new source up before anything depends on it
+	if (xProfiles[eProfile].eSource == SYSTEM_CLOCK_SOURCE_DFLL && prvEnableDfll() != pdPASS)
+	{
+		return pdFAIL;
+	}
+
+	system_gclk_gen_get_config_defaults(&xGenConfig);
+	xGenConfig.source_clock = xProfiles[eProfile].eSource;
+	xGenConfig.division_factor = 1;
+
+	taskENTER_CRITICAL();
+
+	prvNotify(CLOCK_PROFILE_PRE_CHANGE, 0);
+
+	// More wait states before the clock goes up, fewer only after it has come down
+	if (xProfiles[eProfile].ucFlashWaitStates > xProfiles[eCurrentProfile].ucFlashWaitStates)
+	{
+		system_flash_set_waitstates(xProfiles[eProfile].ucFlashWaitStates);
+	}
+
+	system_gclk_gen_set_config(GCLK_GENERATOR_0, &xGenConfig);
+
+	if (xProfiles[eProfile].ucFlashWaitStates < xProfiles[eCurrentProfile].ucFlashWaitStates)
+	{
+		system_flash_set_waitstates(xProfiles[eProfile].ucFlashWaitStates);
+	}
+
+	ulCpuHz = system_gclk_gen_get_hz(GCLK_GENERATOR_0);
+
+	// Keep the RTOS tick at configTICK_RATE_HZ. The tick in progress is restarted
+	SysTick->LOAD = (ulCpuHz / configTICK_RATE_HZ) - 1UL;
+	SysTick->VAL = 0;
+
+	prvNotify(CLOCK_PROFILE_POST_CHANGE, ulCpuHz);
+
+	taskEXIT_CRITICAL();
+
+	// The DFLL is the largest consumer of the clock tree, stop it when unused
+	if (xProfiles[eCurrentProfile].eSource == SYSTEM_CLOCK_SOURCE_DFLL)
+	{
+		system_clock_source_disable(SYSTEM_CLOCK_SOURCE_DFLL);
+	}
+
+	eCurrentProfile = eProfile;
+	ulSwitchCount++;
+
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvEnableDfll(void)
+ * @brief		Re-enables the DFLL with the configuration from conf_clocks.h and
+ *				waits for it to report ready and, in closed loop, coarse and fine lock
+ * @return		pdPASS once locked, pdFAIL (DFLL disabled again) on timeout
+ *****************************************************************************/
+static BaseType_t prvEnableDfll(void)
+{
+	TickType_t xStart = xTaskGetTickCount();
+
+	system_clock_source_enable(SYSTEM_CLOCK_SOURCE_DFLL);
+
+	while (!system_clock_source_is_ready(SYSTEM_CLOCK_SOURCE_DFLL))
+	{
+		if ((xTaskGetTickCount() - xStart) > pdMS_TO_TICKS(CLOCK_PROFILE_LOCK_TIMEOUT_MS))
+		{
+			system_clock_source_disable(SYSTEM_CLOCK_SOURCE_DFLL);
+			return pdFAIL;
+		}
+		vTaskDelay(1);
+	}
+
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvNotify(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+ * @brief		Calls every registered clock change callback
+ *****************************************************************************/
+static void prvNotify(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+{
+	for (UBaseType_t i = 0; i < uxCallbackCount; i++)
+	{
+		pxCallbacks[i](eEvent, ulCpuHz);
+	}
+}
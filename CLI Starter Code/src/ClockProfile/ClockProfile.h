@@ -0,0 +1,131 @@
+/**************************************************************************/ /**
+ * @file      ClockProfile.h
+ * @brief     CPU clock profiles. Switches GCLK0 (CPU, SysTick and the
+ *            peripherals clocked from it) between a 48 MHz high performance
+ *            profile and an 8 MHz low power profile at run time.
+ * @details   --HIGH: DFLL48M in closed loop, locked to XOSC32K through GCLK1,
+ *              one flash wait state. This is the profile the part boots into
+ *              (see conf_clocks.h)
+ *            --LOW: OSC8M, no flash wait states, DFLL switched off
+ *            On every switch the SysTick reload and any registered callbacks
+ *            (e.g. the console baud rate) are updated to the new frequency.
+ *
+ *            In the automatic mode, the default, the profile follows the
+ *            activity the application reports with ClockProfileRequest(): the
+ *            IMU task asks for HIGH while it streams and LOW while it waits
+ *            for motion. ClockProfileSetAuto(false) fixes the profile for
+ *            ClockProfileSet() and the "clock" command.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CLOCK_PROFILE_MAX_CALLBACKS 4		///< Maximum number of clock change callbacks
+#define CLOCK_PROFILE_LOCK_TIMEOUT_MS 20	///< Time allowed for the DFLL to lock when entering HIGH
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+enum eClockProfiles
+{
+	CLOCK_PROFILE_HIGH = 0, ///< 48 MHz from the closed loop DFLL
+	CLOCK_PROFILE_LOW = 1,	///< 8 MHz from OSC8M
+	N_CLOCK_PROFILES = 2	///< Number of clock profiles
+};
+
+enum eClockProfileEvents
+{
+	CLOCK_PROFILE_PRE_CHANGE = 0, ///< GCLK0 is about to change. Finish or pause anything timed from it
+	CLOCK_PROFILE_POST_CHANGE = 1 ///< GCLK0 has changed. Re-derive dividers from ulCpuHz
+};
+
+/**
+ * @brief Called around every profile switch, with interrupts masked. Must not
+ *        block or call FreeRTOS APIs.
+ * @param eEvent Whether the clock is about to change or has changed
+ * @param ulCpuHz GCLK0 frequency after the switch
+ */
+typedef void (*ClockProfileCallback_t)(enum eClockProfileEvents eEvent, uint32_t ulCpuHz);
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void ClockProfileInit(void)
+ * @brief		Creates the lock that serialises the switches
+ * @note		Call once, before any task switches
+ *****************************************************************************/
+void ClockProfileInit(void);
+
+/**
+ * @fn			BaseType_t ClockProfileRegisterCallback(ClockProfileCallback_t pxCallback)
+ * @brief		Registers a function to be told about clock changes
+ * @note		May be called before the scheduler starts
+ * @return		pdPASS if registered, pdFAIL if the table is full
+ *****************************************************************************/
+BaseType_t ClockProfileRegisterCallback(ClockProfileCallback_t pxCallback);
+
+/**
+ * @fn			BaseType_t ClockProfileSet(enum eClockProfiles eProfile)
+ * @brief		Switches to a clock profile
+ * @details		Entering HIGH re-enables the DFLL and waits (blocking, up to
+ *				CLOCK_PROFILE_LOCK_TIMEOUT_MS) for it to lock before GCLK0 is moved
+ *				to it. The flash wait states are raised before the frequency goes up
+ *				and lowered after it comes down. In the automatic mode the next
+ *				ClockProfileRequest() switches again.
+ * @note		Call from a task. Switches from several tasks run one at a time
+ * @return		pdPASS on success, pdFAIL if the DFLL did not lock or eProfile is invalid
+ *****************************************************************************/
+BaseType_t ClockProfileSet(enum eClockProfiles eProfile);
+
+/**
+ * @fn			BaseType_t ClockProfileRequest(enum eClockProfiles eProfile)
+ * @brief		Records the profile the application's activity needs, and
+ *				switches to it in the automatic mode
+ * @note		Call from a task. May block while the DFLL locks
+ * @return		pdPASS if recorded and, in the automatic mode, switched
+ *****************************************************************************/
+BaseType_t ClockProfileRequest(enum eClockProfiles eProfile);
+
+/**
+ * @fn			BaseType_t ClockProfileSetAuto(bool bAuto)
+ * @brief		Turns the automatic mode on, switching to the last requested
+ *				profile, or off, keeping the current one
+ * @return		pdPASS, or pdFAIL if the switch to the requested profile failed
+ *****************************************************************************/
+BaseType_t ClockProfileSetAuto(bool bAuto);
+
+/**
+ * @fn			bool ClockProfileIsAuto(void)
+ * @brief		Returns true in the automatic mode
+ *****************************************************************************/
+bool ClockProfileIsAuto(void);
+
+/**
+ * @fn			enum eClockProfiles ClockProfileGet(void)
+ * @brief		Returns the active clock profile
+ *****************************************************************************/
+enum eClockProfiles ClockProfileGet(void);
+
+/**
+ * @fn			const char *ClockProfileGetName(enum eClockProfiles eProfile)
+ * @brief		Returns "high" or "low", or NULL for an invalid profile
+ *****************************************************************************/
+const char *ClockProfileGetName(enum eClockProfiles eProfile);
+
+/**
+ * @fn			uint32_t ClockProfileGetSwitchCount(void)
+ * @brief		Returns the number of profile switches since boot
+ *****************************************************************************/
+uint32_t ClockProfileGetSwitchCount(void);
+
+#endif /* CLOCK_PROFILE_H */
@@ -0,0 +1,652 @@
+/**************************************************************************/ /**
+ * @file      Codec.c
+ * @brief     Lossless IMU stream codec and its pipeline stage. See Codec.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Codec.h"
+#include "Pipeline/Pipeline.h"
+#include "Benchmark/Benchmark.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CODEC_CRC_INIT 0xFFFF
+#define CODEC_QUEUE_MASK (CODEC_QUEUE_BYTES - 1)
+#define CODEC_RICE_MAX_K 15 ///< Largest parameter, sent in 4 bits
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Packs bits from the most significant. Up to 7 bits wait in ulBits.
+ */
+typedef struct
+{
+	uint8_t *pucOut;
+	uint32_t ulBits;
+	uint8_t ucCount; ///< Bits of ulBits not written yet
+} BitWriter_t;
+
+/**
+ * @brief Unpacks bits from the most significant. Reading past pucEnd gives zeros and sets bOverrun.
+ */
+typedef struct
+{
+	const uint8_t *pucIn;
+	const uint8_t *pucEnd;
+	uint32_t ulBits;
+	uint8_t ucCount; ///< Bits of ulBits not read yet
+	bool bOverrun;
+} BitReader_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static uint8_t prvEncodeChannel(BitWriter_t *pxWriter, const ImuBlock_t *pxBlock, uint8_t ucChannel, int16_t *psHistory,
+								bool bKey);
+static bool prvDecodeChannel(BitReader_t *pxReader, ImuBlock_t *pxBlock, uint16_t usCount, uint8_t ucChannel,
+							 int16_t *psHistory, bool bKey);
+static int16_t *prvAxis(ImuSample_t *pxSample, uint8_t ucChannel);
+static uint8_t prvRiceParameter(uint32_t ulSum, uint16_t usCount);
+static uint32_t prvRiceBits(const uint16_t *pusValues, uint16_t usCount, uint8_t ucK);
+static void prvPut(BitWriter_t *pxWriter, uint32_t ulValue, uint8_t ucBits);
+static uint16_t prvGet(BitReader_t *pxReader, uint8_t ucBits);
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength);
+static bool prvQueuePut(const uint8_t *pucPacket, size_t xLength);
+static void prvCodecStage(const ImuBlock_t *pxFrame);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+/**
+ * CRC-16/CCITT-FALSE of each value of the top nibble, for two lookups a byte.
+ * The whole stream goes through it, so it is table driven, but a 16-entry
+ * table keeps it to 32 bytes of flash.
+ */
+static const uint16_t usCrcTable[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+										0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static Codec_t xEncoder;						///< The pipeline encoder, only touched by the pipeline task
+static CodecStats_t xStats;
+static uint8_t ucPacket[CODEC_MAX_PACKET_BYTES]; ///< Packet being coded, before it is queued
+static uint8_t ucQueue[CODEC_QUEUE_BYTES];
+static volatile uint16_t usQueueHead;			///< Free running. Written by the pipeline task
+static volatile uint16_t usQueueTail;			///< Free running. Written by CodecRead()
+static volatile bool bRecording;
+static volatile bool bRestart;					///< Set by CodecSetRecording(), handled on the next frame
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Resets the pipeline encoder and adds its stage.
+ */
+void CodecInit(void)
+{
+	CodecReset(&xEncoder);
+	PipelineRegisterStage(prvCodecStage);
+}
+
+/**
+ * @brief No history, packet numbers from 0.
+ */
+void CodecReset(Codec_t *pxCodec)
+{
+	memset(pxCodec, 0, sizeof(*pxCodec));
+}
+
+/**
+ * @brief Header, then each channel in its cheapest mode, then the CRC.
+ */
+size_t CodecEncode(Codec_t *pxCodec, const ImuBlock_t *pxBlock, uint8_t *pucPacket, size_t xSize, uint8_t *pucModes)
+{
+	BitWriter_t xWriter = {pucPacket + CODEC_HEADER_BYTES, 0, 0};
+	bool bKey = !pxCodec->bKeyed || pxCodec->ucSinceKey + 1 >= CODEC_KEY_PACKETS;
+	uint16_t usLength, usCrc;
+
+	if (xSize < CODEC_MAX_PACKET_BYTES || pxBlock->usCount == 0 || pxBlock->usCount > IMU_BLOCK_SAMPLES)
+	{
+		return 0;
+	}
+
+	pucPacket[0] = CODEC_SYNC_0;
+	pucPacket[1] = CODEC_SYNC_1;
+	pucPacket[2] = (uint8_t)((bKey ? CODEC_FLAG_KEY : 0) | ((uint8_t)pxBlock->cRateShift & 0x0F));
+	pucPacket[3] = (uint8_t)pxBlock->usCount;
+	pucPacket[4] = pxCodec->ucNumber;
+	pucPacket[5] = (uint8_t)pxBlock->xTimestamp;
+	pucPacket[6] = (uint8_t)(pxBlock->xTimestamp >> 8);
+	pucPacket[7] = (uint8_t)(pxBlock->xTimestamp >> 16);
+	pucPacket[8] = (uint8_t)(pxBlock->xTimestamp >> 24);
+
+	for (uint8_t c = 0; c < CODEC_CHANNELS; c++)
+	{
+		uint8_t ucMode = prvEncodeChannel(&xWriter, pxBlock, c, pxCodec->sHistory[c], bKey);
+
+		if (pucModes != NULL)
+		{
+			pucModes[c] = ucMode;
+		}
+	}
+	if (xWriter.ucCount > 0)
+	{
+		prvPut(&xWriter, 0, (uint8_t)(8 - xWriter.ucCount));
+	}
+
+	usLength = (uint16_t)(xWriter.pucOut - pucPacket + CODEC_CRC_BYTES);
+	pucPacket[9] = (uint8_t)usLength;
+	pucPacket[10] = (uint8_t)(usLength >> 8);
+	usCrc = prvCrc16(pucPacket, usLength - CODEC_CRC_BYTES);
+	pucPacket[usLength - 2] = (uint8_t)usCrc;
+	pucPacket[usLength - 1] = (uint8_t)(usCrc >> 8);
+
+	pxCodec->bKeyed = true;
+	pxCodec->ucNumber++;
+	pxCodec->ucSinceKey = bKey ? 0 : pxCodec->ucSinceKey + 1;
+	pxCodec->ulPackets++;
+	return usLength;
+}
+
+/**
+ * @brief Checks the header and CRC before touching the state, and decodes
+ *        into a copy of the history, so nothing invalid is taken in.
+ */
+enum eCodecResults CodecDecode(Codec_t *pxCodec, const uint8_t *pucData, size_t xLength, ImuBlock_t *pxBlock,
+							   size_t *pxUsed)
+{
+	int16_t sHistory[CODEC_CHANNELS][2];
+	BitReader_t xReader;
+	uint8_t ucFlags, ucCount, ucNumber;
+	uint16_t usLength;
+	bool bKey, bUsable;
+
+	if ((xLength > 0 && pucData[0] != CODEC_SYNC_0) || (xLength > 1 && pucData[1] != CODEC_SYNC_1))
+	{
+		return CODEC_INVALID;
+	}
+	if (xLength < CODEC_HEADER_BYTES)
+	{
+		return CODEC_NEED_MORE;
+	}
+
+	ucFlags = pucData[2];
+	ucCount = pucData[3];
+	ucNumber = pucData[4];
+	usLength = (uint16_t)(pucData[9] | pucData[10] << 8);
+	if ((ucFlags & 0x70) != 0 || ucCount == 0 || ucCount > IMU_BLOCK_SAMPLES ||
+		usLength < CODEC_HEADER_BYTES + CODEC_CRC_BYTES || usLength > CODEC_MAX_PACKET_BYTES)
+	{
+		return CODEC_INVALID;
+	}
+	if (xLength < usLength)
+	{
+		return CODEC_NEED_MORE;
+	}
+	if (prvCrc16(pucData, usLength - CODEC_CRC_BYTES) != (uint16_t)(pucData[usLength - 2] | pucData[usLength - 1] << 8))
+	{
+		return CODEC_INVALID;
+	}
+
+	// Without a key, the packet only follows on from the previous one
+	bKey = (ucFlags & CODEC_FLAG_KEY) != 0;
+	bUsable = bKey || (pxCodec->bKeyed && ucNumber == pxCodec->ucNumber);
+	if (bUsable)
+	{
+		xReader.pucIn = pucData + CODEC_HEADER_BYTES;
+		xReader.pucEnd = pucData + usLength - CODEC_CRC_BYTES;
+		xReader.ulBits = 0;
+		xReader.ucCount = 0;
+		xReader.bOverrun = false;
+		memcpy(sHistory, pxCodec->sHistory, sizeof(sHistory));
+		for (uint8_t c = 0; c < CODEC_CHANNELS; c++)
+		{
+			if (!prvDecodeChannel(&xReader, pxBlock, ucCount, c, sHistory[c], bKey))
+			{
+				return CODEC_INVALID;
+			}
+		}
+		memcpy(pxCodec->sHistory, sHistory, sizeof(sHistory));
+
+		pxBlock->usCount = ucCount;
+		pxBlock->cRateShift = (int8_t)(((ucFlags & 0x0F) ^ 0x08) - 0x08);
+		pxBlock->xTimestamp = (TickType_t)pucData[5] | (TickType_t)pucData[6] << 8 | (TickType_t)pucData[7] << 16 |
+							  (TickType_t)pucData[8] << 24;
+		pxBlock->ulCycles = 0;
+	}
+
+	if (pxCodec->ulPackets > 0)
+	{
+		pxCodec->ulLost += (uint8_t)(ucNumber - pxCodec->ucNumber);
+	}
+	pxBlock->ulSequence = pxCodec->ulPackets + pxCodec->ulLost;
+	pxCodec->ulPackets++;
+	pxCodec->ucNumber = (uint8_t)(ucNumber + 1);
+	pxCodec->bKeyed = bUsable;
+	*pxUsed = usLength;
+	return bUsable ? CODEC_DECODED : CODEC_SKIPPED;
+}
+
+/**
+ * @brief Sets the flag; the stage keys the next packet.
+ */
+void CodecSetRecording(bool bEnable)
+{
+	if (bEnable && !bRecording)
+	{
+		bRestart = true;
+	}
+	bRecording = bEnable;
+}
+
+/**
+ * @brief Copies out of the ring, then frees the space.
+ */
+size_t CodecRead(uint8_t *pucData, size_t xSize)
+{
+	uint16_t usTail, usUsed, usFirst;
+
+	taskENTER_CRITICAL();
+	usTail = usQueueTail;
+	usUsed = (uint16_t)(usQueueHead - usTail);
+	taskEXIT_CRITICAL();
+
+	usUsed = (xSize < usUsed) ? (uint16_t)xSize : usUsed;
+	usFirst = (uint16_t)(CODEC_QUEUE_BYTES - (usTail & CODEC_QUEUE_MASK));
+	usFirst = (usUsed < usFirst) ? usUsed : usFirst;
+	memcpy(pucData, &ucQueue[usTail & CODEC_QUEUE_MASK], usFirst);
+	memcpy(pucData + usFirst, ucQueue, usUsed - usFirst);
+
+	taskENTER_CRITICAL();
+	usQueueTail = (uint16_t)(usTail + usUsed);
+	taskEXIT_CRITICAL();
+	return usUsed;
+}
+
+/**
+ * @brief Snapshot of the counters, with the queue level.
+ */
+void CodecGetStats(CodecStats_t *pxStats)
+{
+	taskENTER_CRITICAL();
+	*pxStats = xStats;
+	pxStats->usQueued = (uint16_t)(usQueueHead - usQueueTail);
+	pxStats->bRecording = bRecording;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Clears the counters.
+ */
+void CodecResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&xStats, 0, sizeof(xStats));
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t prvEncodeChannel(BitWriter_t *pxWriter, const ImuBlock_t *pxBlock, uint8_t ucChannel,
+ *											int16_t *psHistory, bool bKey)
+ * @brief		Codes one channel of a block and moves its history on
+ * @details		Both predictions are made in one pass. The one with the smaller
+ *				sum of mapped residuals is kept, k is taken from that sum, and
+ *				the exact Rice length is compared with verbatim
+ * @return		The mode used
+ *****************************************************************************/
+static uint8_t prvEncodeChannel(BitWriter_t *pxWriter, const ImuBlock_t *pxBlock, uint8_t ucChannel, int16_t *psHistory,
+								bool bKey)
+{
+	uint16_t usDelta[IMU_BLOCK_SAMPLES];
+	uint16_t usLinear[IMU_BLOCK_SAMPLES];
+	uint32_t ulDeltaSum = 0;
+	uint32_t ulLinearSum = 0;
+	uint16_t usCount = pxBlock->usCount;
+	uint16_t usFirst = bKey ? 1 : 0;
+	int16_t sPrevious = psHistory[0];
+	int16_t sBefore = psHistory[1];
+	ImuSample_t *pxSamples = (ImuSample_t *)pxBlock->xSamples; // Only read
+	const uint16_t *pusResiduals;
+	uint32_t ulSum;
+	uint8_t ucMode, ucK;
+
+	if (bKey)
+	{
+		sPrevious = *prvAxis(&pxSamples[0], ucChannel);
+		sBefore = sPrevious;
+	}
+	for (uint16_t i = usFirst; i < usCount; i++)
+	{
+		int16_t sValue = *prvAxis(&pxSamples[i], ucChannel);
+		int16_t sResidual;
+
+		// Modulo 2^16, so any prediction is undone exactly
+		sResidual = (int16_t)(uint16_t)(sValue - sPrevious);
+		usDelta[i] = (uint16_t)((uint16_t)(sResidual << 1) ^ (uint16_t)(sResidual >> 15));
+		sResidual = (int16_t)(uint16_t)(sValue - 2 * sPrevious + sBefore);
+		usLinear[i] = (uint16_t)((uint16_t)(sResidual << 1) ^ (uint16_t)(sResidual >> 15));
+		ulDeltaSum += usDelta[i];
+		ulLinearSum += usLinear[i];
+		sBefore = sPrevious;
+		sPrevious = sValue;
+	}
+	psHistory[0] = sPrevious;
+	psHistory[1] = sBefore;
+
+	ucMode = (ulLinearSum < ulDeltaSum) ? CODEC_MODE_LINEAR : CODEC_MODE_DELTA;
+	pusResiduals = (ucMode == CODEC_MODE_LINEAR) ? usLinear : usDelta;
+	ulSum = (ucMode == CODEC_MODE_LINEAR) ? ulLinearSum : ulDeltaSum;
+	ucK = prvRiceParameter(ulSum, usCount - usFirst);
+	if (4 + prvRiceBits(&pusResiduals[usFirst], usCount - usFirst, ucK) >= 16UL * (usCount - usFirst))
+	{
+		ucMode = CODEC_MODE_VERBATIM;
+	}
+
+	prvPut(pxWriter, ucMode, 2);
+	if (bKey)
+	{
+		prvPut(pxWriter, (uint16_t)*prvAxis(&pxSamples[0], ucChannel), 16);
+	}
+	if (ucMode == CODEC_MODE_VERBATIM)
+	{
+		for (uint16_t i = usFirst; i < usCount; i++)
+		{
+			prvPut(pxWriter, (uint16_t)*prvAxis(&pxSamples[i], ucChannel), 16);
+		}
+		return ucMode;
+	}
+
+	prvPut(pxWriter, ucK, 4);
+	for (uint16_t i = usFirst; i < usCount; i++)
+	{
+		uint16_t usQuotient = pusResiduals[i] >> ucK;
+
+		if (usQuotient < CODEC_RICE_ESCAPE)
+		{
+			// usQuotient ones and a zero
+			prvPut(pxWriter, (1UL << (usQuotient + 1)) - 2, (uint8_t)(usQuotient + 1));
+			prvPut(pxWriter, pusResiduals[i] & ((1UL << ucK) - 1), ucK);
+		}
+		else
+		{
+			prvPut(pxWriter, (1UL << CODEC_RICE_ESCAPE) - 1, CODEC_RICE_ESCAPE);
+			prvPut(pxWriter, pusResiduals[i], 16);
+		}
+	}
+	return ucMode;
+}
+
+/**************************************************************************/ /**
+ * @fn			static bool prvDecodeChannel(BitReader_t *pxReader, ImuBlock_t *pxBlock, uint16_t usCount,
+ *											uint8_t ucChannel, int16_t *psHistory, bool bKey)
+ * @brief		Decodes one channel of usCount samples into the block and moves its history on
+ * @return		false on an invalid mode or a channel running past the packet
+ *****************************************************************************/
+static bool prvDecodeChannel(BitReader_t *pxReader, ImuBlock_t *pxBlock, uint16_t usCount, uint8_t ucChannel,
+							 int16_t *psHistory, bool bKey)
+{
+	uint8_t ucMode = (uint8_t)prvGet(pxReader, 2);
+	uint16_t usFirst = bKey ? 1 : 0;
+	int16_t sPrevious = psHistory[0];
+	int16_t sBefore = psHistory[1];
+	uint8_t ucK = 0;
+
+	if (ucMode >= N_CODEC_MODES)
+	{
+		return false;
+	}
+	if (bKey)
+	{
+		sPrevious = (int16_t)prvGet(pxReader, 16);
+		sBefore = sPrevious;
+		*prvAxis(&pxBlock->xSamples[0], ucChannel) = sPrevious;
+	}
+	if (ucMode != CODEC_MODE_VERBATIM)
+	{
+		ucK = (uint8_t)prvGet(pxReader, 4);
+	}
+
+	for (uint16_t i = usFirst; i < usCount; i++)
+	{
+		int16_t sValue;
+
+		if (ucMode == CODEC_MODE_VERBATIM)
+		{
+			sValue = (int16_t)prvGet(pxReader, 16);
+		}
+		else
+		{
+			uint16_t usQuotient = 0;
+			uint16_t usMapped;
+			int16_t sResidual;
+
+			while (usQuotient < CODEC_RICE_ESCAPE && prvGet(pxReader, 1) != 0)
+			{
+				usQuotient++;
+			}
+			if (usQuotient < CODEC_RICE_ESCAPE)
+			{
+				usMapped = (uint16_t)((usQuotient << ucK) | prvGet(pxReader, ucK));
+			}
+			else
+			{
+				usMapped = prvGet(pxReader, 16);
+			}
+			sResidual = (int16_t)((usMapped >> 1) ^ (uint16_t)-(usMapped & 1));
+			if (ucMode == CODEC_MODE_LINEAR)
+			{
+				sValue = (int16_t)(uint16_t)(2 * sPrevious - sBefore + sResidual);
+			}
+			else
+			{
+				sValue = (int16_t)(uint16_t)(sPrevious + sResidual);
+			}
+		}
+		*prvAxis(&pxBlock->xSamples[i], ucChannel) = sValue;
+		sBefore = sPrevious;
+		sPrevious = sValue;
+	}
+	psHistory[0] = sPrevious;
+	psHistory[1] = sBefore;
+	return !pxReader->bOverrun;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int16_t *prvAxis(ImuSample_t *pxSample, uint8_t ucChannel)
+ * @brief		Channel 0 to 8 of a sample: MPU6000 accelerometer and
+ *				gyroscope, then LIS2DS12 accelerometer
+ *****************************************************************************/
+static int16_t *prvAxis(ImuSample_t *pxSample, uint8_t ucChannel)
+{
+	if (ucChannel < 3)
+	{
+		return &pxSample->sAccel[ucChannel];
+	}
+	return (ucChannel < 6) ? &pxSample->sGyro[ucChannel - 3] : &pxSample->sAccelAux[ucChannel - 6];
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t prvRiceParameter(uint32_t ulSum, uint16_t usCount)
+ * @brief		floor(log2(mean)) of the mapped residuals, 0 below a mean of 2,
+ *				by doubling: the Cortex-M0+ has no CLZ or divide
+ *****************************************************************************/
+static uint8_t prvRiceParameter(uint32_t ulSum, uint16_t usCount)
+{
+	uint8_t ucK = 0;
+
+	while (ucK < CODEC_RICE_MAX_K && ((uint32_t)usCount << (ucK + 1)) <= ulSum)
+	{
+		ucK++;
+	}
+	return ucK;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvRiceBits(const uint16_t *pusValues, uint16_t usCount, uint8_t ucK)
+ * @brief		Exact length of the values Rice coded with ucK, escapes included
+ *****************************************************************************/
+static uint32_t prvRiceBits(const uint16_t *pusValues, uint16_t usCount, uint8_t ucK)
+{
+	uint32_t ulBits = 0;
+
+	for (uint16_t i = 0; i < usCount; i++)
+	{
+		uint16_t usQuotient = pusValues[i] >> ucK;
+
+		ulBits += (usQuotient < CODEC_RICE_ESCAPE) ? usQuotient + 1 + ucK : CODEC_RICE_ESCAPE + 16;
+	}
+	return ulBits;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPut(BitWriter_t *pxWriter, uint32_t ulValue, uint8_t ucBits)
+ * @brief		Appends the ucBits low bits of ulValue, up to 24. The bits
+ *				above them must be zero
+ *****************************************************************************/
+static void prvPut(BitWriter_t *pxWriter, uint32_t ulValue, uint8_t ucBits)
+{
+	pxWriter->ulBits = (pxWriter->ulBits << ucBits) | ulValue;
+	pxWriter->ucCount += ucBits;
+	while (pxWriter->ucCount >= 8)
+	{
+		pxWriter->ucCount -= 8;
+		*pxWriter->pucOut++ = (uint8_t)(pxWriter->ulBits >> pxWriter->ucCount);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvGet(BitReader_t *pxReader, uint8_t ucBits)
+ * @brief		Takes the next ucBits bits, up to 16
+ *****************************************************************************/
+static uint16_t prvGet(BitReader_t *pxReader, uint8_t ucBits)
+{
+	while (pxReader->ucCount < ucBits)
+	{
+		uint8_t ucByte = 0;
+
+		if (pxReader->pucIn < pxReader->pucEnd)
+		{
+			ucByte = *pxReader->pucIn++;
+		}
+		else
+		{
+			pxReader->bOverrun = true;
+		}
+		pxReader->ulBits = (pxReader->ulBits << 8) | ucByte;
+		pxReader->ucCount += 8;
+	}
+	pxReader->ucCount -= ucBits;
+	return (uint16_t)((pxReader->ulBits >> pxReader->ucCount) & ((1UL << ucBits) - 1));
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+ * @brief		CRC-16/CCITT-FALSE, a nibble at a time
+ *****************************************************************************/
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+{
+	uint16_t usCrc = CODEC_CRC_INIT;
+
+	for (size_t i = 0; i < xLength; i++)
+	{
+		usCrc = (uint16_t)((usCrc << 4) ^ usCrcTable[(usCrc >> 12) ^ (pucData[i] >> 4)]);
+		usCrc = (uint16_t)((usCrc << 4) ^ usCrcTable[(usCrc >> 12) ^ (pucData[i] & 0x0F)]);
+	}
+	return usCrc;
+}
+
+/**************************************************************************/ /**
+ * @fn			static bool prvQueuePut(const uint8_t *pucPacket, size_t xLength)
+ * @brief		Queues a whole packet, or nothing if it does not fit
+ *****************************************************************************/
+static bool prvQueuePut(const uint8_t *pucPacket, size_t xLength)
+{
+	uint16_t usHead, usFree, usFirst;
+
+	taskENTER_CRITICAL();
+	usHead = usQueueHead;
+	usFree = (uint16_t)(CODEC_QUEUE_BYTES - (uint16_t)(usHead - usQueueTail));
+	taskEXIT_CRITICAL();
+
+	if (xLength > usFree)
+	{
+		return false;
+	}
+	usFirst = (uint16_t)(CODEC_QUEUE_BYTES - (usHead & CODEC_QUEUE_MASK));
+	usFirst = (xLength < usFirst) ? (uint16_t)xLength : usFirst;
+	memcpy(&ucQueue[usHead & CODEC_QUEUE_MASK], pucPacket, usFirst);
+	memcpy(ucQueue, pucPacket + usFirst, xLength - usFirst);
+
+	taskENTER_CRITICAL();
+	usQueueHead = (uint16_t)(usHead + xLength);
+	taskEXIT_CRITICAL();
+	return true;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCodecStage(const ImuBlock_t *pxFrame)
+ * @brief		Pipeline stage: while recording, codes the block and queues
+ *				the packet, and checks the block against
+ *				CODEC_BLOCK_BUDGET_CYCLES. A dropped packet makes the next one
+ *				a key packet, so the reader picks up again at once
+ *****************************************************************************/
+static void prvCodecStage(const ImuBlock_t *pxFrame)
+{
+	uint8_t ucModes[CODEC_CHANNELS];
+	uint32_t ulStart, ulCycles;
+	size_t xLength;
+	bool bQueued;
+
+	if (!bRecording)
+	{
+		return;
+	}
+	if (bRestart)
+	{
+		bRestart = false;
+		xEncoder.bKeyed = false;
+	}
+
+	ulStart = BenchmarkGetCycles();
+	xLength = CodecEncode(&xEncoder, pxFrame, ucPacket, sizeof(ucPacket), ucModes);
+	bQueued = (xLength > 0) && prvQueuePut(ucPacket, xLength);
+	ulCycles = BenchmarkGetCycles() - ulStart;
+	if (xLength == 0)
+	{
+		return;
+	}
+	if (!bQueued)
+	{
+		xEncoder.bKeyed = false;
+	}
+
+	taskENTER_CRITICAL();
+	xStats.ulBlocks++;
+	xStats.ulKeys += (ucPacket[2] & CODEC_FLAG_KEY) ? 1 : 0;
+	xStats.ulSamples += pxFrame->usCount;
+	xStats.ulBytes += xLength;
+	xStats.ulDropped += bQueued ? 0 : 1;
+	for (uint8_t c = 0; c < CODEC_CHANNELS; c++)
+	{
+		xStats.ulModes[ucModes[c]]++;
+	}
+	xStats.ullCyclesTotal += ulCycles;
+	if (ulCycles > xStats.ulCyclesMax)
+	{
+		xStats.ulCyclesMax = ulCycles;
+	}
+	if (ulCycles > CODEC_BLOCK_BUDGET_CYCLES)
+	{
+		xStats.ulOverBudget++;
+	}
+	taskEXIT_CRITICAL();
+}
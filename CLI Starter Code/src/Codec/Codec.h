@@ -0,0 +1,208 @@
+/**************************************************************************/ /**
+ * @file      Codec.h
+ * @brief     Lossless compression of the IMU stream, one pipeline block per
+ *            packet, for storage and upload.
+ * @details   Each of the nine channels of a block (MPU6000 accelerometer and
+ *            gyroscope, LIS2DS12 accelerometer, X Y Z each) is coded on its
+ *            own, with the one of three modes that gives the fewest bits:
+ *            --delta: the residual from the previous value
+ *            --linear: the residual from the line through the two previous
+ *              values, 2 x[n-1] - x[n-2], better in smooth motion
+ *            --verbatim: 16 bits per value, the bound for noise and impacts
+ *
+ *            The residuals are taken modulo 2^16, so they fit 16 bits and the
+ *            decoder gets every value back exactly. They are zigzag mapped
+ *            (0, -1, 1, -2 ... to 0, 1, 2, 3 ...) and Rice coded with one
+ *            parameter k per channel and block, from the mean of the mapped
+ *            residuals: the quotient in unary, then k low bits. A quotient of
+ *            CODEC_RICE_ESCAPE or more is sent as the escape and the 16 bits.
+ *
+ *            The prediction runs on from one packet to the next, so a packet
+ *            only decodes after the one before it. Every CODEC_KEY_PACKETS
+ *            packets, and after a packet was dropped, a key packet sends the
+ *            first value of each channel verbatim instead; a decoder that
+ *            lost packets, or starts mid-stream, picks up from there.
+ *
+ *            Packet, little endian, CODEC_HEADER_BYTES of header:
+ *                uint8 CODEC_SYNC_0, CODEC_SYNC_1
+ *                uint8 flags: bit 7 key packet, bits 3..0 rate shift as in
+ *                      ImuBlock_t, two's complement
+ *                uint8 samples, 1 to IMU_BLOCK_SAMPLES
+ *                uint8 packet number, one more than the previous packet's
+ *                uint32 tick of the block
+ *                uint16 packet length, header and CRC included
+ *            then the channels in order, bits from the most significant:
+ *                2 bits mode (0 delta, 1 linear, 2 verbatim), 4 bits k
+ *                unless verbatim, then the values
+ *            zero bits to the byte, and the CRC-16/CCITT-FALSE of all bytes
+ *            before it. A reader that lost its place finds the next packet
+ *            by the sync bytes, a sane length and the CRC.
+ *
+ *            CodecInit() hooks an encoder into the frame pipeline. While
+ *            recording, every block is coded into a queue of
+ *            CODEC_QUEUE_BYTES, drained by CodecRead(); a packet that does
+ *            not fit is dropped. The "codec" command shows the counters and
+ *            dumps the queue in hex. tools/replay reads the dump, or the
+ *            packets as a binary file, as a session, and measures the
+ *            compression. On the synthetic sessions of "make -C tools/replay
+ *            check" (synth.py --seed 3) the ratio is 1.55 at 25 Hz, 1.64 at
+ *            50 Hz, 1.70 at 100 Hz and 1.74 at 200 Hz.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CODEC_H
+#define CODEC_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "Imu/Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CODEC_CHANNELS 9				///< Axes of an ImuSample_t
+#define CODEC_SYNC_0 0xA5
+#define CODEC_SYNC_1 0x5A
+#define CODEC_FLAG_KEY 0x80
+#define CODEC_HEADER_BYTES 11
+#define CODEC_CRC_BYTES 2
+#define CODEC_KEY_PACKETS 10			///< A key packet at least this often, once a second at 100 Hz
+#define CODEC_RICE_ESCAPE 16			///< Quotients from this on are sent as 16 bits
+#define CODEC_QUEUE_BYTES 1024			///< Packets waiting for CodecRead(), a power of 2
+#define CODEC_BLOCK_BUDGET_CYCLES 40000 ///< Cycles one block may take, checked by the pipeline stage. Under 2 % of the CPU at 200 Hz
+
+/** Largest packet: every channel verbatim */
+#define CODEC_MAX_PACKET_BYTES \
+	(CODEC_HEADER_BYTES + (CODEC_CHANNELS * (2 + 16 * IMU_BLOCK_SAMPLES) + 7) / 8 + CODEC_CRC_BYTES)
+
+/** Bytes of the same samples uncoded */
+#define CODEC_RAW_SAMPLE_BYTES (CODEC_CHANNELS * 2)
+
+#if (CODEC_QUEUE_BYTES & (CODEC_QUEUE_BYTES - 1)) != 0 || CODEC_QUEUE_BYTES > 32768
+#error "CODEC_QUEUE_BYTES must be a power of 2 up to 32768"
+#endif
+#if IMU_BLOCK_SAMPLES > 255 || IMU_RATE_SHIFT_MIN < -8 || IMU_RATE_SHIFT_MAX > 7
+#error "The packet header has one byte for the samples and four bits for the rate shift"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief How a channel of a block is coded.
+ */
+enum eCodecModes
+{
+	CODEC_MODE_DELTA = 0,
+	CODEC_MODE_LINEAR,
+	CODEC_MODE_VERBATIM,
+	N_CODEC_MODES
+};
+
+/**
+ * @brief What CodecDecode() found at the start of its data.
+ */
+enum eCodecResults
+{
+	CODEC_DECODED = 0, ///< A packet, decoded into the block
+	CODEC_SKIPPED,	   ///< A packet, but packets before it were lost: waiting for a key packet
+	CODEC_NEED_MORE,   ///< Could be a packet, cut short
+	CODEC_INVALID	   ///< Not a packet. Try again one byte on
+};
+
+/**
+ * @brief State of one encoder or decoder. Set up with CodecReset().
+ */
+typedef struct
+{
+	int16_t sHistory[CODEC_CHANNELS][2]; ///< Last two values of each channel, newest first
+	bool bKeyed;						 ///< sHistory is valid. Cleared, the next packet is a key packet
+	uint8_t ucNumber;					 ///< Number of the next packet
+	uint8_t ucSinceKey;					 ///< Encoder: packets since the last key packet
+	uint32_t ulPackets;					 ///< Packets coded, or decoded and skipped
+	uint32_t ulLost;					 ///< Decoder: packets missing from the numbering
+} Codec_t;
+
+/**
+ * @brief Counters of the pipeline encoder.
+ */
+typedef struct
+{
+	uint32_t ulBlocks;			   ///< Blocks coded
+	uint32_t ulKeys;			   ///< Of them key packets
+	uint32_t ulSamples;
+	uint32_t ulBytes;			   ///< Packet bytes, headers included
+	uint32_t ulDropped;			   ///< Packets that did not fit in the queue
+	uint32_t ulModes[N_CODEC_MODES]; ///< Channels of a block coded in each mode
+	uint32_t ulCyclesMax;		   ///< Longest block
+	uint64_t ullCyclesTotal;	   ///< Divide by ulBlocks for the mean
+	uint32_t ulOverBudget;		   ///< Blocks over CODEC_BLOCK_BUDGET_CYCLES
+	uint16_t usQueued;			   ///< Bytes waiting in the queue
+	bool bRecording;
+} CodecStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void CodecInit(void)
+ * @brief		Resets the pipeline encoder and registers it as a pipeline stage, not recording
+ * @note		Call once from the daemon task startup hook, after PipelineInit()
+ *****************************************************************************/
+void CodecInit(void);
+
+/**
+ * @fn			void CodecReset(Codec_t *pxCodec)
+ * @brief		Forgets the history. An encoder starts with a key packet, a decoder waits for one
+ *****************************************************************************/
+void CodecReset(Codec_t *pxCodec);
+
+/**
+ * @fn			size_t CodecEncode(Codec_t *pxCodec, const ImuBlock_t *pxBlock, uint8_t *pucPacket, size_t xSize, uint8_t *pucModes)
+ * @brief		Codes a block into one packet
+ * @param[out]	pucPacket At least CODEC_MAX_PACKET_BYTES
+ * @param[out]	pucModes Optional, the mode of each channel, CODEC_CHANNELS entries
+ * @return		Packet length, or 0 if xSize is below CODEC_MAX_PACKET_BYTES or the block is empty
+ *****************************************************************************/
+size_t CodecEncode(Codec_t *pxCodec, const ImuBlock_t *pxBlock, uint8_t *pucPacket, size_t xSize, uint8_t *pucModes);
+
+/**
+ * @fn			enum eCodecResults CodecDecode(Codec_t *pxCodec, const uint8_t *pucData, size_t xLength, ImuBlock_t *pxBlock, size_t *pxUsed)
+ * @brief		Decodes the packet at the start of pucData
+ * @details		The block gets the samples, rate shift and tick of the packet,
+ *				and a sequence number that skips one for every lost packet,
+ *				as blocks from the IMU task do. ulCycles is 0
+ * @param[out]	pxUsed Packet length for CODEC_DECODED and CODEC_SKIPPED
+ *****************************************************************************/
+enum eCodecResults CodecDecode(Codec_t *pxCodec, const uint8_t *pucData, size_t xLength, ImuBlock_t *pxBlock,
+							   size_t *pxUsed);
+
+/**
+ * @fn			void CodecSetRecording(bool bEnable)
+ * @brief		Starts or stops coding the pipeline blocks into the queue. Each start sends a key packet first
+ *****************************************************************************/
+void CodecSetRecording(bool bEnable);
+
+/**
+ * @fn			size_t CodecRead(uint8_t *pucData, size_t xSize)
+ * @brief		Takes up to xSize bytes from the queue, oldest first. Packets
+ *				are only queued whole, so an empty queue ends on a packet
+ * @return		Bytes copied
+ *****************************************************************************/
+size_t CodecRead(uint8_t *pucData, size_t xSize);
+
+/**
+ * @fn			void CodecGetStats(CodecStats_t *pxStats)
+ * @brief		Copies the counters
+ *****************************************************************************/
+void CodecGetStats(CodecStats_t *pxStats);
+
+/**
+ * @fn			void CodecResetStats(void)
+ * @brief		Clears the counters
+ *****************************************************************************/
+void CodecResetStats(void);
+
+#endif /* CODEC_H */
@@ -0,0 +1,190 @@
+/**************************************************************************/ /**
+ * @file      Dmac.c
+ * @brief     DMAC channel setup, one-block transfers and completion callbacks.
+ *            See Dmac.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Dmac.h"
+#include "Benchmark/Benchmark.h"
+#include "IrqMonitor/IrqMonitor.h"
+#include "conf_irq_priorities.h"
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Callback of one channel.
+ */
+typedef struct
+{
+	DmacCallback_t pxCallback;
+	void *pvContext;
+} DmacChannel_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvDisable(enum eDmacChannels eChannel);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+// BASEADDR and WRBADDR must be 128-bit aligned. Entry n belongs to channel n
+static DmacDescriptor xDescriptors[N_DMAC_CHANNELS] __attribute__((aligned(16)));
+static DmacDescriptor xWriteback[N_DMAC_CHANNELS] __attribute__((aligned(16)));
+static DmacChannel_t xChannels[N_DMAC_CHANNELS];
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Clocks, resets and enables the DMAC.
+ */
+void DmacInit(void)
+{
+	system_ahb_clock_set_mask(PM_AHBMASK_DMAC);
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBB, PM_APBBMASK_DMAC);
+
+	DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+	DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+	while (DMAC->CTRL.reg & DMAC_CTRL_SWRST)
+		;
+	DMAC->BASEADDR.reg = (uint32_t)xDescriptors;
+	DMAC->WRBADDR.reg = (uint32_t)xWriteback;
+	DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+	NVIC_SetPriority(DMAC_IRQn, IRQ_PRIORITY_DMAC);
+	NVIC_EnableIRQ(DMAC_IRQn);
+}
+
+/**
+ * @brief Resets a channel and sets its trigger and callback.
+ */
+void DmacConfigure(enum eDmacChannels eChannel, uint8_t ucTrigger, DmacCallback_t pxCallback, void *pvContext)
+{
+	if (eChannel >= N_DMAC_CHANNELS)
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	prvDisable(eChannel);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST)
+		;
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(ucTrigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+	xChannels[eChannel].pxCallback = pxCallback;
+	xChannels[eChannel].pvContext = pvContext;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Writes the channel's descriptor and enables it.
+ */
+void DmacStart(enum eDmacChannels eChannel, const volatile void *pvSource, volatile void *pvDestination,
+			   uint16_t usBytes, bool bSourceIncrement, bool bDestinationIncrement)
+{
+	DmacDescriptor *pxDescriptor = &xDescriptors[eChannel];
+	uint16_t usControl = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_BLOCKACT_NOACT;
+	uint32_t ulSource = (uint32_t)pvSource;
+	uint32_t ulDestination = (uint32_t)pvDestination;
+
+	if (eChannel >= N_DMAC_CHANNELS || usBytes == 0)
+	{
+		return;
+	}
+
+	// An incrementing address is given as the end of the block, not its start
+	if (bSourceIncrement)
+	{
+		usControl |= DMAC_BTCTRL_SRCINC;
+		ulSource += usBytes;
+	}
+	if (bDestinationIncrement)
+	{
+		usControl |= DMAC_BTCTRL_DSTINC;
+		ulDestination += usBytes;
+	}
+	pxDescriptor->BTCTRL.reg = usControl;
+	pxDescriptor->BTCNT.reg = usBytes;
+	pxDescriptor->SRCADDR.reg = ulSource;
+	pxDescriptor->DSTADDR.reg = ulDestination;
+	pxDescriptor->DESCADDR.reg = 0;
+
+	// CHID selects the channel for every CH register, DMAC_Handler included
+	taskENTER_CRITICAL();
+	DMAC->CHID.reg = DMAC_CHID_ID(eChannel);
+	DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_MASK;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Disables a channel and drops its pending flags.
+ */
+void DmacAbort(enum eDmacChannels eChannel)
+{
+	if (eChannel >= N_DMAC_CHANNELS)
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	prvDisable(eChannel);
+	DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_MASK;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief DMAC interrupt. Runs the callback of every channel that completed or failed.
+ */
+void DMAC_Handler(void)
+{
+	uint32_t ulEntry = BenchmarkGetCycles();
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t ulPending = DMAC->INTSTATUS.reg;
+
+	for (uint8_t ucChannel = 0; ucChannel < N_DMAC_CHANNELS; ucChannel++)
+	{
+		if (ulPending & (1UL << ucChannel))
+		{
+			uint8_t ucFlags;
+
+			DMAC->CHID.reg = DMAC_CHID_ID(ucChannel);
+			ucFlags = DMAC->CHINTFLAG.reg;
+			DMAC->CHINTFLAG.reg = ucFlags;
+			if (xChannels[ucChannel].pxCallback != NULL)
+			{
+				xChannels[ucChannel].pxCallback(xChannels[ucChannel].pvContext, (ucFlags & DMAC_CHINTFLAG_TERR) != 0,
+												&xHigherPriorityTaskWoken);
+			}
+		}
+	}
+
+	IrqMonitorRecord(IRQ_MONITOR_DMAC, IRQ_MONITOR_NO_LATENCY, BenchmarkGetCycles() - ulEntry);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvDisable(enum eDmacChannels eChannel)
+ * @brief		Selects a channel and waits until it is disabled
+ * @note		Call with interrupts masked, CHID is shared with DMAC_Handler.
+ *				Disabling lets the beat in progress finish, so the wait is short
+ *****************************************************************************/
+static void prvDisable(enum eDmacChannels eChannel)
+{
+	DMAC->CHID.reg = DMAC_CHID_ID(eChannel);
+	DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE)
+		;
+}
@@ -0,0 +1,77 @@
+/**************************************************************************/ /**
+ * @file      Dmac.h
+ * @brief     DMAC channel setup, one-block transfers and completion callbacks.
+ * @details   Each user of the DMAC owns one of the channels listed in
+ *            eDmacChannels. A channel moves one block between memory and a
+ *            peripheral, one beat per peripheral trigger, and then calls its
+ *            callback from DMAC_Handler. Descriptors are single blocks; there
+ *            is no linked list and no event output.
+ *
+ *            The descriptor and write-back sections hold only the channels
+ *            listed here, so adding a channel costs 32 bytes of RAM.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef DMAC_H
+#define DMAC_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Channels in use. The value is the DMAC channel number
+ */
+enum eDmacChannels
+{
+	DMAC_CHANNEL_IMU_SPI_RX = 0, ///< MPU6000 FIFO, SERCOM1 DATA to memory
+	DMAC_CHANNEL_IMU_SPI_TX,	 ///< MPU6000 dummy bytes that clock the read
+	DMAC_CHANNEL_IMU_I2C_RX,	 ///< LIS2DS12 FIFO, SERCOM0 DATA to memory
+	N_DMAC_CHANNELS
+};
+
+/**
+ * @brief Called from DMAC_Handler when a channel's block is done or failed.
+ *        Runs at IRQ_PRIORITY_DMAC and may use the FreeRTOS FromISR API.
+ * @param bError The transfer stopped on a bus error, the block is incomplete
+ */
+typedef void (*DmacCallback_t)(void *pvContext, bool bError, BaseType_t *pxHigherPriorityTaskWoken);
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void DmacInit(void)
+ * @brief		Resets and enables the DMAC with every channel idle
+ * @note		Call once from the daemon task startup hook, before any DmacConfigure()
+ *****************************************************************************/
+void DmacInit(void);
+
+/**
+ * @fn			void DmacConfigure(enum eDmacChannels eChannel, uint8_t ucTrigger, DmacCallback_t pxCallback, void *pvContext)
+ * @brief		Sets a channel's peripheral trigger and its completion callback
+ * @param[in]	ucTrigger A <PERIPH>_DMAC_ID_<RX|TX> value. One beat is moved per trigger
+ *****************************************************************************/
+void DmacConfigure(enum eDmacChannels eChannel, uint8_t ucTrigger, DmacCallback_t pxCallback, void *pvContext);
+
+/**
+ * @fn			void DmacStart(enum eDmacChannels eChannel, const volatile void *pvSource, volatile void *pvDestination, uint16_t usBytes, bool bSourceIncrement, bool bDestinationIncrement)
+ * @brief		Starts a block of byte beats on an idle channel
+ * @details		An address that does not increment is a peripheral register, or a
+ *				single dummy byte. The channel is idle again when its callback runs.
+ *				Start the receiving channel of a pair before the sending one.
+ *****************************************************************************/
+void DmacStart(enum eDmacChannels eChannel, const volatile void *pvSource, volatile void *pvDestination,
+			   uint16_t usBytes, bool bSourceIncrement, bool bDestinationIncrement);
+
+/**
+ * @fn			void DmacAbort(enum eDmacChannels eChannel)
+ * @brief		Stops a channel after a timeout. Its callback does not run
+ *****************************************************************************/
+void DmacAbort(enum eDmacChannels eChannel);
+
+#endif /* DMAC_H */
@@ -0,0 +1,158 @@
+/**************************************************************************/ /**
+ * @file      ExtInt.c
+ * @brief     Shared EIC setup and per-line interrupt dispatch. See ExtInt.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "ExtInt.h"
+#include "Benchmark/Benchmark.h"
+#include "IrqMonitor/IrqMonitor.h"
+#include "conf_irq_priorities.h"
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Callback of one line.
+ */
+typedef struct
+{
+	ExtIntCallback_t pxCallback;
+	void *pvContext;
+} ExtIntLine_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvSync(void);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static ExtIntLine_t xLines[EXTINT_LINES];
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Clocks the EIC from GCLK1 and enables it.
+ */
+void ExtIntInit(void)
+{
+	struct system_gclk_chan_config gclkConfig;
+
+	system_gclk_chan_get_config_defaults(&gclkConfig);
+	gclkConfig.source_generator = GCLK_GENERATOR_1;
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_EIC);
+	system_gclk_chan_set_config(EIC_GCLK_ID, &gclkConfig);
+	system_gclk_chan_enable(EIC_GCLK_ID);
+
+	EIC->CTRL.reg = EIC_CTRL_SWRST;
+	while ((EIC->CTRL.reg & EIC_CTRL_SWRST) || (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY))
+		;
+	EIC->CTRL.reg = EIC_CTRL_ENABLE;
+	prvSync();
+
+	NVIC_SetPriority(EIC_IRQn, IRQ_PRIORITY_EIC);
+	NVIC_EnableIRQ(EIC_IRQn);
+}
+
+/**
+ * @brief Sets the sense and wake of a line and stores its callback.
+ */
+BaseType_t ExtIntConfigure(uint8_t ucLine, enum eExtIntSenses eSense, bool bWakeup, ExtIntCallback_t pxCallback,
+						   void *pvContext)
+{
+	uint32_t ulShift = 4 * (ucLine % 8);
+
+	if (ucLine >= EXTINT_LINES)
+	{
+		return pdFAIL;
+	}
+
+	taskENTER_CRITICAL();
+	EIC->INTENCLR.reg = (1UL << ucLine);
+	xLines[ucLine].pxCallback = pxCallback;
+	xLines[ucLine].pvContext = pvContext;
+
+	// CONFIG is enable protected. The other lines miss edges for the few GCLK1 cycles this takes
+	EIC->CTRL.reg &= ~EIC_CTRL_ENABLE;
+	prvSync();
+	EIC->CONFIG[ucLine / 8].reg = (EIC->CONFIG[ucLine / 8].reg & ~(0xFUL << ulShift)) | ((uint32_t)eSense << ulShift);
+	if (bWakeup)
+	{
+		EIC->WAKEUP.reg |= (1UL << ucLine);
+	}
+	else
+	{
+		EIC->WAKEUP.reg &= ~(1UL << ucLine);
+	}
+	EIC->CTRL.reg |= EIC_CTRL_ENABLE;
+	prvSync();
+	taskEXIT_CRITICAL();
+
+	return pdPASS;
+}
+
+/**
+ * @brief Enables a line's interrupt.
+ */
+void ExtIntEnable(uint8_t ucLine)
+{
+	EIC->INTFLAG.reg = (1UL << ucLine);
+	EIC->INTENSET.reg = (1UL << ucLine);
+}
+
+/**
+ * @brief Disables a line's interrupt.
+ */
+bool ExtIntDisable(uint8_t ucLine)
+{
+	bool bPending;
+
+	EIC->INTENCLR.reg = (1UL << ucLine);
+	bPending = (EIC->INTFLAG.reg & (1UL << ucLine)) != 0;
+	EIC->INTFLAG.reg = (1UL << ucLine);
+
+	return bPending;
+}
+
+/**
+ * @brief EIC interrupt. Runs the callback of every enabled line that fired.
+ */
+void EIC_Handler(void)
+{
+	uint32_t ulEntry = BenchmarkGetCycles();
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t ulFlags = EIC->INTFLAG.reg & EIC->INTENSET.reg;
+
+	EIC->INTFLAG.reg = ulFlags;
+	for (uint8_t ucLine = 0; ulFlags != 0; ucLine++, ulFlags >>= 1)
+	{
+		if ((ulFlags & 1) && xLines[ucLine].pxCallback != NULL)
+		{
+			xLines[ucLine].pxCallback(xLines[ucLine].pvContext, &xHigherPriorityTaskWoken);
+		}
+	}
+
+	IrqMonitorRecord(IRQ_MONITOR_EIC, IRQ_MONITOR_NO_LATENCY, BenchmarkGetCycles() - ulEntry);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvSync(void)
+ * @brief		Waits for a CTRL write to reach the GCLK1 domain
+ *****************************************************************************/
+static void prvSync(void)
+{
+	while (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)
+		;
+}
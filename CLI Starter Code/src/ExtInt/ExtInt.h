@@ -0,0 +1,86 @@
+/**************************************************************************/ /**
+ * @file      ExtInt.h
+ * @brief     Shared EIC setup and per-line interrupt dispatch.
+ * @details   The SAMD21 has one EIC interrupt for its 16 external interrupt
+ *            lines. This module owns the EIC and EIC_Handler, and calls the
+ *            callback of every enabled line whose flag is set. Modules that
+ *            need a line (the STANDBY console wake, the IMU FIFO watermark)
+ *            configure it here instead of writing the EIC registers.
+ *
+ *            The EIC is clocked from GCLK1 (32.768 kHz), which keeps running
+ *            in STANDBY, so every line can wake the device. Edge detection is
+ *            synchronized to that clock and adds up to about 100 us of latency.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef EXTINT_H
+#define EXTINT_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define EXTINT_LINES 16 ///< EXTINT[0..15]
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Input sense of a line, the EIC CONFIG SENSEn values.
+ */
+enum eExtIntSenses
+{
+	EXTINT_SENSE_RISE = EIC_CONFIG_SENSE0_RISE_Val,
+	EXTINT_SENSE_FALL = EIC_CONFIG_SENSE0_FALL_Val,
+	EXTINT_SENSE_BOTH = EIC_CONFIG_SENSE0_BOTH_Val,
+	EXTINT_SENSE_HIGH = EIC_CONFIG_SENSE0_HIGH_Val,
+	EXTINT_SENSE_LOW = EIC_CONFIG_SENSE0_LOW_Val
+};
+
+/**
+ * @brief Called from EIC_Handler with the line's flag already cleared.
+ *        Runs at IRQ_PRIORITY_EIC and may use the FreeRTOS FromISR API.
+ * @param pvContext Pointer given to ExtIntConfigure()
+ * @param pxHigherPriorityTaskWoken Passed on to FromISR calls. The handler yields once for all lines
+ */
+typedef void (*ExtIntCallback_t)(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken);
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void ExtIntInit(void)
+ * @brief		Clocks and enables the EIC with every line disabled
+ * @note		Call once from the daemon task startup hook, before any ExtIntConfigure()
+ *****************************************************************************/
+void ExtIntInit(void);
+
+/**
+ * @fn			BaseType_t ExtIntConfigure(uint8_t ucLine, enum eExtIntSenses eSense, bool bWakeup, ExtIntCallback_t pxCallback, void *pvContext)
+ * @brief		Sets up a line. Its interrupt stays disabled until ExtIntEnable()
+ * @details		The pin must be muxed to its EIC function by the caller.
+ * @param[in]	bWakeup The line also wakes the device from STANDBY
+ * @param[in]	pxCallback May be NULL for a line that is only used to wake
+ * @return		pdPASS, or pdFAIL if ucLine is out of range
+ *****************************************************************************/
+BaseType_t ExtIntConfigure(uint8_t ucLine, enum eExtIntSenses eSense, bool bWakeup, ExtIntCallback_t pxCallback,
+						   void *pvContext);
+
+/**
+ * @fn			void ExtIntEnable(uint8_t ucLine)
+ * @brief		Clears a stale flag and enables the line's interrupt
+ *****************************************************************************/
+void ExtIntEnable(uint8_t ucLine);
+
+/**
+ * @fn			bool ExtIntDisable(uint8_t ucLine)
+ * @brief		Disables the line's interrupt and clears its flag
+ * @return		true if the flag was set, i.e. the line fired and was not handled yet
+ *****************************************************************************/
+bool ExtIntDisable(uint8_t ucLine);
+
+#endif /* EXTINT_H */
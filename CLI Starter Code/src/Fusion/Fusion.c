@@ -0,0 +1,348 @@
+/**************************************************************************/ /**
+ * @file      Fusion.c
+ * @brief     Fixed-point Madgwick orientation filter. See Fusion.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Fusion.h"
+#include "Pipeline/Pipeline.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define FUSION_HALF (1L << 29)		 ///< 1.0 in q29, the format of the gradient error terms
+#define FUSION_RSQRT_FIRST 32		 ///< Table index of the smallest normalised mantissa, 0.25
+#define FUSION_RSQRT_STEPS 2		 ///< Newton steps after the table
+#define FUSION_GRADIENT_BITS 13		 ///< Error terms are cut to this many bits, so the gradient products fit 32 bits
+#define FUSION_GATE_MIN_SQ ((uint32_t)(FUSION_GATE_MIN_G * IMU_ACCEL_LSB_PER_G * FUSION_GATE_MIN_G * IMU_ACCEL_LSB_PER_G))
+#define FUSION_GATE_MAX_SQ ((uint32_t)(FUSION_GATE_MAX_G * IMU_ACCEL_LSB_PER_G * FUSION_GATE_MAX_G * IMU_ACCEL_LSB_PER_G))
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static bool prvNormalise(int32_t *plVector, uint8_t ucLength);
+static uint32_t prvRsqrt(uint32_t ulMantissa);
+static uint8_t prvBits(uint32_t ulValue);
+static bool prvAlign(Fusion_t *pxFusion, const int32_t *plAccel);
+static void prvFusionStage(const ImuBlock_t *pxFrame);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+/**
+ * 1 / sqrt(m) / 2 in q15 for the mantissa m in [0.25, 1), at the middle of
+ * each 1/128 step: entry i is for m = (i + 32.5) / 128.
+ */
+static const uint16_t usRsqrtTable[96] = {
+	32515, 32026, 31558, 31111, 30682, 30270, 29874, 29494, 29127, 28774, 28434, 28105, 27787, 27480, 27183, 26895,
+	26617, 26346, 26084, 25830, 25583, 25342, 25109, 24882, 24660, 24445, 24235, 24031, 23831, 23637, 23447, 23262,
+	23080, 22904, 22731, 22562, 22396, 22235, 22077, 21922, 21770, 21621, 21476, 21333, 21193, 21056, 20921, 20789,
+	20660, 20533, 20408, 20285, 20165, 20047, 19930, 19816, 19704, 19594, 19485, 19378, 19273, 19170, 19068, 18968,
+	18870, 18773, 18677, 18583, 18490, 18399, 18309, 18220, 18133, 18047, 17962, 17878, 17795, 17714, 17634, 17554,
+	17476, 17399, 17323, 17248, 17174, 17100, 17028, 16957, 16886, 16817, 16748, 16680, 16613, 16546, 16481, 16416};
+
+static Fusion_t xFusion;		  ///< The pipeline filter, only touched by the pipeline task
+static Fusion_t xShown;			  ///< Copy of it after each frame, for FusionGet()
+static volatile bool bRestart;	  ///< Set by FusionRestart(), handled on the next frame
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Resets the pipeline filter and adds its stage.
+ */
+void FusionInit(void)
+{
+	FusionReset(&xFusion);
+	xShown = xFusion;
+	PipelineRegisterStage(prvFusionStage);
+}
+
+/**
+ * @brief Identity quaternion, not aligned, counters cleared.
+ */
+void FusionReset(Fusion_t *pxFusion)
+{
+	memset(pxFusion, 0, sizeof(*pxFusion));
+	pxFusion->lQ[0] = FUSION_ONE;
+}
+
+/**
+ * @brief Gyro integration plus one gradient step, both from the quaternion before the update.
+ */
+void FusionUpdate(Fusion_t *pxFusion, const ImuSample_t *pxSample)
+{
+	int32_t *plQ = pxFusion->lQ;
+	int32_t lW[3];
+	int32_t lDelta[4];
+	int32_t lAccel[3];
+	uint32_t ulSquares = 0;
+	bool bUseAccel;
+	int8_t cShift = pxFusion->cRateShift;
+	int32_t lGyroScale = FUSION_GYRO_Q30_X2 << ((cShift < 0) ? -cShift : 0);
+	uint8_t ucGyroShift = 1 + ((cShift > 0) ? cShift : 0);
+
+	pxFusion->ulUpdates++;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		lAccel[i] = pxSample->sAccel[i];
+		ulSquares += (uint32_t)(lAccel[i] * lAccel[i]);
+		lW[i] = (pxSample->sGyro[i] * lGyroScale) >> ucGyroShift;
+	}
+	bUseAccel = ulSquares >= FUSION_GATE_MIN_SQ && ulSquares <= FUSION_GATE_MAX_SQ && prvNormalise(lAccel, 3);
+	if (!bUseAccel)
+	{
+		pxFusion->ulGated++;
+	}
+
+	if (!pxFusion->bAligned)
+	{
+		// Until gravity has been seen once, there is nothing to integrate from
+		if (bUseAccel)
+		{
+			pxFusion->bAligned = prvAlign(pxFusion, lAccel);
+		}
+		return;
+	}
+
+	// q * (0, w): the change over one period, w being the half angle
+	lDelta[0] = (int32_t)((-(int64_t)plQ[1] * lW[0] - (int64_t)plQ[2] * lW[1] - (int64_t)plQ[3] * lW[2]) >> 30);
+	lDelta[1] = (int32_t)(((int64_t)plQ[0] * lW[0] + (int64_t)plQ[2] * lW[2] - (int64_t)plQ[3] * lW[1]) >> 30);
+	lDelta[2] = (int32_t)(((int64_t)plQ[0] * lW[1] - (int64_t)plQ[1] * lW[2] + (int64_t)plQ[3] * lW[0]) >> 30);
+	lDelta[3] = (int32_t)(((int64_t)plQ[0] * lW[2] + (int64_t)plQ[1] * lW[1] - (int64_t)plQ[2] * lW[0]) >> 30);
+
+	if (bUseAccel)
+	{
+		int32_t lF[3];
+		int32_t lS[4];
+		int32_t lQ15[4];
+		uint32_t ulLargest = 0;
+		uint8_t ucShift;
+
+		// Predicted minus measured gravity, in q29 as the difference of two unit vectors reaches 2
+		lF[0] = (int32_t)((((int64_t)plQ[1] * plQ[3] - (int64_t)plQ[0] * plQ[2]) >> 30) - (lAccel[0] >> 1));
+		lF[1] = (int32_t)((((int64_t)plQ[0] * plQ[1] + (int64_t)plQ[2] * plQ[3]) >> 30) - (lAccel[1] >> 1));
+		lF[2] = (int32_t)(FUSION_HALF - (((int64_t)plQ[1] * plQ[1] + (int64_t)plQ[2] * plQ[2]) >> 30) - (lAccel[2] >> 1));
+
+		// Only the direction of the gradient is used, so the error terms are scaled to a common
+		// width that keeps their precision when small
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			ulLargest |= (uint32_t)((lF[i] < 0) ? -lF[i] : lF[i]);
+		}
+		ucShift = prvBits(ulLargest);
+		ucShift = (ucShift > FUSION_GRADIENT_BITS) ? ucShift - FUSION_GRADIENT_BITS : 0;
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			lF[i] >>= ucShift;
+		}
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			lQ15[i] = plQ[i] >> 15;
+		}
+
+		// J^T f, without the common factor 2
+		lS[0] = -lQ15[2] * lF[0] + lQ15[1] * lF[1];
+		lS[1] = lQ15[3] * lF[0] + lQ15[0] * lF[1] - 2 * lQ15[1] * lF[2];
+		lS[2] = -lQ15[0] * lF[0] + lQ15[3] * lF[1] - 2 * lQ15[2] * lF[2];
+		lS[3] = lQ15[1] * lF[0] + lQ15[2] * lF[1];
+
+		if (prvNormalise(lS, 4))
+		{
+			for (uint8_t i = 0; i < 4; i++)
+			{
+				lDelta[i] -= lS[i] >> (FUSION_BETA_SHIFT + cShift);
+			}
+		}
+	}
+
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		plQ[i] += lDelta[i];
+	}
+	prvNormalise(plQ, 4);
+}
+
+/**
+ * @brief The third column of the rotation matrix: the earth Z axis seen from the sensor.
+ */
+void FusionGravity(const Fusion_t *pxFusion, int32_t *plGravity)
+{
+	const int32_t *plQ = pxFusion->lQ;
+
+	plGravity[0] = (int32_t)(((int64_t)plQ[1] * plQ[3] - (int64_t)plQ[0] * plQ[2]) >> 29);
+	plGravity[1] = (int32_t)(((int64_t)plQ[0] * plQ[1] + (int64_t)plQ[2] * plQ[3]) >> 29);
+	plGravity[2] = (int32_t)(((int64_t)plQ[0] * plQ[0] - (int64_t)plQ[1] * plQ[1] - (int64_t)plQ[2] * plQ[2] +
+							  (int64_t)plQ[3] * plQ[3]) >> 30);
+}
+
+/**
+ * @brief Copies the state published after the last frame.
+ */
+void FusionGet(Fusion_t *pxFusion)
+{
+	taskENTER_CRITICAL();
+	*pxFusion = xShown;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Flags the reset, done by the pipeline task before its next frame.
+ */
+void FusionRestart(void)
+{
+	bRestart = true;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static bool prvNormalise(int32_t *plVector, uint8_t ucLength)
+ * @brief		Scales a vector of up to 4 components to unit length in q30
+ * @details		The 64-bit sum of squares is shifted by an even count to a
+ *				mantissa in [0.25, 1), so its square root is that of the
+ *				mantissa times a power of two.
+ * @return		false, leaving the vector as it was, if it is zero
+ *****************************************************************************/
+static bool prvNormalise(int32_t *plVector, uint8_t ucLength)
+{
+	uint64_t ullSquares = 0;
+	uint32_t ulRoot;
+	uint8_t ucExponent;
+
+	for (uint8_t i = 0; i < ucLength; i++)
+	{
+		ullSquares += (uint64_t)((int64_t)plVector[i] * plVector[i]);
+	}
+	if (ullSquares == 0)
+	{
+		return false;
+	}
+
+	ucExponent = (uint8_t)((64 - (((ullSquares >> 32) != 0) ? 32 + prvBits((uint32_t)(ullSquares >> 32)) : prvBits((uint32_t)ullSquares))) & ~1u);
+	ulRoot = prvRsqrt((uint32_t)((ullSquares << ucExponent) >> 32));
+
+	// ulRoot / 2^30 is 2^(32 - ucExponent / 2) / sqrt(ullSquares)
+	for (uint8_t i = 0; i < ucLength; i++)
+	{
+		plVector[i] = (int32_t)(((int64_t)plVector[i] * ulRoot) >> (32 - ucExponent / 2));
+	}
+	return true;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvRsqrt(uint32_t ulMantissa)
+ * @brief		1 / sqrt(m) in q30, for m = ulMantissa / 2^32 in [0.25, 1)
+ * @details		The table is within 0.8%. Each Newton step,
+ *				y = y * (3 - m * y^2) / 2, squares the error: 1e-4, then
+ *				below the q30 resolution.
+ *****************************************************************************/
+static uint32_t prvRsqrt(uint32_t ulMantissa)
+{
+	uint64_t ullRoot = (uint64_t)usRsqrtTable[(ulMantissa >> 25) - FUSION_RSQRT_FIRST] << 16;
+
+	for (uint8_t i = 0; i < FUSION_RSQRT_STEPS; i++)
+	{
+		uint64_t ullProduct = (ulMantissa * ((ullRoot * ullRoot) >> 30)) >> 32;
+
+		ullRoot = (ullRoot * ((3ULL << 30) - ullProduct)) >> 31;
+	}
+	return (uint32_t)ullRoot;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t prvBits(uint32_t ulValue)
+ * @brief		Position of the highest set bit plus one, 0 for 0
+ * @details		A binary search, as the M0+ has no count leading zeros instruction.
+ *****************************************************************************/
+static uint8_t prvBits(uint32_t ulValue)
+{
+	uint8_t ucBits = 0;
+
+	if (ulValue >= (1UL << 16))
+	{
+		ulValue >>= 16;
+		ucBits += 16;
+	}
+	if (ulValue >= (1UL << 8))
+	{
+		ulValue >>= 8;
+		ucBits += 8;
+	}
+	if (ulValue >= (1UL << 4))
+	{
+		ulValue >>= 4;
+		ucBits += 4;
+	}
+	if (ulValue >= (1UL << 2))
+	{
+		ulValue >>= 2;
+		ucBits += 2;
+	}
+	if (ulValue >= (1UL << 1))
+	{
+		ulValue >>= 1;
+		ucBits += 1;
+	}
+	return (uint8_t)(ucBits + ulValue);
+}
+
+/**************************************************************************/ /**
+ * @fn			static bool prvAlign(Fusion_t *pxFusion, const int32_t *plAccel)
+ * @brief		Sets the quaternion that takes the earth Z axis to the measured
+ *				gravity, with no yaw: (1 + a_z, a_y, -a_x, 0), normalised
+ * @param[in]	plAccel Unit gravity vector in q30
+ * @return		true once set
+ *****************************************************************************/
+static bool prvAlign(Fusion_t *pxFusion, const int32_t *plAccel)
+{
+	int32_t *plQ = pxFusion->lQ;
+
+	// In q29, as 1 + a_z reaches 2
+	plQ[0] = FUSION_HALF + (plAccel[2] >> 1);
+	plQ[1] = plAccel[1] >> 1;
+	plQ[2] = -(plAccel[0] >> 1);
+	plQ[3] = 0;
+
+	// Upside down the formula loses its precision; any rotation by half a turn about a level axis does
+	if (plQ[0] < (FUSION_HALF >> 10))
+	{
+		plQ[0] = 0;
+		plQ[1] = FUSION_ONE;
+		plQ[2] = 0;
+		return true;
+	}
+	return prvNormalise(plQ, 4);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvFusionStage(const ImuBlock_t *pxFrame)
+ * @brief		Pipeline stage: runs the pipeline filter over the frame and
+ *				publishes the result
+ *****************************************************************************/
+static void prvFusionStage(const ImuBlock_t *pxFrame)
+{
+	if (bRestart)
+	{
+		bRestart = false;
+		FusionReset(&xFusion);
+	}
+
+	xFusion.cRateShift = pxFrame->cRateShift;
+	for (uint16_t i = 0; i < pxFrame->usCount; i++)
+	{
+		FusionUpdate(&xFusion, &pxFrame->xSamples[i]);
+	}
+
+	taskENTER_CRITICAL();
+	xShown = xFusion;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,128 @@
+/**************************************************************************/ /**
+ * @file      Fusion.h
+ * @brief     Fixed-point Madgwick orientation filter on the MPU6000 gyroscope
+ *            and accelerometer, one sample per update.
+ * @details   The orientation is a unit quaternion (w, x, y, z) in q30, the
+ *            rotation from the earth frame to the sensor frame, as in
+ *            Madgwick's IMU filter. Every update:
+ *            --integrates the gyroscope: q += q * (0, w) with w the half angle
+ *              turned in one sample period, from the raw value by one
+ *              multiply (FUSION_GYRO_Q30_X2)
+ *            --corrects towards the accelerometer: one gradient descent step
+ *              of 2^-FUSION_BETA_SHIFT on the error between the measured and
+ *              the predicted gravity direction (beta of about 0.1 rad/s at
+ *              100 Hz). The step is skipped while the measured magnitude is
+ *              outside FUSION_GATE_MIN_G to FUSION_GATE_MAX_G, during hits and
+ *              swings, when the accelerometer is not measuring gravity
+ *            --renormalises the quaternion
+ *
+ *            The three normalisations share one reciprocal square root of
+ *            the 64-bit sum of squares: a 96-entry table on its mantissa and
+ *            two Newton steps, exact to the q30 resolution. Products of q30
+ *            values are 64-bit. The gradient is 32-bit, from q15 copies of
+ *            the quaternion and the error terms cut to 13 bits, as only its
+ *            direction is kept.
+ *
+ *            At the other rates of the IMU task, IMU_SAMPLE_HZ * 2^cRateShift,
+ *            the gyroscope step and the correction step are shifted by the
+ *            rate shift, so the filter keeps its beta in rad/s. The pipeline
+ *            stage takes the shift from each block.
+ *
+ *            The first update with a usable accelerometer reading sets the
+ *            quaternion straight from gravity instead of waiting for the slow
+ *            correction. Yaw has no reference, so it drifts with the gyro.
+ *
+ *            A Fusion_t holds all the state. FusionInit() hooks one into the
+ *            frame pipeline; the "orient" command shows it. tools/replay
+ *            checks the filter against a double-precision reference.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef FUSION_H
+#define FUSION_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "Imu/Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define FUSION_ONE (1L << 30)		///< 1.0 in q30
+#define FUSION_BETA_SHIFT 10		///< Correction step per sample, 2^-10: beta = 2^-10 * IMU_SAMPLE_HZ rad/s
+#define FUSION_GATE_MIN_G 0.5		///< Accelerometer magnitudes trusted as gravity. Compared squared, in raw LSB
+#define FUSION_GATE_MAX_G 1.5
+
+/**
+ * Twice the half angle, in q30, turned in one sample period per raw gyro LSB:
+ * pi / 180 / 16.4 / IMU_SAMPLE_HZ * 2^30 = 11427.03. Doubled so it stays an
+ * integer to 3e-6.
+ */
+#define FUSION_GYRO_Q30_X2 11427L
+
+#if IMU_SAMPLE_HZ != 100 || IMU_GYRO_LSB_PER_10_DPS != 164
+#error "FUSION_GYRO_Q30_X2 is for 100 Hz and 16.4 LSB per dps"
+#endif
+#if IMU_RATE_SHIFT_MIN < -2
+#error "The gyroscope step overflows 32 bits below 25 Hz"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief State of one filter. Set up with FusionReset().
+ */
+typedef struct
+{
+	int32_t lQ[4];		   ///< w, x, y, z in q30
+	bool bAligned;		   ///< Set from gravity yet
+	uint32_t ulUpdates;
+	uint32_t ulGated;	   ///< Updates without the accelerometer step
+	int8_t cRateShift;	   ///< Sample rate, as in ImuBlock_t. 0 after FusionReset()
+} Fusion_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void FusionInit(void)
+ * @brief		Resets the pipeline filter and registers it as a pipeline stage
+ * @note		Call once from the daemon task startup hook, after PipelineInit()
+ *****************************************************************************/
+void FusionInit(void);
+
+/**
+ * @fn			void FusionReset(Fusion_t *pxFusion)
+ * @brief		Identity orientation, to be aligned by the next usable accelerometer reading
+ *****************************************************************************/
+void FusionReset(Fusion_t *pxFusion);
+
+/**
+ * @fn			void FusionUpdate(Fusion_t *pxFusion, const ImuSample_t *pxSample)
+ * @brief		Advances the filter by one sample period at cRateShift
+ *****************************************************************************/
+void FusionUpdate(Fusion_t *pxFusion, const ImuSample_t *pxSample);
+
+/**
+ * @fn			void FusionGravity(const Fusion_t *pxFusion, int32_t *plGravity)
+ * @brief		Direction of gravity in the sensor frame, as the filter sees it
+ * @param[out]	plGravity X, Y, Z of a unit vector in q30
+ *****************************************************************************/
+void FusionGravity(const Fusion_t *pxFusion, int32_t *plGravity);
+
+/**
+ * @fn			void FusionGet(Fusion_t *pxFusion)
+ * @brief		Copies the state of the pipeline filter
+ *****************************************************************************/
+void FusionGet(Fusion_t *pxFusion);
+
+/**
+ * @fn			void FusionRestart(void)
+ * @brief		Resets the pipeline filter, which then re-aligns to gravity
+ *****************************************************************************/
+void FusionRestart(void);
+
+#endif /* FUSION_H */
@@ -0,0 +1,255 @@
+/**************************************************************************/ /**
+ * @file      HitDetect.c
+ * @brief     Fixed-point hit detection on the acceleration magnitude. See HitDetect.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "HitDetect.h"
+#include "Pipeline/Pipeline.h"
+#include "Benchmark/Benchmark.h"
+#include "SessionStats/SessionStats.h"
+#include "Stroke/Stroke.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define HIT_POST_SHIFT 1 ///< The feedback coefficients are above 1, so all are stored halved
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvHitStage(const ImuBlock_t *pxFrame);
+static void prvSetRate(HitDetector_t *pxDetector, int8_t cShift);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+/**
+ * Butterworth high-pass, 5 Hz, by the bilinear transform with prewarping, at
+ * each rate from HIT_RATE_SHIFT_MIN. At 100 Hz b = 0.80059, -1.60118, 0.80059
+ * and a = 1, -1.56102, 0.64135. In the CMSIS order {b0, 0, b1, b2, -a1, -a2},
+ * in q15 divided by 2^HIT_POST_SHIFT, b1 = -2 b0 exactly so DC is removed.
+ */
+static const q15_t sHighPass[HIT_RATE_SHIFT_MAX - HIT_RATE_SHIFT_MIN + 1][6 * HIT_BIQUAD_STAGES] = {
+	{6412, 0, -12824, 6412, 6054, -3208},		// 25 Hz
+	{10468, 0, -20936, 10468, 18727, -6763},	// 50 Hz
+	{13117, 0, -26234, 13117, 25576, -10508},	// 100 Hz
+	{14661, 0, -29322, 14661, 29141, -13120}};	// 200 Hz
+
+static HitDetector_t xDetector; ///< The pipeline detector
+static HitStats_t xStats;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Resets the pipeline detector and adds its stage.
+ */
+void HitDetectInit(void)
+{
+	HitDetectReset(&xDetector);
+	PipelineRegisterStage(prvHitStage);
+}
+
+/**
+ * @brief Sets up the filter. Its input history is 1 g, so a sensor at rest gives no step.
+ */
+void HitDetectReset(HitDetector_t *pxDetector)
+{
+	memset(pxDetector, 0, sizeof(*pxDetector));
+	arm_biquad_cascade_df1_init_q15(&pxDetector->xFilter, HIT_BIQUAD_STAGES, (q15_t *)sHighPass[-HIT_RATE_SHIFT_MIN],
+									pxDetector->sFilterState, HIT_POST_SHIFT);
+
+	// State order is x[n-1], x[n-2], y[n-1], y[n-2]
+	pxDetector->sFilterState[0] = HIT_LSB_PER_G;
+	pxDetector->sFilterState[1] = HIT_LSB_PER_G;
+	pxDetector->sThreshold = HIT_MIN_THRESHOLD;
+	pxDetector->usSinceStart = HIT_REFRACTORY_SAMPLES;
+	pxDetector->usRefractory = HIT_REFRACTORY_SAMPLES;
+}
+
+/**
+ * @brief Magnitude, filter and rectify the whole block, then walk the envelope sample by sample.
+ */
+uint16_t HitDetectProcess(HitDetector_t *pxDetector, const ImuBlock_t *pxBlock, Hit_t *pxHits)
+{
+	q15_t sMagnitude[IMU_BLOCK_SAMPLES];
+	q15_t sRectified[IMU_BLOCK_SAMPLES];
+	uint16_t usHits = 0;
+	uint8_t ucDecayShift, ucFloorShift;
+
+	if (pxBlock->usCount == 0 || pxBlock->usCount > IMU_BLOCK_SAMPLES || pxBlock->cRateShift < HIT_RATE_SHIFT_MIN ||
+		pxBlock->cRateShift > HIT_RATE_SHIFT_MAX)
+	{
+		return 0;
+	}
+	if (pxBlock->cRateShift != pxDetector->cRateShift)
+	{
+		prvSetRate(pxDetector, pxBlock->cRateShift);
+	}
+	ucDecayShift = (uint8_t)(HIT_DECAY_SHIFT + pxDetector->cRateShift);
+	ucFloorShift = (uint8_t)(HIT_FLOOR_SHIFT + pxDetector->cRateShift);
+
+	for (uint16_t i = 0; i < pxBlock->usCount; i++)
+	{
+		const int16_t *psAccel = pxBlock->xSamples[i].sAccel;
+		uint32_t ulSquares = 0;
+		q31_t lRoot;
+
+		for (uint8_t ucAxis = 0; ucAxis < 3; ucAxis++)
+		{
+			ulSquares += (uint32_t)((int32_t)psAccel[ucAxis] * psAccel[ucAxis]);
+		}
+
+		// At most 3 * 2^29 after the shift. As q31 that is |a|^2 / 2^32, so the root is |a| / 2^16 and,
+		// back in q15, half the raw magnitude: 1024 LSB per g
+		arm_sqrt_q31((q31_t)(ulSquares >> 1), &lRoot);
+		sMagnitude[i] = (q15_t)(lRoot >> 16);
+	}
+
+	arm_biquad_cascade_df1_q15(&pxDetector->xFilter, sMagnitude, sRectified, pxBlock->usCount);
+	arm_abs_q15(sRectified, sRectified, pxBlock->usCount);
+
+	for (uint16_t i = 0; i < pxBlock->usCount; i++)
+	{
+		q15_t sLevel = sRectified[i];
+		q15_t sDecayed = pxDetector->sEnvelope - (pxDetector->sEnvelope >> ucDecayShift);
+		int32_t lThreshold;
+
+		pxDetector->sEnvelope = (sLevel > sDecayed) ? sLevel : sDecayed;
+
+		// Running sum of 2^ucFloorShift samples, so small levels are not lost to the shift
+		pxDetector->lFloorSum += ((sLevel < pxDetector->sThreshold) ? sLevel : pxDetector->sThreshold) -
+								 (pxDetector->lFloorSum >> ucFloorShift);
+		lThreshold = (pxDetector->lFloorSum >> ucFloorShift) * HIT_THRESHOLD_FACTOR;
+		pxDetector->sThreshold = (q15_t)((lThreshold < HIT_MIN_THRESHOLD) ? HIT_MIN_THRESHOLD : (lThreshold > INT16_MAX) ? INT16_MAX : lThreshold);
+
+		if (pxDetector->usSinceStart < pxDetector->usRefractory)
+		{
+			pxDetector->usSinceStart++;
+		}
+
+		if (!pxDetector->bInHit)
+		{
+			if (pxDetector->sEnvelope > pxDetector->sThreshold && pxDetector->usSinceStart >= pxDetector->usRefractory)
+			{
+				pxDetector->bInHit = true;
+				pxDetector->usSinceStart = 0;
+				pxDetector->xCurrent.xTick =
+					pxBlock->xTimestamp - pdMS_TO_TICKS((pxBlock->usCount - 1 - i) * 1000 / IMU_RATE_HZ(pxBlock->cRateShift));
+				pxDetector->xCurrent.sPeak = pxDetector->sEnvelope;
+			}
+		}
+		else if (pxDetector->sEnvelope < pxDetector->sThreshold / 2)
+		{
+			pxDetector->bInHit = false;
+			pxDetector->xCurrent.ulSequence = pxBlock->ulSequence;
+			if (usHits < HIT_MAX_PER_BLOCK)
+			{
+				pxHits[usHits++] = pxDetector->xCurrent;
+			}
+		}
+		else if (pxDetector->sEnvelope > pxDetector->xCurrent.sPeak)
+		{
+			pxDetector->xCurrent.sPeak = pxDetector->sEnvelope;
+		}
+	}
+
+	return usHits;
+}
+
+/**
+ * @brief Copies the counters and the live floor and threshold.
+ */
+void HitDetectGetStats(HitStats_t *pxStats)
+{
+	taskENTER_CRITICAL();
+	*pxStats = xStats;
+	pxStats->sFloor = (q15_t)(xDetector.lFloorSum >> (HIT_FLOOR_SHIFT + xDetector.cRateShift));
+	pxStats->sThreshold = xDetector.sThreshold;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Clears the counters.
+ */
+void HitDetectResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&xStats, 0, sizeof(xStats));
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvHitStage(const ImuBlock_t *pxFrame)
+ * @brief		Pipeline stage: runs the pipeline detector, checks the block
+ *				against HIT_BLOCK_BUDGET_CYCLES and adds its hits to the
+ *				session statistics and the stroke classifier
+ *****************************************************************************/
+static void prvHitStage(const ImuBlock_t *pxFrame)
+{
+	Hit_t xHits[HIT_MAX_PER_BLOCK];
+	uint32_t ulStart = BenchmarkGetCycles();
+	uint16_t usHits = HitDetectProcess(&xDetector, pxFrame, xHits);
+	uint32_t ulCycles = BenchmarkGetCycles() - ulStart;
+
+	for (uint16_t i = 0; i < usHits; i++)
+	{
+		SessionStatsAddHit(&xHits[i]);
+		StrokeQueueHit(&xHits[i]);
+	}
+
+	taskENTER_CRITICAL();
+	xStats.ulBlocks++;
+	xStats.ulHits += usHits;
+	if (ulCycles > xStats.ulCyclesMax)
+	{
+		xStats.ulCyclesMax = ulCycles;
+	}
+	if (ulCycles > HIT_BLOCK_BUDGET_CYCLES)
+	{
+		xStats.ulOverBudget++;
+	}
+	if (usHits > 0)
+	{
+		xStats.xLast = xHits[usHits - 1];
+		xStats.bHaveLast = true;
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSetRate(HitDetector_t *pxDetector, int8_t cShift)
+ * @brief		Switches the detector to another rate. The filter keeps its
+ *				history, which is in g, not in samples; the floor sum and the
+ *				samples since the last start are rescaled to the new rate
+ *****************************************************************************/
+static void prvSetRate(HitDetector_t *pxDetector, int8_t cShift)
+{
+	int8_t cStep = cShift - pxDetector->cRateShift;
+	uint32_t ulSince = pxDetector->usSinceStart;
+
+	pxDetector->xFilter.pCoeffs = (q15_t *)sHighPass[cShift - HIT_RATE_SHIFT_MIN];
+	if (cStep > 0)
+	{
+		pxDetector->lFloorSum <<= cStep;
+		ulSince <<= cStep;
+	}
+	else
+	{
+		pxDetector->lFloorSum >>= -cStep;
+		ulSince >>= -cStep;
+	}
+	pxDetector->cRateShift = cShift;
+	pxDetector->usRefractory = HIT_REFRACTORY_AT(cShift);
+	pxDetector->usSinceStart = (ulSince < pxDetector->usRefractory) ? (uint16_t)ulSince : pxDetector->usRefractory;
+}
@@ -0,0 +1,162 @@
+/**************************************************************************/ /**
+ * @file      HitDetect.h
+ * @brief     Fixed-point hit detection on the acceleration magnitude, a block
+ *            at a time, with the CMSIS-DSP q15/q31 functions.
+ * @details   Per sample, in q15 with 1024 LSB per g (full scale 32 g):
+ *            --the magnitude of the MPU6000 acceleration, arm_sqrt_q31()
+ *            --a 2nd order Butterworth high-pass at HIT_HIGHPASS_HZ, which
+ *              removes gravity and slow motion, arm_biquad_cascade_df1_q15()
+ *            --the rectified output, arm_abs_q15(), feeds a peak envelope
+ *              that follows rises at once and decays by 1/2^HIT_DECAY_SHIFT
+ *              per sample
+ *            --a noise floor, the rectified output averaged over about
+ *              2^HIT_FLOOR_SHIFT samples, clipped at the threshold so a hit
+ *              barely moves it
+ *
+ *            The threshold is HIT_THRESHOLD_FACTOR times the floor, and never
+ *            below HIT_MIN_THRESHOLD. A hit starts when the envelope rises
+ *            above the threshold, at least HIT_REFRACTORY_SAMPLES after the
+ *            previous start. It ends when the envelope falls below half the
+ *            threshold, and is reported then, with the time of its start and
+ *            the envelope peak.
+ *
+ *            The constants above are for IMU_SAMPLE_HZ. A block at another
+ *            rate of the IMU task switches the detector to it first: the
+ *            high-pass coefficients for the same cut-off, and the decay, floor
+ *            and refractory lengths scaled by the rate, so the detector keeps
+ *            its behaviour in time. The floor average and the refractory count
+ *            are carried over, so the switch needs no settling. Hit times are
+ *            counted back from the block timestamp at the block's rate.
+ *
+ *            A HitDetector_t holds all the state, so a detector can be run
+ *            on recorded data next to the live one. HitDetectInit() hooks a
+ *            detector into the frame pipeline and feeds its hits to the
+ *            session statistics (SessionStats.h) and the stroke classifier
+ *            (Stroke.h); the "hits" command shows it.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef HIT_DETECT_H
+#define HIT_DETECT_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <arm_math.h>
+#include "Imu/Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define HIT_LSB_PER_G 1024			 ///< Scale of the magnitude, the filter output and the thresholds
+#define HIT_HIGHPASS_HZ 5			 ///< Cut-off of the high-pass, at every rate
+#define HIT_BIQUAD_STAGES 1
+#define HIT_DECAY_SHIFT 2			 ///< Envelope decay, 1/4 per sample
+#define HIT_FLOOR_SHIFT 7			 ///< Noise floor average, about 1.3 s at 100 Hz
+#define HIT_THRESHOLD_FACTOR 4
+#define HIT_MIN_THRESHOLD (3 * HIT_LSB_PER_G / 2) ///< 1.5 g
+#define HIT_REFRACTORY_SAMPLES 15	 ///< Shortest time between two hit starts, 150 ms at 100 Hz
+#define HIT_MAX_PER_BLOCK 3			 ///< Hits one block can end, given the refractory period at the lowest rate
+#define HIT_RATE_SHIFT_MIN -2		 ///< Rates with high-pass coefficients, 25 to 200 Hz
+#define HIT_RATE_SHIFT_MAX 1
+
+/** Refractory period in samples at a rate shift, rounded up */
+#define HIT_REFRACTORY_AT(cShift) (((HIT_REFRACTORY_SAMPLES << ((cShift) + 2)) + 3) >> 2)
+#define HIT_BLOCK_BUDGET_CYCLES 20000 ///< Cycles one block may take, checked by the pipeline stage
+
+#if IMU_SAMPLE_HZ != 100
+#error "The high-pass coefficients in HitDetect.c are designed for 100 Hz"
+#endif
+#if IMU_RATE_SHIFT_MIN < HIT_RATE_SHIFT_MIN || IMU_RATE_SHIFT_MAX > HIT_RATE_SHIFT_MAX
+#error "HitDetect.c has no high-pass coefficients for some IMU rates"
+#endif
+#if HIT_RATE_SHIFT_MIN + HIT_DECAY_SHIFT < 0
+#error "The envelope decay shift goes negative at the lowest rate"
+#endif
+#if 2 * HIT_REFRACTORY_AT(HIT_RATE_SHIFT_MIN) + 3 <= IMU_BLOCK_SAMPLES
+#error "A block can end more than HIT_MAX_PER_BLOCK hits"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief One detected hit.
+ */
+typedef struct
+{
+	TickType_t xTick;	  ///< Tick of the sample where the hit started
+	uint32_t ulSequence;  ///< Sequence of the block where it ended
+	q15_t sPeak;		  ///< Highest envelope during the hit, HIT_LSB_PER_G
+} Hit_t;
+
+/**
+ * @brief State of one detector. Set up with HitDetectReset().
+ */
+typedef struct
+{
+	arm_biquad_casd_df1_inst_q15 xFilter;
+	q15_t sFilterState[4 * HIT_BIQUAD_STAGES];
+	q15_t sEnvelope;
+	int32_t lFloorSum;	   ///< Noise floor times 2^(HIT_FLOOR_SHIFT + cRateShift)
+	q15_t sThreshold;
+	bool bInHit;
+	uint16_t usSinceStart; ///< Samples since the last hit started, saturates at usRefractory
+	Hit_t xCurrent;		   ///< Hit in progress while bInHit
+	int8_t cRateShift;	   ///< Rate the detector is set up for, as in ImuBlock_t
+	uint16_t usRefractory; ///< HIT_REFRACTORY_AT(cRateShift)
+} HitDetector_t;
+
+/**
+ * @brief Counters of the pipeline detector.
+ */
+typedef struct
+{
+	uint32_t ulHits;
+	uint32_t ulBlocks;
+	uint32_t ulCyclesMax;	///< Longest block
+	uint32_t ulOverBudget;	///< Blocks over HIT_BLOCK_BUDGET_CYCLES
+	q15_t sFloor;			///< Current noise floor
+	q15_t sThreshold;		///< Current threshold
+	bool bHaveLast;
+	Hit_t xLast;			///< Valid if bHaveLast
+} HitStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void HitDetectInit(void)
+ * @brief		Resets the pipeline detector and registers it as a pipeline stage
+ * @note		Call once from the daemon task startup hook, after PipelineInit()
+ *****************************************************************************/
+void HitDetectInit(void);
+
+/**
+ * @fn			void HitDetectReset(HitDetector_t *pxDetector)
+ * @brief		Sets up the filter for IMU_SAMPLE_HZ and clears the state, as if the sensor had been at rest
+ *****************************************************************************/
+void HitDetectReset(HitDetector_t *pxDetector);
+
+/**
+ * @fn			uint16_t HitDetectProcess(HitDetector_t *pxDetector, const ImuBlock_t *pxBlock, Hit_t *pxHits)
+ * @brief		Runs a block through the detector
+ * @param[out]	pxHits Room for HIT_MAX_PER_BLOCK hits that ended in the block
+ * @return		Number of hits written to pxHits
+ *****************************************************************************/
+uint16_t HitDetectProcess(HitDetector_t *pxDetector, const ImuBlock_t *pxBlock, Hit_t *pxHits);
+
+/**
+ * @fn			void HitDetectGetStats(HitStats_t *pxStats)
+ * @brief		Copies the counters of the pipeline detector
+ *****************************************************************************/
+void HitDetectGetStats(HitStats_t *pxStats);
+
+/**
+ * @fn			void HitDetectResetStats(void)
+ * @brief		Clears the counters. The detector keeps its state
+ *****************************************************************************/
+void HitDetectResetStats(void);
+
+#endif /* HIT_DETECT_H */
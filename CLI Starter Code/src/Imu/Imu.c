@@ -0,0 +1,672 @@
+/**************************************************************************/ /**
+ * @file      Imu.c
+ * @brief     IMU task: block reads of the MPU6000 and LIS2DS12 FIFOs. See Imu.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Imu.h"
+#include "ImuBus.h"
+#include "Lis2ds12.h"
+#include "Mpu6000.h"
+#include "ExtInt/ExtInt.h"
+#include "Benchmark/Benchmark.h"
+#include "ClockProfile/ClockProfile.h"
+#include "Pipeline/Pipeline.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IMU_DPS_TO_LSB(ulDps) ((ulDps) * IMU_GYRO_LSB_PER_10_DPS / 10)
+
+#if IMU_RATE_SHIFT_MIN < MPU6000_RATE_SHIFT_MIN || IMU_RATE_SHIFT_MAX > MPU6000_RATE_SHIFT_MAX || \
+	IMU_RATE_SHIFT_MIN < LIS2DS12_RATE_SHIFT_MIN || IMU_RATE_SHIFT_MAX > LIS2DS12_RATE_SHIFT_MAX
+#error "A rate shift is outside what both sensors support"
+#endif
+#if (IMU_SAMPLE_HZ >> -IMU_RATE_SHIFT_MIN << -IMU_RATE_SHIFT_MIN) != IMU_SAMPLE_HZ
+#error "IMU_RATE_HZ() needs a whole number of Hz at IMU_RATE_SHIFT_MIN"
+#endif
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static BaseType_t prvStartSensors(void);
+static BaseType_t prvReadBlock(uint16_t *pusActivity);
+static BaseType_t prvDropLead(BaseType_t (*pxRead)(ImuSample_t *, uint16_t), uint16_t usLead, ImuSample_t *pxScratch);
+static void prvRestartFifos(void);
+static uint16_t prvActivity(const ImuSample_t *pxSamples, uint16_t usCount);
+static void prvStopStream(void);
+static void prvWaitForMotion(void);
+static void prvSetAcqState(enum eImuAcqStates eNew);
+static int8_t prvTargetRate(uint16_t usActivity, TickType_t xNow);
+static void prvSetRate(int8_t cNew);
+static void prvCloseRate(TickType_t xNow);
+static uint16_t prvWatermarkAt(int8_t cShift);
+static uint32_t prvBlockPeriodMs(int8_t cShift);
+static void prvWatermark(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static TaskHandle_t xImuTask = NULL;
+static volatile enum eImuStates eState = IMU_STATE_STARTING;
+static uint32_t ulSequence = 0;	 ///< Number of the next block
+static ImuSample_t xLatest;		 ///< Last sample of the last block
+static bool bHaveLatest = false; ///< xLatest has been written
+static ImuStats_t xStats = {.ulWakeLatencyMin = UINT32_MAX};
+static volatile enum eImuAcqStates eAcqState = IMU_ACQ_STREAMING;
+static TickType_t xAcqSince;					 ///< Tick the current acquisition state started, or the counters were reset
+static TickType_t xLastMotion;					 ///< Timestamp of the last block with motion
+static TickType_t xLastPlay;					 ///< Last block above IMU_RATE_DOWN_DPS
+static TickType_t xLastBurst;					 ///< Last block above IMU_RATE_BURST_DOWN_DPS
+static int8_t cRateShift = 0;					 ///< Rate of the sensors
+static TickType_t xRateSince;					 ///< Tick streaming at cRateShift started, or the counters were reset
+static volatile int8_t cRateRequest = IMU_RATE_AUTO; ///< ImuSetRate()
+static volatile TickType_t xWakeTick;			 ///< Tick of the wake-up interrupt
+static volatile uint32_t ulQuietMs = IMU_QUIET_MS; ///< 0 to stream all the time
+
+static const char *const pcAcqStateNames[N_IMU_ACQ_STATES] = {
+	[IMU_ACQ_STREAMING] = "streaming",
+	[IMU_ACQ_WAITING] = "waiting",
+	[IMU_ACQ_WAKING] = "waking",
+};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief IMU task. Finds the sensors, then reads a block on every watermark.
+ */
+void vImuTask(void *pvParameters)
+{
+	uint16_t usActivity;
+	int8_t cTarget;
+	TickType_t xNow;
+
+	xImuTask = xTaskGetCurrentTaskHandle();
+	ImuBusInit();
+
+	// Level sense: a watermark that is still pending when the line is re-enabled fires again.
+	// The wake-up interrupt on the same line has to bring the device out of STANDBY
+	ExtIntConfigure(IMU_WATERMARK_EXTINT, EXTINT_SENSE_HIGH, true, prvWatermark, NULL);
+
+	while (prvStartSensors() != pdPASS)
+	{
+		eState = IMU_STATE_NOT_FOUND;
+		vTaskDelay(pdMS_TO_TICKS(IMU_RETRY_MS));
+	}
+	xLastMotion = xLastPlay = xLastBurst = xTaskGetTickCount();
+	prvSetAcqState(IMU_ACQ_STREAMING);
+	eState = IMU_STATE_RUNNING;
+
+	for (;;)
+	{
+		if (eAcqState == IMU_ACQ_WAITING)
+		{
+			prvWaitForMotion();
+			continue;
+		}
+
+		ExtIntEnable(IMU_WATERMARK_EXTINT);
+		if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_WATERMARK_TIMEOUT_BLOCKS * prvBlockPeriodMs(cRateShift))) != 0)
+		{
+			xStats.ulWakes++;
+		}
+		else
+		{
+			ExtIntDisable(IMU_WATERMARK_EXTINT);
+			xStats.ulTimeouts++;
+		}
+		xStats.ulRateWakes[cRateShift - IMU_RATE_SHIFT_MIN]++;
+
+		xNow = xTaskGetTickCount();
+		if (prvReadBlock(&usActivity) == pdPASS)
+		{
+			if (usActivity > IMU_QUIET_GYRO_LSB)
+			{
+				xLastMotion = xNow;
+			}
+			cTarget = prvTargetRate(usActivity, xNow);
+		}
+		else
+		{
+			// Requests still apply while no block comes through
+			cTarget = (cRateRequest == IMU_RATE_AUTO) ? cRateShift : cRateRequest;
+		}
+
+		if (ulQuietMs != 0 && xNow - xLastMotion >= pdMS_TO_TICKS(ulQuietMs))
+		{
+			prvStopStream();
+		}
+		else if (cTarget != cRateShift)
+		{
+			prvSetRate(cTarget);
+		}
+	}
+}
+
+/**
+ * @brief Returns the task state.
+ */
+enum eImuStates ImuGetState(void)
+{
+	return eState;
+}
+
+/**
+ * @brief Returns the acquisition state.
+ */
+enum eImuAcqStates ImuGetAcqState(void)
+{
+	return eAcqState;
+}
+
+/**
+ * @brief Returns the name of an acquisition state.
+ */
+const char *ImuGetAcqStateName(enum eImuAcqStates eAcq)
+{
+	return (eAcq < N_IMU_ACQ_STATES) ? pcAcqStateNames[eAcq] : NULL;
+}
+
+/**
+ * @brief Sets the quiet period. Turning acquisition stops off ends a wait for motion.
+ */
+void ImuSetQuietPeriod(uint32_t ulMs)
+{
+	ulQuietMs = ulMs;
+	if (ulMs == 0 && xImuTask != NULL)
+	{
+		// While streaming, this only brings the next read forward
+		xTaskNotifyGive(xImuTask);
+	}
+}
+
+/**
+ * @brief Returns the quiet period.
+ */
+uint32_t ImuGetQuietPeriod(void)
+{
+	return ulQuietMs;
+}
+
+/**
+ * @brief Records the request. The IMU task applies it after its next block.
+ */
+BaseType_t ImuSetRate(int8_t cShift)
+{
+	if (cShift != IMU_RATE_AUTO && (cShift < IMU_RATE_SHIFT_MIN || cShift > IMU_RATE_SHIFT_MAX))
+	{
+		return pdFAIL;
+	}
+	cRateRequest = cShift;
+	return pdPASS;
+}
+
+/**
+ * @brief Returns the rate shift of the sensors.
+ */
+int8_t ImuGetRate(bool *pbAuto)
+{
+	*pbAuto = (cRateRequest == IMU_RATE_AUTO);
+	return cRateShift;
+}
+
+/**
+ * @brief Copies the newest sample.
+ */
+BaseType_t ImuGetLatest(ImuSample_t *pxSample)
+{
+	BaseType_t xResult;
+
+	taskENTER_CRITICAL();
+	xResult = bHaveLatest ? pdPASS : pdFAIL;
+	*pxSample = xLatest;
+	taskEXIT_CRITICAL();
+
+	return xResult;
+}
+
+/**
+ * @brief Copies the counters.
+ */
+void ImuGetStats(ImuStats_t *pxStats)
+{
+	TickType_t xNow = xTaskGetTickCount();
+
+	taskENTER_CRITICAL();
+	*pxStats = xStats;
+	if (eState == IMU_STATE_RUNNING)
+	{
+		pxStats->ulStateTicks[eAcqState] += xNow - xAcqSince;
+		if (eAcqState == IMU_ACQ_STREAMING)
+		{
+			pxStats->ulRateTicks[cRateShift - IMU_RATE_SHIFT_MIN] += xNow - xRateSince;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Clears the counters. The latest sample stays valid.
+ */
+void ImuResetStats(void)
+{
+	TickType_t xNow = xTaskGetTickCount();
+
+	taskENTER_CRITICAL();
+	memset(&xStats, 0, sizeof(xStats));
+	xStats.ulWakeLatencyMin = UINT32_MAX;
+	xAcqSince = xNow;
+	xRateSince = xNow;
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvStartSensors(void)
+ * @brief		Sets up both sensors, then restarts their FIFOs together so
+ *				they start out paired
+ *****************************************************************************/
+static BaseType_t prvStartSensors(void)
+{
+	if (Mpu6000Init() != pdPASS || Lis2ds12Init() != pdPASS)
+	{
+		return pdFAIL;
+	}
+	prvRestartFifos();
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvReadBlock(uint16_t *pusActivity)
+ * @brief		Reads as many paired samples as both FIFOs hold, up to a block,
+ *				into a pipeline frame and submits it
+ * @param[out]	pusActivity Largest gyroscope axis of the block, raw
+ * @return		pdPASS if a block was submitted
+ *****************************************************************************/
+static BaseType_t prvReadBlock(uint16_t *pusActivity)
+{
+	uint16_t usMpu, usLis, usCount;
+	bool bMpuOverrun, bLisOverrun;
+	ImuBlock_t *pxFrame;
+
+	if (PipelineIsSynthetic())
+	{
+		// The synthetic source has the pipeline. Keep the FIFOs short and paired meanwhile
+		prvRestartFifos();
+		return pdFAIL;
+	}
+
+	if (Mpu6000GetFifoLevel(&usMpu, &bMpuOverrun) != pdPASS || Lis2ds12GetFifoLevel(&usLis, &bLisOverrun) != pdPASS)
+	{
+		xStats.ulBusErrors++;
+		return pdFAIL;
+	}
+	if (bMpuOverrun || bLisOverrun)
+	{
+		xStats.ulMpuOverruns += bMpuOverrun ? 1 : 0;
+		xStats.ulLisOverruns += bLisOverrun ? 1 : 0;
+		ulSequence++;
+		prvRestartFifos();
+		return pdFAIL;
+	}
+
+	// Wait for the pipeline task to free a frame. The FIFOs keep filling meanwhile
+	pxFrame = PipelineAcquire(pdMS_TO_TICKS(prvBlockPeriodMs(cRateShift)));
+	if (pxFrame == NULL)
+	{
+		return pdFAIL;
+	}
+
+	// Drop the oldest samples of a FIFO that has run ahead of the other
+	if (usMpu > usLis + IMU_MAX_SKEW)
+	{
+		if (prvDropLead(Mpu6000ReadFifo, usMpu - usLis, pxFrame->xSamples) != pdPASS)
+		{
+			PipelineCancel(pxFrame);
+			return pdFAIL;
+		}
+		usMpu = usLis;
+	}
+	else if (usLis > usMpu + IMU_MAX_SKEW)
+	{
+		if (prvDropLead(Lis2ds12ReadFifo, usLis - usMpu, pxFrame->xSamples) != pdPASS)
+		{
+			PipelineCancel(pxFrame);
+			return pdFAIL;
+		}
+		usLis = usMpu;
+	}
+
+	usCount = (usMpu < usLis) ? usMpu : usLis;
+	if (usCount > IMU_BLOCK_SAMPLES)
+	{
+		usCount = IMU_BLOCK_SAMPLES;
+	}
+	if (usCount == 0)
+	{
+		PipelineCancel(pxFrame);
+		return pdFAIL;
+	}
+
+	if (Mpu6000ReadFifo(pxFrame->xSamples, usCount) != pdPASS || Lis2ds12ReadFifo(pxFrame->xSamples, usCount) != pdPASS)
+	{
+		// One FIFO may have been read and the other not. Start both over
+		xStats.ulBusErrors++;
+		ulSequence++;
+		prvRestartFifos();
+		PipelineCancel(pxFrame);
+		return pdFAIL;
+	}
+	pxFrame->ulCycles = BenchmarkGetCycles();
+	pxFrame->xTimestamp = xTaskGetTickCount();
+	pxFrame->usCount = usCount;
+	pxFrame->ulSequence = ulSequence++;
+	pxFrame->cRateShift = cRateShift;
+	*pusActivity = prvActivity(pxFrame->xSamples, usCount);
+
+	taskENTER_CRITICAL();
+	xLatest = pxFrame->xSamples[usCount - 1];
+	bHaveLatest = true;
+	xStats.ulBlocks++;
+	xStats.ulSamples += usCount;
+	xStats.ulRateSamples[cRateShift - IMU_RATE_SHIFT_MIN] += usCount;
+	taskEXIT_CRITICAL();
+
+	PipelineSubmit(pxFrame);
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvDropLead(BaseType_t (*pxRead)(ImuSample_t *, uint16_t), uint16_t usLead, ImuSample_t *pxScratch)
+ * @brief		Reads and discards the oldest usLead samples of one FIFO
+ * @param[in]	pxScratch Room for IMU_BLOCK_SAMPLES samples
+ *****************************************************************************/
+static BaseType_t prvDropLead(BaseType_t (*pxRead)(ImuSample_t *, uint16_t), uint16_t usLead, ImuSample_t *pxScratch)
+{
+	while (usLead > 0)
+	{
+		uint16_t usChunk = (usLead > IMU_BLOCK_SAMPLES) ? IMU_BLOCK_SAMPLES : usLead;
+
+		if (pxRead(pxScratch, usChunk) != pdPASS)
+		{
+			xStats.ulBusErrors++;
+			ulSequence++;
+			prvRestartFifos();
+			return pdFAIL;
+		}
+		xStats.ulSkewDrops += usChunk;
+		usLead -= usChunk;
+	}
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvRestartFifos(void)
+ * @brief		Empties both FIFOs back to back, so the next samples pair up again
+ *****************************************************************************/
+static void prvRestartFifos(void)
+{
+	if (Mpu6000RestartFifo() != pdPASS || Lis2ds12RestartFifo() != pdPASS)
+	{
+		xStats.ulBusErrors++;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvActivity(const ImuSample_t *pxSamples, uint16_t usCount)
+ * @brief		Activity of a block: the largest gyroscope axis of its samples, raw
+ *****************************************************************************/
+static uint16_t prvActivity(const ImuSample_t *pxSamples, uint16_t usCount)
+{
+	uint16_t usMax = 0;
+
+	for (uint16_t i = 0; i < usCount; i++)
+	{
+		for (uint8_t ucAxis = 0; ucAxis < 3; ucAxis++)
+		{
+			int16_t sRate = pxSamples[i].sGyro[ucAxis];
+			uint16_t usRate = (uint16_t)((sRate < 0) ? -(int32_t)sRate : sRate);
+
+			usMax = (usRate > usMax) ? usRate : usMax;
+		}
+	}
+	return usMax;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvStopStream(void)
+ * @brief		Puts the MPU6000 to sleep and the LIS2DS12 in wake mode. On a bus
+ *				error both keep streaming and the stop is tried after the next block
+ *****************************************************************************/
+static void prvStopStream(void)
+{
+	if (Lis2ds12SetWakeMode(true) != pdPASS || Mpu6000SetSleep(true) != pdPASS)
+	{
+		xStats.ulBusErrors++;
+		if (Lis2ds12SetWakeMode(false) != pdPASS || Mpu6000SetSleep(false) != pdPASS)
+		{
+			xStats.ulBusErrors++;
+		}
+		ulSequence++;
+		prvRestartFifos();
+		return;
+	}
+	xStats.ulQuietStops++;
+	prvSetAcqState(IMU_ACQ_WAITING);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvWaitForMotion(void)
+ * @brief		Blocks until the wake-up interrupt, or until ImuSetQuietPeriod()
+ *				turns the stops off, then starts streaming again. A bus error
+ *				also starts streaming, as the wake-up may be lost
+ *****************************************************************************/
+static void prvWaitForMotion(void)
+{
+	bool bWoken = false;
+	int8_t cTarget;
+	TickType_t xStart;
+	uint32_t ulLatency;
+
+	// A notification left over from streaming returns at once without a wake-up
+	do
+	{
+		ExtIntEnable(IMU_WATERMARK_EXTINT);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		ExtIntDisable(IMU_WATERMARK_EXTINT);
+		if (Lis2ds12GetWake(&bWoken) != pdPASS)
+		{
+			xStats.ulBusErrors++;
+			break;
+		}
+	} while (!bWoken && ulQuietMs != 0);
+	prvSetAcqState(IMU_ACQ_WAKING);
+
+	if (Mpu6000SetSleep(false) != pdPASS || Lis2ds12SetWakeMode(false) != pdPASS)
+	{
+		// Stream anyway. Watermark timeouts and the next stop retry the bus
+		xStats.ulBusErrors++;
+	}
+	ulSequence++;
+
+	// Motion: start at IMU_SAMPLE_HZ, unless a rate is fixed
+	cTarget = (cRateRequest == IMU_RATE_AUTO) ? 0 : cRateRequest;
+	if (cTarget != cRateShift)
+	{
+		prvSetRate(cTarget);
+	}
+	else
+	{
+		prvRestartFifos();
+	}
+	xStart = xTaskGetTickCount();
+	xLastMotion = xLastPlay = xLastBurst = xStart;
+
+	if (bWoken)
+	{
+		ulLatency = (xStart - xWakeTick) * portTICK_PERIOD_MS;
+
+		taskENTER_CRITICAL();
+		xStats.ulMotionWakes++;
+		xStats.ulWakeLatencyTotal += ulLatency;
+		xStats.ulWakeLatencyMin = (ulLatency < xStats.ulWakeLatencyMin) ? ulLatency : xStats.ulWakeLatencyMin;
+		xStats.ulWakeLatencyMax = (ulLatency > xStats.ulWakeLatencyMax) ? ulLatency : xStats.ulWakeLatencyMax;
+		xStats.ulWakeLostSamples += ulLatency * IMU_RATE_HZ(cRateShift) / 1000;
+		xStats.ulWakeLostFirst += (ulLatency * IMU_RATE_HZ(cRateShift) >= 1000) ? 1 : 0;
+		taskEXIT_CRITICAL();
+	}
+	prvSetAcqState(IMU_ACQ_STREAMING);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSetAcqState(enum eImuAcqStates eNew)
+ * @brief		Closes the time of the current acquisition state and enters eNew
+ * @details		Asks for the low power clock profile while waiting for motion
+ *				and for the 48 MHz one otherwise, from the wake-up on, so the
+ *				stream restarts at full speed
+ *****************************************************************************/
+static void prvSetAcqState(enum eImuAcqStates eNew)
+{
+	TickType_t xNow = xTaskGetTickCount();
+
+	taskENTER_CRITICAL();
+	if (eState == IMU_STATE_RUNNING)
+	{
+		xStats.ulStateTicks[eAcqState] += xNow - xAcqSince;
+	}
+	prvCloseRate(xNow);
+	xStats.ulStateEntries[eNew]++;
+	xAcqSince = xNow;
+	eAcqState = eNew;
+	taskEXIT_CRITICAL();
+
+	ClockProfileRequest((eNew == IMU_ACQ_WAITING) ? CLOCK_PROFILE_LOW : CLOCK_PROFILE_HIGH);
+}
+
+/**************************************************************************/ /**
+ * @fn			static int8_t prvTargetRate(uint16_t usActivity, TickType_t xNow)
+ * @brief		Rate for the next block: the fixed one, or the activity
+ *				controller's, which steps up at once and down after a hold time
+ *****************************************************************************/
+static int8_t prvTargetRate(uint16_t usActivity, TickType_t xNow)
+{
+	int8_t cRequest = cRateRequest;
+
+	if (usActivity > IMU_DPS_TO_LSB(IMU_RATE_BURST_DOWN_DPS))
+	{
+		xLastBurst = xNow;
+	}
+	if (usActivity > IMU_DPS_TO_LSB(IMU_RATE_DOWN_DPS))
+	{
+		xLastPlay = xNow;
+	}
+
+	if (cRequest != IMU_RATE_AUTO)
+	{
+		return cRequest;
+	}
+	if (usActivity > IMU_DPS_TO_LSB(IMU_RATE_BURST_DPS) ||
+		(cRateShift == IMU_RATE_SHIFT_MAX && xNow - xLastBurst < pdMS_TO_TICKS(IMU_RATE_BURST_HOLD_MS)))
+	{
+		return IMU_RATE_SHIFT_MAX;
+	}
+	if (usActivity > IMU_DPS_TO_LSB(IMU_RATE_UP_DPS) ||
+		(cRateShift >= 0 && xNow - xLastPlay < pdMS_TO_TICKS(IMU_RATE_HOLD_MS)))
+	{
+		return 0;
+	}
+	return IMU_RATE_SHIFT_MIN;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSetRate(int8_t cNew)
+ * @brief		Moves both sensors to a new rate and restarts their FIFOs
+ *				together. Called between blocks, so every block has one rate.
+ *				On a bus error both go back to the old rate
+ *****************************************************************************/
+static void prvSetRate(int8_t cNew)
+{
+	TickType_t xNow;
+
+	if (Mpu6000SetRate(cNew) != pdPASS || Lis2ds12SetRate(cNew, prvWatermarkAt(cNew)) != pdPASS)
+	{
+		xStats.ulBusErrors++;
+		if (Mpu6000SetRate(cRateShift) != pdPASS || Lis2ds12SetRate(cRateShift, prvWatermarkAt(cRateShift)) != pdPASS)
+		{
+			xStats.ulBusErrors++;
+		}
+		ulSequence++;
+		prvRestartFifos();
+		return;
+	}
+	prvRestartFifos();
+
+	xNow = xTaskGetTickCount();
+	taskENTER_CRITICAL();
+	prvCloseRate(xNow);
+	cRateShift = cNew;
+	xStats.ulRateChanges++;
+	taskEXIT_CRITICAL();
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCloseRate(TickType_t xNow)
+ * @brief		Adds the streaming time at the current rate up to xNow. Called
+ *				in a critical section, before the rate or the state changes
+ *****************************************************************************/
+static void prvCloseRate(TickType_t xNow)
+{
+	if (eState == IMU_STATE_RUNNING && eAcqState == IMU_ACQ_STREAMING)
+	{
+		xStats.ulRateTicks[cRateShift - IMU_RATE_SHIFT_MIN] += xNow - xRateSince;
+	}
+	xRateSince = xNow;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvWatermarkAt(int8_t cShift)
+ * @brief		FIFO threshold that keeps the block period of IMU_SAMPLE_HZ,
+ *				rounded up, within IMU_BLOCK_SAMPLES
+ *****************************************************************************/
+static uint16_t prvWatermarkAt(int8_t cShift)
+{
+	uint16_t usWatermark = (cShift >= 0) ? IMU_FIFO_WATERMARK << cShift
+										 : (IMU_FIFO_WATERMARK + (1 << -cShift) - 1) >> -cShift;
+
+	return (usWatermark > IMU_BLOCK_SAMPLES) ? IMU_BLOCK_SAMPLES : usWatermark;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvBlockPeriodMs(int8_t cShift)
+ * @brief		Time between watermarks at a rate: 100 ms at 100 Hz, 50 ms at 200 Hz
+ *****************************************************************************/
+static uint32_t prvBlockPeriodMs(int8_t cShift)
+{
+	return 1000UL * prvWatermarkAt(cShift) / IMU_RATE_HZ(cShift);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvWatermark(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken)
+ * @brief		EIC callback of the LIS2DS12 INT1 line, the watermark or the
+ *				wake-up. Either level stays high until the sensor is read, so
+ *				the line is switched off until then
+ *****************************************************************************/
+static void prvWatermark(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	ExtIntDisable(IMU_WATERMARK_EXTINT);
+	if (eAcqState == IMU_ACQ_WAITING)
+	{
+		// Runs after the tick count was stepped over the sleep
+		xWakeTick = xTaskGetTickCountFromISR();
+	}
+	vTaskNotifyGiveFromISR(xImuTask, pxHigherPriorityTaskWoken);
+}
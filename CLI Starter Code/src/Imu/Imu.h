@@ -0,0 +1,252 @@
+/**************************************************************************/ /**
+ * @file      Imu.h
+ * @brief     IMU task: block reads of the MPU6000 and LIS2DS12 FIFOs.
+ * @details   Both sensors sample into their own hardware FIFO at
+ *            IMU_SAMPLE_HZ. The LIS2DS12 FIFO threshold drives its INT1 line
+ *            high once IMU_FIFO_WATERMARK samples are waiting; the EIC wakes
+ *            the IMU task, which reads the same number of samples from both
+ *            FIFOs in one DMA burst each into a pipeline frame, an ImuBlock_t,
+ *            and submits it (see Pipeline.h). The task wakes once per block
+ *            instead of once per sample.
+ *
+ *            Samples are paired by their position in the two FIFOs. The two
+ *            sensors run from their own oscillators, so one FIFO slowly gets
+ *            ahead of the other; when it leads by more than IMU_MAX_SKEW
+ *            samples, its oldest extra samples are dropped.
+ *
+ *            A FIFO that overran has lost samples and, on the MPU6000, its
+ *            byte alignment, so both FIFOs are restarted together and the
+ *            overrun is counted. The INT1 line is level sensitive: if the task
+ *            falls behind, the line is still high when it is re-enabled and the
+ *            task runs again at once. A timeout of IMU_WATERMARK_TIMEOUT_BLOCKS
+ *            block periods recovers from a missed or disconnected line. Lost samples make the block
+ *            sequence skip a number.
+ *
+ *            Acquisition stops when the racket has been still for the quiet
+ *            period (IMU_QUIET_MS, set with ImuSetQuietPeriod()): no gyroscope
+ *            axis above IMU_QUIET_GYRO_DPS. The MPU6000 then sleeps and the
+ *            LIS2DS12 moves INT1 to its wake-up interrupt, and the task blocks
+ *            without a timeout, so the idle task can drop to STANDBY. Motion
+ *            wakes the device through the same EIC line; the task wakes the
+ *            MPU6000, restarts both FIFOs and streams again. The CPU clock
+ *            follows (ClockProfileRequest()): 8 MHz while waiting, 48 MHz from
+ *            the wake-up on.
+ *
+ *            The wake latency runs from the tick of the interrupt to the FIFO
+ *            restart, mostly the MPU6000 start-up and the DFLL lock. Samples in that time are
+ *            lost: the first samples of the motion. Before the interrupt, the
+ *            LIS2DS12 takes up to one 12.5 Hz period to see the motion and
+ *            the clocks up to 1 ms to restart; neither is measured. The
+ *            counters also keep the time and entries of each acquisition state.
+ *
+ *            While streaming, the rate follows the activity, the largest
+ *            gyroscope axis of each block: IMU_SAMPLE_HZ above IMU_RATE_UP_DPS
+ *            when the lowest rate is below it, the top rate above
+ *            IMU_RATE_BURST_DPS, at once. Each step down waits until the
+ *            activity has stayed below a lower threshold for a hold time, so
+ *            the rate does not flap. A change happens between two
+ *            blocks: both sensors are reconfigured and their FIFOs restarted
+ *            together, so no block mixes rates and the pairing holds. The few
+ *            samples taken during the switch are discarded without a sequence
+ *            gap; the timestamps show the pause. Every block carries its rate
+ *            as cRateShift, and the timestamps of its samples are counted back
+ *            from xTimestamp at that rate. The counters keep, per rate, the
+ *            streaming time, the samples read and the task wakes, the main
+ *            costs of the stream.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef IMU_H
+#define IMU_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "conf_imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IMU_TASK_SIZE 192						///< IMU task stack, in words
+#define IMU_PRIORITY (configMAX_PRIORITIES - 2) ///< Above the timer daemon, below the CLI
+#define IMU_BLOCK_SAMPLES IMU_FIFO_WATERMARK	///< Most samples in a block
+#define IMU_MAX_SKEW 2							///< Samples one FIFO may lead the other by
+#define IMU_BLOCK_PERIOD_MS (1000 * IMU_FIFO_WATERMARK / IMU_SAMPLE_HZ) ///< Time between watermarks at IMU_SAMPLE_HZ
+#define IMU_WATERMARK_TIMEOUT_BLOCKS 3			///< Block periods, at the current rate, without a watermark
+#define IMU_RETRY_MS 1000						///< Delay between attempts to find the sensors
+#define IMU_QUIET_MS 10000						///< Default quiet period before acquisition stops
+#define IMU_QUIET_GYRO_DPS 10					///< Slower turns on every axis count as still
+#define IMU_QUIET_GYRO_LSB (IMU_QUIET_GYRO_DPS * IMU_GYRO_LSB_PER_10_DPS / 10)
+#define IMU_RATE_UP_DPS 60						///< Activity that raises the rate to IMU_SAMPLE_HZ
+#define IMU_RATE_BURST_DPS 400					///< Activity that raises it to the top rate
+#define IMU_RATE_DOWN_DPS 30					///< Below this for IMU_RATE_HOLD_MS, down to the lowest rate
+#define IMU_RATE_HOLD_MS 3000
+#define IMU_RATE_BURST_DOWN_DPS 200				///< Below this for IMU_RATE_BURST_HOLD_MS, down from the top rate
+#define IMU_RATE_BURST_HOLD_MS 1000
+#define N_IMU_RATES (IMU_RATE_SHIFT_MAX - IMU_RATE_SHIFT_MIN + 1)
+#define IMU_RATE_AUTO INT8_MAX					///< ImuSetRate() argument for the activity controller
+
+/** Sample rate in Hz at a rate shift */
+#define IMU_RATE_HZ(cShift) (((cShift) >= 0) ? IMU_SAMPLE_HZ << (cShift) : IMU_SAMPLE_HZ >> -(cShift))
+
+#if IMU_RATE_SHIFT_MIN > 0 || IMU_RATE_SHIFT_MAX < 0
+#error "The rate shifts must include IMU_SAMPLE_HZ"
+#endif
+
+// Scale of the raw values, both sensors at their +-16 g and +-2000 dps ranges
+#define IMU_ACCEL_LSB_PER_G 2048
+#define IMU_GYRO_LSB_PER_10_DPS 164
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief One sample of both sensors, raw, in the sensors' own axes.
+ */
+typedef struct
+{
+	int16_t sAccel[3];	  ///< MPU6000 accelerometer X, Y, Z
+	int16_t sGyro[3];	  ///< MPU6000 gyroscope X, Y, Z
+	int16_t sAccelAux[3]; ///< LIS2DS12 accelerometer X, Y, Z
+} ImuSample_t;
+
+/**
+ * @brief Samples read on one watermark, oldest first.
+ */
+typedef struct
+{
+	uint32_t ulSequence;	 ///< Block number of its producer. A block lost before it skips a number
+	TickType_t xTimestamp; ///< Tick count when the block was read. The last sample is at most one period older
+	uint32_t ulCycles;	 ///< BenchmarkGetCycles() when the block was read, for the pipeline latency
+	uint16_t usCount;		 ///< Valid entries in xSamples
+	int8_t cRateShift;		 ///< The samples are 1 / IMU_RATE_HZ(cRateShift) apart
+	ImuSample_t xSamples[IMU_BLOCK_SAMPLES];
+} ImuBlock_t;
+
+/**
+ * @brief Where the IMU task is.
+ */
+enum eImuStates
+{
+	IMU_STATE_STARTING = 0, ///< Not tried yet
+	IMU_STATE_NOT_FOUND,	///< A sensor did not answer, retried every IMU_RETRY_MS
+	IMU_STATE_RUNNING		///< Reading blocks
+};
+
+/**
+ * @brief Acquisition state of the running IMU task.
+ */
+enum eImuAcqStates
+{
+	IMU_ACQ_STREAMING = 0, ///< Both sensors at the current rate, read on every watermark
+	IMU_ACQ_WAITING,	   ///< MPU6000 asleep, LIS2DS12 waiting for motion
+	IMU_ACQ_WAKING,		   ///< Between the wake-up and the FIFO restart
+	N_IMU_ACQ_STATES
+};
+
+/**
+ * @brief IMU task counters.
+ */
+typedef struct
+{
+	uint32_t ulBlocks;		   ///< Blocks submitted to the pipeline
+	uint32_t ulSamples;		   ///< Samples in them
+	uint32_t ulWakes;		   ///< Wakes by the watermark line
+	uint32_t ulTimeouts;	   ///< Wakes by the watermark timeout
+	uint32_t ulMpuOverruns;	   ///< MPU6000 FIFO overruns
+	uint32_t ulLisOverruns;	   ///< LIS2DS12 FIFO overruns
+	uint32_t ulSkewDrops;	   ///< Samples dropped to pair the FIFOs
+	uint32_t ulBusErrors;	   ///< Failed bus transfers
+	uint32_t ulQuietStops;	   ///< Streams stopped after the quiet period
+	uint32_t ulMotionWakes;	   ///< Streams started by the wake-up interrupt
+	uint32_t ulWakeLatencyMin; ///< ms, UINT32_MAX before the first motion wake
+	uint32_t ulWakeLatencyMax;
+	uint32_t ulWakeLatencyTotal;
+	uint32_t ulWakeLostFirst;	///< Motion wakes that lost at least the first sample
+	uint32_t ulWakeLostSamples; ///< Sample periods between the interrupts and the FIFO restarts
+	uint32_t ulStateTicks[N_IMU_ACQ_STATES];   ///< Time in each acquisition state, including the current one
+	uint32_t ulStateEntries[N_IMU_ACQ_STATES]; ///< Times each state was entered
+	uint32_t ulRateChanges;
+	uint32_t ulRateTicks[N_IMU_RATES];   ///< Streaming time at each rate, from IMU_RATE_SHIFT_MIN, including the current one
+	uint32_t ulRateSamples[N_IMU_RATES]; ///< Samples read at each rate
+	uint32_t ulRateWakes[N_IMU_RATES];   ///< Task wakes and timeouts at each rate
+} ImuStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void vImuTask(void *pvParameters)
+ * @brief		IMU task. Sets up the buses and sensors, then reads a block on every watermark
+ * @note		Needs DmacInit(), ExtIntInit() and PipelineInit() first
+ *****************************************************************************/
+void vImuTask(void *pvParameters);
+
+/**
+ * @fn			enum eImuStates ImuGetState(void)
+ * @brief		Returns whether the sensors were found and are being read
+ *****************************************************************************/
+enum eImuStates ImuGetState(void);
+
+/**
+ * @fn			enum eImuAcqStates ImuGetAcqState(void)
+ * @brief		Returns whether the sensors are streaming or waiting for motion
+ *****************************************************************************/
+enum eImuAcqStates ImuGetAcqState(void);
+
+/**
+ * @fn			const char *ImuGetAcqStateName(enum eImuAcqStates eAcq)
+ * @brief		Returns "streaming", "waiting" or "waking", or NULL for an invalid state
+ *****************************************************************************/
+const char *ImuGetAcqStateName(enum eImuAcqStates eAcq);
+
+/**
+ * @fn			void ImuSetQuietPeriod(uint32_t ulMs)
+ * @brief		Sets how long the racket must be still before acquisition stops
+ * @param[in]	ulMs 0 streams all the time, and starts a stream that is waiting
+ *****************************************************************************/
+void ImuSetQuietPeriod(uint32_t ulMs);
+
+/**
+ * @fn			uint32_t ImuGetQuietPeriod(void)
+ * @brief		Returns the quiet period in ms, 0 when acquisition never stops
+ *****************************************************************************/
+uint32_t ImuGetQuietPeriod(void);
+
+/**
+ * @fn			void ImuSetRate(int8_t cShift)
+ * @brief		Fixes the rate at IMU_RATE_HZ(cShift), or hands it to the activity
+ *				controller. Takes effect after the next block
+ * @param[in]	cShift IMU_RATE_SHIFT_MIN to IMU_RATE_SHIFT_MAX, or IMU_RATE_AUTO
+ * @return		pdFAIL for a shift out of range
+ *****************************************************************************/
+BaseType_t ImuSetRate(int8_t cShift);
+
+/**
+ * @fn			int8_t ImuGetRate(bool *pbAuto)
+ * @brief		Returns the current rate shift
+ * @param[out]	pbAuto Whether the activity controller sets it
+ *****************************************************************************/
+int8_t ImuGetRate(bool *pbAuto);
+
+/**
+ * @fn			BaseType_t ImuGetLatest(ImuSample_t *pxSample)
+ * @brief		Copies the newest sample
+ * @return		pdFAIL if no block has been read yet
+ *****************************************************************************/
+BaseType_t ImuGetLatest(ImuSample_t *pxSample);
+
+/**
+ * @fn			void ImuGetStats(ImuStats_t *pxStats)
+ * @brief		Copies the counters, with the time in the current state up to now
+ *****************************************************************************/
+void ImuGetStats(ImuStats_t *pxStats);
+
+/**
+ * @fn			void ImuResetStats(void)
+ * @brief		Clears the counters. State times restart from now
+ *****************************************************************************/
+void ImuResetStats(void);
+
+#endif /* IMU_H */
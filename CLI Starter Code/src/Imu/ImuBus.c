@@ -0,0 +1,429 @@
+/**************************************************************************/ /**
+ * @file      ImuBus.c
+ * @brief     SERCOM SPI and I2C masters of the IMUs, with DMA burst reads.
+ *            See ImuBus.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "ImuBus.h"
+#include "Dmac/Dmac.h"
+#include "conf_imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IMU_SPI_READ 0x80				///< Register address bit of an MPU6000 read
+#define IMU_I2C_READ 0x01				///< Address byte bit of an I2C read
+#define IMU_I2C_CMD_STOP 3				///< CTRLB.CMD: acknowledge action, then STOP
+#define IMU_I2C_BUSSTATE_IDLE 1			///< STATUS.BUSSTATE
+#define IMU_I2C_SDAHOLD 2				///< 300-600 ns SDA hold, what fast mode asks for
+#define IMU_I2C_STATUS_ERRORS (SERCOM_I2CM_STATUS_RXNACK | SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST)
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief DMA read in flight on one bus.
+ */
+typedef struct
+{
+	SemaphoreHandle_t xDone;		 ///< Given by the DMA callback
+	StaticSemaphore_t xDoneBuffer;
+	volatile bool bError;			 ///< The DMA reported a bus error
+} BusTransfer_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvClockSercom(uint32_t ulApbcMask, uint8_t ucGclkId);
+static void prvPinmux(uint32_t ulPinmux);
+static void prvSpiInit(void);
+static void prvI2cInit(void);
+static BaseType_t prvWaitFlag(volatile const uint8_t *pucFlags, uint8_t ucMask);
+static BaseType_t prvWaitDma(BusTransfer_t *pxTransfer);
+static void prvDmaDone(void *pvContext, bool bError, BaseType_t *pxHigherPriorityTaskWoken);
+static BaseType_t prvSpiByte(uint8_t ucOut, uint8_t *pucIn);
+static void prvI2cSync(void);
+static BaseType_t prvI2cStart(uint8_t ucAddressByte);
+static BaseType_t prvI2cSend(uint8_t ucByte);
+static void prvI2cStop(void);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static BusTransfer_t xSpiTransfer;
+static BusTransfer_t xI2cTransfer;
+static const uint8_t ucSpiDummy = 0; ///< Sent while the MPU6000 answers
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Sets up both buses.
+ */
+void ImuBusInit(void)
+{
+	xSpiTransfer.xDone = xSemaphoreCreateBinaryStatic(&xSpiTransfer.xDoneBuffer);
+	xI2cTransfer.xDone = xSemaphoreCreateBinaryStatic(&xI2cTransfer.xDoneBuffer);
+
+	prvSpiInit();
+	prvI2cInit();
+	prvPinmux(IMU_WATERMARK_PINMUX);
+
+	DmacConfigure(DMAC_CHANNEL_IMU_SPI_RX, IMU_SPI_DMAC_ID_RX, prvDmaDone, &xSpiTransfer);
+	DmacConfigure(DMAC_CHANNEL_IMU_SPI_TX, IMU_SPI_DMAC_ID_TX, NULL, NULL);
+	DmacConfigure(DMAC_CHANNEL_IMU_I2C_RX, IMU_I2C_DMAC_ID_RX, prvDmaDone, &xI2cTransfer);
+}
+
+/**
+ * @brief Writes one MPU6000 register with two polled bytes.
+ */
+BaseType_t ImuSpiWrite(uint8_t ucRegister, uint8_t ucValue)
+{
+	uint8_t ucDiscard;
+	BaseType_t xResult;
+
+	port_pin_set_output_level(IMU_SPI_PIN_CS, false);
+	xResult = prvSpiByte(ucRegister & ~IMU_SPI_READ, &ucDiscard);
+	if (xResult == pdPASS)
+	{
+		xResult = prvSpiByte(ucValue, &ucDiscard);
+	}
+	port_pin_set_output_level(IMU_SPI_PIN_CS, true);
+
+	return xResult;
+}
+
+/**
+ * @brief Sends the register address polled, then reads the data by DMA.
+ */
+BaseType_t ImuSpiRead(uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+{
+	SercomSpi *const pxSpi = &IMU_SPI_SERCOM->SPI;
+	uint8_t ucDiscard;
+	BaseType_t xResult;
+
+	port_pin_set_output_level(IMU_SPI_PIN_CS, false);
+	xResult = prvSpiByte(ucRegister | IMU_SPI_READ, &ucDiscard);
+	if (xResult == pdPASS && usLength > 0)
+	{
+		// RX first, so it is armed before the first dummy byte comes back
+		xSemaphoreTake(xSpiTransfer.xDone, 0);
+		xSpiTransfer.bError = false;
+		DmacStart(DMAC_CHANNEL_IMU_SPI_RX, &pxSpi->DATA.reg, pucData, usLength, false, true);
+		DmacStart(DMAC_CHANNEL_IMU_SPI_TX, &ucSpiDummy, &pxSpi->DATA.reg, usLength, false, false);
+		xResult = prvWaitDma(&xSpiTransfer);
+		if (xResult != pdPASS)
+		{
+			DmacAbort(DMAC_CHANNEL_IMU_SPI_TX);
+			DmacAbort(DMAC_CHANNEL_IMU_SPI_RX);
+		}
+	}
+	// The last byte has been received, so it has also been shifted out
+	port_pin_set_output_level(IMU_SPI_PIN_CS, true);
+
+	return xResult;
+}
+
+/**
+ * @brief Writes one register: address, register, value, STOP.
+ */
+BaseType_t ImuI2cWrite(uint8_t ucAddress, uint8_t ucRegister, uint8_t ucValue)
+{
+	BaseType_t xResult;
+
+	xResult = prvI2cStart(ucAddress << 1);
+	if (xResult == pdPASS)
+	{
+		xResult = prvI2cSend(ucRegister);
+	}
+	if (xResult == pdPASS)
+	{
+		xResult = prvI2cSend(ucValue);
+	}
+	prvI2cStop();
+
+	return xResult;
+}
+
+/**
+ * @brief Writes the register address, then reads with a repeated start, LENEN and DMA.
+ */
+BaseType_t ImuI2cRead(uint8_t ucAddress, uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+{
+	SercomI2cm *const pxI2c = &IMU_I2C_SERCOM->I2CM;
+	BaseType_t xResult;
+
+	if (usLength == 0 || usLength > IMU_I2C_MAX_READ)
+	{
+		return pdFAIL;
+	}
+
+	xResult = prvI2cStart(ucAddress << 1);
+	if (xResult == pdPASS)
+	{
+		xResult = prvI2cSend(ucRegister);
+	}
+	if (xResult != pdPASS)
+	{
+		prvI2cStop();
+		return pdFAIL;
+	}
+
+	xSemaphoreTake(xI2cTransfer.xDone, 0);
+	xI2cTransfer.bError = false;
+	DmacStart(DMAC_CHANNEL_IMU_I2C_RX, &pxI2c->DATA.reg, pucData, usLength, false, true);
+	pxI2c->ADDR.reg = ((ucAddress << 1) | IMU_I2C_READ) | SERCOM_I2CM_ADDR_LENEN | SERCOM_I2CM_ADDR_LEN(usLength);
+	prvI2cSync();
+	xResult = prvWaitDma(&xI2cTransfer);
+
+	if (xResult == pdPASS)
+	{
+		// The SERCOM sends NACK and STOP after the last byte. Wait for it before the next transfer
+		uint32_t ulLoops = 0;
+
+		while ((pxI2c->STATUS.reg & SERCOM_I2CM_STATUS_BUSSTATE_Msk) !=
+			   SERCOM_I2CM_STATUS_BUSSTATE(IMU_I2C_BUSSTATE_IDLE))
+		{
+			if (++ulLoops > IMU_BUS_POLL_LOOPS)
+			{
+				xResult = pdFAIL;
+				break;
+			}
+		}
+	}
+	else
+	{
+		DmacAbort(DMAC_CHANNEL_IMU_I2C_RX);
+		prvI2cStop();
+	}
+
+	return xResult;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvClockSercom(uint32_t ulApbcMask, uint8_t ucGclkId)
+ * @brief		Enables a SERCOM's bus clock and feeds its core from IMU_SERCOM_GCLK
+ *****************************************************************************/
+static void prvClockSercom(uint32_t ulApbcMask, uint8_t ucGclkId)
+{
+	struct system_gclk_chan_config xGclkConfig;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, ulApbcMask);
+	system_gclk_chan_get_config_defaults(&xGclkConfig);
+	xGclkConfig.source_generator = IMU_SERCOM_GCLK;
+	system_gclk_chan_set_config(ucGclkId, &xGclkConfig);
+	system_gclk_chan_enable(ucGclkId);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPinmux(uint32_t ulPinmux)
+ * @brief		Muxes a pin to the peripheral function of a PINMUX_ value
+ *****************************************************************************/
+static void prvPinmux(uint32_t ulPinmux)
+{
+	struct system_pinmux_config xPinConfig;
+
+	system_pinmux_get_config_defaults(&xPinConfig);
+	xPinConfig.mux_position = ulPinmux & 0xFFFF;
+	system_pinmux_pin_set_config(ulPinmux >> 16, &xPinConfig);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSpiInit(void)
+ * @brief		SPI master, mode 3, MSB first, chip select released
+ *****************************************************************************/
+static void prvSpiInit(void)
+{
+	SercomSpi *const pxSpi = &IMU_SPI_SERCOM->SPI;
+	struct port_config xPortConfig;
+
+	port_get_config_defaults(&xPortConfig);
+	xPortConfig.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_output_level(IMU_SPI_PIN_CS, true);
+	port_pin_set_config(IMU_SPI_PIN_CS, &xPortConfig);
+
+	prvClockSercom(IMU_SPI_SERCOM_APBC_MASK, IMU_SPI_GCLK_ID);
+	pxSpi->CTRLA.reg = SERCOM_SPI_CTRLA_SWRST;
+	while (pxSpi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_SWRST)
+		;
+	pxSpi->CTRLA.reg = SERCOM_SPI_CTRLA_MODE_SPI_MASTER | SERCOM_SPI_CTRLA_DOPO(IMU_SPI_DOPO) |
+					   SERCOM_SPI_CTRLA_DIPO(IMU_SPI_DIPO) | SERCOM_SPI_CTRLA_CPOL | SERCOM_SPI_CTRLA_CPHA;
+	pxSpi->CTRLB.reg = SERCOM_SPI_CTRLB_RXEN;
+	while (pxSpi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_CTRLB)
+		;
+	pxSpi->BAUD.reg = system_gclk_gen_get_hz(IMU_SERCOM_GCLK) / (2 * IMU_SPI_BAUD_HZ) - 1;
+	pxSpi->CTRLA.reg |= SERCOM_SPI_CTRLA_ENABLE;
+	while (pxSpi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_ENABLE)
+		;
+
+	prvPinmux(IMU_SPI_PINMUX_MISO);
+	prvPinmux(IMU_SPI_PINMUX_MOSI);
+	prvPinmux(IMU_SPI_PINMUX_SCK);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvI2cInit(void)
+ * @brief		I2C master in smart mode at IMU_I2C_BAUD_HZ, bus forced to idle
+ *****************************************************************************/
+static void prvI2cInit(void)
+{
+	SercomI2cm *const pxI2c = &IMU_I2C_SERCOM->I2CM;
+	uint32_t ulHz = system_gclk_gen_get_hz(IMU_SERCOM_GCLK);
+	uint32_t ulRiseCycles = (ulHz / 1000) * IMU_I2C_RISE_NS / 1000000;
+
+	prvClockSercom(IMU_I2C_SERCOM_APBC_MASK, IMU_I2C_GCLK_ID);
+	pxI2c->CTRLA.reg = SERCOM_I2CM_CTRLA_SWRST;
+	while (pxI2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_SWRST)
+		;
+	pxI2c->CTRLA.reg = SERCOM_I2CM_CTRLA_MODE_I2C_MASTER | SERCOM_I2CM_CTRLA_SDAHOLD(IMU_I2C_SDAHOLD);
+	pxI2c->CTRLB.reg = SERCOM_I2CM_CTRLB_SMEN;
+	prvI2cSync();
+	// fSCL = fGCLK / (10 + 2 * BAUD + fGCLK * tRISE), with BAUDLOW 0 for a symmetric clock
+	pxI2c->BAUD.reg = SERCOM_I2CM_BAUD_BAUD((ulHz / IMU_I2C_BAUD_HZ - 10 - ulRiseCycles) / 2);
+	pxI2c->CTRLA.reg |= SERCOM_I2CM_CTRLA_ENABLE;
+	while (pxI2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_ENABLE)
+		;
+	// The bus state is unknown after enable and no transfer can start until it is idle
+	pxI2c->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(IMU_I2C_BUSSTATE_IDLE);
+	prvI2cSync();
+
+	prvPinmux(IMU_I2C_PINMUX_SDA);
+	prvPinmux(IMU_I2C_PINMUX_SCL);
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvWaitFlag(volatile const uint8_t *pucFlags, uint8_t ucMask)
+ * @brief		Polls an INTFLAG register for any of ucMask, at most IMU_BUS_POLL_LOOPS times
+ *****************************************************************************/
+static BaseType_t prvWaitFlag(volatile const uint8_t *pucFlags, uint8_t ucMask)
+{
+	for (uint32_t ulLoops = 0; ulLoops < IMU_BUS_POLL_LOOPS; ulLoops++)
+	{
+		if (*pucFlags & ucMask)
+		{
+			return pdPASS;
+		}
+	}
+	return pdFAIL;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvWaitDma(BusTransfer_t *pxTransfer)
+ * @brief		Blocks until the bus's DMA read completes or times out
+ *****************************************************************************/
+static BaseType_t prvWaitDma(BusTransfer_t *pxTransfer)
+{
+	if (xSemaphoreTake(pxTransfer->xDone, pdMS_TO_TICKS(IMU_BUS_DMA_TIMEOUT_MS)) != pdTRUE)
+	{
+		return pdFAIL;
+	}
+	return pxTransfer->bError ? pdFAIL : pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvDmaDone(void *pvContext, bool bError, BaseType_t *pxHigherPriorityTaskWoken)
+ * @brief		DMA callback of the receive channels. Wakes the task waiting on the bus
+ *****************************************************************************/
+static void prvDmaDone(void *pvContext, bool bError, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	BusTransfer_t *pxTransfer = (BusTransfer_t *)pvContext;
+
+	pxTransfer->bError = bError;
+	xSemaphoreGiveFromISR(pxTransfer->xDone, pxHigherPriorityTaskWoken);
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvSpiByte(uint8_t ucOut, uint8_t *pucIn)
+ * @brief		Exchanges one byte on the SPI by polling
+ *****************************************************************************/
+static BaseType_t prvSpiByte(uint8_t ucOut, uint8_t *pucIn)
+{
+	SercomSpi *const pxSpi = &IMU_SPI_SERCOM->SPI;
+
+	if (prvWaitFlag(&pxSpi->INTFLAG.reg, SERCOM_SPI_INTFLAG_DRE) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	pxSpi->DATA.reg = ucOut;
+	if (prvWaitFlag(&pxSpi->INTFLAG.reg, SERCOM_SPI_INTFLAG_RXC) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	*pucIn = pxSpi->DATA.reg;
+	return pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvI2cSync(void)
+ * @brief		Waits for a CTRLB, STATUS, ADDR or DATA write to reach the SERCOM core clock
+ *****************************************************************************/
+static void prvI2cSync(void)
+{
+	while (IMU_I2C_SERCOM->I2CM.SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_SYSOP)
+		;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvI2cStart(uint8_t ucAddressByte)
+ * @brief		Sends a (repeated) START and the address byte
+ * @return		pdFAIL on a NACK, bus error, lost arbitration or timeout
+ *****************************************************************************/
+static BaseType_t prvI2cStart(uint8_t ucAddressByte)
+{
+	SercomI2cm *const pxI2c = &IMU_I2C_SERCOM->I2CM;
+
+	pxI2c->ADDR.reg = ucAddressByte;
+	prvI2cSync();
+	if (prvWaitFlag(&pxI2c->INTFLAG.reg, SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return (pxI2c->STATUS.reg & IMU_I2C_STATUS_ERRORS) ? pdFAIL : pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvI2cSend(uint8_t ucByte)
+ * @brief		Sends one data byte and checks its acknowledge
+ *****************************************************************************/
+static BaseType_t prvI2cSend(uint8_t ucByte)
+{
+	SercomI2cm *const pxI2c = &IMU_I2C_SERCOM->I2CM;
+
+	pxI2c->DATA.reg = ucByte;
+	prvI2cSync();
+	if (prvWaitFlag(&pxI2c->INTFLAG.reg, SERCOM_I2CM_INTFLAG_MB) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return (pxI2c->STATUS.reg & IMU_I2C_STATUS_ERRORS) ? pdFAIL : pdPASS;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvI2cStop(void)
+ * @brief		Sends STOP. After a bus error or lost arbitration, where the
+ *				master no longer owns the bus, forces the bus state back to idle
+ *****************************************************************************/
+static void prvI2cStop(void)
+{
+	SercomI2cm *const pxI2c = &IMU_I2C_SERCOM->I2CM;
+
+	if (pxI2c->STATUS.reg & (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST))
+	{
+		pxI2c->STATUS.reg = SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST |
+							SERCOM_I2CM_STATUS_BUSSTATE(IMU_I2C_BUSSTATE_IDLE);
+	}
+	else
+	{
+		pxI2c->CTRLB.reg |= SERCOM_I2CM_CTRLB_CMD(IMU_I2C_CMD_STOP);
+	}
+	prvI2cSync();
+}
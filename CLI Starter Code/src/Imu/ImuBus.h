@@ -0,0 +1,79 @@
+/**************************************************************************/ /**
+ * @file      ImuBus.h
+ * @brief     SERCOM SPI and I2C masters of the IMUs, with DMA burst reads.
+ * @details   Register writes and the register address phase of a read are
+ *            polled; they are a byte or two, and only the sensor setup uses
+ *            writes. The data phase of a read is one DMA block straight into
+ *            the caller's buffer, while the calling task blocks on a
+ *            semaphore given by the DMA completion callback.
+ *
+ *            SPI (MPU6000): mode 3, chip select driven as a GPIO. The DMA TX
+ *            channel clocks out a dummy byte per byte received.
+ *            I2C (LIS2DS12): smart mode, so reading DATA acknowledges the
+ *            byte. The read is sent with ADDR.LENEN, and the SERCOM sends the
+ *            NACK and STOP after the last byte by itself.
+ *
+ *            Every wait is bounded, so a missing sensor makes the calls fail
+ *            instead of hanging. Only the IMU task uses the buses.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef IMU_BUS_H
+#define IMU_BUS_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IMU_BUS_POLL_LOOPS 5000		///< Bound on a polled byte, several byte times at the slowest CPU clock
+#define IMU_BUS_DMA_TIMEOUT_MS 20	///< Bound on a DMA read. The largest block takes about 3 ms on the I2C
+#define IMU_I2C_MAX_READ 255		///< ADDR.LEN is 8 bits
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void ImuBusInit(void)
+ * @brief		Sets up both SERCOMs, their pins and DMA channels, and muxes the
+ *				watermark pin to the EIC
+ * @note		Call from the IMU task, after DmacInit()
+ *****************************************************************************/
+void ImuBusInit(void);
+
+/**
+ * @fn			BaseType_t ImuSpiWrite(uint8_t ucRegister, uint8_t ucValue)
+ * @brief		Writes one MPU6000 register
+ * @return		pdPASS, or pdFAIL on a timeout
+ *****************************************************************************/
+BaseType_t ImuSpiWrite(uint8_t ucRegister, uint8_t ucValue);
+
+/**
+ * @fn			BaseType_t ImuSpiRead(uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+ * @brief		Reads usLength bytes starting at an MPU6000 register
+ * @details		The MPU6000 increments the address, except on FIFO_R_W, which
+ *				returns the next FIFO byte on every read
+ * @return		pdPASS, or pdFAIL on a timeout or DMA error
+ *****************************************************************************/
+BaseType_t ImuSpiRead(uint8_t ucRegister, uint8_t *pucData, uint16_t usLength);
+
+/**
+ * @fn			BaseType_t ImuI2cWrite(uint8_t ucAddress, uint8_t ucRegister, uint8_t ucValue)
+ * @brief		Writes one register of an I2C device
+ * @param[in]	ucAddress 7-bit device address
+ * @return		pdPASS, or pdFAIL on a NACK, bus error or timeout
+ *****************************************************************************/
+BaseType_t ImuI2cWrite(uint8_t ucAddress, uint8_t ucRegister, uint8_t ucValue);
+
+/**
+ * @fn			BaseType_t ImuI2cRead(uint8_t ucAddress, uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+ * @brief		Writes the register address, then reads usLength bytes after a repeated start
+ * @param[in]	usLength 1 to IMU_I2C_MAX_READ
+ * @return		pdPASS, or pdFAIL on a NACK, bus error, DMA error or timeout
+ *****************************************************************************/
+BaseType_t ImuI2cRead(uint8_t ucAddress, uint8_t ucRegister, uint8_t *pucData, uint16_t usLength);
+
+#endif /* IMU_BUS_H */
@@ -0,0 +1,215 @@
+/**************************************************************************/ /**
+ * @file      Lis2ds12.c
+ * @brief     LIS2DS12 accelerometer on the IMU I2C bus. See Lis2ds12.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Lis2ds12.h"
+#include "ImuBus.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define LIS2DS12_WHO_AM_I 0x0F
+#define LIS2DS12_CTRL1 0x20
+#define LIS2DS12_CTRL2 0x21
+#define LIS2DS12_CTRL3 0x22
+#define LIS2DS12_CTRL4 0x23
+#define LIS2DS12_OUT_X_L 0x28
+#define LIS2DS12_FIFO_CTRL 0x25
+#define LIS2DS12_FIFO_THS 0x2E
+#define LIS2DS12_FIFO_SRC 0x2F ///< Followed by FIFO_SAMPLES
+#define LIS2DS12_WAKE_UP_THS 0x33
+#define LIS2DS12_WAKE_UP_DUR 0x34
+#define LIS2DS12_WAKE_UP_SRC 0x38
+
+#define LIS2DS12_ID 0x43
+#define LIS2DS12_CTRL1_16G_BDU 0x05		  ///< FS +-16 g, block data update, with a high resolution ODR above
+#define LIS2DS12_CTRL1_ODR_SHIFT 4
+#define LIS2DS12_CTRL1_ODR_100HZ 4		  ///< High resolution ODRs double from 1 (12.5 Hz) to 7 (800 Hz)
+#define LIS2DS12_CTRL1_LP12HZ_2G_BDU 0x91 ///< ODR 12.5 Hz low power, FS +-2 g, block data update
+#define LIS2DS12_CTRL2_SOFT_RESET 0x40
+#define LIS2DS12_CTRL2_IF_ADD_INC 0x04	  ///< Address auto-increment on multi-byte access
+#define LIS2DS12_CTRL3_LIR 0x04			  ///< Latched wake-up, held until WAKE_UP_SRC is read
+#define LIS2DS12_CTRL4_INT1_FTH 0x02	  ///< FIFO threshold on INT1
+#define LIS2DS12_CTRL4_INT1_WU 0x20		  ///< Wake-up on INT1
+#define LIS2DS12_WAKE_UP_SRC_WU_IA 0x08
+#define LIS2DS12_WAKE_FS_MG 2000		  ///< Full scale in wake mode. The threshold is 1/64 of it per LSB
+#define LIS2DS12_WAKE_THS ((IMU_WAKE_THRESHOLD_MG * 64 + LIS2DS12_WAKE_FS_MG / 2) / LIS2DS12_WAKE_FS_MG)
+#define LIS2DS12_WAKE_SETTLE_MS 240		  ///< Three samples at 12.5 Hz for the high-pass filter
+#define LIS2DS12_FIFO_BYPASS 0x00
+#define LIS2DS12_FIFO_CONTINUOUS 0xC0
+#define LIS2DS12_FIFO_SRC_OVR 0x40
+#define LIS2DS12_FIFO_SRC_DIFF8 0x20	  ///< Bit 8 of the sample count
+#define LIS2DS12_RESET_MS 5
+#define LIS2DS12_SAMPLE_BYTES 6
+
+#if LIS2DS12_WAKE_THS < 1 || LIS2DS12_WAKE_THS > 63
+#error "IMU_WAKE_THRESHOLD_MG is out of the LIS2DS12 wake-up range"
+#endif
+#if IMU_SAMPLE_HZ != 100
+#error "LIS2DS12_CTRL1_ODR_100HZ is the nominal rate"
+#endif
+
+/** CTRL1 at a rate shift: high resolution, +-16 g, block data update */
+#define LIS2DS12_CTRL1_AT(cShift) (((LIS2DS12_CTRL1_ODR_100HZ + (cShift)) << LIS2DS12_CTRL1_ODR_SHIFT) | LIS2DS12_CTRL1_16G_BDU)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint8_t ucRaw[IMU_BLOCK_SAMPLES * LIS2DS12_SAMPLE_BYTES]; ///< DMA destination of a FIFO burst
+static uint8_t ucStreamCtrl1 = LIS2DS12_CTRL1_AT(0);				///< CTRL1 of the rate set last, restored after wake mode
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Identifies, resets and configures the sensor, then starts the FIFO.
+ */
+BaseType_t Lis2ds12Init(void)
+{
+	uint8_t ucId = 0;
+
+	if (ImuI2cRead(IMU_LIS2DS12_ADDRESS, LIS2DS12_WHO_AM_I, &ucId, 1) != pdPASS || ucId != LIS2DS12_ID)
+	{
+		return pdFAIL;
+	}
+	if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL2, LIS2DS12_CTRL2_SOFT_RESET) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	vTaskDelay(pdMS_TO_TICKS(LIS2DS12_RESET_MS));
+
+	ucStreamCtrl1 = LIS2DS12_CTRL1_AT(0);
+	if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL2, LIS2DS12_CTRL2_IF_ADD_INC) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL1, ucStreamCtrl1) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL3, LIS2DS12_CTRL3_LIR) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_WAKE_UP_THS, LIS2DS12_WAKE_THS) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_WAKE_UP_DUR, 0) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_THS, IMU_FIFO_WATERMARK) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL4, LIS2DS12_CTRL4_INT1_FTH) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return Lis2ds12RestartFifo();
+}
+
+/**
+ * @brief Reads FIFO_SRC and FIFO_SAMPLES in one transfer.
+ */
+BaseType_t Lis2ds12GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun)
+{
+	uint8_t ucSource[2];
+
+	if (ImuI2cRead(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_SRC, ucSource, sizeof(ucSource)) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	*pusSamples = ((ucSource[0] & LIS2DS12_FIFO_SRC_DIFF8) ? 256 : 0) + ucSource[1];
+	*pbOverrun = (ucSource[0] & LIS2DS12_FIFO_SRC_OVR) != 0;
+	return pdPASS;
+}
+
+/**
+ * @brief Reads the samples from OUT_X_L in one burst and unpacks them.
+ */
+BaseType_t Lis2ds12ReadFifo(ImuSample_t *pxSamples, uint16_t usCount)
+{
+	const uint8_t *pucRaw = ucRaw;
+
+	if (usCount == 0 || usCount > IMU_BLOCK_SAMPLES)
+	{
+		return pdFAIL;
+	}
+	// With the FIFO on, the read address wraps from OUT_Z_H back to OUT_X_L,
+	// so one read returns consecutive samples
+	if (ImuI2cRead(IMU_LIS2DS12_ADDRESS, LIS2DS12_OUT_X_L, ucRaw, usCount * LIS2DS12_SAMPLE_BYTES) != pdPASS)
+	{
+		return pdFAIL;
+	}
+
+	for (uint16_t i = 0; i < usCount; i++)
+	{
+		for (uint8_t ucAxis = 0; ucAxis < 3; ucAxis++, pucRaw += 2)
+		{
+			pxSamples[i].sAccelAux[ucAxis] = (int16_t)(pucRaw[0] | (pucRaw[1] << 8));
+		}
+	}
+	return pdPASS;
+}
+
+/**
+ * @brief Passes through bypass mode, which empties the FIFO, back to continuous mode.
+ */
+BaseType_t Lis2ds12RestartFifo(void)
+{
+	if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_CTRL, LIS2DS12_FIFO_BYPASS) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_CTRL, LIS2DS12_FIFO_CONTINUOUS);
+}
+
+/**
+ * @brief Writes the ODR and the FIFO threshold.
+ */
+BaseType_t Lis2ds12SetRate(int8_t cShift, uint16_t usWatermark)
+{
+	if (cShift < LIS2DS12_RATE_SHIFT_MIN || cShift > LIS2DS12_RATE_SHIFT_MAX || usWatermark == 0 || usWatermark > IMU_BLOCK_SAMPLES)
+	{
+		return pdFAIL;
+	}
+	ucStreamCtrl1 = LIS2DS12_CTRL1_AT(cShift);
+	if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL1, ucStreamCtrl1) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_THS, (uint8_t)usWatermark);
+}
+
+/**
+ * @brief Moves INT1 between the FIFO threshold and the wake-up, and the rate between streaming and low power.
+ */
+BaseType_t Lis2ds12SetWakeMode(bool bWake)
+{
+	bool bDiscard;
+
+	if (!bWake)
+	{
+		if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL4, LIS2DS12_CTRL4_INT1_FTH) != pdPASS)
+		{
+			return pdFAIL;
+		}
+		return ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL1, ucStreamCtrl1);
+	}
+
+	if (ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_FIFO_CTRL, LIS2DS12_FIFO_BYPASS) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL1, LIS2DS12_CTRL1_LP12HZ_2G_BDU) != pdPASS ||
+		ImuI2cWrite(IMU_LIS2DS12_ADDRESS, LIS2DS12_CTRL4, LIS2DS12_CTRL4_INT1_WU) != pdPASS)
+	{
+		return pdFAIL;
+	}
+
+	// The rate and range change is a step to the high-pass filter
+	vTaskDelay(pdMS_TO_TICKS(LIS2DS12_WAKE_SETTLE_MS));
+	return Lis2ds12GetWake(&bDiscard);
+}
+
+/**
+ * @brief Reading WAKE_UP_SRC releases the latch and INT1.
+ */
+BaseType_t Lis2ds12GetWake(bool *pbWoken)
+{
+	uint8_t ucSource;
+
+	if (ImuI2cRead(IMU_LIS2DS12_ADDRESS, LIS2DS12_WAKE_UP_SRC, &ucSource, 1) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	*pbWoken = (ucSource & LIS2DS12_WAKE_UP_SRC_WU_IA) != 0;
+	return pdPASS;
+}
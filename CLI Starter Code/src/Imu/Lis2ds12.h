@@ -0,0 +1,82 @@
+/**************************************************************************/ /**
+ * @file      Lis2ds12.h
+ * @brief     LIS2DS12 accelerometer on the IMU I2C bus, read through its FIFO.
+ * @details   The sensor runs at IMU_SAMPLE_HZ, +-16 g, into its 256-sample
+ *            FIFO in continuous mode. INT1 is high while the FIFO holds at
+ *            least IMU_FIFO_WATERMARK samples. Lis2ds12SetRate() changes both.
+ *
+ *            In wake mode it runs in low power at 12.5 Hz, +-2 g, with the
+ *            FIFO off. INT1 then latches high when the high-passed
+ *            acceleration exceeds IMU_WAKE_THRESHOLD_MG on any axis, until
+ *            Lis2ds12GetWake() reads the source.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef LIS2DS12_H
+#define LIS2DS12_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define LIS2DS12_RATE_SHIFT_MIN -3 ///< 12.5 Hz, the slowest high resolution rate
+#define LIS2DS12_RATE_SHIFT_MAX 3  ///< 800 Hz
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			BaseType_t Lis2ds12Init(void)
+ * @brief		Checks WHO_AM_I, resets the sensor and starts sampling into the FIFO
+ * @note		Blocks for the reset, a few milliseconds
+ * @return		pdFAIL if the sensor does not answer or is not a LIS2DS12
+ *****************************************************************************/
+BaseType_t Lis2ds12Init(void);
+
+/**
+ * @fn			BaseType_t Lis2ds12GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun)
+ * @brief		Reads the number of samples in the FIFO and whether it overran
+ *****************************************************************************/
+BaseType_t Lis2ds12GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun);
+
+/**
+ * @fn			BaseType_t Lis2ds12ReadFifo(ImuSample_t *pxSamples, uint16_t usCount)
+ * @brief		Reads usCount samples in one burst into the sAccelAux field of pxSamples
+ * @param[in]	usCount 1 to IMU_BLOCK_SAMPLES, at most the FIFO level
+ *****************************************************************************/
+BaseType_t Lis2ds12ReadFifo(ImuSample_t *pxSamples, uint16_t usCount);
+
+/**
+ * @fn			BaseType_t Lis2ds12RestartFifo(void)
+ * @brief		Empties the FIFO and clears its overrun flag
+ *****************************************************************************/
+BaseType_t Lis2ds12RestartFifo(void);
+
+/**
+ * @fn			BaseType_t Lis2ds12SetRate(int8_t cShift, uint16_t usWatermark)
+ * @brief		Sets the rate to IMU_RATE_HZ(cShift) and the FIFO threshold. The caller restarts the FIFO
+ * @param[in]	cShift LIS2DS12_RATE_SHIFT_MIN to LIS2DS12_RATE_SHIFT_MAX
+ *****************************************************************************/
+BaseType_t Lis2ds12SetRate(int8_t cShift, uint16_t usWatermark);
+
+/**
+ * @fn			BaseType_t Lis2ds12SetWakeMode(bool bWake)
+ * @brief		Switches between wake mode and streaming
+ * @details		Entering wake mode blocks while the high-pass filter settles
+ *				at the new rate, then clears the wake-up it may have latched.
+ *				Leaving it restores the last rate; the caller restarts the FIFO.
+ *****************************************************************************/
+BaseType_t Lis2ds12SetWakeMode(bool bWake);
+
+/**
+ * @fn			BaseType_t Lis2ds12GetWake(bool *pbWoken)
+ * @brief		Reads and clears the latched wake-up
+ * @param[out]	pbWoken Whether motion was seen since the last read
+ *****************************************************************************/
+BaseType_t Lis2ds12GetWake(bool *pbWoken);
+
+#endif /* LIS2DS12_H */
@@ -0,0 +1,213 @@
+/**************************************************************************/ /**
+ * @file      Mpu6000.c
+ * @brief     MPU6000 accelerometer and gyroscope on the IMU SPI bus. See Mpu6000.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Mpu6000.h"
+#include "ImuBus.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define MPU6000_SMPLRT_DIV 0x19
+#define MPU6000_CONFIG 0x1A
+#define MPU6000_GYRO_CONFIG 0x1B
+#define MPU6000_ACCEL_CONFIG 0x1C
+#define MPU6000_FIFO_EN 0x23
+#define MPU6000_INT_ENABLE 0x38
+#define MPU6000_INT_STATUS 0x3A
+#define MPU6000_SIGNAL_PATH_RESET 0x68
+#define MPU6000_USER_CTRL 0x6A
+#define MPU6000_PWR_MGMT_1 0x6B
+#define MPU6000_FIFO_COUNT_H 0x72 ///< Followed by FIFO_COUNT_L
+#define MPU6000_FIFO_R_W 0x74
+#define MPU6000_WHO_AM_I 0x75
+
+#define MPU6000_ID 0x68
+#define MPU6000_RATE_HZ 1000			   ///< Internal sample rate with the DLPF on
+#define MPU6000_GYRO_2000DPS 0x18
+#define MPU6000_ACCEL_16G 0x18
+#define MPU6000_FIFO_EN_ACCEL_GYRO 0x78	   ///< XG, YG, ZG and ACCEL
+#define MPU6000_INT_FIFO_OFLOW 0x10
+#define MPU6000_SIGNAL_PATH_RESET_ALL 0x07
+#define MPU6000_USER_CTRL_FIFO_EN 0x40
+#define MPU6000_USER_CTRL_I2C_IF_DIS 0x10  ///< SPI only
+#define MPU6000_USER_CTRL_FIFO_RESET 0x04
+#define MPU6000_PWR_MGMT_1_RESET 0x80
+#define MPU6000_PWR_MGMT_1_PLL_X 0x01	   ///< Clock from the X gyro PLL
+#define MPU6000_PWR_MGMT_1_SLEEP 0x40
+#define MPU6000_RESET_MS 100
+#define MPU6000_WAKE_MS 30				   ///< Gyroscope start-up, typical
+#define MPU6000_SAMPLE_BYTES 12
+
+#if IMU_SAMPLE_HZ != 100
+#error "The rate table is for IMU_SAMPLE_HZ of 100 Hz"
+#endif
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static int16_t prvBigEndian(const uint8_t *pucBytes);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint8_t ucRaw[IMU_BLOCK_SAMPLES * MPU6000_SAMPLE_BYTES]; ///< DMA destination of a FIFO burst
+
+/**
+ * SMPLRT_DIV and CONFIG at each rate shift from MPU6000_RATE_SHIFT_MIN,
+ * 12.5 to 200 Hz: MPU6000_RATE_HZ / rate - 1, and the DLPF with the widest
+ * bandwidth below the Nyquist frequency, 5, 10, 21, 44 and 94 Hz.
+ */
+static const uint8_t ucRates[MPU6000_RATE_SHIFT_MAX - MPU6000_RATE_SHIFT_MIN + 1][2] = {
+	{79, 0x06}, {39, 0x05}, {19, 0x04}, {9, 0x03}, {4, 0x02}};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Resets the sensor the way the datasheet asks for SPI, identifies and configures it.
+ */
+BaseType_t Mpu6000Init(void)
+{
+	uint8_t ucId = 0;
+
+	if (ImuSpiWrite(MPU6000_PWR_MGMT_1, MPU6000_PWR_MGMT_1_RESET) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	vTaskDelay(pdMS_TO_TICKS(MPU6000_RESET_MS));
+	if (ImuSpiWrite(MPU6000_SIGNAL_PATH_RESET, MPU6000_SIGNAL_PATH_RESET_ALL) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	vTaskDelay(pdMS_TO_TICKS(MPU6000_RESET_MS));
+
+	// The I2C interface is disabled first, before a stray edge on CS can select it
+	if (ImuSpiWrite(MPU6000_USER_CTRL, MPU6000_USER_CTRL_I2C_IF_DIS) != pdPASS ||
+		ImuSpiRead(MPU6000_WHO_AM_I, &ucId, 1) != pdPASS || ucId != MPU6000_ID)
+	{
+		return pdFAIL;
+	}
+
+	if (ImuSpiWrite(MPU6000_PWR_MGMT_1, MPU6000_PWR_MGMT_1_PLL_X) != pdPASS ||
+		Mpu6000SetRate(0) != pdPASS ||
+		ImuSpiWrite(MPU6000_GYRO_CONFIG, MPU6000_GYRO_2000DPS) != pdPASS ||
+		ImuSpiWrite(MPU6000_ACCEL_CONFIG, MPU6000_ACCEL_16G) != pdPASS ||
+		ImuSpiWrite(MPU6000_INT_ENABLE, MPU6000_INT_FIFO_OFLOW) != pdPASS ||
+		ImuSpiWrite(MPU6000_FIFO_EN, MPU6000_FIFO_EN_ACCEL_GYRO) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return Mpu6000RestartFifo();
+}
+
+/**
+ * @brief Reads INT_STATUS, which clears the overflow flag, and FIFO_COUNT.
+ */
+BaseType_t Mpu6000GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun)
+{
+	uint8_t ucStatus;
+	uint8_t ucCount[2];
+
+	if (ImuSpiRead(MPU6000_INT_STATUS, &ucStatus, 1) != pdPASS ||
+		ImuSpiRead(MPU6000_FIFO_COUNT_H, ucCount, sizeof(ucCount)) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	*pusSamples = (uint16_t)prvBigEndian(ucCount) / MPU6000_SAMPLE_BYTES;
+	*pbOverrun = (ucStatus & MPU6000_INT_FIFO_OFLOW) != 0;
+	return pdPASS;
+}
+
+/**
+ * @brief Reads the samples from FIFO_R_W in one burst and unpacks them.
+ */
+BaseType_t Mpu6000ReadFifo(ImuSample_t *pxSamples, uint16_t usCount)
+{
+	const uint8_t *pucRaw = ucRaw;
+
+	if (usCount == 0 || usCount > IMU_BLOCK_SAMPLES)
+	{
+		return pdFAIL;
+	}
+	if (ImuSpiRead(MPU6000_FIFO_R_W, ucRaw, usCount * MPU6000_SAMPLE_BYTES) != pdPASS)
+	{
+		return pdFAIL;
+	}
+
+	for (uint16_t i = 0; i < usCount; i++)
+	{
+		for (uint8_t ucAxis = 0; ucAxis < 3; ucAxis++, pucRaw += 2)
+		{
+			pxSamples[i].sAccel[ucAxis] = prvBigEndian(pucRaw);
+		}
+		for (uint8_t ucAxis = 0; ucAxis < 3; ucAxis++, pucRaw += 2)
+		{
+			pxSamples[i].sGyro[ucAxis] = prvBigEndian(pucRaw);
+		}
+	}
+	return pdPASS;
+}
+
+/**
+ * @brief Resets and re-enables the FIFO.
+ */
+BaseType_t Mpu6000RestartFifo(void)
+{
+	if (ImuSpiWrite(MPU6000_USER_CTRL, MPU6000_USER_CTRL_I2C_IF_DIS | MPU6000_USER_CTRL_FIFO_RESET) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return ImuSpiWrite(MPU6000_USER_CTRL, MPU6000_USER_CTRL_I2C_IF_DIS | MPU6000_USER_CTRL_FIFO_EN);
+}
+
+/**
+ * @brief Writes the divider of the 1 kHz internal rate, then the DLPF for the new rate.
+ */
+BaseType_t Mpu6000SetRate(int8_t cShift)
+{
+	if (cShift < MPU6000_RATE_SHIFT_MIN || cShift > MPU6000_RATE_SHIFT_MAX)
+	{
+		return pdFAIL;
+	}
+	if (ImuSpiWrite(MPU6000_SMPLRT_DIV, ucRates[cShift - MPU6000_RATE_SHIFT_MIN][0]) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	return ImuSpiWrite(MPU6000_CONFIG, ucRates[cShift - MPU6000_RATE_SHIFT_MIN][1]);
+}
+
+/**
+ * @brief Sets PWR_MGMT_1.SLEEP, keeping the PLL clock selected.
+ */
+BaseType_t Mpu6000SetSleep(bool bSleep)
+{
+	if (ImuSpiWrite(MPU6000_PWR_MGMT_1, MPU6000_PWR_MGMT_1_PLL_X | (bSleep ? MPU6000_PWR_MGMT_1_SLEEP : 0)) != pdPASS)
+	{
+		return pdFAIL;
+	}
+	if (!bSleep)
+	{
+		vTaskDelay(pdMS_TO_TICKS(MPU6000_WAKE_MS));
+	}
+	return pdPASS;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static int16_t prvBigEndian(const uint8_t *pucBytes)
+ * @brief		Joins a high and a low register byte
+ *****************************************************************************/
+static int16_t prvBigEndian(const uint8_t *pucBytes)
+{
+	return (int16_t)((pucBytes[0] << 8) | pucBytes[1]);
+}
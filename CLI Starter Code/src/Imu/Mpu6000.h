@@ -0,0 +1,78 @@
+/**************************************************************************/ /**
+ * @file      Mpu6000.h
+ * @brief     MPU6000 accelerometer and gyroscope on the IMU SPI bus, read
+ *            through its FIFO.
+ * @details   The sensor runs at IMU_SAMPLE_HZ, +-16 g and +-2000 dps, and
+ *            writes accelerometer then gyroscope (12 bytes) per sample into
+ *            its 1024-byte FIFO, about 85 samples. It has no FIFO threshold
+ *            interrupt; the IMU task reads it when the LIS2DS12 reaches its
+ *            watermark.
+ *
+ *            Mpu6000SetRate() moves it to the other rates of the IMU task, each
+ *            with a DLPF cut-off below its Nyquist frequency.
+ *
+ *            Between streams it sleeps at about 5 uA instead of 3.8 mA, keeping
+ *            its configuration.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef MPU6000_H
+#define MPU6000_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define MPU6000_RATE_SHIFT_MIN -3 ///< 12.5 Hz
+#define MPU6000_RATE_SHIFT_MAX 1  ///< 200 Hz. The 1 kHz internal rate does not divide to 400 Hz
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			BaseType_t Mpu6000Init(void)
+ * @brief		Resets the sensor, checks WHO_AM_I and starts sampling into the FIFO
+ * @note		Blocks for the reset, about 200 ms
+ * @return		pdFAIL if the sensor does not answer or is not an MPU6000
+ *****************************************************************************/
+BaseType_t Mpu6000Init(void);
+
+/**
+ * @fn			BaseType_t Mpu6000GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun)
+ * @brief		Reads the number of whole samples in the FIFO and whether it overran
+ * @details		An overrun leaves the FIFO misaligned; restart it before reading
+ *****************************************************************************/
+BaseType_t Mpu6000GetFifoLevel(uint16_t *pusSamples, bool *pbOverrun);
+
+/**
+ * @fn			BaseType_t Mpu6000ReadFifo(ImuSample_t *pxSamples, uint16_t usCount)
+ * @brief		Reads usCount samples in one burst into the sAccel and sGyro fields of pxSamples
+ * @param[in]	usCount 1 to IMU_BLOCK_SAMPLES, at most the FIFO level
+ *****************************************************************************/
+BaseType_t Mpu6000ReadFifo(ImuSample_t *pxSamples, uint16_t usCount);
+
+/**
+ * @fn			BaseType_t Mpu6000RestartFifo(void)
+ * @brief		Empties the FIFO. Sampling into it continues
+ *****************************************************************************/
+BaseType_t Mpu6000RestartFifo(void);
+
+/**
+ * @fn			BaseType_t Mpu6000SetRate(int8_t cShift)
+ * @brief		Sets the rate to IMU_RATE_HZ(cShift). The caller restarts the FIFO
+ * @param[in]	cShift MPU6000_RATE_SHIFT_MIN to MPU6000_RATE_SHIFT_MAX
+ *****************************************************************************/
+BaseType_t Mpu6000SetRate(int8_t cShift);
+
+/**
+ * @fn			BaseType_t Mpu6000SetSleep(bool bSleep)
+ * @brief		Stops or restarts the sensor. The caller restarts the FIFO after waking it
+ * @note		Waking blocks for the gyroscope start-up, MPU6000_WAKE_MS
+ *****************************************************************************/
+BaseType_t Mpu6000SetSleep(bool bSleep);
+
+#endif /* MPU6000_H */
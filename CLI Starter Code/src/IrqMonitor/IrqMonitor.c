@@ -0,0 +1,160 @@
+/**************************************************************************/ /**
+ * @file      IrqMonitor.c
+ * @brief     Interrupt latency and duration statistics. See IrqMonitor.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "IrqMonitor.h"
+#include "conf_ramfunc.h"
+#include <string.h>
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef struct
+{
+	const char *const pcName;
+	const IRQn_Type eIrqn;
+	IrqHistogram_t xLatency;
+	IrqHistogram_t xDuration;
+} IrqMonitor_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+RAMFUNC_HOT static void prvAdd(IrqHistogram_t *pxHistogram, uint32_t ulCycles);
+static void prvClear(IrqHistogram_t *pxHistogram);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static IrqMonitor_t xMonitors[N_IRQ_MONITORS] = {
+	[IRQ_MONITOR_CYCLE_COUNTER] = {"tc3", TC3_IRQn},
+	[IRQ_MONITOR_CONSOLE_RX] = {"uart_rx", SERCOM4_IRQn},
+	[IRQ_MONITOR_CONSOLE_TX] = {"uart_tx", SERCOM4_IRQn},
+	[IRQ_MONITOR_EIC] = {"eic", EIC_IRQn},
+	[IRQ_MONITOR_DMAC] = {"dmac", DMAC_IRQn},
+};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Adds one handler run.
+ */
+RAMFUNC_HOT void IrqMonitorRecord(enum eIrqMonitors eMonitor, uint32_t ulLatency, uint32_t ulDuration)
+{
+	if (eMonitor >= N_IRQ_MONITORS)
+	{
+		return;
+	}
+
+	if (ulLatency != IRQ_MONITOR_NO_LATENCY)
+	{
+		prvAdd(&xMonitors[eMonitor].xLatency, ulLatency);
+	}
+	prvAdd(&xMonitors[eMonitor].xDuration, ulDuration);
+}
+
+/**
+ * @brief Copies the statistics of one interrupt.
+ */
+void IrqMonitorGet(enum eIrqMonitors eMonitor, IrqHistogram_t *pxLatency, IrqHistogram_t *pxDuration)
+{
+	if (eMonitor >= N_IRQ_MONITORS)
+	{
+		return;
+	}
+
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	*pxLatency = xMonitors[eMonitor].xLatency;
+	*pxDuration = xMonitors[eMonitor].xDuration;
+
+	__set_PRIMASK(ulPrimask);
+}
+
+/**
+ * @brief Clears the statistics of every interrupt.
+ */
+void IrqMonitorReset(void)
+{
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	for (uint32_t i = 0; i < N_IRQ_MONITORS; i++)
+	{
+		prvClear(&xMonitors[i].xLatency);
+		prvClear(&xMonitors[i].xDuration);
+	}
+
+	__set_PRIMASK(ulPrimask);
+}
+
+/**
+ * @brief Returns the name used by the "irq" command.
+ */
+const char *IrqMonitorGetName(enum eIrqMonitors eMonitor)
+{
+	return (eMonitor < N_IRQ_MONITORS) ? xMonitors[eMonitor].pcName : "?";
+}
+
+/**
+ * @brief Returns the current NVIC priority of the interrupt.
+ */
+uint32_t IrqMonitorGetPriority(enum eIrqMonitors eMonitor)
+{
+	return (eMonitor < N_IRQ_MONITORS) ? NVIC_GetPriority(xMonitors[eMonitor].eIrqn) : 0;
+}
+
+/**
+ * @brief Returns the smallest cycle count that falls in a bucket.
+ */
+uint32_t IrqMonitorBucketFloor(uint32_t ulBucket)
+{
+	return (ulBucket == 0) ? 0 : (1UL << ulBucket);
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvAdd(IrqHistogram_t *pxHistogram, uint32_t ulCycles)
+ * @brief		Adds one sample. The bucket is found with a shift loop, the
+ *				Cortex-M0+ has no CLZ instruction
+ *****************************************************************************/
+static void prvAdd(IrqHistogram_t *pxHistogram, uint32_t ulCycles)
+{
+	uint32_t ulBucket = 0;
+
+	for (uint32_t ulRest = ulCycles >> 1; ulRest != 0 && ulBucket < IRQ_MONITOR_BUCKETS - 1; ulRest >>= 1)
+	{
+		ulBucket++;
+	}
+
+	if (pxHistogram->ulCount == 0 || ulCycles < pxHistogram->ulMin)
+	{
+		pxHistogram->ulMin = ulCycles;
+	}
+	if (ulCycles > pxHistogram->ulMax)
+	{
+		pxHistogram->ulMax = ulCycles;
+	}
+	pxHistogram->ulBuckets[ulBucket]++;
+	pxHistogram->ulCount++;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvClear(IrqHistogram_t *pxHistogram)
+ * @brief		Empties a histogram
+ *****************************************************************************/
+static void prvClear(IrqHistogram_t *pxHistogram)
+{
+	memset(pxHistogram, 0, sizeof(*pxHistogram));
+}
@@ -0,0 +1,105 @@
+/**************************************************************************/ /**
+ * @file      IrqMonitor.h
+ * @brief     Interrupt latency and duration statistics. Monitored handlers
+ *            report how long their interrupt waited before the handler ran and
+ *            how long the handler took, both in CPU cycles. Each interrupt keeps
+ *            a count, min/max and a log2 histogram of both, shown by the "irq"
+ *            command.
+ * @details   Latency needs a timestamp of the hardware event, which only the
+ *            cycle counter has: TC3 counts CPU cycles from 0 after it overflows,
+ *            so COUNT read at handler entry is exactly the cycles since its
+ *            interrupt was raised. TC3 runs at the highest priority, so its
+ *            latency histogram shows how long interrupts are masked (critical
+ *            sections, PRIMASK) anywhere in the system. SERCOM and EIC have no
+ *            such timestamp and report duration only, measured from the top of
+ *            the handler or callback.
+ *
+ *            Each monitor is written from a single priority level, so recording
+ *            needs no interrupt mask.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef IRQMONITOR_H
+#define IRQMONITOR_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IRQ_MONITOR_BUCKETS 16				///< Bucket n counts [2^n, 2^(n+1)) cycles, bucket 0 also 0, the last everything above
+#define IRQ_MONITOR_NO_LATENCY UINT32_MAX	///< Passed as latency by handlers without a hardware event timestamp
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Monitored interrupts.
+ */
+enum eIrqMonitors
+{
+	IRQ_MONITOR_CYCLE_COUNTER = 0, ///< TC3 overflow
+	IRQ_MONITOR_CONSOLE_RX,		   ///< SERCOM4 receive complete callback
+	IRQ_MONITOR_CONSOLE_TX,		   ///< SERCOM4 transmit complete callback
+	IRQ_MONITOR_EIC,			   ///< EIC handler
+	IRQ_MONITOR_DMAC,			   ///< DMAC handler
+	N_IRQ_MONITORS
+};
+
+/**
+ * @brief Statistics of one quantity (latency or duration) of one interrupt.
+ */
+typedef struct
+{
+	uint32_t ulCount;
+	uint32_t ulMin; ///< Cycles. ulMin and ulMax are 0 while ulCount is 0
+	uint32_t ulMax; ///< Cycles
+	uint32_t ulBuckets[IRQ_MONITOR_BUCKETS];
+} IrqHistogram_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void IrqMonitorRecord(enum eIrqMonitors eMonitor, uint32_t ulLatency, uint32_t ulDuration)
+ * @brief		Adds one handler run. Call at the end of the handler
+ * @param		eMonitor Interrupt that ran
+ * @param		ulLatency Cycles from the hardware event to handler entry, or IRQ_MONITOR_NO_LATENCY
+ * @param		ulDuration Cycles from handler entry to this call
+ *****************************************************************************/
+void IrqMonitorRecord(enum eIrqMonitors eMonitor, uint32_t ulLatency, uint32_t ulDuration);
+
+/**
+ * @fn			void IrqMonitorGet(enum eIrqMonitors eMonitor, IrqHistogram_t *pxLatency, IrqHistogram_t *pxDuration)
+ * @brief		Copies the statistics of one interrupt
+ *****************************************************************************/
+void IrqMonitorGet(enum eIrqMonitors eMonitor, IrqHistogram_t *pxLatency, IrqHistogram_t *pxDuration);
+
+/**
+ * @fn			void IrqMonitorReset(void)
+ * @brief		Clears the statistics of every interrupt
+ *****************************************************************************/
+void IrqMonitorReset(void);
+
+/**
+ * @fn			const char *IrqMonitorGetName(enum eIrqMonitors eMonitor)
+ * @brief		Returns the name used by the "irq" command
+ *****************************************************************************/
+const char *IrqMonitorGetName(enum eIrqMonitors eMonitor);
+
+/**
+ * @fn			uint32_t IrqMonitorGetPriority(enum eIrqMonitors eMonitor)
+ * @brief		Returns the NVIC priority the interrupt currently has
+ *****************************************************************************/
+uint32_t IrqMonitorGetPriority(enum eIrqMonitors eMonitor);
+
+/**
+ * @fn			uint32_t IrqMonitorBucketFloor(uint32_t ulBucket)
+ * @brief		Returns the smallest cycle count that falls in a bucket
+ *****************************************************************************/
+uint32_t IrqMonitorBucketFloor(uint32_t ulBucket);
+
+#endif /* IRQMONITOR_H */
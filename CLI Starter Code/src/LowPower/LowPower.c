@@ -0,0 +1,385 @@
+/**************************************************************************/ /**
+ * @file      LowPower.c
+ * @brief     Tickless idle with RTC wakeup. See LowPower.h.
+ * @details   Time is converted between SysTick cycles, RTC counts and ticks in
+ *            "units" of 1/(LOWPOWER_RTC_HZ * configTICK_RATE_HZ) s: one tick is
+ *            LOWPOWER_RTC_HZ units and one RTC count is configTICK_RATE_HZ units,
+ *            so neither conversion rounds.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "LowPower.h"
+#include "SerialConsole/SerialConsole.h"
+#include "ExtInt/ExtInt.h"
+#include "conf_irq_priorities.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define LOWPOWER_IDLE_SLEEPMODE SYSTEM_SLEEPMODE_IDLE_2		 ///< Sleep mode used for SLEEP_STATE_IDLE
+#define LOWPOWER_MIN_SLEEP_COUNTS 8							 ///< Shorter sleeps are skipped. Covers the RTC COMP write synchronization
+#define LOWPOWER_STANDBY_WAKE_COUNTS 33						 ///< Wake this early from STANDBY (about 1 ms) to allow for the DFLL restart
+#define LOWPOWER_MIN_SYSTICK_CYCLES 64						 ///< Shortest SysTick period programmed after a sleep
+#define LOWPOWER_WAKE_PINMUX PINMUX_PB11A_EIC_EXTINT11		 ///< Console RX pin (EDBG_CDC_SERCOM_PINMUX_PAD3) in its EIC function
+#define LOWPOWER_WAKE_EXTINT 11								 ///< EXTINT line of LOWPOWER_WAKE_PINMUX
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static enum eSleepStates prvChooseSleepState(TickType_t xExpectedIdleTime);
+static uint32_t prvReadRtc(bool bResync);
+static void prvArmConsoleWake(void);
+static bool prvDisarmConsoleWake(void);
+static void prvConsoleWake(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static const char *const pcStateNames[N_SLEEP_STATES] =
+{
+	[SLEEP_STATE_RUN] = "run",
+	[SLEEP_STATE_IDLE] = "idle",
+	[SLEEP_STATE_STANDBY] = "standby",
+};
+
+static bool bReady = false;					///< Set by LowPowerInit(). Ticks run normally until then
+static volatile TickType_t xLastActivity = 0; ///< Tick count of the last LowPowerNotifyActivity()
+static LowPowerStats_t xStats;				///< RUN is not accumulated, it is the remainder of ullTotalCounts
+static uint32_t ulStatsLastRtc;				///< RTC count up to which xStats.ullTotalCounts is accumulated
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Starts the RTC and sets up the STANDBY wake line.
+ */
+void LowPowerInit(void)
+{
+	struct system_gclk_chan_config gclkConfig;
+
+	system_gclk_chan_get_config_defaults(&gclkConfig);
+	gclkConfig.source_generator = GCLK_GENERATOR_1;
+
+	// RTC: 32-bit counter at 32.768 kHz, compare 0 wakes the CPU
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_RTC);
+	system_gclk_chan_set_config(RTC_GCLK_ID, &gclkConfig);
+	system_gclk_chan_enable(RTC_GCLK_ID);
+
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_SWRST;
+	while ((RTC->MODE0.CTRL.reg & RTC_MODE0_CTRL_SWRST) || (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY))
+		;
+
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1;
+	RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ | RTC_READREQ_RCONT | RTC_READREQ_ADDR(RTC_MODE0_COUNT_OFFSET);
+	NVIC_SetPriority(RTC_IRQn, IRQ_PRIORITY_RTC);
+	NVIC_EnableIRQ(RTC_IRQn);
+
+	RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+	while (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY)
+		;
+
+	// Low level on the console RX line wakes from STANDBY. The interrupt is only enabled while asleep
+	ExtIntConfigure(LOWPOWER_WAKE_EXTINT, EXTINT_SENSE_LOW, true, prvConsoleWake, NULL);
+
+	ulStatsLastRtc = prvReadRtc(true);
+	bReady = true;
+}
+
+/**
+ * @brief Restarts the inactivity timer.
+ */
+void LowPowerNotifyActivity(void)
+{
+	xLastActivity = xTaskGetTickCount();
+}
+
+/**
+ * @brief Copies the sleep statistics.
+ */
+void LowPowerGetStats(LowPowerStats_t *pxStats)
+{
+	uint32_t ulNow;
+
+	taskENTER_CRITICAL();
+
+	if (bReady)
+	{
+		ulNow = prvReadRtc(false);
+		xStats.ullTotalCounts += ulNow - ulStatsLastRtc;
+		ulStatsLastRtc = ulNow;
+	}
+
+	*pxStats = xStats;
+
+	taskEXIT_CRITICAL();
+
+	pxStats->ullStateCounts[SLEEP_STATE_RUN] = pxStats->ullTotalCounts - pxStats->ullStateCounts[SLEEP_STATE_IDLE] -
+											   pxStats->ullStateCounts[SLEEP_STATE_STANDBY];
+}
+
+/**
+ * @brief Clears the sleep statistics.
+ */
+void LowPowerResetStats(void)
+{
+	taskENTER_CRITICAL();
+
+	memset(&xStats, 0, sizeof(xStats));
+	if (bReady)
+	{
+		ulStatsLastRtc = prvReadRtc(false);
+	}
+
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Returns the name of a sleep state.
+ */
+const char *LowPowerGetStateName(enum eSleepStates eState)
+{
+	if (eState >= N_SLEEP_STATES)
+	{
+		return NULL;
+	}
+
+	return pcStateNames[eState];
+}
+
+/**
+ * @brief Sleeps for up to xExpectedIdleTime ticks and steps the tick count by the time slept.
+ */
+void vLowPowerSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+	enum eSleepStates eState;
+	uint32_t ulTickCycles, ulUnitsIntoTick, ulSleepCounts;
+	uint32_t ulRtcStart, ulRtcEnd, ulUnits, ulCompleteTicks, ulCyclesLeft;
+	bool bConsoleWake = false;
+
+	if (!bReady)
+	{
+		return;
+	}
+
+	if (xExpectedIdleTime > LOWPOWER_MAX_SUPPRESSED_TICKS)
+	{
+		xExpectedIdleTime = LOWPOWER_MAX_SUPPRESSED_TICKS;
+	}
+
+	eState = prvChooseSleepState(xExpectedIdleTime);
+
+	// Interrupts stay masked until the tick count is corrected. A pending interrupt still ends WFI
+	portDISABLE_INTERRUPTS();
+	__DSB();
+	__ISB();
+
+	if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+	{
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	// Freeze SysTick. A tick that has already elapsed is left to the tick interrupt
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+	{
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	// Part of the current tick already gone. Fits 32 bits for CPU clocks up to 131 MHz
+	ulTickCycles = SysTick->LOAD + 1UL;
+	ulUnitsIntoTick = ((ulTickCycles - 1UL - SysTick->VAL) * LOWPOWER_RTC_HZ) / ulTickCycles;
+
+	// Wake at the start of the tick the kernel is waiting for
+	ulSleepCounts = ((xExpectedIdleTime * LOWPOWER_RTC_HZ) - ulUnitsIntoTick) / configTICK_RATE_HZ;
+	if (eState == SLEEP_STATE_STANDBY)
+	{
+		ulSleepCounts -= LOWPOWER_STANDBY_WAKE_COUNTS;
+	}
+
+	if (ulSleepCounts < LOWPOWER_MIN_SLEEP_COUNTS)
+	{
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	// The COMP write synchronizes in a few RTC counts, well before the compare is due
+	ulRtcStart = prvReadRtc(false);
+	RTC->MODE0.COMP[0].reg = ulRtcStart + ulSleepCounts;
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_CMP0;
+
+	if (eState == SLEEP_STATE_STANDBY)
+	{
+		prvArmConsoleWake();
+		system_set_sleepmode(SYSTEM_SLEEPMODE_STANDBY);
+	}
+	else
+	{
+		system_set_sleepmode(LOWPOWER_IDLE_SLEEPMODE);
+	}
+
+	system_sleep();
+
+	if (eState == SLEEP_STATE_STANDBY)
+	{
+		bConsoleWake = prvDisarmConsoleWake();
+	}
+
+	RTC->MODE0.INTENCLR.reg = RTC_MODE0_INTENCLR_CMP0;
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	NVIC_ClearPendingIRQ(RTC_IRQn);
+
+	// Continuous read synchronization does not run in STANDBY, so the first value after it is stale
+	ulRtcEnd = prvReadRtc(eState == SLEEP_STATE_STANDBY);
+
+	xStats.ullTotalCounts += ulRtcEnd - ulStatsLastRtc;
+	xStats.ullStateCounts[eState] += ulRtcEnd - ulRtcStart;
+	xStats.ulEntries[eState]++;
+	ulStatsLastRtc = ulRtcEnd;
+
+	// Whatever woke the CPU, the RTC says how long it slept
+	ulUnits = ulUnitsIntoTick + (ulRtcEnd - ulRtcStart) * configTICK_RATE_HZ;
+	ulCompleteTicks = ulUnits / LOWPOWER_RTC_HZ;
+	ulUnitsIntoTick = ulUnits % LOWPOWER_RTC_HZ;
+
+	if (ulCompleteTicks >= xExpectedIdleTime)
+	{
+		// The tick that unblocks a task must come from the tick interrupt, so let it
+		// fire straight away. Only a late wake lands here, and its overshoot is dropped
+		if (ulCompleteTicks > xExpectedIdleTime)
+		{
+			xStats.ulLateWakes++;
+			xStats.ulDroppedTicks += ulCompleteTicks - xExpectedIdleTime;
+		}
+		ulCompleteTicks = xExpectedIdleTime - 1UL;
+		ulCyclesLeft = LOWPOWER_MIN_SYSTICK_CYCLES;
+	}
+	else
+	{
+		ulCyclesLeft = ((LOWPOWER_RTC_HZ - ulUnitsIntoTick) * ulTickCycles) / LOWPOWER_RTC_HZ;
+		if (ulCyclesLeft < LOWPOWER_MIN_SYSTICK_CYCLES)
+		{
+			ulCyclesLeft = LOWPOWER_MIN_SYSTICK_CYCLES;
+		}
+	}
+
+	// Finish the current tick, then reload at the normal period
+	SysTick->LOAD = ulCyclesLeft - 1UL;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = ulTickCycles - 1UL;
+
+	vTaskStepTick(ulCompleteTicks);
+
+	if (bConsoleWake)
+	{
+		// Someone is typing, stay out of STANDBY so the console keeps receiving
+		xLastActivity = xTaskGetTickCount();
+	}
+
+	portENABLE_INTERRUPTS();
+}
+
+/**
+ * @brief RTC interrupt. Compare 0 only wakes the CPU and is normally cleared by
+ *        vLowPowerSuppressTicksAndSleep before interrupts are unmasked.
+ */
+void RTC_Handler(void)
+{
+	RTC->MODE0.INTENCLR.reg = RTC_MODE0_INTENCLR_CMP0;
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_MASK;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static enum eSleepStates prvChooseSleepState(TickType_t xExpectedIdleTime)
+ * @brief		Picks STANDBY for long idle periods once the console has gone quiet
+ *				and has nothing left to send, IDLE otherwise
+ *****************************************************************************/
+static enum eSleepStates prvChooseSleepState(TickType_t xExpectedIdleTime)
+{
+	if (xExpectedIdleTime >= pdMS_TO_TICKS(LOWPOWER_STANDBY_MIN_MS) &&
+		(xTaskGetTickCount() - xLastActivity) >= pdMS_TO_TICKS(LOWPOWER_INACTIVITY_MS) && SerialConsoleIsTxIdle())
+	{
+		return SLEEP_STATE_STANDBY;
+	}
+
+	return SLEEP_STATE_IDLE;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvReadRtc(bool bResync)
+ * @brief		Reads the RTC counter
+ * @param[in]	bResync Request a fresh read and wait for it (a few RTC counts).
+ *				Otherwise the continuously synchronized value is returned at once
+ *****************************************************************************/
+static uint32_t prvReadRtc(bool bResync)
+{
+	if (bResync)
+	{
+		RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ | RTC_READREQ_RCONT | RTC_READREQ_ADDR(RTC_MODE0_COUNT_OFFSET);
+		while (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY)
+			;
+	}
+
+	return RTC->MODE0.COUNT.reg;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvArmConsoleWake(void)
+ * @brief		Hands the console RX pin from SERCOM to the EIC and enables its
+ *				wake interrupt
+ *****************************************************************************/
+static void prvArmConsoleWake(void)
+{
+	struct system_pinmux_config xPinConfig;
+
+	system_pinmux_get_config_defaults(&xPinConfig);
+	xPinConfig.mux_position = LOWPOWER_WAKE_PINMUX & 0xFFFF;
+	system_pinmux_pin_set_config(LOWPOWER_WAKE_PINMUX >> 16, &xPinConfig);
+
+	ExtIntEnable(LOWPOWER_WAKE_EXTINT);
+}
+
+/**************************************************************************/ /**
+ * @fn			static bool prvDisarmConsoleWake(void)
+ * @brief		Disables the wake interrupt and gives the RX pin back to SERCOM
+ * @return		true if the console line woke the device
+ *****************************************************************************/
+static bool prvDisarmConsoleWake(void)
+{
+	struct system_pinmux_config xPinConfig;
+	bool bWoke;
+
+	// EIC_Handler may still run for it once interrupts are unmasked, and finds no flag
+	bWoke = ExtIntDisable(LOWPOWER_WAKE_EXTINT);
+
+	system_pinmux_get_config_defaults(&xPinConfig);
+	xPinConfig.mux_position = EDBG_CDC_SERCOM_PINMUX_PAD3 & 0xFFFF;
+	system_pinmux_pin_set_config(EDBG_CDC_SERCOM_PINMUX_PAD3 >> 16, &xPinConfig);
+
+	return bWoke;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvConsoleWake(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken)
+ * @brief		EIC callback of the wake line. Normally the line is disarmed
+ *				before interrupts are unmasked and this does not run; if it does,
+ *				the level interrupt is switched off so it cannot fire again
+ *****************************************************************************/
+static void prvConsoleWake(void *pvContext, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	ExtIntDisable(LOWPOWER_WAKE_EXTINT);
+}
@@ -0,0 +1,110 @@
+/**************************************************************************/ /**
+ * @file      LowPower.h
+ * @brief     Tickless idle. When every task is blocked, the idle task stops
+ *            SysTick and sleeps until the next task is due, timed by the RTC
+ *            running from the 32.768 kHz crystal (GCLK1).
+ * @details   --IDLE (IDLE2): CPU, AHB and APB clocks stopped. Peripherals clocked
+ *              from a GCLK keep running, so console RX wakes the CPU as usual.
+ *              Used for short idle periods and while the console is in use
+ *            --STANDBY: every clock but the 32 kHz crystal is stopped. Used when
+ *              the idle period is at least LOWPOWER_STANDBY_MIN_MS, the console
+ *              has been quiet for LOWPOWER_INACTIVITY_MS and nothing is left to
+ *              transmit. The console RX pin is moved to the EIC for the sleep, so
+ *              a key press wakes the device. That first character is lost.
+ *              The IMU wake-up interrupt also wakes it (see Imu.h).
+ *            The RTC counts the time actually slept, whatever woke the CPU, and
+ *            the kernel tick count is stepped by it. The fraction of a tick left
+ *            over is carried into the restarted SysTick.
+ *            A wake more than a tick after the one the kernel was waiting for
+ *            (an interrupt held the CPU, or STANDBY was slow to wake from) steps
+ *            the count only to that tick, since the tick interrupt must be the
+ *            one that unblocks the task. The whole ticks overslept are lost to
+ *            the tick count and counted in ulDroppedTicks.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define LOWPOWER_RTC_HZ 32768UL				///< RTC count rate, GCLK1 undivided
+#define LOWPOWER_STANDBY_MIN_MS 100			///< Shortest idle period worth the STANDBY wake up cost
+#define LOWPOWER_INACTIVITY_MS 30000		///< Console silence before STANDBY is allowed (SRS: sleep after 30 s)
+#define LOWPOWER_MAX_SUPPRESSED_TICKS 60000 ///< Longest single sleep. Keeps the tick/RTC conversions within 32 bits
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+enum eSleepStates
+{
+	SLEEP_STATE_RUN = 0,	 ///< CPU running, including the idle task when it does not sleep
+	SLEEP_STATE_IDLE = 1,	 ///< IDLE2 sleep
+	SLEEP_STATE_STANDBY = 2, ///< STANDBY sleep
+	N_SLEEP_STATES = 3		 ///< Number of sleep states
+};
+
+/**
+ * @brief Time spent in each state since boot or the last LowPowerResetStats(),
+ *        in RTC counts (1/LOWPOWER_RTC_HZ s).
+ */
+typedef struct
+{
+	uint64_t ullTotalCounts;
+	uint64_t ullStateCounts[N_SLEEP_STATES];
+	uint32_t ulEntries[N_SLEEP_STATES]; ///< Number of sleeps. Not counted for SLEEP_STATE_RUN
+	uint32_t ulLateWakes;				///< Sleeps that ended after the expected tick
+	uint32_t ulDroppedTicks;			///< Whole ticks those overslept, missing from the tick count
+} LowPowerStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void LowPowerInit(void)
+ * @brief		Starts the RTC as a free running 32-bit counter and sets up the EIC
+ *				line used to wake from STANDBY. Ticks are not suppressed until this
+ *				has run
+ * @note		Call once from the daemon task startup hook, after ExtIntInit()
+ *****************************************************************************/
+void LowPowerInit(void);
+
+/**
+ * @fn			void LowPowerNotifyActivity(void)
+ * @brief		Restarts the inactivity timer that keeps the device out of STANDBY
+ * @note		Call from a task whenever the user interacts with the device
+ *****************************************************************************/
+void LowPowerNotifyActivity(void);
+
+/**
+ * @fn			void LowPowerGetStats(LowPowerStats_t *pxStats)
+ * @brief		Copies the sleep statistics, with the time up to now counted as RUN
+ *****************************************************************************/
+void LowPowerGetStats(LowPowerStats_t *pxStats);
+
+/**
+ * @fn			void LowPowerResetStats(void)
+ * @brief		Clears the sleep statistics
+ *****************************************************************************/
+void LowPowerResetStats(void);
+
+/**
+ * @fn			const char *LowPowerGetStateName(enum eSleepStates eState)
+ * @brief		Returns "run", "idle" or "standby", or NULL for an invalid state
+ *****************************************************************************/
+const char *LowPowerGetStateName(enum eSleepStates eState);
+
+/**
+ * @fn			void vLowPowerSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+ * @brief		portSUPPRESS_TICKS_AND_SLEEP implementation, called by the idle task
+ *				with the scheduler suspended. See FreeRTOSConfig.h
+ *****************************************************************************/
+void vLowPowerSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+
+#endif /* LOW_POWER_H */
@@ -0,0 +1,175 @@
+/**************************************************************************/ /**
+ * @file      MemPool.c
+ * @brief     Fixed-block pool allocator. See MemPool.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "MemPool.h"
+#include <string.h>
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static BaseType_t prvBlockIndex(const MemPool_t *pxPool, const void *pvBlock, UBaseType_t *puxIndex);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static MemPool_t *pxPools[MEMPOOL_MAX_POOLS];
+static UBaseType_t uxPoolCount = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Builds the free list of a pool and adds it to the table.
+ */
+BaseType_t MemPoolRegister(MemPool_t *pxPool)
+{
+	MemPoolBlock_t *pxBlock;
+
+	configASSERT(pxPool != NULL && pxPool->uxBlockCount > 0);
+
+	// Link the blocks in address order, so the first allocations are the lowest addresses
+	pxPool->pxFreeList = NULL;
+	for (UBaseType_t i = pxPool->uxBlockCount; i > 0; i--)
+	{
+		pxBlock = (MemPoolBlock_t *)&pxPool->pucStorage[(i - 1) * pxPool->xBlockSize];
+		pxBlock->pxNext = pxPool->pxFreeList;
+		pxPool->pxFreeList = pxBlock;
+	}
+
+	memset(pxPool->pulAllocated, 0, ((pxPool->uxBlockCount + 31) / 32) * sizeof(uint32_t));
+	pxPool->uxInUse = 0;
+	pxPool->uxHighWater = 0;
+	pxPool->ulFailures = 0;
+	pxPool->ulInvalidFrees = 0;
+
+	if (uxPoolCount >= MEMPOOL_MAX_POOLS)
+	{
+		return pdFAIL;
+	}
+
+	pxPools[uxPoolCount++] = pxPool;
+	return pdPASS;
+}
+
+/**
+ * @brief Takes one block from the pool.
+ */
+void *MemPoolAlloc(MemPool_t *pxPool)
+{
+	MemPoolBlock_t *pxBlock;
+	UBaseType_t uxIndex;
+	UBaseType_t uxSavedInterruptStatus;
+
+	// The FROM_ISR mask nests and works from task context too
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+	pxBlock = pxPool->pxFreeList;
+	if (pxBlock != NULL)
+	{
+		pxPool->pxFreeList = pxBlock->pxNext;
+		prvBlockIndex(pxPool, pxBlock, &uxIndex);
+		pxPool->pulAllocated[uxIndex / 32] |= (1UL << (uxIndex % 32));
+
+		if (++pxPool->uxInUse > pxPool->uxHighWater)
+		{
+			pxPool->uxHighWater = pxPool->uxInUse;
+		}
+	}
+	else
+	{
+		pxPool->ulFailures++;
+	}
+
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+	return pxBlock;
+}
+
+/**
+ * @brief Returns a block to the pool.
+ */
+void MemPoolFree(MemPool_t *pxPool, void *pvBlock)
+{
+	MemPoolBlock_t *pxBlock = (MemPoolBlock_t *)pvBlock;
+	UBaseType_t uxIndex;
+	uint32_t ulMask;
+	UBaseType_t uxSavedInterruptStatus;
+
+	if (pvBlock == NULL)
+	{
+		return;
+	}
+
+	BaseType_t xValid = prvBlockIndex(pxPool, pvBlock, &uxIndex);
+	ulMask = 1UL << (uxIndex % 32);
+
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+	if (xValid == pdTRUE && (pxPool->pulAllocated[uxIndex / 32] & ulMask) != 0)
+	{
+		pxPool->pulAllocated[uxIndex / 32] &= ~ulMask;
+		pxBlock->pxNext = pxPool->pxFreeList;
+		pxPool->pxFreeList = pxBlock;
+		pxPool->uxInUse--;
+	}
+	else
+	{
+		pxPool->ulInvalidFrees++;
+	}
+
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+ * @brief Returns the number of registered pools.
+ */
+UBaseType_t MemPoolGetCount(void)
+{
+	return uxPoolCount;
+}
+
+/**
+ * @brief Returns the registered pool at uxIndex.
+ */
+const MemPool_t *MemPoolGet(UBaseType_t uxIndex)
+{
+	if (uxIndex >= uxPoolCount)
+	{
+		return NULL;
+	}
+
+	return pxPools[uxIndex];
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static BaseType_t prvBlockIndex(const MemPool_t *pxPool, const void *pvBlock, UBaseType_t *puxIndex)
+ * @brief		Converts a block address to its index in the pool
+ * @return		pdTRUE if pvBlock is the start of one of the pool's blocks, else pdFALSE
+ *				(and *puxIndex is set to 0)
+ *****************************************************************************/
+static BaseType_t prvBlockIndex(const MemPool_t *pxPool, const void *pvBlock, UBaseType_t *puxIndex)
+{
+	uintptr_t xOffset = (uintptr_t)pvBlock - (uintptr_t)pxPool->pucStorage;
+	UBaseType_t uxIndex = xOffset / pxPool->xBlockSize;
+
+	// A pointer below the storage wraps to a huge offset and fails the range check
+	if (uxIndex >= pxPool->uxBlockCount || uxIndex * pxPool->xBlockSize != xOffset)
+	{
+		*puxIndex = 0;
+		return pdFALSE;
+	}
+
+	*puxIndex = uxIndex;
+	return pdTRUE;
+}
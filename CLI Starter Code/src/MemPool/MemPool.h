@@ -0,0 +1,127 @@
+/**************************************************************************/ /**
+ * @file      MemPool.h
+ * @brief     Fixed-block pool allocator for data that is allocated and freed
+ *            continuously, such as sensor frames and telemetry packets.
+ * @details   Each pool is a static array of equal sized blocks, with the free
+ *            blocks kept in a singly linked list threaded through the blocks
+ *            themselves. Alloc pops the head and free pushes it back, so both
+ *            are O(1). Both run under a short interrupt mask and can be called
+ *            from tasks and interrupts. A bitmap with one bit per block catches
+ *            double frees and pointers that do not belong to the pool.
+ *
+ *            The module defines no pools of its own; each user declares the
+ *            pool it needs, so no RAM goes to blocks nothing allocates.
+ *
+ *            Block sizes are fixed at compile time:
+ *
+ *                MEMPOOL_DEFINE(xMyPool, "mine", sizeof(MyFrame_t), 8);
+ *                ...
+ *                MemPoolRegister(&xMyPool);          // once, before use
+ *                MyFrame_t *pxFrame = MemPoolAlloc(&xMyPool);
+ *                MemPoolFree(&xMyPool, pxFrame);
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define MEMPOOL_MAX_POOLS 8 ///< Pools that can be registered, and listed by the "pools" command
+#define MEMPOOL_ALIGNMENT 8 ///< Every block is aligned to this, enough for any C type on Cortex-M0+
+
+/**
+ * @brief Size of one block for a requested size: at least a pointer, rounded
+ *        up to MEMPOOL_ALIGNMENT.
+ */
+#define MEMPOOL_BLOCK_SIZE(xSize) \
+	((((xSize) < sizeof(void *) ? sizeof(void *) : (xSize)) + MEMPOOL_ALIGNMENT - 1) & ~(size_t)(MEMPOOL_ALIGNMENT - 1))
+
+/**
+ * @brief Declares a pool and its static storage. Use at file scope, then call
+ *        MemPoolRegister() once before the first MemPoolAlloc().
+ * @param xPool Name of the MemPool_t variable
+ * @param pcPoolName Name shown by the "pools" command
+ * @param xSize Bytes needed per block
+ * @param uxCount Number of blocks
+ */
+#define MEMPOOL_DEFINE(xPool, pcPoolName, xSize, uxCount)                                            \
+	static uint8_t xPool##Storage[MEMPOOL_BLOCK_SIZE(xSize) * (uxCount)]                             \
+		__attribute__((aligned(MEMPOOL_ALIGNMENT)));                                                 \
+	static uint32_t xPool##Allocated[((uxCount) + 31) / 32];                                         \
+	MemPool_t xPool = {(pcPoolName), MEMPOOL_BLOCK_SIZE(xSize), (uxCount), xPool##Storage, xPool##Allocated, \
+					   NULL, 0, 0, 0, 0}
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A free block. The link lives in the block itself, so free blocks cost no extra RAM.
+ */
+typedef struct xMEMPOOL_BLOCK
+{
+	struct xMEMPOOL_BLOCK *pxNext;
+} MemPoolBlock_t;
+
+/**
+ * @brief A pool. Declare with MEMPOOL_DEFINE rather than filling it in by hand.
+ */
+typedef struct
+{
+	const char *const pcName;
+	const size_t xBlockSize;		///< Bytes per block, already rounded up
+	const UBaseType_t uxBlockCount;
+	uint8_t *const pucStorage;		///< uxBlockCount * xBlockSize bytes
+	uint32_t *const pulAllocated;	///< One bit per block, set while the block is allocated
+	MemPoolBlock_t *pxFreeList;
+	UBaseType_t uxInUse;			///< Blocks allocated now
+	UBaseType_t uxHighWater;		///< Most blocks ever allocated at once
+	uint32_t ulFailures;			///< Allocations refused because the pool was empty
+	uint32_t ulInvalidFrees;		///< Frees of foreign, misaligned or already free pointers
+} MemPool_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			BaseType_t MemPoolRegister(MemPool_t *pxPool)
+ * @brief		Builds the free list of a pool and adds it to the table shown by "pools"
+ * @param[in]	pxPool Pool declared with MEMPOOL_DEFINE
+ * @return		pdPASS, or pdFAIL if the table is full. The pool is usable either way
+ *****************************************************************************/
+BaseType_t MemPoolRegister(MemPool_t *pxPool);
+
+/**
+ * @fn			void *MemPoolAlloc(MemPool_t *pxPool)
+ * @brief		Takes one block from the pool. O(1), safe from tasks and interrupts
+ * @return		The block, aligned to MEMPOOL_ALIGNMENT, or NULL if the pool is empty
+ *****************************************************************************/
+void *MemPoolAlloc(MemPool_t *pxPool);
+
+/**
+ * @fn			void MemPoolFree(MemPool_t *pxPool, void *pvBlock)
+ * @brief		Returns a block to the pool. O(1), safe from tasks and interrupts
+ * @details		NULL is ignored. A pointer that is not an allocated block of this
+ *				pool is counted in ulInvalidFrees and otherwise ignored.
+ *****************************************************************************/
+void MemPoolFree(MemPool_t *pxPool, void *pvBlock);
+
+/**
+ * @fn			UBaseType_t MemPoolGetCount(void)
+ * @brief		Returns the number of registered pools
+ *****************************************************************************/
+UBaseType_t MemPoolGetCount(void);
+
+/**
+ * @fn			const MemPool_t *MemPoolGet(UBaseType_t uxIndex)
+ * @brief		Returns the registered pool at uxIndex, or NULL if out of range
+ *****************************************************************************/
+const MemPool_t *MemPoolGet(UBaseType_t uxIndex);
+
+#endif /* MEMPOOL_H */
@@ -0,0 +1,349 @@
+/**************************************************************************/ /**
+ * @file      Pipeline.c
+ * @brief     Ping-pong frame pipeline from IMU acquisition to processing. See Pipeline.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Pipeline.h"
+#include "Benchmark/Benchmark.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+// A message is its length and the frame pointer. A stream buffer holds one byte less than its storage
+#define PIPELINE_MESSAGE_BYTES (sizeof(size_t) + sizeof(ImuBlock_t *))
+#define PIPELINE_BUFFER_BYTES (PIPELINE_FRAMES * PIPELINE_MESSAGE_BYTES + 1)
+
+#define PIPELINE_SYNTH_PERIOD_MS (IMU_BLOCK_PERIOD_MS / PIPELINE_SYNTH_SPEEDUP)
+#define PIPELINE_SYNTH_WAVE 64 ///< Period of the synthetic waveform, in samples
+#define PIPELINE_SYNTH_HIT_EVERY (4 * PIPELINE_SYNTH_WAVE) ///< Samples between synthetic hits
+
+#if PIPELINE_SYNTH_PERIOD_MS < 1
+#error "The synthetic source cannot run that much faster than the IMU"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Where a frame came from. Each source numbers its blocks on its own.
+ */
+enum ePipelineSources
+{
+	PIPELINE_SOURCE_IMU = 0,
+	PIPELINE_SOURCE_SYNTHETIC,
+	N_PIPELINE_SOURCES
+};
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static ImuBlock_t *prvAcquire(TickType_t xTicksToWait, enum ePipelineSources eSource);
+static void prvRelease(ImuBlock_t *pxFrame);
+static void prvProcess(ImuBlock_t *pxFrame);
+static void prvSynthTick(TimerHandle_t xTimer);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static ImuBlock_t xFrames[PIPELINE_FRAMES];
+static bool bFrameBusy[PIPELINE_FRAMES];						  ///< Acquired and not yet released
+static enum ePipelineSources eFrameSource[PIPELINE_FRAMES];
+
+static SemaphoreHandle_t xFreeFrames = NULL; ///< Counts frames that are not busy
+static StaticSemaphore_t xFreeFramesBuffer;
+static MessageBufferHandle_t xSubmitted = NULL; ///< Frame pointers, oldest first
+static StaticMessageBuffer_t xSubmittedBuffer;
+static uint8_t ucSubmittedStorage[PIPELINE_BUFFER_BYTES];
+
+static PipelineStage_t pxStages[PIPELINE_MAX_STAGES];
+static UBaseType_t uxStageCount = 0;
+
+static uint32_t ulExpected[N_PIPELINE_SOURCES]; ///< Next block number of each source
+static bool bSeen[N_PIPELINE_SOURCES];			 ///< ulExpected is valid
+
+static TimerHandle_t xSynthTimer = NULL;
+static StaticTimer_t xSynthTimerBuffer;
+static volatile bool bSynthetic = false;
+static uint32_t ulSynthSequence = 0;
+static uint32_t ulSynthPhase = 0; ///< Samples generated
+
+static PipelineStats_t xStats = {.ulLatencyMin = UINT32_MAX};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Creates the static kernel objects. All frames start out free.
+ */
+void PipelineInit(void)
+{
+	xFreeFrames = xSemaphoreCreateCountingStatic(PIPELINE_FRAMES, PIPELINE_FRAMES, &xFreeFramesBuffer);
+	xSubmitted = xMessageBufferCreateStatic(sizeof(ucSubmittedStorage), ucSubmittedStorage, &xSubmittedBuffer);
+	xSynthTimer = xTimerCreateStatic("PipeSynth", pdMS_TO_TICKS(PIPELINE_SYNTH_PERIOD_MS), pdTRUE, NULL, prvSynthTick, &xSynthTimerBuffer);
+}
+
+/**
+ * @brief Pipeline task. Takes submitted frames in order and processes them.
+ */
+void vPipelineTask(void *pvParameters)
+{
+	ImuBlock_t *pxFrame;
+
+	for (;;)
+	{
+		if (xMessageBufferReceive(xSubmitted, &pxFrame, sizeof(pxFrame), portMAX_DELAY) == sizeof(pxFrame))
+		{
+			prvProcess(pxFrame);
+			prvRelease(pxFrame);
+		}
+	}
+}
+
+/**
+ * @brief Appends a stage.
+ */
+BaseType_t PipelineRegisterStage(PipelineStage_t pxStage)
+{
+	configASSERT(pxStage != NULL);
+
+	if (uxStageCount >= PIPELINE_MAX_STAGES)
+	{
+		return pdFAIL;
+	}
+	pxStages[uxStageCount++] = pxStage;
+	return pdPASS;
+}
+
+/**
+ * @brief Takes a free frame for the IMU task.
+ */
+ImuBlock_t *PipelineAcquire(TickType_t xTicksToWait)
+{
+	return prvAcquire(xTicksToWait, PIPELINE_SOURCE_IMU);
+}
+
+/**
+ * @brief Sends the frame's pointer to the pipeline task.
+ */
+void PipelineSubmit(ImuBlock_t *pxFrame)
+{
+	size_t xSent;
+
+	// Both producers are tasks; with the scheduler suspended they cannot interleave inside the send.
+	// There is room for every frame, so the send does not need to wait
+	vTaskSuspendAll();
+	xSent = xMessageBufferSend(xSubmitted, &pxFrame, sizeof(pxFrame), 0);
+	(void)xTaskResumeAll();
+
+	configASSERT(xSent == sizeof(pxFrame));
+	if (xSent != sizeof(pxFrame))
+	{
+		prvRelease(pxFrame);
+	}
+}
+
+/**
+ * @brief Frees a frame that was acquired but not filled.
+ */
+void PipelineCancel(ImuBlock_t *pxFrame)
+{
+	prvRelease(pxFrame);
+}
+
+/**
+ * @brief Starts or stops the synthetic source timer.
+ */
+void PipelineSetSynthetic(bool bEnable)
+{
+	bSynthetic = bEnable;
+	if (bEnable)
+	{
+		(void)xTimerStart(xSynthTimer, 0);
+	}
+	else
+	{
+		(void)xTimerStop(xSynthTimer, 0);
+	}
+}
+
+/**
+ * @brief Returns whether the synthetic source runs.
+ */
+bool PipelineIsSynthetic(void)
+{
+	return bSynthetic;
+}
+
+/**
+ * @brief Copies the counters.
+ */
+void PipelineGetStats(PipelineStats_t *pxStats)
+{
+	taskENTER_CRITICAL();
+	*pxStats = xStats;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Clears the counters.
+ */
+void PipelineResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&xStats, 0, sizeof(xStats));
+	xStats.ulLatencyMin = UINT32_MAX;
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static ImuBlock_t *prvAcquire(TickType_t xTicksToWait, enum ePipelineSources eSource)
+ * @brief		Waits for a free frame and marks it busy
+ * @details		Frames can be released out of order, when one is cancelled, so
+ *				the free one is looked up rather than assumed to alternate
+ *****************************************************************************/
+static ImuBlock_t *prvAcquire(TickType_t xTicksToWait, enum ePipelineSources eSource)
+{
+	ImuBlock_t *pxFrame = NULL;
+
+	if (xSemaphoreTake(xFreeFrames, xTicksToWait) != pdTRUE)
+	{
+		taskENTER_CRITICAL();
+		xStats.ulStalls++;
+		taskEXIT_CRITICAL();
+		return NULL;
+	}
+
+	taskENTER_CRITICAL();
+	for (UBaseType_t i = 0; i < PIPELINE_FRAMES; i++)
+	{
+		if (!bFrameBusy[i])
+		{
+			bFrameBusy[i] = true;
+			eFrameSource[i] = eSource;
+			pxFrame = &xFrames[i];
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	configASSERT(pxFrame != NULL);
+	return pxFrame;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvRelease(ImuBlock_t *pxFrame)
+ * @brief		Marks the frame free and wakes a producer waiting for it
+ *****************************************************************************/
+static void prvRelease(ImuBlock_t *pxFrame)
+{
+	taskENTER_CRITICAL();
+	bFrameBusy[pxFrame - xFrames] = false;
+	taskEXIT_CRITICAL();
+	(void)xSemaphoreGive(xFreeFrames);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvProcess(ImuBlock_t *pxFrame)
+ * @brief		Checks the frame's sequence, runs the stages and records the latency
+ *****************************************************************************/
+static void prvProcess(ImuBlock_t *pxFrame)
+{
+	enum ePipelineSources eSource = eFrameSource[pxFrame - xFrames];
+	uint32_t ulGap = 0;
+	uint32_t ulStart, ulEnd, ulLatency;
+
+	// Only a jump forward is a gap
+	if (bSeen[eSource] && (int32_t)(pxFrame->ulSequence - ulExpected[eSource]) > 0)
+	{
+		ulGap = pxFrame->ulSequence - ulExpected[eSource];
+	}
+	ulExpected[eSource] = pxFrame->ulSequence + 1;
+	bSeen[eSource] = true;
+
+	ulStart = BenchmarkGetCycles();
+	for (UBaseType_t i = 0; i < uxStageCount; i++)
+	{
+		pxStages[i](pxFrame);
+	}
+	ulEnd = BenchmarkGetCycles();
+	ulLatency = ulEnd - pxFrame->ulCycles;
+
+	taskENTER_CRITICAL();
+	xStats.ulFrames++;
+	xStats.ulGaps += ulGap;
+	xStats.ullLatencyTotal += ulLatency;
+	if (ulLatency < xStats.ulLatencyMin)
+	{
+		xStats.ulLatencyMin = ulLatency;
+	}
+	if (ulLatency > xStats.ulLatencyMax)
+	{
+		xStats.ulLatencyMax = ulLatency;
+	}
+	if (ulEnd - ulStart > xStats.ulStagesMax)
+	{
+		xStats.ulStagesMax = ulEnd - ulStart;
+	}
+	taskEXIT_CRITICAL();
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvSynthTick(TimerHandle_t xTimer)
+ * @brief		Synthetic source timer callback. Fills a full block with a
+ *				triangle wave on X, 1 g on Z, a constant rotation and, every
+ *				PIPELINE_SYNTH_HIT_EVERY samples, a 6 g spike, and submits it.
+ *				With no free frame the block is lost, and its number skipped
+ *****************************************************************************/
+static void prvSynthTick(TimerHandle_t xTimer)
+{
+	ImuBlock_t *pxFrame = prvAcquire(0, PIPELINE_SOURCE_SYNTHETIC);
+
+	if (pxFrame == NULL)
+	{
+		ulSynthSequence++;
+		ulSynthPhase += IMU_BLOCK_SAMPLES;
+		return;
+	}
+
+	for (uint16_t i = 0; i < IMU_BLOCK_SAMPLES; i++, ulSynthPhase++)
+	{
+		int32_t lStep = (int32_t)(ulSynthPhase % PIPELINE_SYNTH_WAVE);
+		int32_t lTriangle = (lStep < PIPELINE_SYNTH_WAVE / 2) ? lStep : PIPELINE_SYNTH_WAVE - lStep;
+		ImuSample_t *pxSample = &pxFrame->xSamples[i];
+
+		// -1 g to +1 g and back
+		pxSample->sAccel[0] = (int16_t)((lTriangle * 4 - PIPELINE_SYNTH_WAVE) * IMU_ACCEL_LSB_PER_G / PIPELINE_SYNTH_WAVE);
+		if (ulSynthPhase % PIPELINE_SYNTH_HIT_EVERY == 0)
+		{
+			pxSample->sAccel[0] += 6 * IMU_ACCEL_LSB_PER_G;
+		}
+		pxSample->sAccel[1] = 0;
+		pxSample->sAccel[2] = IMU_ACCEL_LSB_PER_G;
+		pxSample->sGyro[0] = 0;
+		pxSample->sGyro[1] = 0;
+		pxSample->sGyro[2] = IMU_GYRO_LSB_PER_10_DPS;
+		memcpy(pxSample->sAccelAux, pxSample->sAccel, sizeof(pxSample->sAccelAux));
+	}
+
+	pxFrame->ulCycles = BenchmarkGetCycles();
+	pxFrame->xTimestamp = xTaskGetTickCount();
+	pxFrame->usCount = IMU_BLOCK_SAMPLES;
+	pxFrame->cRateShift = 0;
+	pxFrame->ulSequence = ulSynthSequence++;
+
+	taskENTER_CRITICAL();
+	xStats.ulSynthetic++;
+	taskEXIT_CRITICAL();
+
+	PipelineSubmit(pxFrame);
+}
@@ -0,0 +1,142 @@
+/**************************************************************************/ /**
+ * @file      Pipeline.h
+ * @brief     Ping-pong frame pipeline from IMU acquisition to processing.
+ * @details   PIPELINE_FRAMES ImuBlock_t frames are shared by the producer (the
+ *            IMU task) and the pipeline task. The producer takes a free frame,
+ *            has the DMA reads unpacked straight into it and submits it; only
+ *            the frame's pointer goes through a FreeRTOS message buffer. The
+ *            pipeline task runs the registered stages on the frame in place,
+ *            then frees it. With two frames the producer fills one while the
+ *            other is processed, and nothing is copied.
+ *
+ *                static void prvDetect(const ImuBlock_t *pxFrame) { ... }
+ *                ...
+ *                PipelineRegisterStage(prvDetect); // from the daemon task startup hook
+ *
+ *            If processing falls behind, the producer finds no free frame and
+ *            leaves the samples in the sensor FIFOs, which hold far more than
+ *            a block. Producers number their blocks, and skip a number for a
+ *            block they lost; the pipeline task counts the missing numbers.
+ *
+ *            Latency is measured in CPU cycles from the moment the producer
+ *            read the newest sample of a frame to the end of the last stage.
+ *            The oldest sample of a block is up to one block period older.
+ *
+ *            For load tests, a synthetic source driven by a software timer
+ *            feeds generated blocks at PIPELINE_SYNTH_SPEEDUP times the
+ *            production block rate, in place of the sensors.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "Imu/Imu.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define PIPELINE_FRAMES 2							   ///< Ping-pong
+#define PIPELINE_MAX_STAGES 6						   ///< Processing functions that can be registered
+#define PIPELINE_TASK_SIZE 192						   ///< Pipeline task stack, in words. Stages run on it
+#define PIPELINE_PRIORITY (tskIDLE_PRIORITY + 1)	   ///< Below acquisition and the timer daemon
+#define PIPELINE_SYNTH_SPEEDUP 10					   ///< Synthetic block rate over the production block rate
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A processing stage. Runs in the pipeline task, in registration order.
+ *        The frame is only valid during the call.
+ */
+typedef void (*PipelineStage_t)(const ImuBlock_t *pxFrame);
+
+/**
+ * @brief Pipeline counters. Latencies are in CPU cycles.
+ */
+typedef struct
+{
+	uint32_t ulFrames;		   ///< Frames processed
+	uint32_t ulGaps;		   ///< Blocks missing from the sequence
+	uint32_t ulStalls;		   ///< Times a producer found no free frame
+	uint32_t ulSynthetic;	   ///< Synthetic blocks generated
+	uint32_t ulLatencyMin;	   ///< UINT32_MAX until the first frame
+	uint32_t ulLatencyMax;
+	uint64_t ullLatencyTotal;  ///< Divide by ulFrames for the mean
+	uint32_t ulStagesMax;	   ///< Longest run of all stages on one frame
+} PipelineStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void PipelineInit(void)
+ * @brief		Creates the message buffer, the free frame semaphore and the synthetic source timer
+ * @note		Call once from the daemon task startup hook, before the IMU and pipeline tasks start
+ *****************************************************************************/
+void PipelineInit(void);
+
+/**
+ * @fn			void vPipelineTask(void *pvParameters)
+ * @brief		Pipeline task. Runs the stages on every submitted frame
+ *****************************************************************************/
+void vPipelineTask(void *pvParameters);
+
+/**
+ * @fn			BaseType_t PipelineRegisterStage(PipelineStage_t pxStage)
+ * @brief		Adds a stage at the end of the chain
+ * @return		pdFAIL if PIPELINE_MAX_STAGES are registered
+ *****************************************************************************/
+BaseType_t PipelineRegisterStage(PipelineStage_t pxStage);
+
+/**
+ * @fn			ImuBlock_t *PipelineAcquire(TickType_t xTicksToWait)
+ * @brief		Takes a free frame to fill
+ * @param[in]	xTicksToWait 0 from the timer daemon task
+ * @return		The frame, or NULL if none became free in time
+ *****************************************************************************/
+ImuBlock_t *PipelineAcquire(TickType_t xTicksToWait);
+
+/**
+ * @fn			void PipelineSubmit(ImuBlock_t *pxFrame)
+ * @brief		Hands a filled frame to the pipeline task
+ * @details		Set ulSequence, usCount, xTimestamp and ulCycles first. ulCycles is
+ *				BenchmarkGetCycles() when the newest sample was read
+ *****************************************************************************/
+void PipelineSubmit(ImuBlock_t *pxFrame);
+
+/**
+ * @fn			void PipelineCancel(ImuBlock_t *pxFrame)
+ * @brief		Returns an acquired frame that will not be submitted
+ *****************************************************************************/
+void PipelineCancel(ImuBlock_t *pxFrame);
+
+/**
+ * @fn			void PipelineSetSynthetic(bool bEnable)
+ * @brief		Starts or stops the synthetic source. While it runs, the IMU task discards its samples
+ *****************************************************************************/
+void PipelineSetSynthetic(bool bEnable);
+
+/**
+ * @fn			bool PipelineIsSynthetic(void)
+ * @brief		Returns whether the synthetic source is feeding the pipeline
+ *****************************************************************************/
+bool PipelineIsSynthetic(void);
+
+/**
+ * @fn			void PipelineGetStats(PipelineStats_t *pxStats)
+ * @brief		Copies the counters
+ *****************************************************************************/
+void PipelineGetStats(PipelineStats_t *pxStats);
+
+/**
+ * @fn			void PipelineResetStats(void)
+ * @brief		Clears the counters
+ *****************************************************************************/
+void PipelineResetStats(void);
+
+#endif /* PIPELINE_H */
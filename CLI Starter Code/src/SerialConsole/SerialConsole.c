@@ -28,12 +28,20 @@
  ******************************************************************************/
 #include "SerialConsole.h"
 #include "CliThread.h" 
+#include "ClockProfile/ClockProfile.h"
+#include "Trace/Trace.h"
+#include "Benchmark/Benchmark.h"
+#include "IrqMonitor/IrqMonitor.h"
+#include "conf_irq_priorities.h"
+#include "conf_ramfunc.h"
 extern SemaphoreHandle_t xRxNotificationSemaphore;
 /******************************************************************************
  * Defines
  ******************************************************************************/
 #define RX_BUFFER_SIZE 512 ///< Size of character buffer for RX, in bytes
 #define TX_BUFFER_SIZE 512 ///< Size of character buffers for TX, in bytes
+#define USART_BAUD_RATE 115200 ///< Console baud rate, re-derived from GCLK0 on every clock profile switch
+#define USART_DRAIN_LOOPS 2000 ///< Bound on the wait for the character in flight before a clock switch
 
 /******************************************************************************
  * Structures and Enumerations
@@ -55,6 +63,8 @@ void usart_read_callback(struct usart_module *const usart_module); // Callback f
  ******************************************************************************/
 static void configure_usart(void);
 static void configure_usart_callbacks(void);
+static void start_tx_if_idle(void);
+static void usart_clock_changed(enum eClockProfileEvents eEvent, uint32_t ulCpuHz);
 
 /******************************************************************************
  * Global Variables
@@ -80,7 +90,8 @@ void InitializeSerialConsole(void)
     // Configure USART and Callbacks
 	configure_usart();
     configure_usart_callbacks();
-    NVIC_SetPriority(SERCOM4_IRQn, 10);
+    NVIC_SetPriority(SERCOM4_IRQn, IRQ_PRIORITY_CONSOLE);
+    ClockProfileRegisterCallback(usart_clock_changed);
 
     usart_read_buffer_job(&usart_instance, (uint8_t *)&latestRx, 1); // Kicks off constant reading of characters
 
@@ -105,14 +116,17 @@ void SerialConsoleWriteString(char *string)
     {
         for (size_t iter = 0; iter < strlen(string); iter++)
         {
+            // When called from a task, wait for the UART to drain instead of overwriting
+            // text that has not been sent yet. Batch mode can produce output faster than 115200 baud
+            while (circular_buf_full(cbufTx) && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING && __get_IPSR() == 0)
+            {
+                start_tx_if_idle();
+                vTaskDelay(1);
+            }
             circular_buf_put(cbufTx, string[iter]);
         }
 
-        if (usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_OK)
-        {
-            circular_buf_get(cbufTx, (uint8_t *)&latestTx); // Perform only if the SERCOM TX is free (not busy)
-            usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
-        }
+        start_tx_if_idle();
     }
 }
 
@@ -123,12 +137,23 @@ void SerialConsoleWriteString(char *string)
  */
 int SerialConsoleReadCharacter(uint8_t *rxChar)
 {
+    TraceSectionBegin(TRACE_SECTION_CONSOLE_READ);
     vTaskSuspendAll();
     int a = circular_buf_get(cbufRx, (uint8_t *)rxChar);
     xTaskResumeAll();
+    TraceSectionEnd(TRACE_SECTION_CONSOLE_READ);
     return a;
 }
 
+/**
+ * @brief Checks whether everything queued for the console has been sent.
+ * @return true if the TX ring buffer is empty and no write job is running.
+ */
+bool SerialConsoleIsTxIdle(void)
+{
+    return circular_buf_empty(cbufTx) && usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_OK;
+}
+
 /**
  * @brief Gets the current debug log level.
  * @return The current debug level.
@@ -191,7 +216,7 @@ static void configure_usart(void)
 	struct usart_config config_usart;
 	usart_get_config_defaults(&config_usart);
 
-	config_usart.baudrate = 115200;
+	config_usart.baudrate = USART_BAUD_RATE;
 	config_usart.mux_setting = EDBG_CDC_SERCOM_MUX_SETTING;
 	config_usart.pinmux_pad0 = EDBG_CDC_SERCOM_PINMUX_PAD0;
 	config_usart.pinmux_pad1 = EDBG_CDC_SERCOM_PINMUX_PAD1;
@@ -224,6 +249,59 @@ static void configure_usart_callbacks(void)
 	usart_enable_callback(&usart_instance, USART_CALLBACK_BUFFER_RECEIVED);
 }
 
+/**************************************************************************/ 
+/**
+ * @fn			static void start_tx_if_idle(void)
+ * @brief		Starts sending cbufTx if the SERCOM TX is free (not busy). Once started,
+ *				usart_write_callback keeps sending until the buffer is empty
+ * @note
+ *****************************************************************************/
+static void start_tx_if_idle(void)
+{
+	if (usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_OK)
+	{
+		if (circular_buf_get(cbufTx, (uint8_t *)&latestTx) != -1)
+		{
+			usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
+		}
+	}
+}
+
+/**************************************************************************/ 
+/**
+ * @fn			static void usart_clock_changed(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+ * @brief		Clock profile callback. The SERCOM core clock is GCLK0, so the BAUD
+ *				register is recomputed for the new frequency after every switch
+ * @note		Runs with interrupts masked. Before the switch, the character being
+ *				shifted out is allowed to finish at the old rate
+ *****************************************************************************/
+static void usart_clock_changed(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+{
+	SercomUsart *const usart_hw = &(usart_instance.hw->USART);
+	uint32_t sercom_gclk_id = _sercom_get_sercom_inst_index(usart_instance.hw) + SERCOM0_GCLK_ID_CORE;
+	uint16_t baud;
+
+	if (eEvent == CLOCK_PROFILE_PRE_CHANGE)
+	{
+		if (usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_BUSY)
+		{
+			for (uint32_t loops = 0; loops < USART_DRAIN_LOOPS && !(usart_hw->INTFLAG.reg & SERCOM_USART_INTFLAG_TXC); loops++)
+			{
+			}
+		}
+		return;
+	}
+
+	if (_sercom_get_async_baud_val(USART_BAUD_RATE, system_gclk_chan_get_hz(sercom_gclk_id), &baud,
+								   SERCOM_ASYNC_OPERATION_MODE_ARITHMETIC, SERCOM_ASYNC_SAMPLE_NUM_16) == STATUS_OK)
+	{
+		// BAUD is enable protected. Disabling only stops the NVIC line and the enable bit, pending flags are kept
+		usart_disable(&usart_instance);
+		usart_hw->BAUD.reg = baud;
+		usart_enable(&usart_instance);
+	}
+}
+
 /******************************************************************************
  * Callback Functions
  ******************************************************************************/
@@ -249,8 +327,10 @@ static void configure_usart_callbacks(void)
  * @note This function runs in interrupt context. It uses `xSemaphoreGiveFromISR()`
  *       and `portYIELD_FROM_ISR()` to safely notify the CLI task.
  *****************************************************************************/
-void usart_read_callback(struct usart_module *const usart_module)
+RAMFUNC_HOT void usart_read_callback(struct usart_module *const usart_module)
 {
+	uint32_t ulEntry = BenchmarkGetCycles();
+	TraceIsrEnter(TRACE_ISR_USART_RX);
 	circular_buf_put(cbufRx, latestRx);
 
 	// Restart read job for next byte
@@ -259,6 +339,8 @@ void usart_read_callback(struct usart_module *const usart_module)
 	// Notify CLI thread
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	xSemaphoreGiveFromISR(xRxNotificationSemaphore, &xHigherPriorityTaskWoken);
+	TraceIsrExit(TRACE_ISR_USART_RX);
+	IrqMonitorRecord(IRQ_MONITOR_CONSOLE_RX, IRQ_MONITOR_NO_LATENCY, BenchmarkGetCycles() - ulEntry);
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
@@ -268,10 +350,14 @@ void usart_read_callback(struct usart_module *const usart_module)
  * @brief		Callback called when the system finishes sending all the bytes requested from a UART read job
  * @note
  *****************************************************************************/
-void usart_write_callback(struct usart_module *const usart_module)
+RAMFUNC_HOT void usart_write_callback(struct usart_module *const usart_module)
 {
+	uint32_t ulEntry = BenchmarkGetCycles();
+	TraceIsrEnter(TRACE_ISR_USART_TX);
 	if (circular_buf_get(cbufTx, (uint8_t *)&latestTx) != -1) // Only continue if there are more characters to send
 	{
 		usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
 	}
+	TraceIsrExit(TRACE_ISR_USART_TX);
+	IrqMonitorRecord(IRQ_MONITOR_CONSOLE_TX, IRQ_MONITOR_NO_LATENCY, BenchmarkGetCycles() - ulEntry);
 }
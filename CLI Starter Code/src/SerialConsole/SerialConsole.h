@@ -89,6 +89,13 @@ void SerialConsoleWriteString(char * string);
  *****************************************************************************/
 int SerialConsoleReadCharacter(uint8_t *rxChar);
 
+/**
+ * @fn			bool SerialConsoleIsTxIdle(void)
+ * @brief		Returns true when the TX ring buffer is empty and the SERCOM has finished sending
+ * @note			Safe to call with interrupts masked. Used before clocks are stopped for STANDBY
+ *****************************************************************************/
+bool SerialConsoleIsTxIdle(void);
+
 /**
  * @fn			LogMessage
  * @brief		Logs a message at the specified debug level.
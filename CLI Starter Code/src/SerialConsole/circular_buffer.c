@@ -22,6 +22,7 @@
  #include <assert.h>
 
  #include "circular_buffer.h"
+ #include "conf_ramfunc.h"
 
 
  // The definition of our circular buffer structure is hidden from the user
@@ -33,29 +34,43 @@
 	 bool full;
  };
 
+ // Handle storage. A handle is free while its buffer pointer is NULL
+ static circular_buf_t handle_pool[CIRCULAR_BUF_MAX_HANDLES];
+
  #pragma mark - Private Functions -
 
- static void advance_pointer(cbuf_handle_t cbuf)
+ // Put and get run in the console interrupt, so they live in SRAM (conf_ramfunc.h).
+ // Indices wrap by comparison: % would call the libgcc divide routine in flash.
+ RAMFUNC_HOT static void advance_pointer(cbuf_handle_t cbuf)
  {
 	 //assert(cbuf);
 
 	 if(cbuf->full)
 	 {
-		 cbuf->tail = (cbuf->tail + 1) % cbuf->max;
+		 if(++cbuf->tail == cbuf->max)
+		 {
+			 cbuf->tail = 0;
+		 }
 	 }
 
-	 cbuf->head = (cbuf->head + 1) % cbuf->max;
+	 if(++cbuf->head == cbuf->max)
+	 {
+		 cbuf->head = 0;
+	 }
 
 	 // We mark full because we will advance tail on the next time around
 	 cbuf->full = (cbuf->head == cbuf->tail);
  }
 
- static void retreat_pointer(cbuf_handle_t cbuf)
+ RAMFUNC_HOT static void retreat_pointer(cbuf_handle_t cbuf)
  {
 	 //assert(cbuf);
 
 	 cbuf->full = false;
-	 cbuf->tail = (cbuf->tail + 1) % cbuf->max;
+	 if(++cbuf->tail == cbuf->max)
+	 {
+		 cbuf->tail = 0;
+	 }
  }
 
  #pragma mark - APIs -
@@ -64,8 +79,21 @@
  {
 	// assert(buffer && size);
 
-	 cbuf_handle_t cbuf = malloc(sizeof(circular_buf_t));
-	 //assert(cbuf);
+	 cbuf_handle_t cbuf = NULL;
+
+	 for(size_t i = 0; i < CIRCULAR_BUF_MAX_HANDLES; i++)
+	 {
+		 if(handle_pool[i].buffer == NULL)
+		 {
+			 cbuf = &handle_pool[i];
+			 break;
+		 }
+	 }
+
+	 if(cbuf == NULL)
+	 {
+		 return NULL;
+	 }
 
 	 cbuf->buffer = buffer;
 	 cbuf->max = size;
@@ -79,7 +107,7 @@
  void circular_buf_free(cbuf_handle_t cbuf)
  {
 	// assert(cbuf);
-	 free(cbuf);
+	 cbuf->buffer = NULL;
  }
 
  void circular_buf_reset(cbuf_handle_t cbuf)
@@ -120,7 +148,7 @@
 	 return cbuf->max;
  }
 
- void circular_buf_put(cbuf_handle_t cbuf, uint8_t data)
+ RAMFUNC_HOT void circular_buf_put(cbuf_handle_t cbuf, uint8_t data)
  {
 	 //assert(cbuf && cbuf->buffer);
 
@@ -129,7 +157,7 @@
 	 advance_pointer(cbuf);
  }
 
- int circular_buf_put2(cbuf_handle_t cbuf, uint8_t data)
+ RAMFUNC_HOT int circular_buf_put2(cbuf_handle_t cbuf, uint8_t data)
  {
 	 int r = -1;
 
@@ -145,7 +173,7 @@
 	 return r;
  }
 
- int circular_buf_get(cbuf_handle_t cbuf, uint8_t * data)
+ RAMFUNC_HOT int circular_buf_get(cbuf_handle_t cbuf, uint8_t * data)
  {
 	 //assert(cbuf && data && cbuf->buffer);
 	 
@@ -162,14 +190,14 @@
 	 return r;
  }
 
- bool circular_buf_empty(cbuf_handle_t cbuf)
+ RAMFUNC_HOT bool circular_buf_empty(cbuf_handle_t cbuf)
  {
 	 //assert(cbuf);
 
 	 return (!cbuf->full && (cbuf->head == cbuf->tail));
  }
 
- bool circular_buf_full(cbuf_handle_t cbuf)
+ RAMFUNC_HOT bool circular_buf_full(cbuf_handle_t cbuf)
  {
 	// assert(cbuf);
 
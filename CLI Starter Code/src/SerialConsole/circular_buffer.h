@@ -17,6 +17,9 @@
 #ifndef CIRCULAR_BUFFER_H_
 #define CIRCULAR_BUFFER_H_
 
+/// Number of buffers that can exist at once. Handles come from a static pool, there is no malloc
+#define CIRCULAR_BUF_MAX_HANDLES 4
+
 /// Opaque circular buffer structure
 typedef struct circular_buf_t circular_buf_t;
 
@@ -26,9 +29,10 @@ typedef circular_buf_t* cbuf_handle_t;
 /// Pass in a storage buffer and size, returns a circular buffer handle
 /// Requires: buffer is not NULL, size > 0
 /// Ensures: cbuf has been created and is returned in an empty state
+/// Returns NULL if all CIRCULAR_BUF_MAX_HANDLES handles are in use
 cbuf_handle_t circular_buf_init(uint8_t* buffer, size_t size);
 
-/// Free a circular buffer structure
+/// Free a circular buffer structure, returning its handle to the pool
 /// Requires: cbuf is valid and created by circular_buf_init
 /// Does not free data buffer; owner is responsible for that
 void circular_buf_free(cbuf_handle_t cbuf);
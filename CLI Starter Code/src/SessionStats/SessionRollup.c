@@ -0,0 +1,95 @@
+/**************************************************************************/ /**
+ * @file      SessionRollup.c
+ * @brief     Periodic rollup of the session statistics. See SessionRollup.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "SessionRollup.h"
+#include "WorkQueue/WorkQueue.h"
+#include <string.h>
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvRollup(void *pvContext);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static WORKQUEUE_DEFINE(xRollupWork, "rollup", prvRollup, NULL, WORK_PRIORITY_LOW);
+
+static SessionStats_t xSnapshot;				///< Only used by prvRollup(), kept off the daemon stack
+static uint8_t ucStaging[STATS_RECORD_BYTES];	///< Record being packed
+static uint8_t ucLatest[STATS_RECORD_BYTES];	///< Last complete record, copied in and out in critical sections
+static uint32_t ulRollups = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Registers the work item and queues its first run.
+ */
+void SessionRollupInit(void)
+{
+	WorkQueueRegister(&xRollupWork);
+	WorkQueueSubmit(&xRollupWork);
+}
+
+/**
+ * @brief Queues a rollup now. An already delayed one runs now instead.
+ */
+void SessionRollupNow(void)
+{
+	WorkQueueSubmit(&xRollupWork);
+}
+
+/**
+ * @brief Copies the latest record.
+ */
+bool SessionRollupGet(uint8_t *pucRecord, uint32_t *pulRollups)
+{
+	bool bValid;
+
+	taskENTER_CRITICAL();
+	bValid = (ulRollups > 0);
+	if (bValid)
+	{
+		memcpy(pucRecord, ucLatest, STATS_RECORD_BYTES);
+	}
+	if (pulRollups != NULL)
+	{
+		*pulRollups = ulRollups;
+	}
+	taskEXIT_CRITICAL();
+
+	return bValid;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvRollup(void *pvContext)
+ * @brief		Work item: snapshot, pack, publish, and run again in STATS_ROLLUP_MS
+ * @details		The packing runs outside the critical section; only the copy
+ *				of the finished record is masked, so a reader never sees half
+ *				of one. Delaying itself from its own run is allowed: the item
+ *				is running, not queued, so the delay is not coalesced away.
+ *****************************************************************************/
+static void prvRollup(void *pvContext)
+{
+	SessionStatsGet(&xSnapshot);
+	SessionStatsSerialize(&xSnapshot, ucStaging, sizeof(ucStaging));
+
+	taskENTER_CRITICAL();
+	memcpy(ucLatest, ucStaging, STATS_RECORD_BYTES);
+	ulRollups++;
+	taskEXIT_CRITICAL();
+
+	WorkQueueSubmitDelayed(&xRollupWork, pdMS_TO_TICKS(STATS_ROLLUP_MS));
+}
@@ -0,0 +1,56 @@
+/**************************************************************************/ /**
+ * @file      SessionRollup.h
+ * @brief     Periodic rollup of the session statistics into the upload record.
+ * @details   A low priority work item takes a SessionStatsGet() snapshot
+ *            every STATS_ROLLUP_MS and packs it with SessionStatsSerialize(),
+ *            in the timer daemon task, so deriving the snapshot and its CRC
+ *            costs neither the pipeline task nor a task of its own. The upload
+ *            and the "stats record" command read the latest record with
+ *            SessionRollupGet(); "stats reset" asks for one at once with
+ *            SessionRollupNow().
+ *
+ *            Kept apart from SessionStats.c, which tools/replay builds for the
+ *            host without the work queue.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef SESSION_ROLLUP_H
+#define SESSION_ROLLUP_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "SessionStats.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STATS_ROLLUP_MS 1000 ///< Period of the rollup
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void SessionRollupInit(void)
+ * @brief		Registers the rollup work item and queues its first run
+ * @note		Call once from the daemon task startup hook
+ *****************************************************************************/
+void SessionRollupInit(void);
+
+/**
+ * @fn			void SessionRollupNow(void)
+ * @brief		Queues a rollup to run as soon as the daemon task gets to it
+ *****************************************************************************/
+void SessionRollupNow(void);
+
+/**
+ * @fn			bool SessionRollupGet(uint8_t *pucRecord, uint32_t *pulRollups)
+ * @brief		Copies the latest record
+ * @param[out]	pucRecord STATS_RECORD_BYTES
+ * @param[out]	pulRollups Optional, rollups so far
+ * @return		false, and pucRecord untouched, before the first rollup
+ *****************************************************************************/
+bool SessionRollupGet(uint8_t *pucRecord, uint32_t *pulRollups);
+
+#endif /* SESSION_ROLLUP_H */
@@ -0,0 +1,395 @@
+/**************************************************************************/ /**
+ * @file      SessionStats.c
+ * @brief     Running statistics of the hits of a session. See SessionStats.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "SessionStats.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STATS_WINDOW_MASK (STATS_WINDOW_HITS - 1)
+#define STATS_CRC_POLY 0x1021
+#define STATS_CRC_INIT 0xFFFF
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Running count, mean, spread and range of one measure.
+ */
+typedef struct
+{
+	uint32_t ulCount;
+	int32_t lMean;	  ///< Times 2^STATS_MEAN_SHIFT
+	uint64_t ullM2;	  ///< Sum of squared deviations from the mean, times 2^(2 * STATS_MEAN_SHIFT)
+	uint16_t usMin;
+	uint16_t usMax;
+} Welford_t;
+
+/**
+ * @brief Hit numbers, modulo 256, of the window hits whose force is monotonic from front to back.
+ */
+typedef struct
+{
+	uint8_t ucHit[STATS_WINDOW_HITS];
+	uint8_t ucFront; ///< Position of the front in ucHit
+	uint8_t ucLength;
+} Deque_t;
+
+/**
+ * @brief Everything added since the session started.
+ */
+typedef struct
+{
+	TickType_t xStart;
+	uint32_t ulHits;
+	uint32_t ulRallies;
+	TickType_t xLastTick;
+	Welford_t xForce;
+	Welford_t xInterval;
+	TickType_t xWindowTick[STATS_WINDOW_HITS];	 ///< Ring by hit number
+	uint16_t usWindowForce[STATS_WINDOW_HITS];
+	Deque_t xWindowMax; ///< Decreasing force, the front is the largest
+	Deque_t xWindowMin; ///< Increasing force, the front is the smallest
+	uint16_t usForceBins[STATS_BINS];
+	uint16_t usIntervalBins[STATS_BINS];
+} State_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvWelfordAdd(Welford_t *pxWelford, uint16_t usValue);
+static void prvWelfordSummary(const Welford_t *pxWelford, StatsSummary_t *pxSummary);
+static void prvDequePush(Deque_t *pxDeque, const uint16_t *pusForce, uint8_t ucHit, bool bMax);
+static void prvBinAdd(uint16_t *pusBins, uint32_t ulBin);
+static uint32_t prvSqrt(uint64_t ullValue);
+static uint8_t *prvPut16(uint8_t *pucOut, uint16_t usValue);
+static uint8_t *prvPut32(uint8_t *pucOut, uint32_t ulValue);
+static uint8_t *prvPutSummary(uint8_t *pucOut, const StatsSummary_t *pxSummary);
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static State_t xState; ///< Written by the pipeline task, read by the CLI, both in critical sections
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Clears the state and stamps the start.
+ */
+void SessionStatsReset(void)
+{
+	TickType_t xNow = xTaskGetTickCount();
+
+	taskENTER_CRITICAL();
+	memset(&xState, 0, sizeof(xState));
+	xState.xStart = xNow;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief A fixed number of steps, apart from the deque pops, which are paid for by their pushes.
+ */
+void SessionStatsAddHit(const Hit_t *pxHit)
+{
+	uint16_t usForce = (uint16_t)(((uint32_t)pxHit->sPeak * 1000) / HIT_LSB_PER_G);
+
+	taskENTER_CRITICAL();
+
+	if (xState.ulHits == 0 || pxHit->xTick - xState.xLastTick > pdMS_TO_TICKS(STATS_RALLY_GAP_MS))
+	{
+		// The first hit, or the first after a break
+		xState.ulRallies++;
+	}
+	else
+	{
+		uint16_t usInterval = (uint16_t)((pxHit->xTick - xState.xLastTick) * 1000 / configTICK_RATE_HZ);
+
+		prvWelfordAdd(&xState.xInterval, usInterval);
+		prvBinAdd(xState.usIntervalBins, usInterval >> STATS_INTERVAL_BIN_SHIFT);
+	}
+	xState.xLastTick = pxHit->xTick;
+
+	prvWelfordAdd(&xState.xForce, usForce);
+	prvBinAdd(xState.usForceBins, (uint32_t)pxHit->sPeak / HIT_LSB_PER_G);
+
+	xState.xWindowTick[xState.ulHits & STATS_WINDOW_MASK] = pxHit->xTick;
+	xState.usWindowForce[xState.ulHits & STATS_WINDOW_MASK] = usForce;
+	prvDequePush(&xState.xWindowMax, xState.usWindowForce, (uint8_t)xState.ulHits, true);
+	prvDequePush(&xState.xWindowMin, xState.usWindowForce, (uint8_t)xState.ulHits, false);
+	xState.ulHits++;
+
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Copies the state, then derives the snapshot from the copy.
+ */
+void SessionStatsGet(SessionStats_t *pxStats)
+{
+	static State_t xCopy; // Static, the CLI task stack is small
+	uint16_t usWindowHits;
+
+	taskENTER_CRITICAL();
+	xCopy = xState;
+	taskEXIT_CRITICAL();
+
+	memset(pxStats, 0, sizeof(*pxStats));
+	pxStats->xStart = xCopy.xStart;
+	pxStats->xNow = xTaskGetTickCount();
+	pxStats->ulHits = xCopy.ulHits;
+	pxStats->ulRallies = xCopy.ulRallies;
+	prvWelfordSummary(&xCopy.xForce, &pxStats->xForce);
+	prvWelfordSummary(&xCopy.xInterval, &pxStats->xInterval);
+	memcpy(pxStats->usForceBins, xCopy.usForceBins, sizeof(pxStats->usForceBins));
+	memcpy(pxStats->usIntervalBins, xCopy.usIntervalBins, sizeof(pxStats->usIntervalBins));
+
+	usWindowHits = (uint16_t)((xCopy.ulHits < STATS_WINDOW_HITS) ? xCopy.ulHits : STATS_WINDOW_HITS);
+	pxStats->usWindowHits = usWindowHits;
+	if (usWindowHits > 0)
+	{
+		uint32_t ulNewest = (xCopy.ulHits - 1) & STATS_WINDOW_MASK;
+		uint32_t ulOldest = (xCopy.ulHits - usWindowHits) & STATS_WINDOW_MASK;
+		uint32_t ulSpanMs = (xCopy.xWindowTick[ulNewest] - xCopy.xWindowTick[ulOldest]) * 1000 / configTICK_RATE_HZ;
+
+		pxStats->usWindowForceMax = xCopy.usWindowForce[xCopy.xWindowMax.ucHit[xCopy.xWindowMax.ucFront] & STATS_WINDOW_MASK];
+		pxStats->usWindowForceMin = xCopy.usWindowForce[xCopy.xWindowMin.ucHit[xCopy.xWindowMin.ucFront] & STATS_WINDOW_MASK];
+		if (usWindowHits > 1)
+		{
+			uint32_t ulRate = (ulSpanMs > 0) ? (usWindowHits - 1) * 600000UL / ulSpanMs : UINT16_MAX;
+			pxStats->usWindowRate = (uint16_t)((ulRate < UINT16_MAX) ? ulRate : UINT16_MAX);
+		}
+	}
+}
+
+/**
+ * @brief Writes the fields in order, then the CRC of everything before it.
+ */
+size_t SessionStatsSerialize(const SessionStats_t *pxStats, uint8_t *pucRecord, size_t xSize)
+{
+	uint8_t *pucOut = pucRecord;
+
+	if (xSize < STATS_RECORD_BYTES)
+	{
+		return 0;
+	}
+
+	*pucOut++ = STATS_RECORD_VERSION;
+	*pucOut++ = STATS_WINDOW_HITS;
+	pucOut = prvPut32(pucOut, pxStats->xStart);
+	pucOut = prvPut32(pucOut, pxStats->xNow);
+	pucOut = prvPut32(pucOut, pxStats->ulHits);
+	pucOut = prvPut32(pucOut, pxStats->ulRallies);
+	pucOut = prvPutSummary(pucOut, &pxStats->xForce);
+	pucOut = prvPutSummary(pucOut, &pxStats->xInterval);
+	pucOut = prvPut16(pucOut, pxStats->usWindowHits);
+	pucOut = prvPut16(pucOut, pxStats->usWindowRate);
+	pucOut = prvPut16(pucOut, pxStats->usWindowForceMin);
+	pucOut = prvPut16(pucOut, pxStats->usWindowForceMax);
+	for (uint8_t i = 0; i < STATS_BINS; i++)
+	{
+		pucOut = prvPut16(pucOut, pxStats->usForceBins[i]);
+	}
+	for (uint8_t i = 0; i < STATS_BINS; i++)
+	{
+		pucOut = prvPut16(pucOut, pxStats->usIntervalBins[i]);
+	}
+	pucOut = prvPut16(pucOut, prvCrc16(pucRecord, (size_t)(pucOut - pucRecord)));
+
+	configASSERT(pucOut - pucRecord == STATS_RECORD_BYTES);
+	return STATS_RECORD_BYTES;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvWelfordAdd(Welford_t *pxWelford, uint16_t usValue)
+ * @brief		Welford's update: the mean moves by delta / n, and the squared
+ *				deviations grow by delta times the distance to the new mean
+ * @details		The new mean lies between the old one and the value, so the
+ *				product is never negative. Each division truncates by under
+ *				2^-STATS_MEAN_SHIFT; later updates pull the mean back, so the
+ *				error stays within a few of those.
+ *****************************************************************************/
+static void prvWelfordAdd(Welford_t *pxWelford, uint16_t usValue)
+{
+	int32_t lValue = (int32_t)usValue << STATS_MEAN_SHIFT;
+	int32_t lDelta = lValue - pxWelford->lMean;
+
+	pxWelford->ulCount++;
+	pxWelford->lMean += lDelta / (int32_t)pxWelford->ulCount;
+	pxWelford->ullM2 += (uint64_t)((int64_t)lDelta * (lValue - pxWelford->lMean));
+
+	if (pxWelford->ulCount == 1 || usValue < pxWelford->usMin)
+	{
+		pxWelford->usMin = usValue;
+	}
+	if (usValue > pxWelford->usMax)
+	{
+		pxWelford->usMax = usValue;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvWelfordSummary(const Welford_t *pxWelford, StatsSummary_t *pxSummary)
+ * @brief		Rounded mean and sample standard deviation
+ *****************************************************************************/
+static void prvWelfordSummary(const Welford_t *pxWelford, StatsSummary_t *pxSummary)
+{
+	pxSummary->ulCount = pxWelford->ulCount;
+	pxSummary->usMean = (uint16_t)((pxWelford->lMean + (1L << (STATS_MEAN_SHIFT - 1))) >> STATS_MEAN_SHIFT);
+	pxSummary->usStdDev = 0;
+	pxSummary->usMin = pxWelford->usMin;
+	pxSummary->usMax = pxWelford->usMax;
+
+	if (pxWelford->ulCount > 1)
+	{
+		// The root keeps one 2^STATS_MEAN_SHIFT factor of the squared scale
+		uint32_t ulRoot = prvSqrt(pxWelford->ullM2 / (pxWelford->ulCount - 1));
+
+		ulRoot = (ulRoot + (1UL << (STATS_MEAN_SHIFT - 1))) >> STATS_MEAN_SHIFT;
+		pxSummary->usStdDev = (uint16_t)((ulRoot < UINT16_MAX) ? ulRoot : UINT16_MAX);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvDequePush(Deque_t *pxDeque, const uint16_t *pusForce, uint8_t ucHit, bool bMax)
+ * @brief		Adds the newest hit to a window deque
+ * @details		The front leaves once STATS_WINDOW_HITS newer hits have come.
+ *				Hits at the back that can no longer be the extreme, being older
+ *				and no more extreme than the newest, are dropped before it is
+ *				added. So the front is always the extreme of the window.
+ * @param[in]	pusForce Window ring of forces, the newest hit already in place
+ * @param[in]	bMax true for the largest force, false for the smallest
+ *****************************************************************************/
+static void prvDequePush(Deque_t *pxDeque, const uint16_t *pusForce, uint8_t ucHit, bool bMax)
+{
+	uint16_t usForce = pusForce[ucHit & STATS_WINDOW_MASK];
+
+	if (pxDeque->ucLength > 0 && (uint8_t)(ucHit - pxDeque->ucHit[pxDeque->ucFront]) >= STATS_WINDOW_HITS)
+	{
+		pxDeque->ucFront = (pxDeque->ucFront + 1) & STATS_WINDOW_MASK;
+		pxDeque->ucLength--;
+	}
+
+	while (pxDeque->ucLength > 0)
+	{
+		uint8_t ucBack = pxDeque->ucHit[(pxDeque->ucFront + pxDeque->ucLength - 1) & STATS_WINDOW_MASK];
+		uint16_t usBack = pusForce[ucBack & STATS_WINDOW_MASK];
+
+		if (bMax ? (usBack > usForce) : (usBack < usForce))
+		{
+			break;
+		}
+		pxDeque->ucLength--;
+	}
+
+	pxDeque->ucHit[(pxDeque->ucFront + pxDeque->ucLength) & STATS_WINDOW_MASK] = ucHit;
+	pxDeque->ucLength++;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvBinAdd(uint16_t *pusBins, uint32_t ulBin)
+ * @brief		Counts into a histogram, the last bin taking everything above it
+ *****************************************************************************/
+static void prvBinAdd(uint16_t *pusBins, uint32_t ulBin)
+{
+	ulBin = (ulBin < STATS_BINS) ? ulBin : STATS_BINS - 1;
+	if (pusBins[ulBin] < UINT16_MAX)
+	{
+		pusBins[ulBin]++;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvSqrt(uint64_t ullValue)
+ * @brief		Integer square root, rounded down, one result bit per step
+ *****************************************************************************/
+static uint32_t prvSqrt(uint64_t ullValue)
+{
+	uint64_t ullRoot = 0;
+	uint64_t ullBit = 1ULL << 62;
+
+	while (ullBit > ullValue)
+	{
+		ullBit >>= 2;
+	}
+	while (ullBit != 0)
+	{
+		if (ullValue >= ullRoot + ullBit)
+		{
+			ullValue -= ullRoot + ullBit;
+			ullRoot = (ullRoot >> 1) + ullBit;
+		}
+		else
+		{
+			ullRoot >>= 1;
+		}
+		ullBit >>= 2;
+	}
+	return (uint32_t)ullRoot;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t *prvPut16(uint8_t *pucOut, uint16_t usValue)
+ * @brief		Writes little endian and returns the next position
+ *****************************************************************************/
+static uint8_t *prvPut16(uint8_t *pucOut, uint16_t usValue)
+{
+	pucOut[0] = (uint8_t)usValue;
+	pucOut[1] = (uint8_t)(usValue >> 8);
+	return pucOut + 2;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t *prvPut32(uint8_t *pucOut, uint32_t ulValue)
+ * @brief		Writes little endian and returns the next position
+ *****************************************************************************/
+static uint8_t *prvPut32(uint8_t *pucOut, uint32_t ulValue)
+{
+	pucOut = prvPut16(pucOut, (uint16_t)ulValue);
+	return prvPut16(pucOut, (uint16_t)(ulValue >> 16));
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint8_t *prvPutSummary(uint8_t *pucOut, const StatsSummary_t *pxSummary)
+ * @brief		Count, mean, standard deviation, min, max
+ *****************************************************************************/
+static uint8_t *prvPutSummary(uint8_t *pucOut, const StatsSummary_t *pxSummary)
+{
+	pucOut = prvPut32(pucOut, pxSummary->ulCount);
+	pucOut = prvPut16(pucOut, pxSummary->usMean);
+	pucOut = prvPut16(pucOut, pxSummary->usStdDev);
+	pucOut = prvPut16(pucOut, pxSummary->usMin);
+	return prvPut16(pucOut, pxSummary->usMax);
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+ * @brief		CRC-16/CCITT-FALSE, bitwise: the record is short and built rarely
+ *****************************************************************************/
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+{
+	uint16_t usCrc = STATS_CRC_INIT;
+
+	for (size_t i = 0; i < xLength; i++)
+	{
+		usCrc ^= (uint16_t)(pucData[i] << 8);
+		for (uint8_t ucBit = 0; ucBit < 8; ucBit++)
+		{
+			usCrc = (usCrc & 0x8000) ? (uint16_t)((usCrc << 1) ^ STATS_CRC_POLY) : (uint16_t)(usCrc << 1);
+		}
+	}
+	return usCrc;
+}
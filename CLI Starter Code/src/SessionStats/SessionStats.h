@@ -0,0 +1,117 @@
+/**************************************************************************/ /**
+ * @file      SessionStats.h
+ * @brief     Running statistics of the hits of a session: count, force and
+ *            rhythm, in constant time per hit and without the heap.
+ * @details   Every hit the pipeline detector reports is added once, with its
+ *            start tick and envelope peak:
+ *            --force (peak, mg) and interval to the previous hit (ms): count,
+ *              mean and standard deviation by Welford's update in integers,
+ *              with the mean kept to 1/2^STATS_MEAN_SHIFT, and min and max
+ *            --a gap over STATS_RALLY_GAP_MS starts a new rally instead of
+ *              counting as an interval, so breaks do not skew the rhythm
+ *            --the last STATS_WINDOW_HITS hits: their rate, and their lowest
+ *              and highest force from two monotonic deques, each hit pushed
+ *              and popped at most once
+ *            --histograms of force, 1 g per bin, and of interval,
+ *              2^STATS_INTERVAL_BIN_SHIFT ms per bin. The last bin of each
+ *              also takes everything above it; counts saturate
+ *
+ *            SessionStatsGet() derives the snapshot; SessionStatsSerialize()
+ *            packs it into a STATS_RECORD_BYTES record for upload. The "stats"
+ *            command shows both, and its reset starts a new session.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef SESSION_STATS_H
+#define SESSION_STATS_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "HitDetect/HitDetect.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STATS_WINDOW_HITS 16		 ///< Hits of the rolling window, a power of 2 up to 128
+#define STATS_BINS 16				 ///< Bins of each histogram
+#define STATS_INTERVAL_BIN_SHIFT 8	 ///< Interval bins of 256 ms, the last from 3.84 s
+#define STATS_RALLY_GAP_MS 5000		 ///< Longer gaps between hits start a new rally
+#define STATS_MEAN_SHIFT 8			 ///< Fraction bits of the running means
+#define STATS_RECORD_VERSION 1
+#define STATS_RECORD_BYTES (52 + 4 * STATS_BINS) ///< Serialized snapshot, see SessionStatsSerialize()
+
+#if (STATS_WINDOW_HITS & (STATS_WINDOW_HITS - 1)) != 0 || STATS_WINDOW_HITS > 128
+#error "STATS_WINDOW_HITS must be a power of 2 up to 128"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Summary of one measure.
+ */
+typedef struct
+{
+	uint32_t ulCount;
+	uint16_t usMean;
+	uint16_t usStdDev;	 ///< Sample standard deviation, 0 below two values
+	uint16_t usMin;		 ///< 0 when empty
+	uint16_t usMax;
+} StatsSummary_t;
+
+/**
+ * @brief Snapshot of the session.
+ */
+typedef struct
+{
+	TickType_t xStart;			 ///< Tick the session started
+	TickType_t xNow;			 ///< Tick of the snapshot
+	uint32_t ulHits;
+	uint32_t ulRallies;			 ///< Runs of hits closer than STATS_RALLY_GAP_MS
+	StatsSummary_t xForce;		 ///< Peak force, mg
+	StatsSummary_t xInterval;	 ///< Time between hits of a rally, ms
+	uint16_t usWindowHits;		 ///< Hits in the window, up to STATS_WINDOW_HITS
+	uint16_t usWindowRate;		 ///< Hits per minute over the window, x10. 0 below two hits
+	uint16_t usWindowForceMin;	 ///< mg
+	uint16_t usWindowForceMax;
+	uint16_t usForceBins[STATS_BINS];
+	uint16_t usIntervalBins[STATS_BINS];
+} SessionStats_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void SessionStatsReset(void)
+ * @brief		Clears everything and starts a new session at the current tick
+ *****************************************************************************/
+void SessionStatsReset(void);
+
+/**
+ * @fn			void SessionStatsAddHit(const Hit_t *pxHit)
+ * @brief		Adds one hit. Called by the hit detection stage, in time order
+ *****************************************************************************/
+void SessionStatsAddHit(const Hit_t *pxHit);
+
+/**
+ * @fn			void SessionStatsGet(SessionStats_t *pxStats)
+ * @brief		Takes a snapshot
+ *****************************************************************************/
+void SessionStatsGet(SessionStats_t *pxStats);
+
+/**
+ * @fn			size_t SessionStatsSerialize(const SessionStats_t *pxStats, uint8_t *pucRecord, size_t xSize)
+ * @brief		Packs a snapshot for upload, little endian:
+ *				uint8 version, uint8 STATS_WINDOW_HITS, uint32 start tick,
+ *				uint32 snapshot tick, uint32 hits, uint32 rallies,
+ *				force then interval as uint32 count and uint16 mean, std dev,
+ *				min, max, uint16 window hits, rate, force min, force max,
+ *				uint16 force bins[STATS_BINS], uint16 interval bins[STATS_BINS],
+ *				uint16 CRC-16/CCITT of all bytes before it
+ * @return		STATS_RECORD_BYTES, or 0 if xSize is smaller
+ *****************************************************************************/
+size_t SessionStatsSerialize(const SessionStats_t *pxStats, uint8_t *pucRecord, size_t xSize);
+
+#endif /* SESSION_STATS_H */
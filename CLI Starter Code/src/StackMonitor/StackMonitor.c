@@ -0,0 +1,120 @@
+/**************************************************************************/ /**
+ * @file      StackMonitor.c
+ * @brief     Measured stack peaks of every task and of the main stack. See StackMonitor.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "StackMonitor.h"
+#include "timers.h"
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A registered task stack.
+ */
+typedef struct
+{
+	TaskHandle_t xTask;
+	uint32_t ulDepth; ///< Words
+} StackMonitorTask_t;
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+extern uint32_t _sstack; ///< Lowest address of the main stack, from the linker script
+extern uint32_t _estack; ///< One past its highest address
+
+static StackMonitorTask_t xTasks[STACKMON_MAX_TASKS];
+static UBaseType_t uxTaskCount = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Paints the main stack below the current stack pointer.
+ * @details Everything below the stack pointer is unused this early. The
+ *          frames main() has already pushed are not painted and always show
+ *          as used.
+ */
+void StackMonitorPaintMainStack(void)
+{
+	uint32_t *pulWord = &_sstack;
+	uint32_t *pulStackPointer = (uint32_t *)(uintptr_t)__get_MSP();
+
+	while (pulWord < pulStackPointer)
+	{
+		*pulWord++ = STACKMON_FILL_WORD;
+	}
+}
+
+/**
+ * @brief Registers the kernel's own tasks.
+ */
+void StackMonitorInit(void)
+{
+	StackMonitorRegister(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+	StackMonitorRegister(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+}
+
+/**
+ * @brief Adds a task stack to the table.
+ */
+BaseType_t StackMonitorRegister(TaskHandle_t xTask, uint32_t ulDepth)
+{
+	if (xTask == NULL || uxTaskCount >= STACKMON_MAX_TASKS)
+	{
+		return pdFAIL;
+	}
+
+	xTasks[uxTaskCount].xTask = xTask;
+	xTasks[uxTaskCount].ulDepth = ulDepth;
+	uxTaskCount++;
+	return pdPASS;
+}
+
+/**
+ * @brief Returns the number of stacks, the main stack included.
+ */
+UBaseType_t StackMonitorGetCount(void)
+{
+	return uxTaskCount + 1;
+}
+
+/**
+ * @brief Measures one stack.
+ */
+BaseType_t StackMonitorGet(UBaseType_t uxIndex, StackUsage_t *pxUsage)
+{
+	if (uxIndex < uxTaskCount)
+	{
+		const StackMonitorTask_t *pxTask = &xTasks[uxIndex];
+
+		pxUsage->pcName = pcTaskGetName(pxTask->xTask);
+		pxUsage->ulSize = pxTask->ulDepth * sizeof(StackType_t);
+		pxUsage->ulPeak = (pxTask->ulDepth - uxTaskGetStackHighWaterMark(pxTask->xTask)) * sizeof(StackType_t);
+		return pdPASS;
+	}
+
+	if (uxIndex == uxTaskCount)
+	{
+		const uint32_t *pulWord = &_sstack;
+
+		// The stack grows down, so the first word that is not paint marks the peak
+		while (pulWord < &_estack && *pulWord == STACKMON_FILL_WORD)
+		{
+			pulWord++;
+		}
+
+		pxUsage->pcName = "main/ISR";
+		pxUsage->ulSize = (uint32_t)((uint8_t *)&_estack - (uint8_t *)&_sstack);
+		pxUsage->ulPeak = (uint32_t)((uint8_t *)&_estack - (uint8_t *)pulWord);
+		return pdPASS;
+	}
+
+	return pdFAIL;
+}
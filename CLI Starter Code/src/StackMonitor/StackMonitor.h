@@ -0,0 +1,87 @@
+/**************************************************************************/ /**
+ * @file      StackMonitor.h
+ * @brief     Measured stack peaks of every task and of the main stack.
+ * @details   FreeRTOS fills each task stack with 0xA5 when the task is created
+ *            and uxTaskGetStackHighWaterMark() counts how much of the fill is
+ *            still intact. This module does the same for the main stack,
+ *            which interrupts run on, and keeps a table of the task stacks
+ *            with their sizes so the "stacks" command can show size, peak and
+ *            headroom side by side.
+ *
+ *            A peak is the deepest the stack has been so far, not the deepest
+ *            it can get. tools/stack_depth.py computes that bound from the
+ *            -fstack-usage output of the build. Size each stack from the
+ *            larger of the two plus a margin.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef STACKMONITOR_H
+#define STACKMONITOR_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STACKMON_MAX_TASKS 6		   ///< Task stacks that can be registered
+#define STACKMON_FILL_WORD 0xA5A5A5A5UL ///< The main stack is painted with the byte FreeRTOS uses for task stacks
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief One stack as shown by the "stacks" command. Sizes are in bytes.
+ */
+typedef struct
+{
+	const char *pcName;
+	uint32_t ulSize;
+	uint32_t ulPeak; ///< Deepest use since reset
+} StackUsage_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void StackMonitorPaintMainStack(void)
+ * @brief		Fills the unused part of the main stack with STACKMON_FILL_WORD
+ * @note		Call first thing in main(), before interrupts are enabled
+ *****************************************************************************/
+void StackMonitorPaintMainStack(void);
+
+/**
+ * @fn			void StackMonitorInit(void)
+ * @brief		Registers the idle and timer daemon task stacks
+ * @note		Call from the daemon task startup hook. Application tasks
+ *				register their own with StackMonitorRegister()
+ *****************************************************************************/
+void StackMonitorInit(void);
+
+/**
+ * @fn			BaseType_t StackMonitorRegister(TaskHandle_t xTask, uint32_t ulDepth)
+ * @brief		Adds a task stack to the table shown by "stacks"
+ * @param[in]	xTask Task, as returned by xTaskCreateStatic()
+ * @param[in]	ulDepth Stack depth in words, as passed to xTaskCreateStatic()
+ * @return		pdPASS, or pdFAIL if xTask is NULL or the table is full
+ *****************************************************************************/
+BaseType_t StackMonitorRegister(TaskHandle_t xTask, uint32_t ulDepth);
+
+/**
+ * @fn			UBaseType_t StackMonitorGetCount(void)
+ * @brief		Returns the number of stacks: the registered tasks plus the main stack
+ *****************************************************************************/
+UBaseType_t StackMonitorGetCount(void);
+
+/**
+ * @fn			BaseType_t StackMonitorGet(UBaseType_t uxIndex, StackUsage_t *pxUsage)
+ * @brief		Measures one stack. The main stack is the last index
+ * @details		Scans the fill from the far end of the stack, so it takes time
+ *				proportional to the headroom. Call from a task, not an interrupt.
+ * @return		pdPASS, or pdFAIL if uxIndex is out of range
+ *****************************************************************************/
+BaseType_t StackMonitorGet(UBaseType_t uxIndex, StackUsage_t *pxUsage);
+
+#endif /* STACKMONITOR_H */
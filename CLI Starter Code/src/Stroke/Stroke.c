@@ -0,0 +1,433 @@
+/**************************************************************************/ /**
+ * @file      Stroke.c
+ * @brief     Stroke window features, int8 inference and the pipeline
+ *            classifier. See Stroke.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Stroke.h"
+#include "Pipeline/Pipeline.h"
+#include "Benchmark/Benchmark.h"
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STROKE_RING_MASK (STROKE_RING_SAMPLES - 1)
+#define STROKE_CRC_INIT 0xFFFF
+#define STROKE_CRC_POLY 0x1021
+#define STROKE_CRC_BYTES 2
+#define STROKE_MAX_SHIFT 47 ///< A 32-bit sum times the 16-bit multiplier is below 2^48
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvFeatures(const StrokeClassifier_t *pxClassifier, const Hit_t *pxHit, StrokeResult_t *pxResult);
+static q7_t prvSaturate(int32_t lValue);
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength);
+static void prvStrokeStage(const ImuBlock_t *pxFrame);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static StrokeClassifier_t xClassifier; ///< The pipeline classifier, only touched by the pipeline task
+static StrokeModel_t xModel;		   ///< Layers of ucStrokeModel
+static bool bModelValid;
+static StrokeStats_t xStats;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Loads the flash model and adds the classifier stage.
+ */
+void StrokeInit(void)
+{
+	bModelValid = StrokeModelLoad(&xModel, ucStrokeModel, usStrokeModelBytes);
+	StrokeReset(&xClassifier, bModelValid ? &xModel : NULL);
+	PipelineRegisterStage(prvStrokeStage);
+}
+
+/**
+ * @brief Header, CRC, then each layer against the one before it.
+ */
+bool StrokeModelLoad(StrokeModel_t *pxModel, const uint8_t *pucBlob, size_t xLength)
+{
+	size_t xOffset;
+	uint8_t ucInputs = STROKE_FEATURES;
+
+	memset(pxModel, 0, sizeof(*pxModel));
+	if (((uintptr_t)pucBlob & 3) != 0 || xLength < STROKE_HEADER_BYTES + STROKE_CRC_BYTES ||
+		memcmp(pucBlob, "STRK", 4) != 0 || pucBlob[4] != STROKE_MODEL_VERSION || pucBlob[5] != STROKE_FEATURE_VERSION ||
+		pucBlob[6] == 0 || pucBlob[6] > STROKE_MAX_LAYERS || pucBlob[7] != N_STROKES ||
+		(size_t)(pucBlob[8] | pucBlob[9] << 8) != xLength ||
+		prvCrc16(pucBlob, xLength - STROKE_CRC_BYTES) !=
+			(uint16_t)(pucBlob[xLength - 2] | pucBlob[xLength - 1] << 8))
+	{
+		return false;
+	}
+
+	xOffset = STROKE_HEADER_BYTES + pucBlob[6] * STROKE_LAYER_BYTES;
+	for (uint8_t l = 0; l < pucBlob[6]; l++)
+	{
+		const uint8_t *pucLayer = pucBlob + STROKE_HEADER_BYTES + l * STROKE_LAYER_BYTES;
+		StrokeLayer_t *pxLayer = &pxModel->xLayers[l];
+		bool bLast = (l + 1 == pucBlob[6]);
+
+		pxLayer->ucInputs = pucLayer[0];
+		pxLayer->ucOutputs = pucLayer[1];
+		pxLayer->bRelu = (pucLayer[2] & STROKE_FLAG_RELU) != 0;
+		pxLayer->ucShift = pucLayer[3];
+		pxLayer->usMultiplier = (uint16_t)(pucLayer[4] | pucLayer[5] << 8);
+		if (pxLayer->ucInputs != ucInputs || pxLayer->ucOutputs == 0 || pxLayer->ucOutputs > STROKE_MAX_WIDTH ||
+			pxLayer->ucShift == 0 || pxLayer->ucShift > STROKE_MAX_SHIFT ||
+			(bLast && (pxLayer->ucOutputs != N_STROKES || pxLayer->bRelu)))
+		{
+			return false;
+		}
+
+		pxLayer->plBias = (const int32_t *)(pucBlob + xOffset);
+		xOffset += 4 * pxLayer->ucOutputs;
+		pxLayer->pcWeights = (const q7_t *)(pucBlob + xOffset);
+		xOffset += pxLayer->ucInputs * pxLayer->ucOutputs;
+		xOffset = (xOffset + 3) & ~(size_t)3;
+		ucInputs = pxLayer->ucOutputs;
+	}
+	if (xOffset + STROKE_CRC_BYTES != xLength)
+	{
+		return false;
+	}
+
+	pxModel->ucLayers = pucBlob[6];
+	pxModel->usBytes = (uint16_t)xLength;
+	return true;
+}
+
+/**
+ * @brief The layers in turn, between the two halves of the arena.
+ */
+uint8_t StrokeInfer(const StrokeModel_t *pxModel, const q7_t *pcFeatures, q7_t *pcArena, q7_t *pcScores)
+{
+	q7_t *pcIn = pcArena;
+	q7_t *pcOut = pcArena + STROKE_MAX_WIDTH;
+	uint8_t ucBest = 0;
+
+	memcpy(pcIn, pcFeatures, STROKE_FEATURES);
+	for (uint8_t l = 0; l < pxModel->ucLayers; l++)
+	{
+		const StrokeLayer_t *pxLayer = &pxModel->xLayers[l];
+		const int64_t llRound = 1LL << (pxLayer->ucShift - 1);
+		q7_t *pcSwap;
+
+		for (uint8_t j = 0; j < pxLayer->ucOutputs; j++)
+		{
+			q31_t lDot;
+			int64_t llValue;
+
+			arm_dot_prod_q7(pcIn, (q7_t *)&pxLayer->pcWeights[j * pxLayer->ucInputs], pxLayer->ucInputs, &lDot);
+			llValue = (((int64_t)lDot + pxLayer->plBias[j]) * pxLayer->usMultiplier + llRound) >> pxLayer->ucShift;
+			if (pxLayer->bRelu && llValue < 0)
+			{
+				llValue = 0;
+			}
+			pcOut[j] = (llValue > INT8_MAX) ? INT8_MAX : ((llValue < INT8_MIN) ? INT8_MIN : (q7_t)llValue);
+		}
+		pcSwap = pcIn;
+		pcIn = pcOut;
+		pcOut = pcSwap;
+	}
+
+	// The last outputs are in pcIn after the swap
+	for (uint8_t c = 1; c < N_STROKES; c++)
+	{
+		if (pcIn[c] > pcIn[ucBest])
+		{
+			ucBest = c;
+		}
+	}
+	if (pcScores != NULL)
+	{
+		memcpy(pcScores, pcIn, N_STROKES);
+	}
+	return ucBest;
+}
+
+/**
+ * @brief Nothing kept, nothing pending.
+ */
+void StrokeReset(StrokeClassifier_t *pxClassifier, const StrokeModel_t *pxModel)
+{
+	memset(pxClassifier, 0, sizeof(*pxClassifier));
+	pxClassifier->pxModel = pxModel;
+}
+
+/**
+ * @brief Appends to the pending hits.
+ */
+bool StrokeAddHit(StrokeClassifier_t *pxClassifier, const Hit_t *pxHit)
+{
+	if (pxClassifier->ucPending >= STROKE_PENDING_HITS)
+	{
+		return false;
+	}
+	pxClassifier->xPending[pxClassifier->ucPending++] = *pxHit;
+	return true;
+}
+
+/**
+ * @brief The newest sample is at the block timestamp, the others a period apart before it.
+ */
+void StrokeAddBlock(StrokeClassifier_t *pxClassifier, const ImuBlock_t *pxBlock)
+{
+	for (uint16_t i = 0; i < pxBlock->usCount; i++)
+	{
+		StrokeSample_t *pxSample = &pxClassifier->xRing[pxClassifier->usAdded++ & STROKE_RING_MASK];
+
+		pxSample->xTick =
+			pxBlock->xTimestamp - pdMS_TO_TICKS((pxBlock->usCount - 1 - i) * 1000 / IMU_RATE_HZ(pxBlock->cRateShift));
+		memcpy(pxSample->sAccel, pxBlock->xSamples[i].sAccel, sizeof(pxSample->sAccel));
+		memcpy(pxSample->sGyro, pxBlock->xSamples[i].sGyro, sizeof(pxSample->sGyro));
+	}
+}
+
+/**
+ * @brief Features of the oldest pending hit, then the model, once the newest
+ *        sample is past the end of its window.
+ */
+bool StrokeNext(StrokeClassifier_t *pxClassifier, StrokeResult_t *pxResult)
+{
+	TickType_t xNewest;
+	const Hit_t *pxHit = &pxClassifier->xPending[0];
+
+	if (pxClassifier->ucPending == 0 || pxClassifier->usAdded == 0)
+	{
+		return false;
+	}
+	xNewest = pxClassifier->xRing[(uint16_t)(pxClassifier->usAdded - 1) & STROKE_RING_MASK].xTick;
+	if ((int32_t)(xNewest - pxHit->xTick) < (int32_t)pdMS_TO_TICKS(STROKE_AFTER_MS))
+	{
+		return false;
+	}
+
+	prvFeatures(pxClassifier, pxHit, pxResult);
+	pxResult->xDecided = xNewest;
+	if (pxClassifier->pxModel != NULL)
+	{
+		pxResult->ucStroke =
+			StrokeInfer(pxClassifier->pxModel, pxResult->cFeatures, pxClassifier->cArena, pxResult->cScores);
+	}
+	else
+	{
+		pxResult->ucStroke = N_STROKES;
+		memset(pxResult->cScores, 0, sizeof(pxResult->cScores));
+	}
+
+	pxClassifier->ucPending--;
+	memmove(&pxClassifier->xPending[0], &pxClassifier->xPending[1], pxClassifier->ucPending * sizeof(Hit_t));
+	return true;
+}
+
+/**
+ * @brief Queues the hit on the pipeline classifier and counts it.
+ */
+void StrokeQueueHit(const Hit_t *pxHit)
+{
+	bool bQueued = StrokeAddHit(&xClassifier, pxHit);
+
+	taskENTER_CRITICAL();
+	xStats.ulHits += bQueued ? 1 : 0;
+	xStats.ulDropped += bQueued ? 0 : 1;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief The loaded model, or NULL.
+ */
+const StrokeModel_t *StrokeGetModel(void)
+{
+	return bModelValid ? &xModel : NULL;
+}
+
+/**
+ * @brief The statics of this file.
+ */
+size_t StrokeGetRamBytes(void)
+{
+	return sizeof(xClassifier) + sizeof(xModel) + sizeof(bModelValid) + sizeof(xStats);
+}
+
+/**
+ * @brief Copies the counters.
+ */
+void StrokeGetStats(StrokeStats_t *pxStats)
+{
+	taskENTER_CRITICAL();
+	*pxStats = xStats;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Clears the counters.
+ */
+void StrokeResetStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(&xStats, 0, sizeof(xStats));
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvFeatures(const StrokeClassifier_t *pxClassifier, const Hit_t *pxHit, StrokeResult_t *pxResult)
+ * @brief		Reduces the window of a hit to its features, walking the ring
+ *				from the oldest sample. Ticks are compared by difference, so
+ *				the window may span a tick count wrap
+ *****************************************************************************/
+static void prvFeatures(const StrokeClassifier_t *pxClassifier, const Hit_t *pxHit, StrokeResult_t *pxResult)
+{
+	const TickType_t xSpan = pdMS_TO_TICKS(STROKE_BEFORE_MS + STROKE_AFTER_MS);
+	const TickType_t xFrom = pxHit->xTick - pdMS_TO_TICKS(STROKE_BEFORE_MS);
+	uint16_t usKept = (pxClassifier->usAdded < STROKE_RING_SAMPLES) ? pxClassifier->usAdded : STROKE_RING_SAMPLES;
+	uint16_t usIndex = (uint16_t)(pxClassifier->usAdded - usKept);
+	int32_t lSum[6] = {0};
+	int16_t sMin[6] = {0};
+	int16_t sMax[6] = {0};
+	int16_t sImpact[3] = {0};
+	bool bImpact = false;
+	uint16_t usCount = 0;
+	q7_t *pcOut = pxResult->cFeatures;
+
+	pxResult->xHit = *pxHit;
+	pxResult->bTruncated = (int32_t)(pxClassifier->xRing[usIndex & STROKE_RING_MASK].xTick - xFrom) > 0;
+
+	for (; usKept > 0; usKept--, usIndex++)
+	{
+		const StrokeSample_t *pxSample = &pxClassifier->xRing[usIndex & STROKE_RING_MASK];
+
+		if ((TickType_t)(pxSample->xTick - xFrom) >= xSpan)
+		{
+			continue;
+		}
+		for (uint8_t a = 0; a < 6; a++)
+		{
+			int16_t sValue = (a < 3) ? pxSample->sGyro[a] : pxSample->sAccel[a - 3];
+
+			lSum[a] += sValue;
+			sMin[a] = (usCount == 0 || sValue < sMin[a]) ? sValue : sMin[a];
+			sMax[a] = (usCount == 0 || sValue > sMax[a]) ? sValue : sMax[a];
+		}
+		if (!bImpact && (int32_t)(pxSample->xTick - pxHit->xTick) >= 0)
+		{
+			memcpy(sImpact, pxSample->sGyro, sizeof(sImpact));
+			bImpact = true;
+		}
+		usCount++;
+	}
+	pxResult->usSamples = usCount;
+	usCount = (usCount > 0) ? usCount : 1;
+
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		*pcOut++ = prvSaturate(sImpact[a] >> STROKE_GYRO_SHIFT);
+	}
+	for (uint8_t a = 0; a < 6; a += 3)
+	{
+		uint8_t ucShift = (a == 0) ? STROKE_GYRO_SHIFT : STROKE_ACCEL_SHIFT;
+
+		for (uint8_t i = a; i < a + 3; i++)
+		{
+			*pcOut++ = prvSaturate((lSum[i] / usCount) >> ucShift);
+		}
+		for (uint8_t i = a; i < a + 3; i++)
+		{
+			*pcOut++ = prvSaturate(sMin[i] >> ucShift);
+		}
+		for (uint8_t i = a; i < a + 3; i++)
+		{
+			*pcOut++ = prvSaturate(sMax[i] >> ucShift);
+		}
+	}
+	*pcOut = prvSaturate(pxHit->sPeak >> STROKE_PEAK_SHIFT);
+}
+
+/**************************************************************************/ /**
+ * @fn			static q7_t prvSaturate(int32_t lValue)
+ * @brief		Clips to the int8 range
+ *****************************************************************************/
+static q7_t prvSaturate(int32_t lValue)
+{
+	return (lValue > INT8_MAX) ? INT8_MAX : ((lValue < INT8_MIN) ? INT8_MIN : (q7_t)lValue);
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+ * @brief		CRC-16/CCITT-FALSE, a bit at a time. It only checks the model
+ *				at start-up, so it does without the table of Codec.c
+ *****************************************************************************/
+static uint16_t prvCrc16(const uint8_t *pucData, size_t xLength)
+{
+	uint16_t usCrc = STROKE_CRC_INIT;
+
+	for (size_t i = 0; i < xLength; i++)
+	{
+		usCrc ^= (uint16_t)(pucData[i] << 8);
+		for (uint8_t b = 0; b < 8; b++)
+		{
+			usCrc = (usCrc & 0x8000) ? (uint16_t)((usCrc << 1) ^ STROKE_CRC_POLY) : (uint16_t)(usCrc << 1);
+		}
+	}
+	return usCrc;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvStrokeStage(const ImuBlock_t *pxFrame)
+ * @brief		Pipeline stage: adds the block to the ring and classifies the
+ *				hits whose window it completes, each against
+ *				STROKE_BUDGET_CYCLES
+ *****************************************************************************/
+static void prvStrokeStage(const ImuBlock_t *pxFrame)
+{
+	StrokeResult_t xResult;
+
+	StrokeAddBlock(&xClassifier, pxFrame);
+	for (;;)
+	{
+		uint32_t ulStart = BenchmarkGetCycles();
+		uint32_t ulCycles, ulDelay;
+
+		if (!StrokeNext(&xClassifier, &xResult))
+		{
+			break;
+		}
+		ulCycles = BenchmarkGetCycles() - ulStart;
+		ulDelay = (xResult.xDecided - xResult.xHit.xTick) * 1000 / configTICK_RATE_HZ;
+
+		taskENTER_CRITICAL();
+		xStats.ulStrokes[xResult.ucStroke]++;
+		xStats.ulTruncated += xResult.bTruncated ? 1 : 0;
+		xStats.ulCyclesLast = ulCycles;
+		xStats.ullCyclesTotal += ulCycles;
+		if (ulCycles > xStats.ulCyclesMax)
+		{
+			xStats.ulCyclesMax = ulCycles;
+		}
+		if (ulCycles > STROKE_BUDGET_CYCLES)
+		{
+			xStats.ulOverBudget++;
+		}
+		if (ulDelay > xStats.ulDelayMax)
+		{
+			xStats.ulDelayMax = ulDelay;
+		}
+		xStats.xLast = xResult;
+		xStats.bHaveLast = true;
+		taskEXIT_CRITICAL();
+	}
+}
@@ -0,0 +1,281 @@
+/**************************************************************************/ /**
+ * @file      Stroke.h
+ * @brief     Stroke classification of each detected hit (forehand, backhand,
+ *            smash, drop) by a small int8 neural network, on the device.
+ * @details   The classifier keeps the last STROKE_RING_SAMPLES MPU6000
+ *            samples with their ticks. A hit from the detector waits until the
+ *            samples reach STROKE_AFTER_MS past its start; the window from
+ *            STROKE_BEFORE_MS before the start to STROKE_AFTER_MS after it,
+ *            the swing and the impact, is then reduced to STROKE_FEATURES
+ *            int8 features:
+ *            --gyroscope X Y Z at the impact, the first sample from the start
+ *            --gyroscope X Y Z mean, lowest and highest over the window
+ *            --accelerometer X Y Z mean, lowest and highest over the window
+ *            --the envelope peak of the hit
+ *            in raw units shifted down by STROKE_GYRO_SHIFT, STROKE_ACCEL_SHIFT
+ *            and STROKE_PEAK_SHIFT, saturated. They are means and extremes, so
+ *            they do not depend on the sample rate.
+ *
+ *            The network is a chain of up to STROKE_MAX_LAYERS dense layers.
+ *            Each output is the arm_dot_prod_q7() of the int8 input and a row
+ *            of int8 weights, plus an int32 bias, scaled back to int8 by a
+ *            multiplier and a right shift, and clipped at 0 where the layer
+ *            has a ReLU. The last layer gives one score per stroke; the
+ *            highest wins. The activations live in the arena of the
+ *            classifier, two layers wide, so inference needs no stack or heap
+ *            beyond a few words.
+ *
+ *            The model is a blob in flash, ucStrokeModel in StrokeModel.c,
+ *            written by tools/stroke/train.py from the features of labelled
+ *            sessions. StrokeModelLoad() checks it and points the layers into
+ *            it; nothing is copied. Little endian:
+ *                "STRK", uint8 STROKE_MODEL_VERSION, uint8
+ *                STROKE_FEATURE_VERSION, uint8 layers, uint8 classes, uint16
+ *                blob length, uint16 reserved (0)
+ *                per layer, STROKE_LAYER_BYTES: uint8 inputs, uint8 outputs,
+ *                uint8 flags (bit 0: ReLU), uint8 shift, uint16 multiplier,
+ *                uint16 reserved (0)
+ *                per layer: int32 biases[outputs], int8 weights[outputs]
+ *                [inputs], zeros to 4 bytes
+ *                the CRC-16/CCITT-FALSE of all bytes before it
+ *            A change to the features must bump STROKE_FEATURE_VERSION, so an
+ *            old model is refused rather than fed features it was not trained
+ *            on.
+ *
+ *            A StrokeClassifier_t holds all the state, so tools/replay runs
+ *            one on recorded sessions. StrokeInit() loads the model and hooks
+ *            a classifier into the frame pipeline, behind the hit detector;
+ *            the "stroke" command shows the counts, the inference time and
+ *            the footprint.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef STROKE_H
+#define STROKE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <arm_math.h>
+#include "Imu/Imu.h"
+#include "HitDetect/HitDetect.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define STROKE_BEFORE_MS 150		 ///< Window before the hit start, the swing
+#define STROKE_AFTER_MS 100			 ///< Window after it, the impact and follow-through
+#define STROKE_RING_SAMPLES 64		 ///< Samples kept for the windows, a power of 2
+#define STROKE_PENDING_HITS 4		 ///< Hits waiting for the end of their window
+#define STROKE_FEATURES 22
+#define STROKE_GYRO_SHIFT 8			 ///< Gyroscope features in 256 LSB, 15.6 dps
+#define STROKE_ACCEL_SHIFT 8		 ///< Accelerometer features in 256 LSB, 1/8 g
+#define STROKE_PEAK_SHIFT 8			 ///< Peak feature in 256 HIT_LSB_PER_G, 1/4 g
+#define STROKE_MAX_LAYERS 3
+#define STROKE_MAX_WIDTH 32			 ///< Most inputs or outputs of a layer
+#define STROKE_ARENA_BYTES (2 * STROKE_MAX_WIDTH) ///< Input and output of the layer being run
+#define STROKE_MODEL_VERSION 1
+#define STROKE_FEATURE_VERSION 1
+#define STROKE_HEADER_BYTES 12
+#define STROKE_LAYER_BYTES 8
+#define STROKE_FLAG_RELU 0x01
+#define STROKE_BUDGET_CYCLES 20000	 ///< Cycles one classification may take, checked by the pipeline stage
+
+#if (STROKE_RING_SAMPLES & (STROKE_RING_SAMPLES - 1)) != 0
+#error "STROKE_RING_SAMPLES must be a power of 2"
+#endif
+#if (STROKE_BEFORE_MS + STROKE_AFTER_MS) * IMU_RATE_HZ(IMU_RATE_SHIFT_MAX) / 1000 + IMU_BLOCK_SAMPLES > STROKE_RING_SAMPLES
+#error "STROKE_RING_SAMPLES does not hold a window at the top rate"
+#endif
+#if STROKE_FEATURES > STROKE_MAX_WIDTH
+#error "The features do not fit the arena"
+#endif
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief The strokes, in the order of the model outputs.
+ */
+enum eStrokes
+{
+	STROKE_FOREHAND = 0,
+	STROKE_BACKHAND,
+	STROKE_SMASH,
+	STROKE_DROP,
+	N_STROKES ///< Also the class of a hit classified without a valid model
+};
+
+/**
+ * @brief One dense layer, pointing into the model blob.
+ */
+typedef struct
+{
+	const int32_t *plBias;
+	const q7_t *pcWeights;	///< ucOutputs rows of ucInputs
+	uint16_t usMultiplier;	///< Output = (dot + bias) * usMultiplier >> ucShift, rounded
+	uint8_t ucShift;
+	uint8_t ucInputs;
+	uint8_t ucOutputs;
+	bool bRelu;
+} StrokeLayer_t;
+
+/**
+ * @brief A loaded model. Set up with StrokeModelLoad().
+ */
+typedef struct
+{
+	StrokeLayer_t xLayers[STROKE_MAX_LAYERS];
+	uint8_t ucLayers;
+	uint16_t usBytes; ///< Length of the blob
+} StrokeModel_t;
+
+/**
+ * @brief A sample of the window ring.
+ */
+typedef struct
+{
+	TickType_t xTick;
+	int16_t sAccel[3];
+	int16_t sGyro[3];
+} StrokeSample_t;
+
+/**
+ * @brief State of one classifier. Set up with StrokeReset().
+ */
+typedef struct
+{
+	StrokeSample_t xRing[STROKE_RING_SAMPLES];
+	uint16_t usAdded;						  ///< Samples added, free running. The newest is at usAdded - 1
+	Hit_t xPending[STROKE_PENDING_HITS];	  ///< Oldest first
+	uint8_t ucPending;
+	const StrokeModel_t *pxModel;			  ///< NULL to extract the features only
+	q7_t cArena[STROKE_ARENA_BYTES];
+} StrokeClassifier_t;
+
+/**
+ * @brief One classified hit.
+ */
+typedef struct
+{
+	Hit_t xHit;
+	TickType_t xDecided;			   ///< Tick of the newest sample when it was classified
+	uint16_t usSamples;				   ///< Samples in the window
+	bool bTruncated;				   ///< The window started before the oldest sample kept
+	uint8_t ucStroke;				   ///< enum eStrokes
+	q7_t cScores[N_STROKES];		   ///< Output of the last layer
+	q7_t cFeatures[STROKE_FEATURES];
+} StrokeResult_t;
+
+/**
+ * @brief Counters of the pipeline classifier.
+ */
+typedef struct
+{
+	uint32_t ulHits;				///< Hits queued
+	uint32_t ulDropped;				///< Hits not queued, STROKE_PENDING_HITS waiting
+	uint32_t ulStrokes[N_STROKES + 1]; ///< Hits classified as each stroke, the last without a model
+	uint32_t ulTruncated;			///< Of them with a window cut short
+	uint32_t ulCyclesLast;			///< Features and inference of the last hit
+	uint32_t ulCyclesMax;
+	uint64_t ullCyclesTotal;		///< Divide by the hits classified for the mean
+	uint32_t ulOverBudget;			///< Hits over STROKE_BUDGET_CYCLES
+	uint32_t ulDelayMax;			///< Longest time from a hit start to its class, ms
+	bool bHaveLast;
+	StrokeResult_t xLast;			///< Valid if bHaveLast
+} StrokeStats_t;
+
+/******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern const uint8_t ucStrokeModel[];	 ///< The model blob, StrokeModel.c
+extern const uint16_t usStrokeModelBytes;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void StrokeInit(void)
+ * @brief		Loads ucStrokeModel, resets the pipeline classifier and registers it as a pipeline stage
+ * @note		Call once from the daemon task startup hook, after PipelineInit() and HitDetectInit(). Without a
+ *				valid model the hits are still counted, as N_STROKES
+ *****************************************************************************/
+void StrokeInit(void);
+
+/**
+ * @fn			bool StrokeModelLoad(StrokeModel_t *pxModel, const uint8_t *pucBlob, size_t xLength)
+ * @brief		Checks a model blob and points the layers of pxModel into it
+ * @param[in]	pucBlob Aligned to 4 bytes, and kept as long as the model is used
+ * @return		false if it is not a model of this version, features and classes, or does not fit the arena
+ *****************************************************************************/
+bool StrokeModelLoad(StrokeModel_t *pxModel, const uint8_t *pucBlob, size_t xLength);
+
+/**
+ * @fn			uint8_t StrokeInfer(const StrokeModel_t *pxModel, const q7_t *pcFeatures, q7_t *pcArena, q7_t *pcScores)
+ * @brief		Runs the model on one set of features
+ * @param[in]	pcArena STROKE_ARENA_BYTES of scratch
+ * @param[out]	pcScores Optional, the N_STROKES outputs
+ * @return		The stroke with the highest score, the first of equals
+ *****************************************************************************/
+uint8_t StrokeInfer(const StrokeModel_t *pxModel, const q7_t *pcFeatures, q7_t *pcArena, q7_t *pcScores);
+
+/**
+ * @fn			void StrokeReset(StrokeClassifier_t *pxClassifier, const StrokeModel_t *pxModel)
+ * @brief		Empties the ring and the pending hits, and sets the model
+ *****************************************************************************/
+void StrokeReset(StrokeClassifier_t *pxClassifier, const StrokeModel_t *pxModel);
+
+/**
+ * @fn			bool StrokeAddHit(StrokeClassifier_t *pxClassifier, const Hit_t *pxHit)
+ * @brief		Queues a hit to be classified once its window is complete
+ * @return		false if STROKE_PENDING_HITS are already waiting
+ *****************************************************************************/
+bool StrokeAddHit(StrokeClassifier_t *pxClassifier, const Hit_t *pxHit);
+
+/**
+ * @fn			void StrokeAddBlock(StrokeClassifier_t *pxClassifier, const ImuBlock_t *pxBlock)
+ * @brief		Adds the samples of a block to the ring, timed back from its timestamp at its rate
+ *****************************************************************************/
+void StrokeAddBlock(StrokeClassifier_t *pxClassifier, const ImuBlock_t *pxBlock);
+
+/**
+ * @fn			bool StrokeNext(StrokeClassifier_t *pxClassifier, StrokeResult_t *pxResult)
+ * @brief		Classifies the oldest pending hit, if the samples have reached the end of its window
+ * @return		true if pxResult was written. Call again until false
+ *****************************************************************************/
+bool StrokeNext(StrokeClassifier_t *pxClassifier, StrokeResult_t *pxResult);
+
+/**
+ * @fn			void StrokeQueueHit(const Hit_t *pxHit)
+ * @brief		Queues a hit of the pipeline detector for the pipeline classifier
+ * @note		Pipeline task only, from the hit detector stage
+ *****************************************************************************/
+void StrokeQueueHit(const Hit_t *pxHit);
+
+/**
+ * @fn			const StrokeModel_t *StrokeGetModel(void)
+ * @brief		The model of the pipeline classifier
+ * @return		NULL if ucStrokeModel did not load
+ *****************************************************************************/
+const StrokeModel_t *StrokeGetModel(void);
+
+/**
+ * @fn			size_t StrokeGetRamBytes(void)
+ * @brief		RAM of the pipeline classifier: ring, pending hits, arena, model and counters
+ *****************************************************************************/
+size_t StrokeGetRamBytes(void);
+
+/**
+ * @fn			void StrokeGetStats(StrokeStats_t *pxStats)
+ * @brief		Copies the counters
+ *****************************************************************************/
+void StrokeGetStats(StrokeStats_t *pxStats);
+
+/**
+ * @fn			void StrokeResetStats(void)
+ * @brief		Clears the counters. Pending hits stay queued
+ *****************************************************************************/
+void StrokeResetStats(void);
+
+#endif /* STROKE_H */
@@ -0,0 +1,56 @@
+/**************************************************************************/ /**
+ * @file      StrokeModel.c
+ * @brief     The stroke classifier model blob, loaded by StrokeInit().
+ * @details   Generated by tools/stroke/train.py, do not edit. 22-16-4,
+ *            416 multiply-accumulates per inference, trained on 658
+ *            strokes; 165 held out, 97.0 % of them right after
+ *            quantisation.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Stroke.h"
+
+/******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/** Aligned so the biases are read in place */
+const uint8_t ucStrokeModel[526] __attribute__((aligned(4))) = {
+	0x53, 0x54, 0x52, 0x4B, 0x01, 0x01, 0x02, 0x04, 0x0E, 0x02, 0x00, 0x00, 0x16, 0x10, 0x01, 0x17,
+	0xD3, 0xA9, 0x00, 0x00, 0x10, 0x04, 0x00, 0x16, 0xE8, 0x81, 0x00, 0x00, 0xA7, 0xF7, 0xFF, 0xFF,
+	0xEE, 0x05, 0x00, 0x00, 0x9D, 0xEB, 0xFF, 0xFF, 0xAC, 0x06, 0x00, 0x00, 0xBF, 0xF2, 0xFF, 0xFF,
+	0x9E, 0x0B, 0x00, 0x00, 0xDA, 0xFF, 0xFF, 0xFF, 0xAC, 0x07, 0x00, 0x00, 0x94, 0xFE, 0xFF, 0xFF,
+	0x20, 0xFB, 0xFF, 0xFF, 0xB2, 0xF8, 0xFF, 0xFF, 0xA5, 0x18, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x00,
+	0xC4, 0xEC, 0xFF, 0xFF, 0x51, 0x05, 0x00, 0x00, 0xD8, 0xFE, 0xFF, 0xFF, 0x35, 0x05, 0xCF, 0x08,
+	0xEE, 0xC5, 0x0F, 0xDD, 0xBD, 0x12, 0x44, 0x20, 0xD9, 0x11, 0xD9, 0xF7, 0x03, 0xF1, 0x39, 0x0C,
+	0x19, 0x0A, 0x26, 0x1A, 0x09, 0xF5, 0xFD, 0xEE, 0x1B, 0x20, 0x2A, 0xD4, 0xFC, 0xFD, 0x8D, 0x81,
+	0xD7, 0x8F, 0xA1, 0xEA, 0x3A, 0xE6, 0xF8, 0x08, 0x2F, 0x30, 0xD8, 0xE0, 0xFD, 0x16, 0xEA, 0x35,
+	0xC5, 0x29, 0x48, 0x11, 0x4E, 0x22, 0xF4, 0x18, 0xFF, 0xD0, 0x51, 0x16, 0xEB, 0x53, 0x2D, 0x11,
+	0xC9, 0x11, 0xF2, 0xE5, 0x22, 0xED, 0xEA, 0x07, 0xFE, 0xE2, 0xE9, 0xD8, 0xE2, 0xE8, 0xD5, 0xE3,
+	0x06, 0xEB, 0x23, 0x23, 0xD3, 0xFF, 0x3F, 0xDA, 0x35, 0xF4, 0xB8, 0x15, 0x2D, 0xCA, 0xF9, 0x01,
+	0xBE, 0xB7, 0x0E, 0x9A, 0xE9, 0x3B, 0x3A, 0x1C, 0x02, 0x02, 0xF4, 0x04, 0x0C, 0x33, 0x27, 0x29,
+	0x17, 0x1C, 0xFC, 0xDB, 0xFC, 0xDE, 0xEE, 0xA5, 0xD6, 0xEB, 0xD0, 0xF4, 0x06, 0x0B, 0xE7, 0x23,
+	0xFF, 0xFB, 0x1C, 0x00, 0x09, 0x1D, 0xFE, 0xF3, 0x1D, 0x01, 0x13, 0x15, 0x09, 0x0B, 0xD7, 0x2F,
+	0x37, 0x15, 0xDA, 0xF6, 0xF1, 0xF6, 0xEA, 0xE7, 0xF2, 0x1C, 0x01, 0x0E, 0xE0, 0xDE, 0x0D, 0x0E,
+	0xD6, 0x01, 0xBF, 0xF0, 0xE6, 0xC6, 0xEA, 0xDB, 0xF9, 0xCC, 0x18, 0xF6, 0x33, 0xDF, 0x10, 0xE7,
+	0xDB, 0x05, 0x2F, 0xF2, 0x01, 0x13, 0xEC, 0x1D, 0x14, 0xF4, 0xEC, 0x01, 0xF9, 0xFF, 0xDD, 0xE9,
+	0xE1, 0xE2, 0xCE, 0x1B, 0x26, 0xF6, 0x26, 0x29, 0xE8, 0x15, 0xD3, 0xEB, 0x1B, 0x28, 0x44, 0x39,
+	0xED, 0x25, 0x01, 0xF1, 0x29, 0x20, 0xFE, 0x35, 0x25, 0xCE, 0x3B, 0x55, 0xDC, 0x21, 0x15, 0x16,
+	0xF9, 0x39, 0xCF, 0x52, 0x11, 0xC6, 0xD6, 0xD0, 0xCF, 0xF9, 0x17, 0x01, 0x08, 0x13, 0xFC, 0xF8,
+	0x33, 0xE0, 0x11, 0x1F, 0x27, 0xFF, 0x64, 0xF7, 0x0B, 0xC4, 0x7A, 0x74, 0x46, 0x76, 0x2C, 0x28,
+	0x33, 0xF9, 0xFB, 0x20, 0x14, 0xE8, 0x02, 0xEF, 0x1A, 0x2F, 0x01, 0xE1, 0x18, 0x13, 0xD0, 0xE6,
+	0xE0, 0x05, 0x10, 0xC6, 0xDE, 0xDC, 0xE2, 0xE4, 0xE1, 0x1C, 0x12, 0x1F, 0x47, 0xE8, 0x2C, 0x25,
+	0x9D, 0xD9, 0x1F, 0x51, 0x25, 0x35, 0x1F, 0x0F, 0xFE, 0xEC, 0xC1, 0xDC, 0x44, 0x16, 0x40, 0x10,
+	0x2A, 0x36, 0x08, 0xFF, 0xE0, 0xFF, 0xDF, 0x11, 0xFB, 0xF5, 0x26, 0xE8, 0x37, 0x10, 0xCE, 0x16,
+	0x36, 0xD5, 0x0B, 0xF8, 0xD1, 0x23, 0x3C, 0x21, 0x12, 0x34, 0x23, 0x2B, 0x2D, 0xF8, 0x23, 0x26,
+	0xE0, 0xDD, 0x07, 0x1B, 0xE2, 0xF6, 0x0F, 0xFA, 0xF5, 0x04, 0xFD, 0xDF, 0x4D, 0xFE, 0xFF, 0xFF,
+	0x58, 0x02, 0x00, 0x00, 0xC6, 0xF9, 0xFF, 0xFF, 0x95, 0x05, 0x00, 0x00, 0xFB, 0x38, 0xE0, 0xDC,
+	0x33, 0x1D, 0xF7, 0x0E, 0x11, 0xF7, 0x20, 0xDA, 0x17, 0x1F, 0xD8, 0x11, 0x0E, 0x13, 0xFC, 0x1E,
+	0xDD, 0x1D, 0xF6, 0x31, 0xF2, 0xE3, 0xF2, 0xC9, 0xF0, 0xE5, 0x0B, 0xEA, 0x39, 0xB7, 0x5D, 0x10,
+	0x2E, 0xD2, 0x0E, 0xEC, 0xFB, 0x34, 0x2B, 0xE7, 0xEC, 0x4B, 0x03, 0x24, 0xE4, 0xD6, 0xDC, 0xF7,
+	0xBB, 0x13, 0x16, 0xE4, 0xFA, 0x02, 0xBE, 0x7F, 0xFB, 0xB7, 0x14, 0x0B, 0xCC, 0x0C,
+};
+
+const uint16_t usStrokeModelBytes = sizeof(ucStrokeModel);
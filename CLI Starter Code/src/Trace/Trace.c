@@ -0,0 +1,197 @@
+/**************************************************************************/ /**
+ * @file      Trace.c
+ * @brief     Kernel trace recorder. See Trace.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <string.h>
+#include "Trace.h"
+#include "Benchmark/Benchmark.h"
+#include "ClockProfile/ClockProfile.h"
+#include "conf_ramfunc.h"
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvRecordClock(uint32_t ulCpuHz);
+static void prvClockChanged(enum eClockProfileEvents eEvent, uint32_t ulCpuHz);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static TraceEvent_t xTraceBuffer[TRACE_BUFFER_EVENTS];
+static volatile uint32_t ulTraceHead = 0;	 ///< Events ever written since the last clear. Slot is ulTraceHead % TRACE_BUFFER_EVENTS
+static volatile bool bTraceRunning = false;
+static char cTaskNames[TRACE_MAX_TASKS][TRACE_TASK_NAME_LEN + 1];
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Starts recording.
+ */
+void TraceInit(void)
+{
+	ClockProfileRegisterCallback(prvClockChanged);
+	TraceStart();
+}
+
+/**
+ * @brief Resumes recording into the ring.
+ */
+void TraceStart(void)
+{
+	bTraceRunning = true;
+	prvRecordClock(system_gclk_gen_get_hz(GCLK_GENERATOR_0));
+}
+
+/**
+ * @brief Stops recording.
+ */
+void TraceStop(void)
+{
+	bTraceRunning = false;
+}
+
+/**
+ * @brief Empties the ring.
+ */
+void TraceClear(void)
+{
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	ulTraceHead = 0;
+
+	__set_PRIMASK(ulPrimask);
+
+	if (bTraceRunning)
+	{
+		prvRecordClock(system_gclk_gen_get_hz(GCLK_GENERATOR_0));
+	}
+}
+
+/**
+ * @brief Returns true while events are being recorded.
+ */
+bool TraceIsRunning(void)
+{
+	return bTraceRunning;
+}
+
+/**
+ * @brief Returns the number of events in the ring.
+ */
+uint32_t TraceGetCount(void)
+{
+	uint32_t ulHead = ulTraceHead;
+	return (ulHead < TRACE_BUFFER_EVENTS) ? ulHead : TRACE_BUFFER_EVENTS;
+}
+
+/**
+ * @brief Returns the number of events overwritten.
+ */
+uint32_t TraceGetLost(void)
+{
+	uint32_t ulHead = ulTraceHead;
+	return (ulHead < TRACE_BUFFER_EVENTS) ? 0 : (ulHead - TRACE_BUFFER_EVENTS);
+}
+
+/**
+ * @brief Copies an event, 0 being the oldest.
+ */
+bool TraceGetEvent(uint32_t ulIndex, TraceEvent_t *pxEvent)
+{
+	uint32_t ulHead = ulTraceHead;
+	uint32_t ulCount = (ulHead < TRACE_BUFFER_EVENTS) ? ulHead : TRACE_BUFFER_EVENTS;
+
+	if (ulIndex >= ulCount)
+	{
+		return false;
+	}
+
+	*pxEvent = xTraceBuffer[(ulHead - ulCount + ulIndex) & (TRACE_BUFFER_EVENTS - 1)];
+	return true;
+}
+
+/**
+ * @brief Returns the name recorded for a task number.
+ */
+const char *TraceGetTaskName(uint32_t ulTaskNumber)
+{
+	if (ulTaskNumber >= TRACE_MAX_TASKS || cTaskNames[ulTaskNumber][0] == '\0')
+	{
+		return NULL;
+	}
+
+	return cTaskNames[ulTaskNumber];
+}
+
+/**
+ * @brief Appends one event to the ring. This is the hot path, called from the
+ *        scheduler on every context switch.
+ */
+RAMFUNC_HOT void vTraceRecord(uint8_t ucEvent, uint8_t ucAux, uint16_t usParam)
+{
+	TraceEvent_t *pxEvent;
+
+	if (!bTraceRunning)
+	{
+		return;
+	}
+
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	pxEvent = &xTraceBuffer[ulTraceHead & (TRACE_BUFFER_EVENTS - 1)];
+	ulTraceHead++;
+	pxEvent->ulTimestamp = BenchmarkGetCycles();
+	pxEvent->ucEvent = ucEvent;
+	pxEvent->ucAux = ucAux;
+	pxEvent->usParam = usParam;
+
+	__set_PRIMASK(ulPrimask);
+}
+
+/**
+ * @brief Keeps the task name and records the creation.
+ */
+void vTraceTaskCreated(uint32_t ulTaskNumber, const char *pcName)
+{
+	if (ulTaskNumber < TRACE_MAX_TASKS)
+	{
+		strncpy(cTaskNames[ulTaskNumber], pcName, TRACE_TASK_NAME_LEN);
+	}
+
+	vTraceRecord(TRACE_EVENT_TASK_CREATE, (uint8_t)ulTaskNumber, 0);
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvRecordClock(uint32_t ulCpuHz)
+ * @brief		Records the frequency the following timestamps count at
+ *****************************************************************************/
+static void prvRecordClock(uint32_t ulCpuHz)
+{
+	vTraceRecord(TRACE_EVENT_CLOCK, 0, (uint16_t)(ulCpuHz / 1000UL));
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvClockChanged(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+ * @brief		Clock profile callback. Marks where the timestamp rate changes
+ *****************************************************************************/
+static void prvClockChanged(enum eClockProfileEvents eEvent, uint32_t ulCpuHz)
+{
+	if (eEvent == CLOCK_PROFILE_POST_CHANGE)
+	{
+		prvRecordClock(ulCpuHz);
+	}
+}
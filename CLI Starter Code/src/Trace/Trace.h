@@ -0,0 +1,215 @@
+/**************************************************************************/ /**
+ * @file      Trace.h
+ * @brief     Kernel trace recorder. The FreeRTOS trace hooks, plus ISR and
+ *            critical section markers placed by hand, write 8-byte timestamped
+ *            events into a RAM ring that always holds the most recent
+ *            TRACE_BUFFER_EVENTS events.
+ * @details   Timestamps are CPU cycles from the benchmark counter (TC3), which
+ *            stops in STANDBY. A TRACE_EVENT_CLOCK event is recorded at start
+ *            and after every clock profile switch so the host can convert to
+ *            time. "trace dump" prints the ring as text, one 16 hex digit word
+ *            per event, and tools/trace2chrome.py converts a captured dump to
+ *            Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+ *
+ *            This header is included at the end of FreeRTOSConfig.h, so it must
+ *            not include asf.h or FreeRTOS.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define TRACE_ENABLED 1			 ///< 0 compiles every hook and marker out
+#define TRACE_BUFFER_EVENTS 256	 ///< Ring size in events. Must be a power of two
+#define TRACE_MAX_TASKS 8		 ///< Task names kept for the dump, by FreeRTOS task number
+#define TRACE_TASK_NAME_LEN 8	 ///< Bytes kept per task name, same as configMAX_TASK_NAME_LEN
+#define TRACE_FORMAT_VERSION 1	 ///< Printed in the dump header, bump when events change
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Event codes. The values are part of the dump format, only add to the end.
+ */
+enum eTraceEvents
+{
+	TRACE_EVENT_TASK_CREATE = 1,		 ///< aux: task number
+	TRACE_EVENT_TASK_SWITCHED_IN = 2,	 ///< aux: task number
+	TRACE_EVENT_TASK_SWITCHED_OUT = 3,	 ///< aux: task number
+	TRACE_EVENT_TASK_DELAY = 4,			 ///< aux: task number
+	TRACE_EVENT_QUEUE_CREATE = 5,		 ///< aux: queue type, param: queue address (low 16 bits)
+	TRACE_EVENT_QUEUE_SEND = 6,			 ///< Also semaphore give. aux/param as QUEUE_CREATE
+	TRACE_EVENT_QUEUE_RECEIVE = 7,		 ///< Also semaphore take
+	TRACE_EVENT_QUEUE_BLOCK_SEND = 8,	 ///< The current task blocks on a full queue
+	TRACE_EVENT_QUEUE_BLOCK_RECEIVE = 9, ///< The current task blocks on an empty queue
+	TRACE_EVENT_QUEUE_SEND_FROM_ISR = 10,
+	TRACE_EVENT_QUEUE_RECEIVE_FROM_ISR = 11,
+	TRACE_EVENT_ISR_ENTER = 12,			 ///< aux: eTraceIsrs
+	TRACE_EVENT_ISR_EXIT = 13,			 ///< aux: eTraceIsrs
+	TRACE_EVENT_SECTION_BEGIN = 14,		 ///< aux: eTraceSections
+	TRACE_EVENT_SECTION_END = 15,		 ///< aux: eTraceSections
+	TRACE_EVENT_LOW_POWER_BEGIN = 16,	 ///< Idle task suppresses ticks and sleeps
+	TRACE_EVENT_LOW_POWER_END = 17,
+	TRACE_EVENT_CLOCK = 18				 ///< param: CPU clock in kHz from here on
+};
+
+/**
+ * @brief Interrupt handlers that mark their entry and exit.
+ */
+enum eTraceIsrs
+{
+	TRACE_ISR_USART_RX = 0, ///< Console receive complete callback
+	TRACE_ISR_USART_TX = 1	///< Console transmit complete callback
+};
+
+/**
+ * @brief Code sections that mark their start and end, e.g. scheduler suspended regions.
+ */
+enum eTraceSections
+{
+	TRACE_SECTION_CONSOLE_READ = 0, ///< vTaskSuspendAll() region in SerialConsoleReadCharacter()
+	TRACE_SECTION_CLI_COMMAND = 1	///< One CLI command, from the end of its line to the end of its output
+};
+
+/**
+ * @brief One event as stored in the ring.
+ */
+typedef struct
+{
+	uint32_t ulTimestamp; ///< CPU cycles, wraps
+	uint8_t ucEvent;	  ///< eTraceEvents
+	uint8_t ucAux;		  ///< Task number, queue type, ISR or section
+	uint16_t usParam;	  ///< Event specific
+} TraceEvent_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void TraceInit(void)
+ * @brief		Starts recording. Events before this (task and queue creation at
+ *				boot) are not recorded, but task names are kept
+ * @note		Call from the daemon task startup hook, after BenchmarkInit()
+ *****************************************************************************/
+void TraceInit(void);
+
+/**
+ * @fn			void TraceStart(void)
+ * @brief		Resumes recording into the ring
+ *****************************************************************************/
+void TraceStart(void);
+
+/**
+ * @fn			void TraceStop(void)
+ * @brief		Stops recording. The ring keeps its contents
+ *****************************************************************************/
+void TraceStop(void);
+
+/**
+ * @fn			void TraceClear(void)
+ * @brief		Empties the ring
+ *****************************************************************************/
+void TraceClear(void);
+
+/**
+ * @fn			bool TraceIsRunning(void)
+ * @brief		Returns true while events are being recorded
+ *****************************************************************************/
+bool TraceIsRunning(void);
+
+/**
+ * @fn			uint32_t TraceGetCount(void)
+ * @brief		Returns the number of events in the ring, at most TRACE_BUFFER_EVENTS
+ *****************************************************************************/
+uint32_t TraceGetCount(void);
+
+/**
+ * @fn			uint32_t TraceGetLost(void)
+ * @brief		Returns the number of events overwritten since the last TraceClear()
+ *****************************************************************************/
+uint32_t TraceGetLost(void);
+
+/**
+ * @fn			bool TraceGetEvent(uint32_t ulIndex, TraceEvent_t *pxEvent)
+ * @brief		Copies an event, 0 being the oldest still in the ring
+ * @return		false if ulIndex >= TraceGetCount()
+ *****************************************************************************/
+bool TraceGetEvent(uint32_t ulIndex, TraceEvent_t *pxEvent);
+
+/**
+ * @fn			const char *TraceGetTaskName(uint32_t ulTaskNumber)
+ * @brief		Returns the name recorded for a task number, or NULL if unknown
+ *****************************************************************************/
+const char *TraceGetTaskName(uint32_t ulTaskNumber);
+
+/**
+ * @fn			void vTraceRecord(uint8_t ucEvent, uint8_t ucAux, uint16_t usParam)
+ * @brief		Appends one event to the ring. Safe from tasks, interrupts and
+ *				critical sections. Returns at once while recording is stopped
+ *****************************************************************************/
+void vTraceRecord(uint8_t ucEvent, uint8_t ucAux, uint16_t usParam);
+
+/**
+ * @fn			void vTraceTaskCreated(uint32_t ulTaskNumber, const char *pcName)
+ * @brief		Keeps the task name for the dump and records TRACE_EVENT_TASK_CREATE
+ *****************************************************************************/
+void vTraceTaskCreated(uint32_t ulTaskNumber, const char *pcName);
+
+/******************************************************************************
+ * Markers and FreeRTOS hooks
+ ******************************************************************************/
+#if defined(QEMU_TARGET)
+// tools/qemu: the board counts instructions between these calls, independent of TRACE_ENABLED
+void QemuBoardSectionBegin(uint8_t ucSection);
+void QemuBoardSectionEnd(uint8_t ucSection);
+#define TRACE_BOARD_SECTION_BEGIN(eSection) QemuBoardSectionBegin(eSection)
+#define TRACE_BOARD_SECTION_END(eSection) QemuBoardSectionEnd(eSection)
+#else
+#define TRACE_BOARD_SECTION_BEGIN(eSection)
+#define TRACE_BOARD_SECTION_END(eSection)
+#endif
+
+#if TRACE_ENABLED
+
+#define TraceIsrEnter(eIsr) vTraceRecord(TRACE_EVENT_ISR_ENTER, (eIsr), 0)
+#define TraceIsrExit(eIsr) vTraceRecord(TRACE_EVENT_ISR_EXIT, (eIsr), 0)
+#define TraceSectionBegin(eSection) do { vTraceRecord(TRACE_EVENT_SECTION_BEGIN, (eSection), 0); TRACE_BOARD_SECTION_BEGIN(eSection); } while (0)
+#define TraceSectionEnd(eSection) do { TRACE_BOARD_SECTION_END(eSection); vTraceRecord(TRACE_EVENT_SECTION_END, (eSection), 0); } while (0)
+
+// Expanded inside tasks.c, where pxCurrentTCB and TCB_t are visible
+#define traceTASK_CREATE(pxNewTCB) vTraceTaskCreated((pxNewTCB)->uxTCBNumber, (pxNewTCB)->pcTaskName)
+#define traceTASK_SWITCHED_IN() vTraceRecord(TRACE_EVENT_TASK_SWITCHED_IN, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SWITCHED_OUT() vTraceRecord(TRACE_EVENT_TASK_SWITCHED_OUT, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_DELAY() vTraceRecord(TRACE_EVENT_TASK_DELAY, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceLOW_POWER_IDLE_BEGIN() vTraceRecord(TRACE_EVENT_LOW_POWER_BEGIN, 0, 0)
+#define traceLOW_POWER_IDLE_END() vTraceRecord(TRACE_EVENT_LOW_POWER_END, 0, 0)
+
+// Expanded inside queue.c. Queues are identified by the low half of their address
+#define TRACE_QUEUE(eEvent, pxQueue) vTraceRecord((eEvent), (pxQueue)->ucQueueType, (uint16_t)(uintptr_t)(pxQueue))
+#define traceQUEUE_CREATE(pxNewQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_CREATE, pxNewQueue)
+#define traceQUEUE_SEND(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_BLOCK_SEND, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_BLOCK_RECEIVE, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND_FROM_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE_FROM_ISR, pxQueue)
+
+#else
+
+#define TraceIsrEnter(eIsr)
+#define TraceIsrExit(eIsr)
+#define TraceSectionBegin(eSection) TRACE_BOARD_SECTION_BEGIN(eSection)
+#define TraceSectionEnd(eSection) TRACE_BOARD_SECTION_END(eSection)
+
+#endif /* TRACE_ENABLED */
+
+#endif /* TRACE_H */
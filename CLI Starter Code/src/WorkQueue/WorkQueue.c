@@ -0,0 +1,395 @@
+/**************************************************************************/ /**
+ * @file      WorkQueue.c
+ * @brief     Deferred background jobs run by the timer daemon task. See WorkQueue.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "WorkQueue.h"
+#include "Benchmark/Benchmark.h"
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static BaseType_t prvSubmit(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken);
+static bool prvEnqueue(WorkItem_t *pxItem);
+static bool prvClaimDrain(void);
+static WorkItem_t *prvDequeue(void);
+static void prvDrain(void *pvParameter1, uint32_t ulParameter2);
+static void prvDelayExpired(TimerHandle_t xTimer);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static WorkItem_t *pxHeads[N_WORK_PRIORITIES]; ///< FIFO of queued items per priority
+static WorkItem_t *pxTails[N_WORK_PRIORITIES];
+static bool bDrainPending = false;	  ///< A drain is posted or running, so submissions need not post another
+static uint32_t ulPostFailures = 0;
+
+static WorkItem_t *pxItems[WORKQUEUE_MAX_ITEMS];
+static UBaseType_t uxItemCount = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Creates the item's delay timer and adds it to the table.
+ */
+BaseType_t WorkQueueRegister(WorkItem_t *pxItem)
+{
+	configASSERT(pxItem != NULL && pxItem->pxFunction != NULL && pxItem->ePriority < N_WORK_PRIORITIES);
+
+	if (pxItem->xTimer == NULL)
+	{
+		pxItem->xTimer = xTimerCreateStatic(pxItem->pcName, 1, pdFALSE, pxItem, prvDelayExpired, &pxItem->xTimerBuffer);
+	}
+
+	if (uxItemCount >= WORKQUEUE_MAX_ITEMS)
+	{
+		return pdFAIL;
+	}
+
+	pxItems[uxItemCount++] = pxItem;
+	return pdPASS;
+}
+
+/**
+ * @brief Queues the item to run as soon as possible.
+ */
+BaseType_t WorkQueueSubmit(WorkItem_t *pxItem)
+{
+	return prvSubmit(pxItem, NULL);
+}
+
+/**
+ * @brief Queues the item from an interrupt.
+ */
+BaseType_t WorkQueueSubmitFromISR(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	BaseType_t xWoken = pdFALSE;
+	BaseType_t xResult = prvSubmit(pxItem, &xWoken);
+
+	if (pxHigherPriorityTaskWoken != NULL && xWoken == pdTRUE)
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+	return xResult;
+}
+
+/**
+ * @brief Queues the item after a delay.
+ */
+BaseType_t WorkQueueSubmitDelayed(WorkItem_t *pxItem, TickType_t xDelay)
+{
+	UBaseType_t uxSavedInterruptStatus;
+
+	if (pxItem->xTimer == NULL)
+	{
+		return pdFAIL;
+	}
+
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	if (pxItem->eState == WORK_STATE_QUEUED)
+	{
+		// Coalesced there, and a drain is posted if a failed post left it without one
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+		return prvSubmit(pxItem, NULL);
+	}
+	if (pxItem->eState == WORK_STATE_DELAYED)
+	{
+		pxItem->xStats.ulCoalesced++;
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+		return pdPASS;
+	}
+	pxItem->eState = WORK_STATE_DELAYED;
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+	// Timer commands leave the interrupt mask with taskEXIT_CRITICAL(), so this one is sent outside it.
+	// A period of 0 is not allowed, the shortest delay is the next tick
+	if (xTimerChangePeriod(pxItem->xTimer, (xDelay > 0) ? xDelay : 1, 0) != pdPASS)
+	{
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		if (pxItem->eState == WORK_STATE_DELAYED)
+		{
+			pxItem->eState = WORK_STATE_IDLE;
+		}
+		ulPostFailures++;
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+		return pdFAIL;
+	}
+	return pdPASS;
+}
+
+/**
+ * @brief Copies the item's counters.
+ */
+void WorkQueueGetStats(const WorkItem_t *pxItem, WorkStats_t *pxStats)
+{
+	UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	*pxStats = pxItem->xStats;
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+ * @brief Clears the counters of every registered item.
+ */
+void WorkQueueResetStats(void)
+{
+	UBaseType_t uxSavedInterruptStatus;
+
+	for (UBaseType_t i = 0; i < uxItemCount; i++)
+	{
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		pxItems[i]->xStats = (WorkStats_t){0};
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+	}
+	ulPostFailures = 0;
+}
+
+/**
+ * @brief Returns how many drains or delays could not be posted.
+ */
+uint32_t WorkQueueGetPostFailures(void)
+{
+	return ulPostFailures;
+}
+
+/**
+ * @brief Returns the number of registered items.
+ */
+UBaseType_t WorkQueueGetCount(void)
+{
+	return uxItemCount;
+}
+
+/**
+ * @brief Returns a registered item.
+ */
+const WorkItem_t *WorkQueueGet(UBaseType_t uxIndex)
+{
+	return (uxIndex < uxItemCount) ? pxItems[uxIndex] : NULL;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**
+ * @fn			static BaseType_t prvSubmit(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken)
+ * @brief		Queues the item and posts a drain if none is pending
+ * @param[out]	pxHigherPriorityTaskWoken NULL from tasks, else set by xTimerPendFunctionCallFromISR()
+ *****************************************************************************/
+static BaseType_t prvSubmit(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	UBaseType_t uxSavedInterruptStatus;
+	BaseType_t xResult;
+	bool bPost;
+
+	// The FROM_ISR mask nests and works from task context too
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	bPost = prvEnqueue(pxItem);
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+	if (!bPost)
+	{
+		return pdPASS;
+	}
+
+	if (pxHigherPriorityTaskWoken != NULL)
+	{
+		xResult = xTimerPendFunctionCallFromISR(prvDrain, NULL, 0, pxHigherPriorityTaskWoken);
+	}
+	else
+	{
+		xResult = xTimerPendFunctionCall(prvDrain, NULL, 0, 0);
+	}
+
+	if (xResult != pdPASS)
+	{
+		// The item stays queued. Clearing the flag lets the next submission post the drain
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		bDrainPending = false;
+		ulPostFailures++;
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+	}
+	return xResult;
+}
+
+/**
+ * @fn			static bool prvEnqueue(WorkItem_t *pxItem)
+ * @brief		Appends the item to the FIFO of its priority, unless it is there already
+ * @details		An item already queued may be there from a submission whose
+ *				drain could not be posted, so it still claims the drain.
+ * @return		true if the caller must start a drain
+ * @note		Call with interrupts masked
+ *****************************************************************************/
+static bool prvEnqueue(WorkItem_t *pxItem)
+{
+	enum eWorkPriorities ePriority = pxItem->ePriority;
+
+	if (pxItem->eState == WORK_STATE_QUEUED)
+	{
+		pxItem->xStats.ulCoalesced++;
+		return prvClaimDrain();
+	}
+	if (pxItem->eState == WORK_STATE_DELAYED)
+	{
+		// Runs now instead. prvDelayExpired() ignores the timer when it expires
+		pxItem->xStats.ulCoalesced++;
+	}
+
+	pxItem->eState = WORK_STATE_QUEUED;
+	pxItem->ulQueuedAt = BenchmarkGetCycles();
+	pxItem->pxNext = NULL;
+	if (pxTails[ePriority] == NULL)
+	{
+		pxHeads[ePriority] = pxItem;
+	}
+	else
+	{
+		pxTails[ePriority]->pxNext = pxItem;
+	}
+	pxTails[ePriority] = pxItem;
+
+	return prvClaimDrain();
+}
+
+/**
+ * @fn			static bool prvClaimDrain(void)
+ * @brief		Marks a drain pending, unless one is already
+ * @return		true if the caller must start the drain
+ * @note		Call with interrupts masked
+ *****************************************************************************/
+static bool prvClaimDrain(void)
+{
+	if (bDrainPending)
+	{
+		return false;
+	}
+	bDrainPending = true;
+	return true;
+}
+
+/**
+ * @fn			static WorkItem_t *prvDequeue(void)
+ * @brief		Removes the oldest item of the highest priority that has one
+ * @return		The item, or NULL if nothing is queued
+ * @note		Call with interrupts masked
+ *****************************************************************************/
+static WorkItem_t *prvDequeue(void)
+{
+	WorkItem_t *pxItem;
+
+	for (uint8_t ePriority = 0; ePriority < N_WORK_PRIORITIES; ePriority++)
+	{
+		pxItem = pxHeads[ePriority];
+		if (pxItem != NULL)
+		{
+			pxHeads[ePriority] = pxItem->pxNext;
+			if (pxHeads[ePriority] == NULL)
+			{
+				pxTails[ePriority] = NULL;
+			}
+			return pxItem;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @fn			static void prvDrain(void *pvParameter1, uint32_t ulParameter2)
+ * @brief		Runs the queued items in the daemon task, WORKQUEUE_BATCH at a time
+ * @details		After a batch it posts itself again, so timer commands sent in
+ *				the meantime are processed before the rest of the backlog. If
+ *				that post fails it carries on instead. It clears bDrainPending
+ *				only when it finds every FIFO empty with interrupts masked, so
+ *				no item is left queued without a drain.
+ *****************************************************************************/
+static void prvDrain(void *pvParameter1, uint32_t ulParameter2)
+{
+	WorkItem_t *pxItem;
+	UBaseType_t uxSavedInterruptStatus;
+	UBaseType_t uxRuns = 0;
+	uint32_t ulQueuedAt, ulStart, ulLatency, ulDuration;
+
+	for (;;)
+	{
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		pxItem = prvDequeue();
+		if (pxItem == NULL)
+		{
+			bDrainPending = false;
+			taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+			return;
+		}
+		pxItem->eState = WORK_STATE_RUNNING;
+		ulQueuedAt = pxItem->ulQueuedAt;
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+		ulStart = BenchmarkGetCycles();
+		pxItem->pxFunction(pxItem->pvContext);
+		ulDuration = BenchmarkGetCycles() - ulStart;
+		ulLatency = ulStart - ulQueuedAt;
+
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		// Submitted or delayed again while it ran: leave it where that put it
+		if (pxItem->eState == WORK_STATE_RUNNING)
+		{
+			pxItem->eState = WORK_STATE_IDLE;
+		}
+		pxItem->xStats.ulRuns++;
+		pxItem->xStats.ullLatencyTotal += ulLatency;
+		if (ulLatency > pxItem->xStats.ulLatencyMax)
+		{
+			pxItem->xStats.ulLatencyMax = ulLatency;
+		}
+		if (ulDuration > pxItem->xStats.ulDurationMax)
+		{
+			pxItem->xStats.ulDurationMax = ulDuration;
+		}
+		taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+		if (++uxRuns == WORKQUEUE_BATCH)
+		{
+			if (xTimerPendFunctionCall(prvDrain, NULL, 0, 0) == pdPASS)
+			{
+				return;
+			}
+			uxRuns = 0;
+		}
+	}
+}
+
+/**
+ * @fn			static void prvDelayExpired(TimerHandle_t xTimer)
+ * @brief		Timer callback of a delayed item. Queues it, unless it was
+ *				submitted directly in the meantime
+ * @details		Already in the daemon task, so it drains here instead of posting,
+ *				also for an item submitted directly whose drain post failed.
+ *****************************************************************************/
+static void prvDelayExpired(TimerHandle_t xTimer)
+{
+	WorkItem_t *pxItem = (WorkItem_t *)pvTimerGetTimerID(xTimer);
+	UBaseType_t uxSavedInterruptStatus;
+	bool bDrain = false;
+
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	if (pxItem->eState == WORK_STATE_DELAYED)
+	{
+		pxItem->eState = WORK_STATE_IDLE;
+		bDrain = prvEnqueue(pxItem);
+	}
+	else if (pxItem->eState == WORK_STATE_QUEUED)
+	{
+		bDrain = prvClaimDrain();
+	}
+	taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+	if (bDrain)
+	{
+		prvDrain(NULL, 0);
+	}
+}
@@ -0,0 +1,193 @@
+/**************************************************************************/ /**
+ * @file      WorkQueue.h
+ * @brief     Deferred background jobs run by the FreeRTOS timer daemon task.
+ * @details   Small jobs such as statistics rollups, LED patterns and retries
+ *            do not need a task and a stack each. They are declared as work
+ *            items and run one after another by the timer daemon, which
+ *            already exists and already has a stack.
+ *
+ *            Submitting an item links it into the FIFO of its priority and,
+ *            if no drain is pending, posts one with xTimerPendFunctionCall().
+ *            The drain runs the queued items, highest priority first, up to
+ *            WORKQUEUE_BATCH at a time so that timer commands are not held
+ *            off by a long backlog. Submitting an item that is already queued
+ *            does nothing but count it as coalesced: the item runs once, for
+ *            all the events that asked for it. An item submitted while it
+ *            runs is queued again.
+ *
+ *                static void prvBlink(void *pvContext) { ... }
+ *                WORKQUEUE_DEFINE(xBlinkWork, "blink", prvBlink, NULL, WORK_PRIORITY_LOW);
+ *                ...
+ *                WorkQueueRegister(&xBlinkWork);           // once, before use
+ *                WorkQueueSubmitFromISR(&xBlinkWork, &xWoken); // from an interrupt
+ *                WorkQueueSubmitDelayed(&xBlinkWork, pdMS_TO_TICKS(500));
+ *
+ *            Work functions run in the daemon task, with its stack
+ *            (configTIMER_TASK_STACK_DEPTH) and priority. They must not
+ *            block: while one runs, no software timer expires.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "timers.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define WORKQUEUE_MAX_ITEMS 12 ///< Items that can be registered, and listed by the "work" command
+#define WORKQUEUE_BATCH 8	   ///< Items run by one drain before it re-posts itself behind pending timer commands
+
+/**
+ * @brief Declares a work item. Use at file scope, then call WorkQueueRegister()
+ *        once before the first submission.
+ * @param xItem Name of the WorkItem_t variable
+ * @param pcItemName Name shown by the "work" command
+ * @param pxItemFunction WorkFunction_t to run
+ * @param pvItemContext Argument passed to pxItemFunction
+ * @param eItemPriority One of eWorkPriorities
+ */
+#define WORKQUEUE_DEFINE(xItem, pcItemName, pxItemFunction, pvItemContext, eItemPriority) \
+	WorkItem_t xItem = {(pcItemName), (pxItemFunction), (pvItemContext), (eItemPriority)}
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief Priority of a work item. Queued items of a higher priority always run first.
+ */
+enum eWorkPriorities
+{
+	WORK_PRIORITY_HIGH = 0,
+	WORK_PRIORITY_NORMAL,
+	WORK_PRIORITY_LOW,
+	N_WORK_PRIORITIES
+};
+
+/**
+ * @brief Where a work item is. Only changed under the interrupt mask.
+ */
+enum eWorkStates
+{
+	WORK_STATE_IDLE = 0, ///< Not scheduled
+	WORK_STATE_DELAYED,	 ///< Its timer is running, it is queued when the timer expires
+	WORK_STATE_QUEUED,	 ///< Waiting for the drain
+	WORK_STATE_RUNNING	 ///< Its function is running in the daemon task
+};
+
+/**
+ * @brief A job. Runs in the daemon task and must not block.
+ */
+typedef void (*WorkFunction_t)(void *pvContext);
+
+/**
+ * @brief Counters of one work item. Times are CPU cycles (BenchmarkGetCycles()).
+ */
+typedef struct
+{
+	uint32_t ulRuns;
+	uint32_t ulCoalesced;	  ///< Submissions merged into an already queued (or delayed) run
+	uint64_t ullLatencyTotal; ///< Sum over runs of queue-to-start time
+	uint32_t ulLatencyMax;	  ///< Longest queue-to-start time
+	uint32_t ulDurationMax;	  ///< Longest run of the function
+} WorkStats_t;
+
+/**
+ * @brief A work item. Declare with WORKQUEUE_DEFINE rather than filling it in by hand.
+ */
+typedef struct xWORK_ITEM
+{
+	const char *const pcName;
+	const WorkFunction_t pxFunction;
+	void *const pvContext;
+	const enum eWorkPriorities ePriority;
+	struct xWORK_ITEM *pxNext;	 ///< Next item in the FIFO of its priority
+	volatile enum eWorkStates eState;
+	uint32_t ulQueuedAt;		 ///< BenchmarkGetCycles() when it was last queued
+	TimerHandle_t xTimer;		 ///< One-shot timer for WorkQueueSubmitDelayed(), created by WorkQueueRegister()
+	StaticTimer_t xTimerBuffer;
+	WorkStats_t xStats;
+} WorkItem_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			BaseType_t WorkQueueRegister(WorkItem_t *pxItem)
+ * @brief		Creates the item's delay timer and adds it to the table shown by "work"
+ * @param[in]	pxItem Item declared with WORKQUEUE_DEFINE
+ * @return		pdPASS, or pdFAIL if the table is full. The item can be submitted
+ *				either way, but not delayed
+ *****************************************************************************/
+BaseType_t WorkQueueRegister(WorkItem_t *pxItem);
+
+/**
+ * @fn			BaseType_t WorkQueueSubmit(WorkItem_t *pxItem)
+ * @brief		Queues the item to run as soon as the daemon task gets to it
+ * @details		An item that is already queued is not queued twice. A delayed
+ *				item is queued now, and its timer no longer queues it.
+ *				Safe from tasks, and from work functions and timer callbacks.
+ * @return		pdPASS when the item is queued. pdFAIL if the timer command
+ *				queue was full; the item stays queued and runs with the next
+ *				successful submission
+ *****************************************************************************/
+BaseType_t WorkQueueSubmit(WorkItem_t *pxItem);
+
+/**
+ * @fn			BaseType_t WorkQueueSubmitFromISR(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken)
+ * @brief		WorkQueueSubmit() for interrupts
+ * @param[out]	pxHigherPriorityTaskWoken Set to pdTRUE if the daemon task
+ *				should run when the interrupt returns, as for other FromISR calls
+ *****************************************************************************/
+BaseType_t WorkQueueSubmitFromISR(WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken);
+
+/**
+ * @fn			BaseType_t WorkQueueSubmitDelayed(WorkItem_t *pxItem, TickType_t xDelay)
+ * @brief		Queues the item when xDelay ticks have passed
+ * @details		An item that is already delayed or queued keeps its earlier
+ *				schedule and the call is counted as coalesced. A queued item
+ *				whose drain could not be posted gets one now, as with
+ *				WorkQueueSubmit(). Task context only, including work functions:
+ *				an item may delay itself to repeat.
+ * @return		pdPASS, or pdFAIL if the item is not registered or the timer
+ *				command queue was full
+ *****************************************************************************/
+BaseType_t WorkQueueSubmitDelayed(WorkItem_t *pxItem, TickType_t xDelay);
+
+/**
+ * @fn			void WorkQueueGetStats(const WorkItem_t *pxItem, WorkStats_t *pxStats)
+ * @brief		Copies the item's counters, consistently with a run finishing
+ *****************************************************************************/
+void WorkQueueGetStats(const WorkItem_t *pxItem, WorkStats_t *pxStats);
+
+/**
+ * @fn			void WorkQueueResetStats(void)
+ * @brief		Clears the counters of every registered item and the post failures
+ *****************************************************************************/
+void WorkQueueResetStats(void);
+
+/**
+ * @fn			uint32_t WorkQueueGetPostFailures(void)
+ * @brief		Returns how many times a drain could not be posted because the
+ *				timer command queue was full
+ *****************************************************************************/
+uint32_t WorkQueueGetPostFailures(void);
+
+/**
+ * @fn			UBaseType_t WorkQueueGetCount(void)
+ * @brief		Returns the number of registered items
+ *****************************************************************************/
+UBaseType_t WorkQueueGetCount(void);
+
+/**
+ * @fn			const WorkItem_t *WorkQueueGet(UBaseType_t uxIndex)
+ * @brief		Returns the registered item at uxIndex, or NULL if out of range
+ *****************************************************************************/
+const WorkItem_t *WorkQueueGet(UBaseType_t uxIndex);
+
+#endif /* WORKQUEUE_H */
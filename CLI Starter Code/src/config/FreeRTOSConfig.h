@@ -42,6 +42,7 @@
 #  include <gclk.h>
 #  include <stdint.h>
 void assert_triggered( const char * file, uint32_t line );
+void vLowPowerSuppressTicksAndSleep( uint32_t xExpectedIdleTime );
 #endif
 
 
@@ -50,27 +51,36 @@ void assert_triggered( const char * file, uint32_t line );
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
 #define configPRIO_BITS                         2
+#define configKERNEL_INTERRUPT_PRIORITY         ( 3 << ( 8 - configPRIO_BITS ) )  // Lowest. The CM0 port sets this itself
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY    ( 1 << ( 8 - configPRIO_BITS ) )  // Level 0 is for ISRs that never call the RTOS API, see conf_irq_priorities.h
 #define configCPU_CLOCK_HZ                      ( system_gclk_gen_get_hz(GCLK_GENERATOR_0) )
 #define configTICK_RATE_HZ                      ( ( portTickType ) 1000 )
 #define configMAX_PRIORITIES                    ( 5 )
 #define configMINIMAL_STACK_SIZE                ( ( unsigned short ) 100)
-/* configTOTAL_HEAP_SIZE is not used when heap_3.c is used. */
-#define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 12000 ) )
 #define configMAX_TASK_NAME_LEN                 ( 8 )
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_16_BIT_TICKS                  0
 #define configIDLE_SHOULD_YIELD                 1
 #define configUSE_MUTEXES                       1
 #define configQUEUE_REGISTRY_SIZE               0
-#define configCHECK_FOR_STACK_OVERFLOW          1
+#define configCHECK_FOR_STACK_OVERFLOW          2       // Also checks the last 16 bytes of fill, catches overflows that unwound before the switch
 #define configUSE_RECURSIVE_MUTEXES             1
-#define configUSE_MALLOC_FAILED_HOOK            1
+#define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configUSE_QUEUE_SETS                    1
 #define configGENERATE_RUN_TIME_STATS           0
 #define configENABLE_BACKWARD_COMPATIBILITY     1
+#define configUSE_TICKLESS_IDLE                 2	// Own implementation, RTC timed. See LowPower.c
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vLowPowerSuppressTicksAndSleep( xExpectedIdleTime )
 #define configUSE_DAEMON_TASK_STARTUP_HOOK		1	// Ported from FreeRToS 9.0.0
 
+/* Memory allocation. There is no RTOS heap: every task, queue and semaphore
+is created with the ...Static() API from memory declared by its owner, so the
+linker map shows where all of the RAM goes. */
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
 #define configMAX_CO_ROUTINE_PRIORITIES         ( 2 )
@@ -78,7 +88,7 @@ void assert_triggered( const char * file, uint32_t line );
 /* Software timer definitions. */
 #define configUSE_TIMERS                        1
 #define configTIMER_TASK_PRIORITY               ( 2 )
-#define configTIMER_QUEUE_LENGTH                5
+#define configTIMER_QUEUE_LENGTH                8       // Also carries work queue drains and delays (WorkQueue.c)
 #define configTIMER_TASK_STACK_DEPTH            ( 128 )
 
 /* Set the following definitions to 1 to include the API function, or zero
@@ -93,8 +103,9 @@ to exclude the API function. */
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
 #define INCLUDE_uxTaskGetStackHighWaterMark     1
-#define INCLUDE_xTaskGetIdleTaskHandle          0
-#define INCLUDE_xTimerGetTimerDaemonTaskHandle  0
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle  1
+#define INCLUDE_xTimerPendFunctionCall          1
 #define INCLUDE_pcTaskGetTaskName               0
 #define INCLUDE_eTaskGetState                   0
 
@@ -111,5 +122,24 @@ standard names - or at least those used in the unmodified vector table. */
 #define xPortSysTickHandler                     SysTick_Handler
 
 #define configCOMMAND_INT_MAX_OUTPUT_SIZE 32
+#define configCLI_MAX_ARGUMENTS           8      // Words per argv command, including the command itself
+#define configCLI_ARGUMENT_BUFFER_SIZE    100    // Holds a tokenised line, so keep it >= MAX_INPUT_LENGTH_CLI
+#define configCLI_MAX_COMMANDS            24     // Size of the sorted command index used for tab completion
+
+/* Kernel trace hooks (traceTASK_SWITCHED_IN etc.), see Trace.h. */
+#if defined (__GNUC__) || defined (__ICCARM__)
+#  include "Trace/Trace.h"
+#endif
+
+/* The context switch runs from SRAM, see conf_ramfunc.h. Declaring the kernel
+functions here with the section attribute places their definitions in port.c and
+tasks.c without editing the kernel sources. Keep the two together: PendSV calls
+vTaskSwitchContext with a plain BL from inline assembly, which -mlong-calls does
+not cover. */
+#if defined (__GNUC__)
+#  include "conf_ramfunc.h"
+void xPortPendSVHandler( void ) RAMFUNC_HOT;
+void vTaskSwitchContext( void ) RAMFUNC_HOT;
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
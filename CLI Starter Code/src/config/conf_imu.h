@@ -0,0 +1,72 @@
+/**************************************************************************/ /**
+ * @file      conf_imu.h
+ * @brief     Wiring and sampling settings of the two IMUs.
+ * @details   Both sensors sit on the EXT1 header of the SAMW25 Xplained Pro:
+ *            --MPU6000 (accelerometer and gyroscope) on the EXT1 SPI, SERCOM1
+ *              in mux setting E, chip select on EXT1 pin 15 (PA17) driven as a GPIO
+ *            --LIS2DS12 (accelerometer) on the EXT1 I2C, SERCOM0, with its INT1
+ *              on EXT1 pin 9 (PA20, EXTINT4)
+ *            Both run at IMU_SAMPLE_HZ into their hardware FIFOs. The LIS2DS12
+ *            raises INT1 when IMU_FIFO_WATERMARK samples are waiting, and the
+ *            IMU task then reads that many samples from both FIFOs by DMA.
+ *            The MPU6000 has no watermark interrupt; it runs at the same rate,
+ *            so its FIFO holds about as many samples.
+ *
+ *            The IMU task moves both to IMU_SAMPLE_HZ * 2^shift with the
+ *            activity, for shifts from IMU_RATE_SHIFT_MIN to IMU_RATE_SHIFT_MAX,
+ *            and scales the watermark to keep the block period. It does not go
+ *            below IMU_SAMPLE_HZ between rallies: an impact rings for about
+ *            30 ms, and the hit detector misses most first hits at 25 Hz and
+ *            many at 50 Hz (tools/replay on synthetic sessions, make check).
+ *
+ *            While the racket lies still, the MPU6000 sleeps and the LIS2DS12
+ *            runs in low power with its wake-up interrupt on the same INT1,
+ *            for a change of more than IMU_WAKE_THRESHOLD_MG.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CONF_IMU_H
+#define CONF_IMU_H
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IMU_SAMPLE_HZ 100	  ///< Output data rate of both sensors. The spec asks for a read every 10 ms
+#define IMU_FIFO_WATERMARK 10 ///< Samples per block, so the IMU task wakes at IMU_SAMPLE_HZ / 10
+#define IMU_RATE_SHIFT_MIN 0  ///< Slowest rate, IMU_SAMPLE_HZ, between rallies
+#define IMU_RATE_SHIFT_MAX 1  ///< Fastest rate, 200 Hz, in swings. The sensors share no rate above it with the MPU6000 DLPF on
+#define IMU_WAKE_THRESHOLD_MG 100 ///< LIS2DS12 wake-up threshold on its high-passed acceleration, 31 to 1968 mg
+
+// Both SERCOMs run from GCLK3 (OSC8M), so their BAUD values do not follow clock profile switches
+#define IMU_SERCOM_GCLK GCLK_GENERATOR_3
+
+// MPU6000 on SPI
+#define IMU_SPI_SERCOM SERCOM1
+#define IMU_SPI_SERCOM_APBC_MASK PM_APBCMASK_SERCOM1
+#define IMU_SPI_GCLK_ID SERCOM1_GCLK_ID_CORE
+#define IMU_SPI_DMAC_ID_RX SERCOM1_DMAC_ID_RX
+#define IMU_SPI_DMAC_ID_TX SERCOM1_DMAC_ID_TX
+#define IMU_SPI_DIPO 0										 ///< MISO on PAD0
+#define IMU_SPI_DOPO 1										 ///< MOSI on PAD2, SCK on PAD3
+#define IMU_SPI_PINMUX_MISO PINMUX_PA16C_SERCOM1_PAD0
+#define IMU_SPI_PINMUX_MOSI PINMUX_PA18C_SERCOM1_PAD2
+#define IMU_SPI_PINMUX_SCK PINMUX_PA19C_SERCOM1_PAD3
+#define IMU_SPI_PIN_CS PIN_PA17								 ///< EXT1_PIN_SPI_SS_0, driven as a GPIO
+#define IMU_SPI_BAUD_HZ 1000000UL							 ///< Highest rate for every MPU6000 register
+
+// LIS2DS12 on I2C
+#define IMU_I2C_SERCOM SERCOM0
+#define IMU_I2C_SERCOM_APBC_MASK PM_APBCMASK_SERCOM0
+#define IMU_I2C_GCLK_ID SERCOM0_GCLK_ID_CORE
+#define IMU_I2C_DMAC_ID_RX SERCOM0_DMAC_ID_RX
+#define IMU_I2C_PINMUX_SDA PINMUX_PA08C_SERCOM0_PAD0
+#define IMU_I2C_PINMUX_SCL PINMUX_PA09C_SERCOM0_PAD1
+#define IMU_I2C_BAUD_HZ 400000UL							 ///< Fast mode
+#define IMU_I2C_RISE_NS 215									 ///< SCL rise time with the board pull-ups, used in the BAUD calculation
+#define IMU_LIS2DS12_ADDRESS 0x1D							 ///< 7-bit address with SA0 high
+
+// LIS2DS12 INT1, the FIFO watermark while streaming, the wake-up while waiting for motion
+#define IMU_WATERMARK_PINMUX PINMUX_PA20A_EIC_EXTINT4
+#define IMU_WATERMARK_EXTINT 4
+
+#endif /* CONF_IMU_H */
@@ -0,0 +1,56 @@
+/**************************************************************************/ /**
+ * @file      conf_irq_priorities.h
+ * @brief     NVIC priority of every interrupt the application enables. Set
+ *            priorities from here only, so the whole map can be reviewed and
+ *            checked in one place.
+ * @details   The SAMD21 implements configPRIO_BITS (2) priority bits: 0 is the
+ *            highest and 3 the lowest, where the kernel (SysTick, PendSV) runs.
+ *            NVIC_SetPriority() keeps only the low bits of its argument, so a
+ *            value like 10 silently becomes 2.
+ *
+ *            Interrupts that call FreeRTOS ...FromISR() functions must not be
+ *            above configMAX_SYSCALL_INTERRUPT_PRIORITY. The Cortex-M0 port masks
+ *            every interrupt in its critical sections, so this is not enforced
+ *            at run time; it keeps level 0 for handlers that never touch the
+ *            kernel and is checked below at compile time.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CONF_IRQ_PRIORITIES_H
+#define CONF_IRQ_PRIORITIES_H
+
+#include "FreeRTOSConfig.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define IRQ_PRIORITY_LOWEST ((1 << configPRIO_BITS) - 1)											  ///< Same level as the kernel
+#define IRQ_PRIORITY_MAX_SYSCALL (configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8 - configPRIO_BITS)) ///< Highest level allowed to call the RTOS API
+
+// No RTOS calls. May preempt everything
+#define IRQ_PRIORITY_CYCLE_COUNTER 0 ///< TC3 overflow. Its entry latency is the IRQ monitor's jitter probe
+#define IRQ_PRIORITY_BENCHMARK_SWI 0 ///< Software pended interrupt of the isr_latency benchmark
+
+// Call the RTOS API
+#define IRQ_PRIORITY_CONSOLE 2 ///< SERCOM4 console USART. Gives the CLI RX semaphore
+#define IRQ_PRIORITY_DMAC 2	   ///< DMA transfer complete. Gives the IMU bus semaphores
+#define IRQ_PRIORITY_EIC 3	   ///< External interrupts: STANDBY wake, IMU FIFO watermark
+
+// No RTOS calls, but nothing urgent either
+#define IRQ_PRIORITY_RTC 3 ///< RTC compare, tickless idle wake
+
+/******************************************************************************
+ * Compile time checks
+ ******************************************************************************/
+#if (IRQ_PRIORITY_CYCLE_COUNTER > IRQ_PRIORITY_LOWEST) || (IRQ_PRIORITY_BENCHMARK_SWI > IRQ_PRIORITY_LOWEST) || \
+	(IRQ_PRIORITY_CONSOLE > IRQ_PRIORITY_LOWEST) || (IRQ_PRIORITY_DMAC > IRQ_PRIORITY_LOWEST) ||                \
+	(IRQ_PRIORITY_EIC > IRQ_PRIORITY_LOWEST) || (IRQ_PRIORITY_RTC > IRQ_PRIORITY_LOWEST)
+#error "An IRQ priority does not fit in configPRIO_BITS"
+#endif
+
+#if (IRQ_PRIORITY_CONSOLE < IRQ_PRIORITY_MAX_SYSCALL) || (IRQ_PRIORITY_DMAC < IRQ_PRIORITY_MAX_SYSCALL) || \
+	(IRQ_PRIORITY_EIC < IRQ_PRIORITY_MAX_SYSCALL)
+#error "An interrupt that calls the RTOS API is above configMAX_SYSCALL_INTERRUPT_PRIORITY"
+#endif
+
+#endif /* CONF_IRQ_PRIORITIES_H */
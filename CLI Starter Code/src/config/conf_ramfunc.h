@@ -0,0 +1,39 @@
+/**************************************************************************/ /**
+ * @file      conf_ramfunc.h
+ * @brief     Places hot interrupt and kernel paths in SRAM. At 48 MHz the flash
+ *            needs one wait state, so code fetched from it can stall; code run
+ *            from SRAM never does.
+ * @details   Functions marked RAMFUNC_HOT go in the .ramfunc.hot input section.
+ *            The linker script puts .ramfunc* at the start of .relocate, so
+ *            Reset_Handler copies it from flash along with .data, between
+ *            _sramfunc and _eramfunc. SRAM is out of BL range of flash; the
+ *            project builds with -mlong-calls, so every call is an indirect
+ *            BLX and works either way. Mark small callees of hot code too, or
+ *            they are still fetched from flash.
+ *
+ *            tools/memory_budget.py reports the SRAM taken as "Hot code (RAM)".
+ *            Set RAMFUNC_ENABLED to 0 and compare "bench all" (ctx_switch,
+ *            isr_latency, cbuf_*, trace_record) to measure what it buys;
+ *            fetch_flash and fetch_ram compare the same loop from each memory
+ *            in a single build.
+ *
+ *            This header is included from FreeRTOSConfig.h, so it must not
+ *            include asf.h or FreeRTOS.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CONF_RAMFUNC_H
+#define CONF_RAMFUNC_H
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define RAMFUNC_ENABLED 1 ///< 0 leaves every RAMFUNC_HOT function in flash
+
+#if RAMFUNC_ENABLED
+#define RAMFUNC_HOT __attribute__((section(".ramfunc.hot")))
+#else
+#define RAMFUNC_HOT
+#endif
+
+#endif /* CONF_RAMFUNC_H */
@@ -34,6 +34,21 @@
 #include <asf.h>
 #include "SerialConsole/SerialConsole.h"
 #include "CliThread.h"
+#include "Benchmark/Benchmark.h"
+#include "ClockProfile/ClockProfile.h"
+#include "MemPool/MemPool.h"
+#include "LowPower/LowPower.h"
+#include "Trace/Trace.h"
+#include "StackMonitor/StackMonitor.h"
+#include "Dmac/Dmac.h"
+#include "ExtInt/ExtInt.h"
+#include "Imu/Imu.h"
+#include "Pipeline/Pipeline.h"
+#include "HitDetect/HitDetect.h"
+#include "Fusion/Fusion.h"
+#include "Codec/Codec.h"
+#include "Stroke/Stroke.h"
+#include "SessionStats/SessionRollup.h"
 /******************************************************************************
  * Includes
  ******************************************************************************/
@@ -51,6 +66,20 @@
  ******************************************************************************/
 static char bufferPrint[64];			  ///< Buffer for daemon task
 static TaskHandle_t cliTaskHandle = NULL; //!< CLI task handle
+static TaskHandle_t imuTaskHandle = NULL; //!< IMU task handle
+static TaskHandle_t pipeTaskHandle = NULL; //!< Pipeline task handle
+
+// Task stacks and control blocks. There is no RTOS heap, see configSUPPORT_DYNAMIC_ALLOCATION
+static StackType_t cliTaskStack[CLI_TASK_SIZE];					 ///< CLI task stack
+static StaticTask_t cliTaskBuffer;								 ///< CLI task control block
+static StackType_t imuTaskStack[IMU_TASK_SIZE];					 ///< IMU task stack
+static StaticTask_t imuTaskBuffer;								 ///< IMU task control block
+static StackType_t pipeTaskStack[PIPELINE_TASK_SIZE];			 ///< Pipeline task stack
+static StaticTask_t pipeTaskBuffer;								 ///< Pipeline task control block
+static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];		 ///< Idle task stack
+static StaticTask_t idleTaskBuffer;								 ///< Idle task control block
+static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH]; ///< Timer daemon task stack
+static StaticTask_t timerTaskBuffer;							 ///< Timer daemon task control block
 
 #define MAX_RX_BUFFER_LENGTH 5
 volatile uint8_t rx_buffer[MAX_RX_BUFFER_LENGTH];
@@ -59,6 +88,8 @@ volatile char buffer[7];
 
 int main(void)
 {
+	StackMonitorPaintMainStack();
+
 	// Board Initialization -- Code that initializes the HW and happens only once
 	system_init();
 	InitializeSerialConsole();
@@ -98,17 +129,30 @@ int main(void)
 static void StartTasks(void)
 {
 
-	snprintf(bufferPrint, 64, "Heap before starting tasks: %d\r\n", xPortGetFreeHeapSize());
-	SerialConsoleWriteString(bufferPrint);
-
-	// CODE HERE: Initialize any Tasks in your system here
+	// CODE HERE: Initialize any Tasks in your system here. Give each one a static stack and control block above
 
-	if (xTaskCreate(vCommandConsoleTask, "CLI_TASK", CLI_TASK_SIZE, NULL, CLI_PRIORITY, &cliTaskHandle) != pdPASS)
+	cliTaskHandle = xTaskCreateStatic(vCommandConsoleTask, "CLI_TASK", CLI_TASK_SIZE, NULL, CLI_PRIORITY, cliTaskStack, &cliTaskBuffer);
+	if (cliTaskHandle == NULL)
 	{
 		SerialConsoleWriteString("ERR: CLI task could not be initialized!\r\n");
 	}
+	StackMonitorRegister(cliTaskHandle, CLI_TASK_SIZE);
+
+	imuTaskHandle = xTaskCreateStatic(vImuTask, "IMU_TASK", IMU_TASK_SIZE, NULL, IMU_PRIORITY, imuTaskStack, &imuTaskBuffer);
+	if (imuTaskHandle == NULL)
+	{
+		SerialConsoleWriteString("ERR: IMU task could not be initialized!\r\n");
+	}
+	StackMonitorRegister(imuTaskHandle, IMU_TASK_SIZE);
 
-	snprintf(bufferPrint, 64, "Heap after starting CLI: %d\r\n", xPortGetFreeHeapSize());
+	pipeTaskHandle = xTaskCreateStatic(vPipelineTask, "PIPE_TASK", PIPELINE_TASK_SIZE, NULL, PIPELINE_PRIORITY, pipeTaskStack, &pipeTaskBuffer);
+	if (pipeTaskHandle == NULL)
+	{
+		SerialConsoleWriteString("ERR: Pipeline task could not be initialized!\r\n");
+	}
+	StackMonitorRegister(pipeTaskHandle, PIPELINE_TASK_SIZE);
+
+	snprintf(bufferPrint, 64, "CLI task stack: %d bytes\r\n", (int)sizeof(cliTaskStack));
 	SerialConsoleWriteString(bufferPrint);
 }
 
@@ -126,21 +170,55 @@ void vApplicationDaemonTaskStartupHook(void *ucParameterToPass) // vApplicationD
 {
 
 	// CODE HERE: Initialize any HW here
+	ClockProfileInit();
+	StackMonitorInit();
+	BenchmarkInit();
+	TraceInit();
+	DmacInit();
+	ExtIntInit();
+	PipelineInit();
+	HitDetectInit();
+	FusionInit();
+	CodecInit();
+	StrokeInit();
+	SessionRollupInit();
+	LowPowerInit();
 
 	// Initialize tasks
 	StartTasks();
 }
 
-void vApplicationMallocFailedHook(void)
+/**************************************************************************/
+/**
+ * function          vApplicationGetIdleTaskMemory
+ * @brief            Supplies the static stack and control block of the idle task
+ * @details			Required by FreeRTOS when configSUPPORT_STATIC_ALLOCATION is 1
+ *****************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &idleTaskBuffer;
+	*ppxIdleTaskStackBuffer = idleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+/**************************************************************************/
+/**
+ * function          vApplicationGetTimerTaskMemory
+ * @brief            Supplies the static stack and control block of the timer daemon task
+ * @details			Required by FreeRTOS when configSUPPORT_STATIC_ALLOCATION and configUSE_TIMERS are 1
+ *****************************************************************************/
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize)
 {
-	SerialConsoleWriteString("Error on memory allocation on FREERTOS!\r\n");
-	while (1)
-		;
+	*ppxTimerTaskTCBBuffer = &timerTaskBuffer;
+	*ppxTimerTaskStackBuffer = timerTaskStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
 }
 
-void vApplicationStackOverflowHook(void)
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
-	SerialConsoleWriteString("Error on stack overflow on FREERTOS!\r\n");
+	SerialConsoleWriteString("Error on stack overflow on FREERTOS! Task: ");
+	SerialConsoleWriteString(pcTaskName);
+	SerialConsoleWriteString("\r\n");
 	while (1)
 		;
 }
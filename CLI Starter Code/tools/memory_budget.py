@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Per-subsystem SRAM budget report, built from the GCC linker map.
+
+Every task stack, control block, semaphore and buffer is statically allocated
+(configSUPPORT_DYNAMIC_ALLOCATION is 0), so the map file accounts for all of
+the RAM that is not main stack or unused. This script adds up the .data and
+.bss input sections of each object file, groups them by subsystem (the source
+directory under src/), and checks them against the budgets below. Code placed
+in SRAM (.ramfunc sections, see src/config/conf_ramfunc.h) is reported on its
+own as "Hot code (RAM)", whatever file it comes from.
+
+Usage:
+    python tools/memory_budget.py Debug/CLI_StarterCode.map [-v]
+
+-v also lists the largest symbols of each subsystem. The exit status is 1 if
+any subsystem is over budget, so the script can run as a post-build step.
+"""
+
+import argparse
+import re
+import sys
+
+RAM_ORIGIN = 0x20000000
+RAM_SIZE = 32 * 1024
+
+# Budget per subsystem, in bytes. Update these together with the code that
+# changes them, so a review of the diff shows where RAM is being spent.
+BUDGETS = {
+    "App (main)": 3584,      # CLI, IMU, pipeline, idle and timer task stacks and TCBs
+    "CLI": 1536,             # Line editor history, batch and I/O buffers, stats snapshot and record
+    "SerialConsole": 1152,   # RX/TX rings, USART instance
+    "Benchmark": 1536,       # Partner task, scratch buffers, work item, pool, hit_block, fusion_update and codec_block state
+    "ClockProfile": 64,
+    "LowPower": 64,
+    "Trace": 2176,           # Event ring, task names
+    "IrqMonitor": 704,       # Latency and duration histograms
+    "Hot code (RAM)": 1024,  # RAMFUNC_HOT functions and the context switch
+    "MemPool": 64,           # Registered pool table. Pools belong to their modules
+    "StackMonitor": 64,      # Task stack table
+    "WorkQueue": 96,         # Priority FIFOs and item table. Items belong to their modules
+    "ExtInt": 128,           # Line callbacks
+    "Dmac": 160,             # Descriptors and write-back, 16-byte aligned, channel callbacks
+    "Imu": 640,              # FIFO burst buffers, bus semaphores, counters. The task stack is in App (main)
+    "Pipeline": 768,         # Two frames, message buffer, semaphore, synthetic source timer
+    "HitDetect": 128,        # Pipeline detector state and counters
+    "Fusion": 96,            # Pipeline filter and its published copy
+    "SessionStats": 1088,    # Running state, the copy each snapshot is derived from, the rollup records and work item
+    "Codec": 1344,           # Packet queue, packet being coded, pipeline encoder and counters
+    "Stroke": 1408,          # Window ring, pending hits, arena, model layers and counters
+    "FreeRTOS": 1088,        # Kernel lists, timer queue, CLI command pool
+    "ASF drivers": 256,
+    "C library": 256,
+    "Main stack (MSP)": 8200,  # STACK_SIZE in the linker script, plus alignment
+    "Padding": 128,
+}
+
+# Checked in order, first match wins. Anything else under src/ is reported
+# under its directory name, anything outside src/ is the C library.
+PATH_RULES = [
+    ("src/ASF/thirdparty/freertos/", "FreeRTOS"),
+    ("src/ASF/", "ASF drivers"),
+    ("src/CliThread/", "CLI"),
+    ("src/SerialConsole/", "SerialConsole"),
+    ("src/Benchmark/", "Benchmark"),
+    ("src/ClockProfile/", "ClockProfile"),
+    ("src/MemPool/", "MemPool"),
+    ("src/LowPower/", "LowPower"),
+    ("src/Trace/", "Trace"),
+    ("src/IrqMonitor/", "IrqMonitor"),
+    ("src/WorkQueue/", "WorkQueue"),
+    ("src/StackMonitor/", "StackMonitor"),
+    ("src/ExtInt/", "ExtInt"),
+    ("src/Dmac/", "Dmac"),
+    ("src/Imu/", "Imu"),
+    ("src/Pipeline/", "Pipeline"),
+    ("src/HitDetect/", "HitDetect"),
+    ("src/Fusion/", "Fusion"),
+    ("src/SessionStats/", "SessionStats"),
+    ("src/Codec/", "Codec"),
+    ("src/Stroke/", "Stroke"),
+    ("src/main.o", "App (main)"),
+]
+
+OUTPUT_SECTION = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+INPUT_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME_ONLY = re.compile(r"^ (\.\S+|COMMON)\s*$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+FILL = re.compile(r"^ \*fill\*\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+END_SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+_end = \.")
+
+
+def subsystem_of(path, section=""):
+    if section.startswith(".ramfunc"):
+        return "Hot code (RAM)"
+    path = path.replace("\\", "/")
+    for prefix, name in PATH_RULES:
+        if prefix in path:
+            return name
+    match = re.search(r"(?:^|/)src/([^/]+)/", path)
+    if match:
+        return match.group(1)
+    return "C library"
+
+
+def in_ram(address):
+    return RAM_ORIGIN <= address < RAM_ORIGIN + RAM_SIZE
+
+
+def parse_map(lines):
+    """Returns ({subsystem: bytes}, {subsystem: [(bytes, section)]}, end of used RAM)."""
+    usage = {}
+    symbols = {}
+    ram_end = RAM_ORIGIN
+    section = None
+    section_in_ram = False
+    pending_name = None
+
+    def add(name, size, label):
+        usage[name] = usage.get(name, 0) + size
+        symbols.setdefault(name, []).append((size, label))
+
+    def add_input(section_name, size, path):
+        name = subsystem_of(path, section_name)
+        # Every hot function shares one section name, so show where it came from
+        add(name, size, "%s %s" % (section_name, path) if name == "Hot code (RAM)" else section_name)
+
+    started = False
+    for line in lines:
+        if not started:
+            started = line.startswith("Linker script and memory map")
+            continue
+
+        match = OUTPUT_SECTION.match(line)
+        if match:
+            section = match.group(1)
+            address = int(match.group(2), 16)
+            size = int(match.group(3), 16)
+            section_in_ram = in_ram(address) and size > 0
+            if section_in_ram:
+                ram_end = max(ram_end, address + size)
+            if section_in_ram and section == ".stack":
+                add("Main stack (MSP)", size, ".stack")
+            pending_name = None
+            continue
+
+        if not section_in_ram or section == ".stack":
+            continue
+
+        match = FILL.match(line)
+        if match:
+            add("Padding", int(match.group(2), 16), "*fill*")
+            continue
+
+        match = INPUT_SECTION.match(line)
+        if match:
+            name, size, path = match.group(1), int(match.group(3), 16), match.group(4)
+            if size:
+                add_input(name, size, path)
+            pending_name = None
+            continue
+
+        match = INPUT_NAME_ONLY.match(line)
+        if match:
+            pending_name = match.group(1)
+            continue
+
+        match = CONTINUATION.match(line)
+        if match and pending_name is not None:
+            size, path = int(match.group(2), 16), match.group(3)
+            if size:
+                add_input(pending_name, size, path)
+            pending_name = None
+
+    return usage, symbols, ram_end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map_file", help="linker map file (-Wl,-Map)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="list the largest symbols per subsystem")
+    args = parser.parse_args()
+
+    with open(args.map_file, encoding="utf-8", errors="replace") as handle:
+        usage, symbols, ram_end = parse_map(handle)
+
+    over_budget = False
+    print("%-18s %8s %8s %6s" % ("Subsystem", "Used", "Budget", ""))
+    for name in sorted(usage, key=lambda n: -usage[n]):
+        budget = BUDGETS.get(name)
+        status = ""
+        if budget is None:
+            status = "NO BUDGET"
+            over_budget = True
+        elif usage[name] > budget:
+            status = "OVER"
+            over_budget = True
+        print("%-18s %8d %8s %6s" % (name, usage[name], budget if budget is not None else "-", status))
+        if args.verbose:
+            for size, label in sorted(symbols[name], reverse=True)[:8]:
+                print("    %6d  %s" % (size, label))
+
+    used = ram_end - RAM_ORIGIN
+    print("%-18s %8d" % ("Total", used))
+    print("%-18s %8d  (newlib heap and anything not linked)" % ("Free", RAM_SIZE - used))
+    return 1 if over_budget else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,49 @@
+/**************************************************************************/ /**
+ * @file      asf.h
+ * @brief     Host stand-in for <asf.h>, for the memory pool stress test.
+ * @details   tools/mempool/Makefile puts this directory first on the include
+ *            path, so MemPool.c compiles unmodified on the host. Its critical
+ *            sections take one process-wide pthread mutex, which gives the
+ *            threads of the test the mutual exclusion the interrupt mask
+ *            gives tasks and interrupts on the SAMD21.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef MEMPOOL_TEST_ASF_H
+#define MEMPOOL_TEST_ASF_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+// Same values as projdefs.h
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define configASSERT(x) assert(x)
+
+#define taskENTER_CRITICAL_FROM_ISR() (pthread_mutex_lock(&xHostCritical), 0UL)
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x), pthread_mutex_unlock(&xHostCritical))
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+/******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern pthread_mutex_t xHostCritical; ///< In mempool_stress.c
+
+#endif /* MEMPOOL_TEST_ASF_H */
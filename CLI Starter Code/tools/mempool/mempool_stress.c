@@ -0,0 +1,457 @@
+/**************************************************************************/ /**
+ * @file      mempool_stress.c
+ * @brief     Concurrent allocation stress test of MemPool.c, built for the
+ *            host by tools/mempool/Makefile.
+ * @details   MemPool.c is compiled unmodified, with its critical sections
+ *            backed by a pthread mutex (asf.h here). The test first checks
+ *            one pool from a single thread: every block handed out once, an
+ *            empty pool refusing, double and foreign frees counted and
+ *            ignored. Then --threads threads allocate and free at random on
+ *            a pool of small blocks, one of large blocks and one of odd
+ *            sized blocks whose allocation bitmap spans two words:
+ *
+ *                mempool_stress [-t threads] [-n operations] [-s seed]
+ *
+ *            Each thread keeps up to MEMPOOL_TEST_HELD blocks of each pool.
+ *            An allocated block is claimed in an owner table with a compare
+ *            and swap, so a block handed to two threads at once is caught,
+ *            and filled with a pattern checked again before it is freed, so
+ *            a block written by anyone else is caught. Now and then a thread
+ *            frees a pointer into the middle of a block it holds, or one
+ *            outside the pool, which the pool must count and ignore.
+ *
+ *            At the end every pool must be back to all blocks free: nothing
+ *            in use, every block on the free list exactly once, the bitmap
+ *            clear, the failed allocations and invalid frees equal to those
+ *            the threads saw. The exit status is 1 on any failure.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "MemPool/MemPool.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define MEMPOOL_TEST_MAX_THREADS 32
+#define MEMPOOL_TEST_POOLS 3		 ///< Small, large and odd
+#define MEMPOOL_TEST_SMALL_SIZE 32	 ///< Bytes per block of the small pool
+#define MEMPOOL_TEST_SMALL_COUNT 8
+#define MEMPOOL_TEST_LARGE_SIZE 128 ///< Bytes per block of the large pool
+#define MEMPOOL_TEST_LARGE_COUNT 4
+#define MEMPOOL_TEST_HELD 4			 ///< Blocks a thread holds at most, per pool
+#define MEMPOOL_TEST_ODD_SIZE 20	 ///< Rounded up to 24 bytes per block
+#define MEMPOOL_TEST_ODD_COUNT 40	 ///< Two words of allocation bitmap
+#define MEMPOOL_TEST_INVALID_ONE_IN 64 ///< Operations per invalid free, on average
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A pool under test, with the owner of each of its blocks and what the threads saw.
+ */
+typedef struct
+{
+	MemPool_t *pxPool;
+	int iOwners[MEMPOOL_TEST_ODD_COUNT]; ///< 0, or the thread holding the block plus 1
+	unsigned long ulFailures;			 ///< Allocations that returned NULL
+	unsigned long ulInvalidFrees;		 ///< Invalid frees made on purpose
+} TestPool_t;
+
+/**
+ * @brief A block a thread holds, and the byte it filled it with.
+ */
+typedef struct
+{
+	uint8_t *pucBlock;
+	uint8_t ucPattern;
+} Held_t;
+
+/**
+ * @brief One thread of the test.
+ */
+typedef struct
+{
+	pthread_t xThread;
+	int iId;
+	uint32_t ulRandom;
+	unsigned long ulOperations;
+	Held_t xHeld[MEMPOOL_TEST_POOLS][MEMPOOL_TEST_HELD];
+	unsigned uHeld[MEMPOOL_TEST_POOLS];
+} Worker_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static int prvSingleThread(MemPool_t *pxPool);
+static void *prvWorker(void *pvWorker);
+static void prvAlloc(Worker_t *pxWorker, int iPool);
+static void prvFree(Worker_t *pxWorker, int iPool, unsigned uSlot);
+static void prvInvalidFree(Worker_t *pxWorker, int iPool);
+static int prvCheckIdle(const TestPool_t *pxTest);
+static UBaseType_t prvIndex(const MemPool_t *pxPool, const void *pvBlock);
+static uint32_t prvRandom(Worker_t *pxWorker);
+static void prvFail(const char *pcPool, const char *pcWhat);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+pthread_mutex_t xHostCritical = PTHREAD_MUTEX_INITIALIZER;
+
+MEMPOOL_DEFINE(xSmallPool, "small", MEMPOOL_TEST_SMALL_SIZE, MEMPOOL_TEST_SMALL_COUNT);
+MEMPOOL_DEFINE(xLargePool, "large", MEMPOOL_TEST_LARGE_SIZE, MEMPOOL_TEST_LARGE_COUNT);
+MEMPOOL_DEFINE(xOddPool, "odd", MEMPOOL_TEST_ODD_SIZE, MEMPOOL_TEST_ODD_COUNT);
+
+static TestPool_t xTests[MEMPOOL_TEST_POOLS] = {{&xSmallPool}, {&xLargePool}, {&xOddPool}};
+static volatile int iFailed = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	Worker_t xWorkers[MEMPOOL_TEST_MAX_THREADS];
+	int iThreads = 8;
+	unsigned long ulOperations = 200000;
+	unsigned long ulSeed = 1;
+	int iOption;
+
+	while ((iOption = getopt(argc, argv, "t:n:s:")) != -1)
+	{
+		switch (iOption)
+		{
+		case 't':
+			iThreads = atoi(optarg);
+			break;
+		case 'n':
+			ulOperations = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			ulSeed = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-t threads] [-n operations per thread] [-s seed]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (iThreads < 1 || iThreads > MEMPOOL_TEST_MAX_THREADS)
+	{
+		fprintf(stderr, "threads must be 1 to %d\n", MEMPOOL_TEST_MAX_THREADS);
+		return 2;
+	}
+
+	MemPoolRegister(&xSmallPool);
+	MemPoolRegister(&xLargePool);
+	MemPoolRegister(&xOddPool);
+	for (int p = 0; p < MEMPOOL_TEST_POOLS; p++)
+	{
+		configASSERT(xTests[p].pxPool->uxBlockCount <= MEMPOOL_TEST_ODD_COUNT);
+	}
+	if (prvSingleThread(&xOddPool) != 0)
+	{
+		return 1;
+	}
+	// The threads start from the counts the single thread left
+	xTests[2].ulFailures = xOddPool.ulFailures;
+	xTests[2].ulInvalidFrees = xOddPool.ulInvalidFrees;
+
+	memset(xWorkers, 0, sizeof(xWorkers));
+	for (int i = 0; i < iThreads; i++)
+	{
+		xWorkers[i].iId = i;
+		xWorkers[i].ulRandom = (uint32_t)(ulSeed * 2654435761UL + (unsigned long)i * 40503UL) | 1;
+		xWorkers[i].ulOperations = ulOperations;
+		if (pthread_create(&xWorkers[i].xThread, NULL, prvWorker, &xWorkers[i]) != 0)
+		{
+			fprintf(stderr, "cannot start thread %d\n", i);
+			return 2;
+		}
+	}
+	for (int i = 0; i < iThreads; i++)
+	{
+		pthread_join(xWorkers[i].xThread, NULL);
+	}
+
+	printf("%-8s %6s %6s %9s %10s %9s %8s\n", "Pool", "Blocks", "Bytes", "HighWater", "Failures", "Invalid", "Result");
+	for (int p = 0; p < MEMPOOL_TEST_POOLS; p++)
+	{
+		const MemPool_t *pxPool = xTests[p].pxPool;
+		int iResult = prvCheckIdle(&xTests[p]);
+
+		printf("%-8s %6lu %6lu %9lu %10lu %9lu %8s\n", pxPool->pcName, (unsigned long)pxPool->uxBlockCount,
+			   (unsigned long)pxPool->xBlockSize, (unsigned long)pxPool->uxHighWater, (unsigned long)pxPool->ulFailures,
+			   (unsigned long)pxPool->ulInvalidFrees, iResult == 0 ? "ok" : "FAIL");
+	}
+	printf("%d threads, %lu operations each: %s\n", iThreads, ulOperations, iFailed ? "FAIL" : "pass");
+
+	return iFailed ? 1 : 0;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static int prvSingleThread(MemPool_t *pxPool)
+ * @brief		Empties a fresh pool and fills it again from one thread
+ * @return		0, or 1 on a failure, reported
+ *****************************************************************************/
+static int prvSingleThread(MemPool_t *pxPool)
+{
+	void *pvBlocks[MEMPOOL_TEST_ODD_COUNT];
+	uint8_t ucOutside[8];
+	int iFailedBefore = iFailed;
+
+	for (UBaseType_t i = 0; i < pxPool->uxBlockCount; i++)
+	{
+		pvBlocks[i] = MemPoolAlloc(pxPool);
+		if (pvBlocks[i] == NULL || ((uintptr_t)pvBlocks[i] % MEMPOOL_ALIGNMENT) != 0 ||
+			prvIndex(pxPool, pvBlocks[i]) != i)
+		{
+			prvFail(pxPool->pcName, "blocks not handed out in address order");
+			return 1;
+		}
+	}
+	if (MemPoolAlloc(pxPool) != NULL || pxPool->ulFailures != 1 || pxPool->uxHighWater != pxPool->uxBlockCount)
+	{
+		prvFail(pxPool->pcName, "empty pool did not refuse");
+	}
+
+	MemPoolFree(pxPool, pvBlocks[33]);
+	MemPoolFree(pxPool, pvBlocks[33]);
+	MemPoolFree(pxPool, (uint8_t *)pvBlocks[2] + 4);
+	MemPoolFree(pxPool, ucOutside);
+	MemPoolFree(pxPool, NULL);
+	if (pxPool->ulInvalidFrees != 3 || pxPool->uxInUse != pxPool->uxBlockCount - 1)
+	{
+		prvFail(pxPool->pcName, "double, misaligned or foreign free not caught");
+	}
+	if (MemPoolAlloc(pxPool) != pvBlocks[33])
+	{
+		prvFail(pxPool->pcName, "freed block not reused");
+	}
+
+	for (UBaseType_t i = 0; i < pxPool->uxBlockCount; i++)
+	{
+		MemPoolFree(pxPool, pvBlocks[i]);
+	}
+	if (pxPool->uxInUse != 0 || pxPool->ulInvalidFrees != 3)
+	{
+		prvFail(pxPool->pcName, "not all blocks returned");
+	}
+
+	return (iFailed != iFailedBefore) ? 1 : 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void *prvWorker(void *pvWorker)
+ * @brief		Allocates and frees at random, then frees what it still holds
+ *****************************************************************************/
+static void *prvWorker(void *pvWorker)
+{
+	Worker_t *pxWorker = pvWorker;
+
+	for (unsigned long n = 0; n < pxWorker->ulOperations && !iFailed; n++)
+	{
+		uint32_t ulRandom = prvRandom(pxWorker);
+		int iPool = (int)(ulRandom % MEMPOOL_TEST_POOLS);
+		unsigned uHeld = pxWorker->uHeld[iPool];
+
+		if ((ulRandom >> 8) % MEMPOOL_TEST_INVALID_ONE_IN == 0)
+		{
+			prvInvalidFree(pxWorker, iPool);
+		}
+		else if (uHeld == 0 || (uHeld < MEMPOOL_TEST_HELD && ((ulRandom >> 16) & 1) != 0))
+		{
+			prvAlloc(pxWorker, iPool);
+		}
+		else
+		{
+			prvFree(pxWorker, iPool, (ulRandom >> 17) % uHeld);
+		}
+	}
+
+	for (int p = 0; p < MEMPOOL_TEST_POOLS; p++)
+	{
+		while (pxWorker->uHeld[p] > 0)
+		{
+			prvFree(pxWorker, p, 0);
+		}
+	}
+
+	return NULL;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvAlloc(Worker_t *pxWorker, int iPool)
+ * @brief		Takes a block, claims it in the owner table and fills it
+ *****************************************************************************/
+static void prvAlloc(Worker_t *pxWorker, int iPool)
+{
+	TestPool_t *pxTest = &xTests[iPool];
+	uint8_t *pucBlock = MemPoolAlloc(pxTest->pxPool);
+	int iFree = 0;
+	Held_t *pxHeld;
+
+	if (pucBlock == NULL)
+	{
+		__atomic_fetch_add(&pxTest->ulFailures, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	if (((uintptr_t)pucBlock % MEMPOOL_ALIGNMENT) != 0 || prvIndex(pxTest->pxPool, pucBlock) >= pxTest->pxPool->uxBlockCount)
+	{
+		prvFail(pxTest->pxPool->pcName, "block outside the pool or misaligned");
+		return;
+	}
+	if (!__atomic_compare_exchange_n(&pxTest->iOwners[prvIndex(pxTest->pxPool, pucBlock)], &iFree, pxWorker->iId + 1,
+									 false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	{
+		prvFail(pxTest->pxPool->pcName, "block handed to two threads at once");
+		return;
+	}
+
+	pxHeld = &pxWorker->xHeld[iPool][pxWorker->uHeld[iPool]++];
+	pxHeld->pucBlock = pucBlock;
+	pxHeld->ucPattern = (uint8_t)prvRandom(pxWorker);
+	memset(pucBlock, pxHeld->ucPattern, pxTest->pxPool->xBlockSize);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvFree(Worker_t *pxWorker, int iPool, unsigned uSlot)
+ * @brief		Checks a held block's pattern, releases it in the owner table and frees it
+ *****************************************************************************/
+static void prvFree(Worker_t *pxWorker, int iPool, unsigned uSlot)
+{
+	TestPool_t *pxTest = &xTests[iPool];
+	Held_t xHeld = pxWorker->xHeld[iPool][uSlot];
+	int iOwner = pxWorker->iId + 1;
+
+	pxWorker->xHeld[iPool][uSlot] = pxWorker->xHeld[iPool][--pxWorker->uHeld[iPool]];
+
+	for (size_t i = 0; i < pxTest->pxPool->xBlockSize; i++)
+	{
+		if (xHeld.pucBlock[i] != xHeld.ucPattern)
+		{
+			prvFail(pxTest->pxPool->pcName, "held block written by someone else");
+			return;
+		}
+	}
+	if (!__atomic_compare_exchange_n(&pxTest->iOwners[prvIndex(pxTest->pxPool, xHeld.pucBlock)], &iOwner, 0, false,
+									 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	{
+		prvFail(pxTest->pxPool->pcName, "held block claimed by another thread");
+		return;
+	}
+
+	MemPoolFree(pxTest->pxPool, xHeld.pucBlock);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvInvalidFree(Worker_t *pxWorker, int iPool)
+ * @brief		Frees a pointer into the middle of a held block, or one outside the pool
+ * @note		A double free cannot be tried here: once freed, the block may
+ *				already belong to another thread, and freeing it again would be valid
+ *****************************************************************************/
+static void prvInvalidFree(Worker_t *pxWorker, int iPool)
+{
+	TestPool_t *pxTest = &xTests[iPool];
+	uint8_t ucOutside[MEMPOOL_ALIGNMENT];
+
+	if (pxWorker->uHeld[iPool] > 0)
+	{
+		MemPoolFree(pxTest->pxPool, pxWorker->xHeld[iPool][0].pucBlock + MEMPOOL_ALIGNMENT);
+	}
+	else
+	{
+		MemPoolFree(pxTest->pxPool, ucOutside);
+	}
+	__atomic_fetch_add(&pxTest->ulInvalidFrees, 1, __ATOMIC_RELAXED);
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvCheckIdle(const TestPool_t *pxTest)
+ * @brief		Checks a pool with no block held is back to its initial state
+ * @return		0, or 1 on a failure, reported
+ *****************************************************************************/
+static int prvCheckIdle(const TestPool_t *pxTest)
+{
+	const MemPool_t *pxPool = pxTest->pxPool;
+	uint8_t ucSeen[MEMPOOL_TEST_ODD_COUNT] = {0};
+	UBaseType_t uxFree = 0;
+	int iFailedBefore = iFailed;
+
+	for (const MemPoolBlock_t *pxBlock = pxPool->pxFreeList; pxBlock != NULL; pxBlock = pxBlock->pxNext)
+	{
+		UBaseType_t uxIndex = prvIndex(pxPool, pxBlock);
+
+		if (uxIndex >= pxPool->uxBlockCount || ucSeen[uxIndex]++ != 0 || ++uxFree > pxPool->uxBlockCount)
+		{
+			prvFail(pxPool->pcName, "free list corrupt");
+			return 1;
+		}
+	}
+	if (uxFree != pxPool->uxBlockCount || pxPool->uxInUse != 0)
+	{
+		prvFail(pxPool->pcName, "blocks lost");
+	}
+	for (UBaseType_t i = 0; i < (pxPool->uxBlockCount + 31) / 32; i++)
+	{
+		if (pxPool->pulAllocated[i] != 0)
+		{
+			prvFail(pxPool->pcName, "allocation bitmap not clear");
+		}
+	}
+	if (pxPool->ulFailures != pxTest->ulFailures || pxPool->ulInvalidFrees != pxTest->ulInvalidFrees)
+	{
+		prvFail(pxPool->pcName, "failure or invalid free counts differ from the threads'");
+	}
+	if (pxPool->uxHighWater > pxPool->uxBlockCount)
+	{
+		prvFail(pxPool->pcName, "high-water mark above the block count");
+	}
+
+	return (iFailed != iFailedBefore) ? 1 : 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static UBaseType_t prvIndex(const MemPool_t *pxPool, const void *pvBlock)
+ * @brief		Index of the block at pvBlock, uxBlockCount or more if outside the pool
+ *****************************************************************************/
+static UBaseType_t prvIndex(const MemPool_t *pxPool, const void *pvBlock)
+{
+	return (UBaseType_t)(((uintptr_t)pvBlock - (uintptr_t)pxPool->pucStorage) / pxPool->xBlockSize);
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvRandom(Worker_t *pxWorker)
+ * @brief		xorshift32, one sequence per thread
+ *****************************************************************************/
+static uint32_t prvRandom(Worker_t *pxWorker)
+{
+	uint32_t ulX = pxWorker->ulRandom;
+
+	ulX ^= ulX << 13;
+	ulX ^= ulX >> 17;
+	ulX ^= ulX << 5;
+	pxWorker->ulRandom = ulX;
+	return ulX;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvFail(const char *pcPool, const char *pcWhat)
+ * @brief		Reports a failure and stops the threads
+ *****************************************************************************/
+static void prvFail(const char *pcPool, const char *pcWhat)
+{
+	fprintf(stderr, "%s: %s\n", pcPool, pcWhat);
+	iFailed = 1;
+}
@@ -0,0 +1,160 @@
+/**************************************************************************/ /**
+ * @file      insn_window.c
+ * @brief     QEMU TCG plugin that counts the guest instructions executed
+ *            between two marker functions, for tools/qemu/perf_check.py.
+ * @details   Load with:
+ *                -plugin insn_window.so,open=<addr>,close=<addr>,out=<file>
+ *            where open and close are the addresses of QemuWindowOpen() and
+ *            QemuWindowClose() (Thumb bit clear). Every close appends one line
+ *                window <n> <instructions>
+ *            to out, flushed at once, so the line is on disk before the CLI
+ *            sends the batch status frame of the command. Instructions are
+ *            counted per executed translation block. The markers are function
+ *            entries and always start a block, so each count runs from the
+ *            first instruction of QemuWindowOpen() to the last of
+ *            QemuWindowClose(): a fixed offset that cancels out in comparisons.
+ *
+ *            Built for the host, not the target, by tools/qemu/Makefile.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <qemu-plugin.h>
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+static uint64_t ullOpenAddr = 0;
+static uint64_t ullCloseAddr = 0;
+static FILE *pxOut = NULL;
+static uint64_t ullExecuted = 0;	///< Instructions since start. The machine has one vCPU
+static uint64_t ullOpenedAt = 0;
+static int bOpen = 0;
+static uint64_t ullWindows = 0;
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**
+ * @brief Adds the instructions of a block as it starts executing.
+ */
+static void prvBlockExec(unsigned int uiVcpu, void *pvInsns)
+{
+	ullExecuted += (uint64_t)(uintptr_t)pvInsns;
+}
+
+/**
+ * @brief Window start marker.
+ */
+static void prvOpen(unsigned int uiVcpu, void *pvUnused)
+{
+	ullOpenedAt = ullExecuted;
+	bOpen = 1;
+}
+
+/**
+ * @brief Window end marker. A close without an open is ignored.
+ */
+static void prvClose(unsigned int uiVcpu, void *pvUnused)
+{
+	if (!bOpen)
+	{
+		return;
+	}
+
+	bOpen = 0;
+	fprintf(pxOut, "window %" PRIu64 " %" PRIu64 "\n", ullWindows++, ullExecuted - ullOpenedAt);
+	fflush(pxOut);
+}
+
+/**
+ * @brief Instruments every new translation block.
+ */
+static void prvBlockTranslated(qemu_plugin_id_t xId, struct qemu_plugin_tb *pxBlock)
+{
+	size_t xInsns = qemu_plugin_tb_n_insns(pxBlock);
+
+	qemu_plugin_register_vcpu_tb_exec_cb(pxBlock, prvBlockExec, QEMU_PLUGIN_CB_NO_REGS, (void *)(uintptr_t)xInsns);
+
+	for (size_t i = 0; i < xInsns; i++)
+	{
+		struct qemu_plugin_insn *pxInsn = qemu_plugin_tb_get_insn(pxBlock, i);
+		uint64_t ullAddr = qemu_plugin_insn_vaddr(pxInsn);
+
+		if (ullAddr == ullOpenAddr)
+		{
+			qemu_plugin_register_vcpu_insn_exec_cb(pxInsn, prvOpen, QEMU_PLUGIN_CB_NO_REGS, NULL);
+		}
+		else if (ullAddr == ullCloseAddr)
+		{
+			qemu_plugin_register_vcpu_insn_exec_cb(pxInsn, prvClose, QEMU_PLUGIN_CB_NO_REGS, NULL);
+		}
+	}
+}
+
+/**
+ * @brief Closes the output file when QEMU exits.
+ */
+static void prvExit(qemu_plugin_id_t xId, void *pvUnused)
+{
+	if (pxOut != NULL && pxOut != stdout)
+	{
+		fclose(pxOut);
+	}
+}
+
+/******************************************************************************
+ * Plugin entry point
+ ******************************************************************************/
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t xId, const qemu_info_t *pxInfo, int argc, char **argv)
+{
+	const char *pcOut = NULL;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (strncmp(argv[i], "open=", 5) == 0)
+		{
+			ullOpenAddr = strtoull(argv[i] + 5, NULL, 0);
+		}
+		else if (strncmp(argv[i], "close=", 6) == 0)
+		{
+			ullCloseAddr = strtoull(argv[i] + 6, NULL, 0);
+		}
+		else if (strncmp(argv[i], "out=", 4) == 0)
+		{
+			pcOut = argv[i] + 4;
+		}
+		else
+		{
+			fprintf(stderr, "insn_window: unknown argument %s\n", argv[i]);
+			return -1;
+		}
+	}
+
+	if (ullOpenAddr == 0 || ullCloseAddr == 0)
+	{
+		fprintf(stderr, "insn_window: open= and close= are required\n");
+		return -1;
+	}
+
+	pxOut = (pcOut != NULL) ? fopen(pcOut, "w") : stdout;
+	if (pxOut == NULL)
+	{
+		fprintf(stderr, "insn_window: cannot open %s\n", pcOut);
+		return -1;
+	}
+
+	qemu_plugin_register_vcpu_tb_trans_cb(xId, prvBlockTranslated);
+	qemu_plugin_register_atexit_cb(xId, prvExit, NULL);
+	return 0;
+}
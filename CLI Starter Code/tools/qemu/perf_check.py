@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Runs CLI scenarios under QEMU and checks their instruction counts.
+
+Boots the QEMU build (make -C tools/qemu) on the "microbit" machine, switches
+the console to batch mode and sends each scenario's command. The insn_window
+plugin counts the instructions executed from the end of the command line to
+the end of its output (TRACE_SECTION_CLI_COMMAND). Every scenario is run
+--runs times, each time in a fresh QEMU, and the smallest count is kept:
+
+    python3 tools/qemu/perf_check.py              compare with perf_baseline.json
+    python3 tools/qemu/perf_check.py --update     write the counts as the baseline
+
+A scenario fails when its count exceeds the baseline by more than --tolerance
+(5 %), or when the baseline has no count for it: a new scenario, or no
+perf_baseline.json at all, needs a run with --update before it can pass. The
+exit status is 1 if any scenario failed or did not complete.
+
+QEMU runs with -icount shift=6,align=off,sleep=off: virtual time advances by
+64 ns per instruction (about the 16 MHz of the machine) and jumps over idle
+periods, so the firmware sees the same timer values on every run. The one
+remaining input from the host is when each command line arrives, which moves
+the tick interrupts relative to the command; taking the minimum of several runs
+removes that.
+"""
+
+import argparse
+import json
+import os
+import re
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# (name, command). Names are the baseline keys; keep them stable
+SCENARIOS = [
+    ("help", "help"),
+    ("version", "version"),
+    ("ticks", "ticks"),
+    ("pools", "pools"),
+    ("irq", "irq"),
+    ("log_info", "bench log_info"),
+    ("log_error", "bench log_error"),
+    ("console_write", "bench console_write"),
+    ("cbuf_put", "bench cbuf_put"),
+    ("cbuf_get", "bench cbuf_get"),
+    ("cli_argv", "bench cli_argv"),
+    ("cli_dispatch_old", "bench cli_dispatch_old"),
+    ("cli_dispatch_argv", "bench cli_dispatch_argv"),
+    ("ctx_switch", "bench ctx_switch"),
+    ("hit_block", "bench hit_block"),
+    ("fusion_update", "bench fusion_update"),
+    ("codec_block", "bench codec_block"),
+    ("stroke_infer", "bench stroke_infer"),
+]
+
+BOOT_DONE = re.compile(re.escape(b"Type Help to view a list of registered commands."))
+FRAME = re.compile(rb"@(\d+) (\w+) (\d+)\r\n")
+WINDOW = re.compile(r"^window (\d+) (\d+)$")
+MARKERS = ("QemuWindowOpen", "QemuWindowClose")
+
+
+def resolve_markers(nm, elf):
+    """Returns the addresses of the window marker functions, Thumb bit cleared."""
+    out = subprocess.run([nm, elf], check=True, capture_output=True, text=True).stdout
+    addresses = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[2] in MARKERS:
+            addresses[fields[2]] = int(fields[0], 16) & ~1
+    missing = [m for m in MARKERS if m not in addresses]
+    if missing:
+        sys.exit("%s: %s not found. Was it built with make -C tools/qemu?" % (elf, ", ".join(missing)))
+    return addresses[MARKERS[0]], addresses[MARKERS[1]]
+
+
+class Console:
+    """The guest UART, through a QEMU socket chardev."""
+
+    def __init__(self, path, timeout):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.timeout = timeout
+        self.data = b""
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                self.sock.connect(path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                if time.monotonic() > deadline:
+                    raise TimeoutError("QEMU did not open %s" % path)
+                time.sleep(0.05)
+
+    def send(self, text):
+        self.sock.sendall(text.encode() + b"\r")
+
+    def expect(self, pattern):
+        """Reads until the compiled regex pattern matches, consumes up to the match and returns it."""
+        deadline = time.monotonic() + self.timeout
+        while True:
+            match = pattern.search(self.data)
+            if match is not None:
+                self.data = self.data[match.end():]
+                return match
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                raise TimeoutError("no %r from the guest. Last output: %r" % (pattern.pattern, self.data[-200:]))
+            self.sock.settimeout(remaining)
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise TimeoutError("QEMU closed the console")
+            self.data += chunk
+
+    def close(self):
+        self.sock.close()
+
+
+def read_windows(path):
+    """Returns the instruction counts written by the plugin so far, in order."""
+    counts = []
+    with open(path) as f:
+        for line in f:
+            match = WINDOW.match(line.strip())
+            if match:
+                counts.append(int(match.group(2)))
+    return counts
+
+
+def run_once(args, markers, scenarios):
+    """Boots QEMU once and returns {name: instructions} for the scenarios."""
+    with tempfile.TemporaryDirectory() as tmp:
+        sock_path = os.path.join(tmp, "console.sock")
+        windows_path = os.path.join(tmp, "windows.txt")
+        plugin = "%s,open=0x%x,close=0x%x,out=%s" % (args.plugin, markers[0], markers[1], windows_path)
+        cmd = [args.qemu, "-M", "microbit", "-display", "none", "-monitor", "none",
+               "-icount", "shift=6,align=off,sleep=off",
+               "-chardev", "socket,id=console,path=%s,server=on,wait=on" % sock_path,
+               "-serial", "chardev:console",
+               "-plugin", plugin,
+               "-kernel", args.elf]
+        qemu = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        results = {}
+        try:
+            console = Console(sock_path, args.timeout)
+            console.expect(BOOT_DONE)
+            console.send("batch on")
+            for name, command in scenarios:
+                console.send(command)
+                frame = console.expect(FRAME)
+                status = frame.group(2).decode()
+                if status != "OK":
+                    raise RuntimeError("%s: '%s' returned %s" % (name, command, status))
+                # "batch on" was not run in batch mode but still counted, so the last window is this command
+                results[name] = read_windows(windows_path)[-1]
+            console.close()
+        finally:
+            qemu.kill()
+            _, err = qemu.communicate()
+            if qemu.returncode not in (0, -9) and err:
+                print(err.decode(errors="replace"), file=sys.stderr)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--elf", default=os.path.join(HERE, "build", "firmware.elf"))
+    parser.add_argument("--plugin", default=os.path.join(HERE, "build", "insn_window.so"))
+    parser.add_argument("--qemu", default="qemu-system-arm")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--baseline", default=os.path.join(HERE, "perf_baseline.json"))
+    parser.add_argument("--runs", type=int, default=3, help="QEMU runs per scenario, the minimum is kept")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="allowed increase over the baseline")
+    parser.add_argument("--timeout", type=float, default=30.0, help="seconds to wait for each frame")
+    parser.add_argument("--update", action="store_true", help="write the counts to the baseline file")
+    parser.add_argument("scenario", nargs="*", help="scenario names to run (default: all)")
+    args = parser.parse_args()
+
+    scenarios = [s for s in SCENARIOS if not args.scenario or s[0] in args.scenario]
+    unknown = set(args.scenario) - {s[0] for s in SCENARIOS}
+    if unknown:
+        sys.exit("unknown scenario: %s" % ", ".join(sorted(unknown)))
+
+    markers = resolve_markers(args.nm, args.elf)
+    best = {}
+    for _ in range(args.runs):
+        for name, count in run_once(args, markers, scenarios).items():
+            best[name] = min(count, best.get(name, count))
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    elif not args.update:
+        print("no baseline at %s, run with --update to record one" % args.baseline, file=sys.stderr)
+
+    failed = False
+    print("%-18s %12s %12s %8s" % ("Scenario", "Instructions", "Baseline", "Change"))
+    for name, _ in scenarios:
+        count = best[name]
+        base = baseline.get(name)
+        status = ""
+        if base is None:
+            change = "-"
+            status = "NEW" if args.update else "NO BASELINE"
+            failed = failed or not args.update
+        else:
+            change = "%+.1f%%" % ((count - base) * 100.0 / base)
+            if count > base * (1 + args.tolerance):
+                status = "REGRESSION"
+                failed = True
+        print("%-18s %12d %12s %8s %s" % (name, count, base if base is not None else "-", change, status))
+
+    if args.update:
+        baseline.update(best)
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % args.baseline)
+        return 0
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,653 @@
+/**************************************************************************/ /**
+ * @file      qemu_board.c
+ * @brief     Board support for the QEMU "microbit" machine. See qemu_board.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <string.h>
+#include "qemu_board.h"
+#include "ClockProfile/ClockProfile.h"
+#include "LowPower/LowPower.h"
+#include "Dmac/Dmac.h"
+#include "ExtInt/ExtInt.h"
+#include "Imu/ImuBus.h"
+#include "Trace/Trace.h"
+#include "conf_irq_priorities.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define NRF_REG(ulAddress) (*(volatile uint32_t *)(ulAddress))
+
+// nRF51 UART0, modelled by QEMU's nrf51_uart
+#define QEMU_UART_IRQn 2
+#define UART_TASKS_STARTRX NRF_REG(0x40002000)
+#define UART_TASKS_STARTTX NRF_REG(0x40002008)
+#define UART_EVENTS_RXDRDY NRF_REG(0x40002108)
+#define UART_EVENTS_TXDRDY NRF_REG(0x4000211C)
+#define UART_INTENSET NRF_REG(0x40002304)
+#define UART_INTENCLR NRF_REG(0x40002308)
+#define UART_ENABLE NRF_REG(0x40002500)
+#define UART_RXD NRF_REG(0x40002518)
+#define UART_TXD NRF_REG(0x4000251C)
+#define UART_INT_RXDRDY (1UL << 2)
+#define UART_INT_TXDRDY (1UL << 7)
+#define UART_ENABLE_ENABLED 4UL
+
+// nRF51 TIMER0, modelled by QEMU's nrf51_timer
+#define TIMER_TASKS_START NRF_REG(0x40008000)
+#define TIMER_TASKS_STOP NRF_REG(0x40008004)
+#define TIMER_TASKS_CLEAR NRF_REG(0x4000800C)
+#define TIMER_TASKS_CAPTURE0 NRF_REG(0x40008040)
+#define TIMER_MODE NRF_REG(0x40008504)
+#define TIMER_BITMODE NRF_REG(0x40008508)
+#define TIMER_PRESCALER NRF_REG(0x40008510)
+#define TIMER_CC0 NRF_REG(0x40008540)
+#define TIMER_BITMODE_32BIT 3UL
+
+#define QEMU_VECTORS (16 + 32) ///< Cortex-M0 exceptions plus the nRF51 interrupt lines
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+int main(void);
+extern void __libc_init_array(void);
+
+static void prvUartHandler(void);
+static void prvFaultHandler(void);
+static void prvUnusedHandler(void);
+static void prvPanic(const char *pcMessage);
+static void prvCallback(struct usart_module *const pxModule, enum usart_callback eCallback);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+extern uint32_t _etext;
+extern uint32_t _srelocate;
+extern uint32_t _erelocate;
+extern uint32_t _szero;
+extern uint32_t _ezero;
+extern uint32_t _estack;
+
+static struct usart_module *pxConsole = NULL; ///< The one USART instance, as passed to usart_init()
+static bool bQemuAutoProfile = true; ///< ClockProfileSetAuto()
+
+/**
+ * @brief Vector table. IRQ 27 is I2S on the SAMD21, pended in software by the
+ *        isr_latency benchmark; the nRF51 NVIC has the line but no peripheral on it.
+ */
+__attribute__((section(".vectors"), used)) static void *const pvVectors[QEMU_VECTORS] = {
+	[0] = (void *)&_estack,
+	[1] = (void *)Reset_Handler,
+	[2] = (void *)prvFaultHandler, // NMI
+	[3] = (void *)prvFaultHandler, // HardFault
+	[11] = (void *)SVC_Handler,
+	[14] = (void *)PendSV_Handler,
+	[15] = (void *)SysTick_Handler,
+	[16 ... 16 + QEMU_UART_IRQn - 1] = (void *)prvUnusedHandler,
+	[16 + QEMU_UART_IRQn] = (void *)prvUartHandler,
+	[16 + QEMU_UART_IRQn + 1 ... 16 + I2S_IRQn - 1] = (void *)prvUnusedHandler,
+	[16 + I2S_IRQn] = (void *)I2S_Handler,
+	[16 + I2S_IRQn + 1 ... QEMU_VECTORS - 1] = (void *)prvUnusedHandler,
+};
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Copies .relocate (data and RAMFUNC_HOT code), clears .bss and runs main().
+ */
+void Reset_Handler(void)
+{
+	uint32_t *pulSrc = &_etext;
+	uint32_t *pulDest = &_srelocate;
+
+	while (pulDest < &_erelocate)
+	{
+		*pulDest++ = *pulSrc++;
+	}
+	for (pulDest = &_szero; pulDest < &_ezero;)
+	{
+		*pulDest++ = 0;
+	}
+
+	__libc_init_array();
+	main();
+
+	for (;;)
+	{
+	}
+}
+
+/**
+ * @brief Replaces the ASF clock and board set up. QEMU needs none.
+ */
+void system_init(void)
+{
+}
+
+/**
+ * @brief Every generator runs at the fixed nRF51 clock.
+ */
+uint32_t system_gclk_gen_get_hz(const uint8_t generator)
+{
+	return QEMU_BOARD_CPU_HZ;
+}
+
+/**
+ * @brief Every peripheral channel runs at the fixed nRF51 clock.
+ */
+uint32_t system_gclk_chan_get_hz(const uint8_t channel)
+{
+	return QEMU_BOARD_CPU_HZ;
+}
+
+/**
+ * @brief The console is SERCOM4 on the board.
+ */
+uint8_t _sercom_get_sercom_inst_index(Sercom *const sercom_instance)
+{
+	return 4;
+}
+
+/**
+ * @brief The emulated UART has no baud rate generator, any rate is accepted.
+ */
+enum status_code _sercom_get_async_baud_val(const uint32_t baudrate, const uint32_t peripheral_clock, uint16_t *const baudval,
+											enum sercom_asynchronous_operation_mode mode, enum sercom_asynchronous_sample_num sample_num)
+{
+	*baudval = 0;
+	return STATUS_OK;
+}
+
+/**
+ * @brief Points usart_enable()/usart_disable() at the nRF51 UART interrupt line.
+ */
+enum system_interrupt_vector _sercom_get_interrupt_vector(Sercom *const sercom_instance)
+{
+	return (enum system_interrupt_vector)QEMU_UART_IRQn;
+}
+
+/**
+ * @brief Starts the nRF51 UART with both interrupts. The configuration is ignored.
+ */
+enum status_code usart_init(struct usart_module *const module, Sercom *const hw, const struct usart_config *const config)
+{
+	memset(module, 0, sizeof(*module));
+	module->hw = hw;
+	module->character_size = USART_CHARACTER_SIZE_8BIT;
+	module->receiver_enabled = true;
+	module->transmitter_enabled = true;
+	module->rx_status = STATUS_OK;
+	module->tx_status = STATUS_OK;
+	pxConsole = module;
+
+	UART_ENABLE = UART_ENABLE_ENABLED;
+	UART_INTENSET = UART_INT_TXDRDY;
+	UART_TASKS_STARTRX = 1;
+	UART_TASKS_STARTTX = 1;
+	NVIC_SetPriority((IRQn_Type)QEMU_UART_IRQn, IRQ_PRIORITY_CONSOLE);
+
+	return STATUS_OK;
+}
+
+/**
+ * @brief Same as the ASF driver.
+ */
+void usart_register_callback(struct usart_module *const module, usart_callback_t callback_func, enum usart_callback callback_type)
+{
+	module->callback[callback_type] = callback_func;
+	module->callback_reg_mask |= (1 << callback_type);
+}
+
+/**
+ * @brief Sends the first byte; the TXDRDY interrupt sends the rest.
+ */
+enum status_code usart_write_buffer_job(struct usart_module *const module, uint8_t *tx_data, uint16_t length)
+{
+	if (length == 0)
+	{
+		return STATUS_ERR_INVALID_ARG;
+	}
+
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	if (module->tx_status == STATUS_BUSY)
+	{
+		__set_PRIMASK(ulPrimask);
+		return STATUS_BUSY;
+	}
+
+	module->tx_status = STATUS_BUSY;
+	module->tx_buffer_ptr = tx_data + 1;
+	module->remaining_tx_buffer_length = length - 1;
+	UART_TXD = tx_data[0];
+
+	__set_PRIMASK(ulPrimask);
+	return STATUS_OK;
+}
+
+/**
+ * @brief Arms the RXDRDY interrupt. Bytes that arrive while no job is active
+ *        wait in the UART FIFO, like the SERCOM's two byte buffer.
+ */
+enum status_code usart_read_buffer_job(struct usart_module *const module, uint8_t *rx_data, uint16_t length)
+{
+	if (length == 0)
+	{
+		return STATUS_ERR_INVALID_ARG;
+	}
+
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	if (module->rx_status == STATUS_BUSY)
+	{
+		__set_PRIMASK(ulPrimask);
+		return STATUS_BUSY;
+	}
+
+	module->rx_status = STATUS_BUSY;
+	module->rx_buffer_ptr = rx_data;
+	module->remaining_rx_buffer_length = length;
+	UART_INTENSET = UART_INT_RXDRDY;
+
+	__set_PRIMASK(ulPrimask);
+	return STATUS_OK;
+}
+
+/**
+ * @brief Same as the ASF driver.
+ */
+enum status_code usart_get_job_status(struct usart_module *const module, enum usart_transceiver_type transceiver_type)
+{
+	return (transceiver_type == USART_TRANSCEIVER_RX) ? module->rx_status : module->tx_status;
+}
+
+/**
+ * @brief Starts TIMER0 from 0 as a 32-bit counter at 16 MHz.
+ */
+void QemuBoardStartCycleCounter(void)
+{
+	TIMER_TASKS_STOP = 1;
+	TIMER_MODE = 0;
+	TIMER_BITMODE = TIMER_BITMODE_32BIT;
+	TIMER_PRESCALER = 0;
+	TIMER_TASKS_CLEAR = 1;
+	TIMER_TASKS_START = 1;
+}
+
+/**
+ * @brief Captures and returns TIMER0. Capture and read are not atomic, so
+ *        interrupts are masked in between.
+ */
+uint32_t QemuBoardGetCycles(void)
+{
+	uint32_t ulPrimask = __get_PRIMASK();
+	__disable_irq();
+
+	TIMER_TASKS_CAPTURE0 = 1;
+	uint32_t ulCycles = TIMER_CC0;
+
+	__set_PRIMASK(ulPrimask);
+	return ulCycles;
+}
+
+/**
+ * @brief Opens the instruction count window for one CLI command.
+ */
+void QemuBoardSectionBegin(uint8_t ucSection)
+{
+	if (ucSection == TRACE_SECTION_CLI_COMMAND)
+	{
+		QemuWindowOpen();
+	}
+}
+
+/**
+ * @brief Closes the window.
+ */
+void QemuBoardSectionEnd(uint8_t ucSection)
+{
+	if (ucSection == TRACE_SECTION_CLI_COMMAND)
+	{
+		QemuWindowClose();
+	}
+}
+
+/**
+ * @brief Marker. Kept out of line and non-empty so its address is unique.
+ */
+__attribute__((noinline, used)) void QemuWindowOpen(void)
+{
+	__asm volatile("nop");
+}
+
+/**
+ * @brief Marker. Kept out of line and non-empty so its address is unique.
+ */
+__attribute__((noinline, used)) void QemuWindowClose(void)
+{
+	__asm volatile("nop");
+}
+
+/******************************************************************************
+ * ClockProfile stubs. The emulated clock is fixed
+ ******************************************************************************/
+
+/**
+ * @brief Nothing to lock: no switch happens.
+ */
+void ClockProfileInit(void)
+{
+}
+
+/**
+ * @brief Accepted, but never called: the clock does not change.
+ */
+BaseType_t ClockProfileRegisterCallback(ClockProfileCallback_t pxCallback)
+{
+	return (pxCallback != NULL) ? pdPASS : pdFAIL;
+}
+
+/**
+ * @brief Only the current profile can be selected.
+ */
+BaseType_t ClockProfileSet(enum eClockProfiles eProfile)
+{
+	return (eProfile == CLOCK_PROFILE_HIGH) ? pdPASS : pdFAIL;
+}
+
+/**
+ * @brief Accepted for HIGH only, like ClockProfileSet(). The IMU task, which
+ *        finds no sensors here, never asks for LOW.
+ */
+BaseType_t ClockProfileRequest(enum eClockProfiles eProfile)
+{
+	return ClockProfileSet(eProfile);
+}
+
+/**
+ * @brief Keeps the mode. The requested profile is always the current one.
+ */
+BaseType_t ClockProfileSetAuto(bool bAuto)
+{
+	bQemuAutoProfile = bAuto;
+	return pdPASS;
+}
+
+/**
+ * @brief Returns the mode last set.
+ */
+bool ClockProfileIsAuto(void)
+{
+	return bQemuAutoProfile;
+}
+
+/**
+ * @brief Always HIGH.
+ */
+enum eClockProfiles ClockProfileGet(void)
+{
+	return CLOCK_PROFILE_HIGH;
+}
+
+/**
+ * @brief Same names as ClockProfile.c.
+ */
+const char *ClockProfileGetName(enum eClockProfiles eProfile)
+{
+	static const char *const pcNames[N_CLOCK_PROFILES] = {"high", "low"};
+
+	return (eProfile < N_CLOCK_PROFILES) ? pcNames[eProfile] : NULL;
+}
+
+/**
+ * @brief Always 0.
+ */
+uint32_t ClockProfileGetSwitchCount(void)
+{
+	return 0;
+}
+
+/******************************************************************************
+ * LowPower stubs. Ticks are never suppressed
+ ******************************************************************************/
+
+/**
+ * @brief Nothing to set up.
+ */
+void LowPowerInit(void)
+{
+}
+
+/**
+ * @brief There is no STANDBY to hold off.
+ */
+void LowPowerNotifyActivity(void)
+{
+}
+
+/**
+ * @brief No sleep is accounted.
+ */
+void LowPowerGetStats(LowPowerStats_t *pxStats)
+{
+	memset(pxStats, 0, sizeof(*pxStats));
+}
+
+/**
+ * @brief Nothing to clear.
+ */
+void LowPowerResetStats(void)
+{
+}
+
+/**
+ * @brief Same names as LowPower.c.
+ */
+const char *LowPowerGetStateName(enum eSleepStates eState)
+{
+	static const char *const pcNames[N_SLEEP_STATES] = {"run", "idle", "standby"};
+
+	return (eState < N_SLEEP_STATES) ? pcNames[eState] : NULL;
+}
+
+/**
+ * @brief Waits for the next interrupt, the tick at the latest. Under -icount
+ *        with sleep=off QEMU skips the idle time without executing anything,
+ *        so idle periods do not add to the instruction counts.
+ */
+void vLowPowerSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+	__DSB();
+	__WFI();
+}
+
+/******************************************************************************
+ * DMAC, EIC and IMU bus stubs. The machine has no sensors
+ ******************************************************************************/
+
+/**
+ * @brief Nothing to set up.
+ */
+void DmacInit(void)
+{
+}
+
+/**
+ * @brief Nothing to set up.
+ */
+void ExtIntInit(void)
+{
+}
+
+/**
+ * @brief Accepted. The line never fires.
+ */
+BaseType_t ExtIntConfigure(uint8_t ucLine, enum eExtIntSenses eSense, bool bWakeup, ExtIntCallback_t pxCallback,
+						   void *pvContext)
+{
+	return (ucLine < EXTINT_LINES) ? pdPASS : pdFAIL;
+}
+
+/**
+ * @brief The line never fires.
+ */
+void ExtIntEnable(uint8_t ucLine)
+{
+}
+
+/**
+ * @brief Never pending.
+ */
+bool ExtIntDisable(uint8_t ucLine)
+{
+	return false;
+}
+
+/**
+ * @brief Nothing to set up.
+ */
+void ImuBusInit(void)
+{
+}
+
+/**
+ * @brief No device answers.
+ */
+BaseType_t ImuSpiWrite(uint8_t ucRegister, uint8_t ucValue)
+{
+	return pdFAIL;
+}
+
+/**
+ * @brief No device answers.
+ */
+BaseType_t ImuSpiRead(uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+{
+	return pdFAIL;
+}
+
+/**
+ * @brief No device answers.
+ */
+BaseType_t ImuI2cWrite(uint8_t ucAddress, uint8_t ucRegister, uint8_t ucValue)
+{
+	return pdFAIL;
+}
+
+/**
+ * @brief No device answers.
+ */
+BaseType_t ImuI2cRead(uint8_t ucAddress, uint8_t ucRegister, uint8_t *pucData, uint16_t usLength)
+{
+	return pdFAIL;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvUartHandler(void)
+ * @brief		UART0 interrupt. Moves one byte per event and calls the ASF style
+ *				callbacks when a job completes, like _usart_interrupt_handler()
+ *****************************************************************************/
+static void prvUartHandler(void)
+{
+	struct usart_module *const pxModule = pxConsole;
+
+	if (UART_EVENTS_TXDRDY)
+	{
+		UART_EVENTS_TXDRDY = 0;
+		if (pxModule->remaining_tx_buffer_length > 0)
+		{
+			pxModule->remaining_tx_buffer_length--;
+			UART_TXD = *(pxModule->tx_buffer_ptr++);
+		}
+		else if (pxModule->tx_status == STATUS_BUSY)
+		{
+			pxModule->tx_status = STATUS_OK;
+			prvCallback(pxModule, USART_CALLBACK_BUFFER_TRANSMITTED);
+		}
+	}
+
+	if (UART_EVENTS_RXDRDY)
+	{
+		if (pxModule->rx_status != STATUS_BUSY)
+		{
+			// Leave the byte in the FIFO until the next read job
+			UART_INTENCLR = UART_INT_RXDRDY;
+			return;
+		}
+
+		// Clear before reading: QEMU raises the event again if more bytes are queued
+		UART_EVENTS_RXDRDY = 0;
+		*(pxModule->rx_buffer_ptr++) = (uint8_t)UART_RXD;
+		if (--pxModule->remaining_rx_buffer_length == 0)
+		{
+			pxModule->rx_status = STATUS_OK;
+			prvCallback(pxModule, USART_CALLBACK_BUFFER_RECEIVED);
+		}
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCallback(struct usart_module *const pxModule, enum usart_callback eCallback)
+ * @brief		Calls a callback if it is registered and enabled
+ *****************************************************************************/
+static void prvCallback(struct usart_module *const pxModule, enum usart_callback eCallback)
+{
+	if ((pxModule->callback_reg_mask & pxModule->callback_enable_mask) & (1 << eCallback))
+	{
+		pxModule->callback[eCallback](pxModule);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvFaultHandler(void)
+ * @brief		NMI and HardFault. The harness times out on the missing frame
+ *****************************************************************************/
+static void prvFaultHandler(void)
+{
+	prvPanic("\r\nqemu_board: fault\r\n");
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvUnusedHandler(void)
+ * @brief		Any interrupt without a handler
+ *****************************************************************************/
+static void prvUnusedHandler(void)
+{
+	prvPanic("\r\nqemu_board: unexpected interrupt\r\n");
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPanic(const char *pcMessage)
+ * @brief		Writes a message with interrupts masked, polling TXDRDY, and stops
+ *****************************************************************************/
+static void prvPanic(const char *pcMessage)
+{
+	__disable_irq();
+	UART_INTENCLR = UART_INT_TXDRDY | UART_INT_RXDRDY;
+
+	while (*pcMessage != '\0')
+	{
+		UART_EVENTS_TXDRDY = 0;
+		UART_TXD = (uint8_t)*pcMessage++;
+		while (!UART_EVENTS_TXDRDY)
+		{
+		}
+	}
+
+	for (;;)
+	{
+	}
+}
@@ -0,0 +1,81 @@
+/**************************************************************************/ /**
+ * @file      qemu_board.h
+ * @brief     Board support for running the firmware under QEMU's "microbit"
+ *            machine (nRF51, Cortex-M0, 16 MHz, 256 KB flash, 16 KB RAM).
+ * @details   QEMU has no SAMD21 machine. The application is built unchanged
+ *            for the same ARMv6-M instruction set, and this file stands in for
+ *            the SAMD21 hardware it touches:
+ *            --The ASF USART job API (usart_init, usart_*_buffer_job, ...) is
+ *              implemented on the nRF51 UART, so SerialConsole.c, the logger
+ *              and the CLI run as they do on the board
+ *            --BenchmarkGetCycles() reads TIMER0, a 32-bit counter at 16 MHz,
+ *              instead of TC3
+ *            --ClockProfile and LowPower are replaced by stubs: the clock is
+ *              fixed and the idle task sleeps with WFI without suppressing ticks
+ *            --TraceSectionBegin/End() of TRACE_SECTION_CLI_COMMAND call
+ *              QemuWindowOpen/Close(), where tools/qemu/insn_window.c counts
+ *              the instructions executed in between
+ *
+ *            The SAMD21 register accesses left in inline ASF functions
+ *            (usart_enable() waiting for SYNCBUSY, ...) hit the unimplemented
+ *            nRF51 peripheral space, which reads as 0 and ignores writes.
+ *
+ *            Built by tools/qemu/Makefile, run by tools/qemu/perf_check.py.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef QEMU_BOARD_H
+#define QEMU_BOARD_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define QEMU_BOARD_CPU_HZ 16000000UL ///< nRF51 HFCLK, also the TIMER0 rate with PRESCALER 0
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+/**
+ * @fn			void QemuBoardStartCycleCounter(void)
+ * @brief		Starts TIMER0 as a free running 32-bit counter at QEMU_BOARD_CPU_HZ
+ *****************************************************************************/
+void QemuBoardStartCycleCounter(void);
+
+/**
+ * @fn			uint32_t QemuBoardGetCycles(void)
+ * @brief		Returns TIMER0. QEMU derives it from virtual time, which with
+ *				-icount advances with the instructions executed
+ *****************************************************************************/
+uint32_t QemuBoardGetCycles(void);
+
+/**
+ * @fn			void QemuBoardSectionBegin(uint8_t ucSection)
+ * @brief		Called by TraceSectionBegin(). Opens the instruction count window
+ *				for TRACE_SECTION_CLI_COMMAND
+ *****************************************************************************/
+void QemuBoardSectionBegin(uint8_t ucSection);
+
+/**
+ * @fn			void QemuBoardSectionEnd(uint8_t ucSection)
+ * @brief		Called by TraceSectionEnd(). Closes the window
+ *****************************************************************************/
+void QemuBoardSectionEnd(uint8_t ucSection);
+
+/**
+ * @fn			void QemuWindowOpen(void)
+ * @brief		Marker function. The insn_window plugin starts counting when it runs
+ *****************************************************************************/
+void QemuWindowOpen(void);
+
+/**
+ * @fn			void QemuWindowClose(void)
+ * @brief		Marker function. The insn_window plugin reports the count when it runs
+ *****************************************************************************/
+void QemuWindowClose(void);
+
+#endif /* QEMU_BOARD_H */
@@ -0,0 +1,56 @@
+/**************************************************************************/ /**
+ * @file      arm_math.h
+ * @brief     Host stand-in for the CMSIS-DSP functions the processing modules
+ *            use, for the replay and pipeline harnesses.
+ * @details   The tree has the CMSIS-DSP headers and the Cortex-M0 library,
+ *            not its sources. cmsis_host.c implements these functions after
+ *            the plain C (ARM_MATH_CM0_FAMILY) code of CMSIS-DSP 1.5.3, the
+ *            version of the linked library, with the same rounding and
+ *            saturation. cmsis_check.c holds them to the outputs of the
+ *            library's own Thumb code, captured in cmsis_golden.h by
+ *            cmsis_golden.py. Add a function here, in cmsis_host.c and to
+ *            the golden cases when a module starts using it.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef REPLAY_ARM_MATH_H
+#define REPLAY_ARM_MATH_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float float32_t;
+
+typedef enum
+{
+	ARM_MATH_SUCCESS = 0,
+	ARM_MATH_ARGUMENT_ERROR = -1
+} arm_status;
+
+typedef struct
+{
+	int8_t numStages;
+	q15_t *pState;
+	q15_t *pCoeffs;
+	int8_t postShift;
+} arm_biquad_casd_df1_inst_q15;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages, q15_t *pCoeffs, q15_t *pState, int8_t postShift);
+void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_abs_q15(q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+arm_status arm_sqrt_q31(q31_t in, q31_t *pOut);
+void arm_dot_prod_q7(q7_t *pSrcA, q7_t *pSrcB, uint32_t blockSize, q31_t *result);
+
+#endif /* REPLAY_ARM_MATH_H */
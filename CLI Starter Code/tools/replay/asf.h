@@ -0,0 +1,53 @@
+/**************************************************************************/ /**
+ * @file      asf.h
+ * @brief     Host stand-in for <asf.h>, for the replay harness.
+ * @details   The processing modules include <asf.h> for the FreeRTOS types
+ *            and critical sections. tools/replay/Makefile puts this directory
+ *            first on the include path, so they compile unmodified on the
+ *            host against these definitions instead of the ASF and the port.
+ *            The harness has one thread, so critical sections are empty.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef REPLAY_ASF_H
+#define REPLAY_ASF_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+// Same values as FreeRTOSConfig.h and projdefs.h
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 5
+#define tskIDLE_PRIORITY 0
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define configASSERT(x) assert(x)
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+TickType_t xTaskGetTickCount(void); ///< In replay_host.c
+
+#endif /* REPLAY_ASF_H */
@@ -0,0 +1,215 @@
+/**************************************************************************/ /**
+ * @file      cmsis_check.c
+ * @brief     Check of the CMSIS-DSP stand-ins of cmsis_host.c against the
+ *            linked library, built for the host by tools/replay/Makefile.
+ * @details   cmsis_golden.h holds inputs and the outputs the Thumb code of
+ *            libarm_cortexM0l_math.a gave for them, captured by
+ *            cmsis_golden.py. Each function of cmsis_host.c runs on the same
+ *            inputs and must give the same outputs to the bit: every filter
+ *            block and the filter state after the last one, every absolute
+ *            value, square root and status, every dot product. The first
+ *            difference of each function is printed; the exit status is 1 if
+ *            there is any.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <arm_math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_golden.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CHECK_MAX_STAGES 2
+#define CHECK_MAX_BLOCK 32
+#define CHECK_ABS_VALUES (sizeof(sGoldenAbsIn) / sizeof(sGoldenAbsIn[0]))
+#define CHECK_SQRT_VALUES (sizeof(lGoldenSqrtIn) / sizeof(lGoldenSqrtIn[0]))
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static uint32_t prvCheckBiquads(uint32_t *pulValues);
+static uint32_t prvCheckAbs(uint32_t *pulValues);
+static uint32_t prvCheckSqrt(uint32_t *pulValues);
+static uint32_t prvCheckDots(uint32_t *pulValues);
+static int prvReport(const char *pcFunction, uint32_t ulCases, uint32_t ulValues, uint32_t ulMismatches);
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Runs every golden case.
+ */
+int main(void)
+{
+	uint32_t ulValues, ulMismatches;
+	int iFailed = 0;
+
+	printf("%-32s %6s %7s %10s %8s\n", "Function", "Cases", "Values", "Mismatches", "Result");
+
+	ulMismatches = prvCheckBiquads(&ulValues);
+	iFailed |= prvReport("arm_biquad_cascade_df1_q15", sizeof(xGoldenBiquads) / sizeof(xGoldenBiquads[0]), ulValues,
+						 ulMismatches);
+	ulMismatches = prvCheckAbs(&ulValues);
+	iFailed |= prvReport("arm_abs_q15", 1, ulValues, ulMismatches);
+	ulMismatches = prvCheckSqrt(&ulValues);
+	iFailed |= prvReport("arm_sqrt_q31", CHECK_SQRT_VALUES, ulValues, ulMismatches);
+	ulMismatches = prvCheckDots(&ulValues);
+	iFailed |= prvReport("arm_dot_prod_q7", sizeof(xGoldenDots) / sizeof(xGoldenDots[0]), ulValues, ulMismatches);
+
+	printf("cmsis_host.c against libarm_cortexM0l_math.a: %s\n", iFailed ? "FAIL" : "pass");
+	return iFailed;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvCheckBiquads(uint32_t *pulValues)
+ * @brief		Runs each filter case block by block, as the detector does
+ * @param[out]	pulValues Outputs and state words compared
+ * @return		Mismatches
+ *****************************************************************************/
+static uint32_t prvCheckBiquads(uint32_t *pulValues)
+{
+	uint32_t ulMismatches = 0;
+
+	*pulValues = 0;
+	for (size_t i = 0; i < sizeof(xGoldenBiquads) / sizeof(xGoldenBiquads[0]); i++)
+	{
+		const GoldenBiquad_t *pxCase = &xGoldenBiquads[i];
+		arm_biquad_casd_df1_inst_q15 xFilter;
+		q15_t sCoeffs[6 * CHECK_MAX_STAGES];
+		q15_t sState[4 * CHECK_MAX_STAGES];
+		q15_t sIn[CHECK_MAX_BLOCK];
+		q15_t sOut[CHECK_MAX_BLOCK];
+		size_t xOffset = 0;
+
+		configASSERT(pxCase->ucStages <= CHECK_MAX_STAGES);
+		memcpy(sCoeffs, pxCase->psCoeffs, 6 * pxCase->ucStages * sizeof(q15_t));
+		arm_biquad_cascade_df1_init_q15(&xFilter, pxCase->ucStages, sCoeffs, sState, pxCase->cPostShift);
+		memcpy(sState, pxCase->psStateIn, 4 * pxCase->ucStages * sizeof(q15_t));
+
+		for (uint16_t b = 0; b < pxCase->usBlocks; b++)
+		{
+			uint16_t usLength = pxCase->pusBlocks[b];
+
+			configASSERT(usLength <= CHECK_MAX_BLOCK);
+			memcpy(sIn, &pxCase->psIn[xOffset], usLength * sizeof(q15_t));
+			arm_biquad_cascade_df1_q15(&xFilter, sIn, sOut, usLength);
+			for (uint16_t j = 0; j < usLength; j++, xOffset++)
+			{
+				if (sOut[j] != pxCase->psOut[xOffset] && ulMismatches++ == 0)
+				{
+					fprintf(stderr, "biquad %s, sample %zu: %d, library %d\n", pxCase->pcName, xOffset, sOut[j],
+							pxCase->psOut[xOffset]);
+				}
+			}
+		}
+		*pulValues += (uint32_t)xOffset;
+
+		for (uint16_t j = 0; j < 4 * pxCase->ucStages; j++, (*pulValues)++)
+		{
+			if (sState[j] != pxCase->psStateOut[j] && ulMismatches++ == 0)
+			{
+				fprintf(stderr, "biquad %s, state %u: %d, library %d\n", pxCase->pcName, j, sState[j],
+						pxCase->psStateOut[j]);
+			}
+		}
+	}
+
+	return ulMismatches;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvCheckAbs(uint32_t *pulValues)
+ * @brief		Absolute values in place, as the detector takes them
+ *****************************************************************************/
+static uint32_t prvCheckAbs(uint32_t *pulValues)
+{
+	q15_t sValues[CHECK_ABS_VALUES];
+	uint32_t ulMismatches = 0;
+
+	memcpy(sValues, sGoldenAbsIn, sizeof(sValues));
+	arm_abs_q15(sValues, sValues, CHECK_ABS_VALUES);
+	for (size_t i = 0; i < CHECK_ABS_VALUES; i++)
+	{
+		if (sValues[i] != sGoldenAbsOut[i] && ulMismatches++ == 0)
+		{
+			fprintf(stderr, "abs of %d: %d, library %d\n", sGoldenAbsIn[i], sValues[i], sGoldenAbsOut[i]);
+		}
+	}
+
+	*pulValues = CHECK_ABS_VALUES;
+	return ulMismatches;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvCheckSqrt(uint32_t *pulValues)
+ * @brief		Square roots and their status, negative and zero arguments included
+ *****************************************************************************/
+static uint32_t prvCheckSqrt(uint32_t *pulValues)
+{
+	uint32_t ulMismatches = 0;
+
+	for (size_t i = 0; i < CHECK_SQRT_VALUES; i++)
+	{
+		q31_t lRoot = 0x5A5A5A5A;
+		arm_status eStatus = arm_sqrt_q31(lGoldenSqrtIn[i], &lRoot);
+
+		if ((lRoot != lGoldenSqrtOut[i] || eStatus != cGoldenSqrtStatus[i]) && ulMismatches++ == 0)
+		{
+			fprintf(stderr, "sqrt of %ld: %ld (%d), library %ld (%d)\n", (long)lGoldenSqrtIn[i], (long)lRoot,
+					(int)eStatus, (long)lGoldenSqrtOut[i], cGoldenSqrtStatus[i]);
+		}
+	}
+
+	*pulValues = CHECK_SQRT_VALUES;
+	return ulMismatches;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvCheckDots(uint32_t *pulValues)
+ * @brief		Dot products, with the products of -128 that overflow q7
+ *****************************************************************************/
+static uint32_t prvCheckDots(uint32_t *pulValues)
+{
+	uint32_t ulMismatches = 0;
+
+	*pulValues = 0;
+	for (size_t i = 0; i < sizeof(xGoldenDots) / sizeof(xGoldenDots[0]); i++)
+	{
+		const GoldenDot_t *pxCase = &xGoldenDots[i];
+		q31_t lResult;
+
+		arm_dot_prod_q7((q7_t *)pxCase->pcA, (q7_t *)pxCase->pcB, pxCase->usLength, &lResult);
+		if (lResult != pxCase->lResult && ulMismatches++ == 0)
+		{
+			fprintf(stderr, "dot product of %u: %ld, library %ld\n", pxCase->usLength, (long)lResult,
+					(long)pxCase->lResult);
+		}
+		*pulValues += pxCase->usLength;
+	}
+
+	return ulMismatches;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvReport(const char *pcFunction, uint32_t ulCases, uint32_t ulValues, uint32_t ulMismatches)
+ * @brief		Prints the line of a function
+ * @return		1 on any mismatch
+ *****************************************************************************/
+static int prvReport(const char *pcFunction, uint32_t ulCases, uint32_t ulValues, uint32_t ulMismatches)
+{
+	printf("%-32s %6lu %7lu %10lu %8s\n", pcFunction, (unsigned long)ulCases, (unsigned long)ulValues,
+		   (unsigned long)ulMismatches, ulMismatches == 0 ? "ok" : "FAIL");
+	return ulMismatches != 0;
+}
@@ -0,0 +1,460 @@
+/**************************************************************************/ /**
+ * @file      cmsis_golden.h
+ * @brief     Outputs of the linked CMSIS-DSP library, for cmsis_check.c.
+ * @details   Generated by tools/replay/cmsis_golden.py from the Thumb code of
+ *            libarm_cortexM0l_math.a. Do not edit; run the script again.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CMSIS_GOLDEN_H
+#define CMSIS_GOLDEN_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <arm_math.h>
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A filter run: an instance set up with the coefficients, its state
+ *        preset, then fed the input in blocks.
+ */
+typedef struct
+{
+	const char *pcName;
+	uint8_t ucStages;
+	int8_t cPostShift;
+	const q15_t *psCoeffs;
+	const q15_t *psStateIn;	 ///< 4 per stage, before the first block
+	const q15_t *psStateOut; ///< After the last block
+	const uint16_t *pusBlocks;
+	uint16_t usBlocks;
+	const q15_t *psIn;	 ///< All blocks back to back
+	const q15_t *psOut;
+} GoldenBiquad_t;
+
+/**
+ * @brief A dot product.
+ */
+typedef struct
+{
+	const q7_t *pcA;
+	const q7_t *pcB;
+	uint16_t usLength;
+	q31_t lResult;
+} GoldenDot_t;
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static const q15_t sBiquad0Coeffs[6] = {
+	6412, 0, -12824, 6412, 6054, -3208,
+};
+
+static const q15_t sBiquad0StateIn[4] = {
+	1024, 1024, 0, 0,
+};
+
+static const q15_t sBiquad0StateOut[4] = {
+	27, 318, -186, -119,
+};
+
+static const uint16_t usBiquad0Blocks[3] = {
+	10, 10, 5,
+};
+
+static const q15_t sBiquad0In[25] = {
+	861, 1143, 907, 868, 688, 895, 1055, 1238, 13614, 1122, 1321, 1050,
+	1149, 1292, 994, 1150, 1122, 25632, 860, 885, 616, 338, 64, 318,
+	27,
+};
+
+static const q15_t sBiquad0Out[25] = {
+	-64, 150, -135, -3, -30, 140, 39, -5, 4762, -7972, 1088, 1779,
+	589, -114, -331, 77, 21, 9595, -15746, 2007, 3709, 974, -365, -119,
+	-186,
+};
+
+static const q15_t sBiquad1Coeffs[6] = {
+	10468, 0, -20936, 10468, 18727, -6763,
+};
+
+static const q15_t sBiquad1StateIn[4] = {
+	1024, 1024, 0, 0,
+};
+
+static const q15_t sBiquad1StateOut[4] = {
+	2005, 2111, 360, 800,
+};
+
+static const uint16_t usBiquad1Blocks[3] = {
+	10, 10, 5,
+};
+
+static const q15_t sBiquad1In[25] = {
+	1114, 1035, 1167, 896, 1136, 1063, 1211, 1418, 14996, 1737, 1673, 1597,
+	1767, 1763, 1485, 1611, 1880, 12946, 1685, 1508, 1548, 1760, 1892, 2111,
+	2005,
+};
+
+static const q15_t sBiquad1Out[25] = {
+	57, -43, 62, -169, 107, -8, 87, 140, 8667, -7298, -3489, -984,
+	472, 834, 583, 580, 513, 7245, -6196, -2991, -723, 518, 839, 800,
+	360,
+};
+
+static const q15_t sBiquad2Coeffs[6] = {
+	13117, 0, -26234, 13117, 25576, -10508,
+};
+
+static const q15_t sBiquad2StateIn[4] = {
+	1024, 1024, 0, 0,
+};
+
+static const q15_t sBiquad2StateOut[4] = {
+	1722, 1707, 69, -538,
+};
+
+static const uint16_t usBiquad2Blocks[3] = {
+	10, 10, 5,
+};
+
+static const q15_t sBiquad2In[25] = {
+	1034, 1024, 1235, 1452, 1554, 1289, 1480, 1428, 20997, 1418, 1493, 1754,
+	1837, 1625, 1774, 1994, 1804, 24199, 1773, 1852, 2053, 1783, 1963, 1707,
+	1722,
+};
+
+static const q15_t sBiquad2Out[25] = {
+	8, -4, 165, 264, 214, -130, 24, -74, 15577, -6979, -5150, -3415,
+	-2171, -1435, -559, 104, 192, 18314, -7418, -5309, -3433, -2332, -1079, -538,
+	69,
+};
+
+static const q15_t sBiquad3Coeffs[6] = {
+	14661, 0, -29322, 14661, 29141, -13120,
+};
+
+static const q15_t sBiquad3StateIn[4] = {
+	1024, 1024, 0, 0,
+};
+
+static const q15_t sBiquad3StateOut[4] = {
+	2534, 2624, -1659, -1985,
+};
+
+static const uint16_t usBiquad3Blocks[3] = {
+	10, 10, 5,
+};
+
+static const q15_t sBiquad3In[25] = {
+	1316, 1419, 1293, 1165, 1379, 1311, 1023, 927, 24731, 1116, 1230, 1456,
+	1508, 1799, 1860, 2030, 2005, 27866, 1971, 2063, 2287, 2119, 2350, 2624,
+	2534,
+};
+
+static const q15_t sBiquad3Out[25] = {
+	261, 295, 110, -43, 141, 32, -253, -304, 21048, -4753, -4076, -3344,
+	-2840, -2160, -1774, -1329, -1118, 22239, -5864, -4985, -4053, -3568, -2744, -1985,
+	-1659,
+};
+
+static const q15_t sBiquad4Coeffs[12] = {
+	23080, 0, -25412, 30290, 15038, -3288, 21417, 0, 30792, 13997, 21551, 6296,
+};
+
+static const q15_t sBiquad4StateIn[8] = {
+	-58, 2443, -18418, -8571, 12376, 5280, -23657, -10818,
+};
+
+static const q15_t sBiquad4StateOut[8] = {
+	4089, -30860, 32767, -32768, 32767, -32768, -32768, -32768,
+};
+
+static const uint16_t usBiquad4Blocks[3] = {
+	1, 7, 16,
+};
+
+static const q15_t sBiquad4In[24] = {
+	32767, -32768, 32767, 32767, -32768, 0, -1, 1, -32561, 10634, 27282, -29102,
+	-2674, -9541, -9073, -20762, 693, -28514, -23534, -21859, -30581, 26607, -30860, 4089,
+};
+
+static const q15_t sBiquad4Out[24] = {
+	7875, 1220, 538, 8037, -12384, -17652, -3311, -9141, -32768, -32768, -22664, -32768,
+	-32768, -21239, -26924, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+};
+
+static const GoldenBiquad_t xGoldenBiquads[5] = {
+	{"hit 25 Hz", 1, 1, sBiquad0Coeffs, sBiquad0StateIn, sBiquad0StateOut, usBiquad0Blocks, 3, sBiquad0In, sBiquad0Out},
+	{"hit 50 Hz", 1, 1, sBiquad1Coeffs, sBiquad1StateIn, sBiquad1StateOut, usBiquad1Blocks, 3, sBiquad1In, sBiquad1Out},
+	{"hit 100 Hz", 1, 1, sBiquad2Coeffs, sBiquad2StateIn, sBiquad2StateOut, usBiquad2Blocks, 3, sBiquad2In, sBiquad2Out},
+	{"hit 200 Hz", 1, 1, sBiquad3Coeffs, sBiquad3StateIn, sBiquad3StateOut, usBiquad3Blocks, 3, sBiquad3In, sBiquad3Out},
+	{"saturating", 2, 0, sBiquad4Coeffs, sBiquad4StateIn, sBiquad4StateOut, usBiquad4Blocks, 3, sBiquad4In, sBiquad4Out},
+};
+
+static const q15_t sGoldenAbsIn[67] = {
+	0, 1, -1, 32767, -32767, -32768, 2, -2, -11846, 683, -10729, 3003,
+	5831, 26830, 9437, 32308, 29330, -17801, -29671, 8127, 17898, 12234, 22402, -8122,
+	1103, -18513, 453, -5363, 23809, -30040, -3228, -30427, 19308, -13571, -28138, -11767,
+	25646, 23155, -3854, 26325, -3514, -28745, 18992, 9338, 23107, -25063, 6370, -16295,
+	-4964, -26550, 7390, -23498, -22749, 7911, 6275, -12032, 21780, 309, -15678, -31657,
+	-27799, -4248, 27636, -10287, -27863, 16773, -6501,
+};
+
+static const q15_t sGoldenAbsOut[67] = {
+	0, 1, 1, 32767, 32767, 32767, 2, 2, 11846, 683, 10729, 3003,
+	5831, 26830, 9437, 32308, 29330, 17801, 29671, 8127, 17898, 12234, 22402, 8122,
+	1103, 18513, 453, 5363, 23809, 30040, 3228, 30427, 19308, 13571, 28138, 11767,
+	25646, 23155, 3854, 26325, 3514, 28745, 18992, 9338, 23107, 25063, 6370, 16295,
+	4964, 26550, 7390, 23498, 22749, 7911, 6275, 12032, 21780, 309, 15678, 31657,
+	27799, 4248, 27636, 10287, 27863, 16773, 6501,
+};
+
+static const q31_t lGoldenSqrtIn[258] = {
+	0, -1, -2147483648, 1, 2, 3,
+	4, 2147483647, 1, 2, 3, 3,
+	4, 5, 7, 8, 9, 15,
+	16, 17, 31, 32, 33, 63,
+	64, 65, 127, 128, 129, 255,
+	256, 257, 511, 512, 513, 1023,
+	1024, 1025, 2047, 2048, 2049, 4095,
+	4096, 4097, 8191, 8192, 8193, 16383,
+	16384, 16385, 32767, 32768, 32769, 65535,
+	65536, 65537, 131071, 131072, 131073, 262143,
+	262144, 262145, 524287, 524288, 524289, 1048575,
+	1048576, 1048577, 2097151, 2097152, 2097153, 4194303,
+	4194304, 4194305, 8388607, 8388608, 8388609, 16777215,
+	16777216, 16777217, 33554431, 33554432, 33554433, 67108863,
+	67108864, 67108865, 134217727, 134217728, 134217729, 268435455,
+	268435456, 268435457, 536870911, 536870912, 536870913, 1073741823,
+	1073741824, 1073741825, 1727, 83, 1955008, 10971,
+	64, 9, 1639339, 579, 46142, 1086,
+	136116500, 248733633, 1, 74, 1144, 1625843509,
+	20142112, 1460, 97, 1967738, 65670093, 500159024,
+	1617, 171566100, 2582640, 33212, 1572873091, 154,
+	5888304, 6, 38, 317156856, 97, 12134418,
+	399122, 70694667, 2723, 1498, 521, 124365797,
+	432835, 804507802, 190500328, 18, 139150, 9,
+	2, 4, 121066047, 22628065, 53896382, 1517,
+	550646, 19800199, 3371, 212076, 122, 5,
+	308, 205393027, 185087, 429202507, 18701, 386,
+	22098644, 53048655, 1, 1803991, 7, 11,
+	181684761, 2, 172, 1665044347, 8489, 11,
+	36, 179, 8770325, 9, 315638285, 3388,
+	1133537624, 305353379, 554, 231, 28276, 8,
+	1215868, 2, 1, 1477071403, 572, 369109,
+	15773, 838, 3, 333972143, 1122611488, 1122206975,
+	239148751, 537005824, 462124021, 1326730160, 1165897207, 1477876354,
+	1006998252, 1421278614, 764132636, 556382943, 393467851, 1163082010,
+	446326359, 659967083, 427812894, 529099591, 774089661, 174738087,
+	602984901, 192016832, 961862738, 194322441, 1400181952, 1233420611,
+	1381832880, 727747380, 488394116, 838546288, 658814258, 88159050,
+	702745589, 401177545, 680183538, 1243407267, 650278088, 527954842,
+	717975535, 216783361, 1168715175, 1312953781, 1243361746, 1279819817,
+	197662829, 526343967, 472780185, 43752891, 523469110, 862802354,
+	155322192, 575662669, 1183703197, 152291735, 1565879080, 161340001,
+	46201130, 1364472666, 21296515, 624534525, 771357606, 1059270028,
+};
+
+static const q31_t lGoldenSqrtOut[258] = {
+	0, 0, 0, 46340, 65535, 80264,
+	92681, 2147483646, 46340, 65535, 80264, 80264,
+	92681, 103621, 122606, 131071, 139022, 179477,
+	185363, 191068, 258015, 262143, 266208, 367819,
+	370727, 373612, 522235, 524287, 526332, 740005,
+	741455, 742901, 1047551, 1048575, 1049599, 1482186,
+	1482910, 1483634, 2096639, 2097151, 2097663, 2965458,
+	2965820, 2966182, 4194047, 4194303, 4194559, 5931460,
+	5931641, 5931822, 8388479, 8388607, 8388735, 11863192,
+	11863283, 11863373, 16777151, 16777215, 16777279, 23726521,
+	23726566, 23726611, 33554399, 33554431, 33554463, 47453110,
+	47453132, 47453155, 67108847, 67108863, 67108879, 94906254,
+	94906265, 94906277, 134217719, 134217727, 134217735, 189812525,
+	189812531, 189812537, 268435450, 268435455, 268435459, 379625059,
+	379625063, 379625065, 536870908, 536870911, 536870913, 759250123,
+	759250126, 759250126, 1073741822, 1073741822, 1073741822, 1518500250,
+	1518500252, 1518500252, 1925799, 422186, 64794657, 4853868,
+	370727, 139022, 59333411, 1115075, 9954355, 1527143,
+	540655119, 730856627, 46340, 398639, 1567393, 1868548192,
+	207978018, 1770685, 456405, 65005270, 375533555, 1036379911,
+	1863459, 606988792, 74472660, 8445248, 1837857238, 575076,
+	112450151, 113511, 285664, 825281260, 456405, 161426342,
+	29276406, 389635266, 2418180, 1793580, 1057751, 516791559,
+	30487802, 1314407604, 639606394, 196607, 17286478, 139022,
+	65535, 92681, 509889552, 220439106, 340208169, 1804919,
+	34387545, 206205245, 2690570, 21340799, 511852, 103621,
+	813280, 664137159, 19936682, 960054877, 6337199, 910455,
+	217845074, 337522027, 46340, 62241796, 122606, 153695,
+	624631933, 65535, 607755, 1890940378, 4269659, 153695,
+	278045, 619999, 137237493, 139022, 823303137, 2697345,
+	1560209442, 809778604, 1090736, 704321, 7792448, 131071,
+	51098499, 65535, 46340, 1781007208, 1108314, 28154138,
+	5819987, 1341488, 80264, 846876446, 1552671832, 1552392066,
+	716636609, 1073876728, 996194650, 1687937002, 1582322718, 1781492432,
+	1470548292, 1747046814, 1281000522, 1093079718, 919220199, 1580411208,
+	979019181, 1190490872, 958499449, 1065942174, 1289319544, 612574227,
+	1137936824, 642147184, 1437214148, 645990917, 1734032248, 1627498260,
+	1722632724, 1250130230, 1024118341, 1341925644, 1189450646, 435109318,
+	1228468420, 928182210, 1208587200, 1634073674, 1181719746, 1064788424,
+	1241708792, 682303980, 1584233798, 1679150614, 1634043758, 1657827534,
+	651519525, 1063162764, 1007614865, 306526700, 1060255324, 1361195778,
+	577539494, 1111857080, 1594359826, 571877618, 1833766534, 588621281,
+	314985985, 1711777654, 213854898, 1158092260, 1287042284, 1508232430,
+};
+
+static const int8_t cGoldenSqrtStatus[258] = {
+	-1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0,
+};
+
+static const q7_t cDot0A[1] = {
+	112,
+};
+
+static const q7_t cDot0B[1] = {
+	-50,
+};
+
+static const q7_t cDot1A[2] = {
+	-77, 39,
+};
+
+static const q7_t cDot1B[2] = {
+	-89, -40,
+};
+
+static const q7_t cDot2A[3] = {
+	-37, -52, -56,
+};
+
+static const q7_t cDot2B[3] = {
+	35, 28, -74,
+};
+
+static const q7_t cDot3A[4] = {
+	-128, -128, -23, -56,
+};
+
+static const q7_t cDot3B[4] = {
+	-128, 127, -23, -37,
+};
+
+static const q7_t cDot4A[5] = {
+	-128, -128, -48, -104, -2,
+};
+
+static const q7_t cDot4B[5] = {
+	-128, 127, 100, 92, 0,
+};
+
+static const q7_t cDot5A[7] = {
+	-128, -128, -123, 74, 45, -41, 4,
+};
+
+static const q7_t cDot5B[7] = {
+	-128, 127, 85, -119, -97, 53, -58,
+};
+
+static const q7_t cDot6A[16] = {
+	-128, -128, 4, 13, 75, 77, -40, -83, -9, 120, -125, -38, 34, 96, -13, -6,
+};
+
+static const q7_t cDot6B[16] = {
+	-128, 127, 117, -13, 83, 44, 12, -16, -104, -92, 60, -47, -24, 31, 24, 25,
+};
+
+static const q7_t cDot7A[22] = {
+	-128, -128, 109, -85, -65, 65, -38, -49, 0, 90, -17, -102, 125, 73, 50, 68,
+	-44, -108, -82, 2, -77, 8,
+};
+
+static const q7_t cDot7B[22] = {
+	-128, 127, -87, 99, -5, 67, 93, 75, -44, 38, 96, -64, 121, -20, -67, 92,
+	81, -68, 23, 14, -1, 65,
+};
+
+static const q7_t cDot8A[64] = {
+	-128, -128, 96, -118, -113, -4, 5, -23, -40, 17, -53, -26, 11, 31, 0, 100,
+	-42, 54, 123, 87, -66, -22, 68, -24, 17, -73, -116, -68, -122, 23, -59, -90,
+	63, 31, 95, 54, 37, -128, -65, 98, 102, 51, 28, 76, 45, 124, -71, 65,
+	67, -24, -127, 14, -27, 108, 81, 28, -41, 102, -27, 56, -127, 71, 90, 79,
+};
+
+static const q7_t cDot8B[64] = {
+	-128, 127, 124, -2, 20, -118, 80, -49, 75, 10, -37, -91, -123, 50, 7, 82,
+	27, -51, 108, 4, 120, -42, 111, -105, 10, -78, 88, -93, 53, -94, 98, -118,
+	-44, -46, -81, 77, 13, 27, -22, -22, -7, 42, 9, -93, -90, 60, 111, -103,
+	-42, 24, 10, 54, -10, 72, 76, -40, 119, 4, 40, -15, 4, -3, -113, 78,
+};
+
+static const q7_t cDot9A[255] = {
+	-128, -128, -1, 9, -31, -91, -44, 99, -53, 6, 107, -45, -58, -58, 97, 56,
+	30, 77, -5, -69, -23, 28, -94, -74, -12, 75, 36, 124, -77, -33, -105, -100,
+	-117, -18, -111, 125, 98, 47, 12, -68, -40, -80, -15, 76, -9, 125, 102, 65,
+	-42, -10, -8, 17, 108, 71, -20, 103, 4, 41, 126, -72, -19, -88, -105, -121,
+	-126, 117, 35, 68, 19, -28, 76, -47, -51, -113, -121, 70, -54, -99, 66, 2,
+	-62, -88, 108, 27, -121, -110, -97, -62, -107, 12, -68, 93, -82, -31, -114, 127,
+	-62, 14, -30, 101, 71, 40, 9, 5, -4, -3, -98, -39, 51, 91, -97, 52,
+	83, -26, 89, -93, 8, -91, 0, -38, -79, -51, -98, -24, 91, -106, -101, -82,
+	112, 61, -78, 32, -108, -64, -112, 98, -63, 74, 100, -116, 10, -82, 0, 38,
+	-85, 26, -111, 68, -99, 5, 32, -62, 5, 66, -69, 27, -80, 89, -3, -23,
+	41, 45, 72, 118, -75, -62, 101, -113, 21, -48, -26, 61, 71, 38, -79, 81,
+	48, -64, -95, -106, 25, 32, 85, 24, 35, 52, 11, 38, -124, -66, -52, 34,
+	38, 39, -93, 103, 15, 117, 104, 58, 66, -88, -100, -60, -104, 123, 0, -3,
+	45, 57, 61, 78, 29, 109, 46, -43, -114, -53, 0, -15, -60, -71, -34, 82,
+	-103, -78, 8, -74, -24, 5, -94, -88, -91, -17, -40, 93, -117, 60, 121, 17,
+	-16, -26, 124, -8, 89, 103, 59, -32, 118, -91, 3, 80, -25, -124, 66,
+};
+
+static const q7_t cDot9B[255] = {
+	-128, 127, 78, 89, -108, 52, 106, -125, -31, 25, -126, -67, 26, 33, 16, 82,
+	81, 29, 103, 26, -61, 99, -57, -45, 1, -124, 89, -110, 60, 87, 77, 16,
+	-119, -82, -82, -126, 68, 9, 109, 11, 62, 118, 44, 70, 105, -69, 119, 53,
+	-54, 84, -53, -119, -40, 5, 60, -63, 19, 83, 4, 19, 87, 12, 93, 43,
+	120, -18, 123, 77, 89, -82, -96, -62, -23, -52, -11, -115, -76, 1, -49, 117,
+	-78, 76, -33, -127, -83, 90, -102, -17, 88, 49, -104, -76, 86, -68, 7, 14,
+	-37, 117, -104, -19, -84, 71, -65, 101, 22, 126, 73, -69, 117, -74, -52, 69,
+	-25, -43, 3, 85, 19, 124, -19, 44, 120, -76, -124, 49, 8, -100, 97, 25,
+	-77, -11, 12, 10, -2, 82, -53, -62, 3, -29, 80, -99, -52, 83, 10, 15,
+	117, 28, 8, 123, -19, 127, 60, 112, -5, 45, -38, -36, 102, -52, -99, 38,
+	-59, -19, 33, 124, 117, 40, -68, -63, -57, 3, -13, -83, -103, -40, -69, -13,
+	-26, 29, 88, 39, -126, -118, 28, -16, -85, -14, 15, 46, 9, 66, -117, -66,
+	40, 49, -57, -70, 0, -55, -107, 49, -89, -81, -76, 25, 34, -1, 9, -103,
+	57, -113, -88, -57, 76, 62, -5, -80, 40, 12, -124, 36, -71, 52, -64, 10,
+	79, -82, 115, 86, 73, 26, -16, 26, -60, -101, -72, -39, -5, -18, 94, 12,
+	-118, 0, 10, 6, 114, -64, 78, -75, 63, -93, 57, -113, 29, 100, -61,
+};
+
+static const GoldenDot_t xGoldenDots[10] = {
+	{cDot0A, cDot0B, 1, -5600},
+	{cDot1A, cDot1B, 2, 5293},
+	{cDot2A, cDot2B, 3, 1393},
+	{cDot3A, cDot3B, 4, 2729},
+	{cDot4A, cDot4B, 5, -14240},
+	{cDot5A, cDot5B, 7, -25903},
+	{cDot6A, cDot6B, 16, -3232},
+	{cDot7A, cDot7B, 22, 7107},
+	{cDot8A, cDot8B, 64, 2955},
+	{cDot9A, cDot9B, 255, -136815},
+};
+
+#endif /* CMSIS_GOLDEN_H */
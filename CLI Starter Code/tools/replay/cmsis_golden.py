@@ -0,0 +1,696 @@
+#!/usr/bin/env python3
+"""Golden outputs of the linked CMSIS-DSP library, for the cmsis_check of
+tools/replay.
+
+The tree has the Cortex-M0 library, src/ASF/thirdparty/CMSIS/Lib/GCC/
+libarm_cortexM0l_math.a, but not its sources, and no ARM toolchain is needed
+to build the host tools. This script takes the objects of the functions the
+processing modules call out of the archive, links them in memory and runs
+their Thumb code in a small ARMv6-M interpreter. The library's calls into
+libgcc and the C library (memset, __aeabi_lmul, the single precision float
+helpers) run as Python with the same IEEE rounding.
+
+The inputs are fixed: the high-pass filters of HitDetect.c at every rate on
+magnitude-like blocks, a two stage cascade driven into saturation, the edge
+cases of arm_abs_q15() and arm_sqrt_q31() and dot products of the lengths the
+stroke model uses. The inputs, the outputs and the filter state after every
+case are written as C arrays, to tools/replay/cmsis_golden.h by default:
+
+    python3 tools/replay/cmsis_golden.py [--output cmsis_golden.h]
+
+Run it again, and commit the header, after adding a function to arm_math.h
+and cmsis_host.c or changing the HitDetect coefficients.
+"""
+
+import argparse
+import os
+import random
+import re
+import struct
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..", "..")
+LIBRARY = os.path.join(ROOT, "src", "ASF", "thirdparty", "CMSIS", "Lib", "GCC", "libarm_cortexM0l_math.a")
+HIT_DETECT = os.path.join(ROOT, "src", "HitDetect", "HitDetect.c")
+
+OBJECTS = [
+    "arm_biquad_cascade_df1_init_q15.o",
+    "arm_biquad_cascade_df1_q15.o",
+    "arm_abs_q15.o",
+    "arm_sqrt_q31.o",
+    "arm_dot_prod_q7.o",
+]
+
+MASK = 0xFFFFFFFF
+MEMORY_BYTES = 0x40000
+CODE_BASE = 0x1000
+HELPER_BASE = 0x8000
+DATA_BASE = 0x10000
+STACK_TOP = 0x3FF00
+RETURN = 0x3FFF0  # Return address of the call from Python; reaching it ends the call
+MAX_STEPS = 1000000
+
+HIT_LSB_PER_G = 1024
+
+
+def signed(value, bits=32):
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value >> (bits - 1) else value
+
+
+def read_archive(path):
+    """Members of a GNU ar archive, by name."""
+    with open(path, "rb") as archive:
+        data = archive.read()
+    if data[:8] != b"!<arch>\n":
+        raise SystemExit("%s: not an archive" % path)
+    members = {}
+    names = b""
+    offset = 8
+    while offset + 60 <= len(data):
+        header = data[offset:offset + 60]
+        name = header[:16].decode().rstrip()
+        size = int(header[48:58].decode())
+        body = data[offset + 60:offset + 60 + size]
+        if name == "//":
+            names = body
+        elif name.startswith("/") and name[1:].isdigit():
+            start = int(name[1:])
+            members[names[start:names.index(b"/", start)].decode()] = body
+        elif name != "/":
+            members[name.rstrip("/")] = body
+        offset += 60 + size + (size & 1)
+    return members
+
+
+class Elf:
+    """The sections, symbols and relocations of an ELF32 relocatable object."""
+
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise SystemExit("not a little endian ELF32 object")
+        shoff, = struct.unpack_from("<I", data, 32)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 46)
+        self.data = data
+        self.sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+        self.symbols = []
+        for section in self.sections:
+            if section[1] == 2:  # SHT_SYMTAB
+                for i in range(section[5] // 16):
+                    name, value, size, info, other, shndx = struct.unpack_from("<IIIBBH", data, section[4] + i * 16)
+                    self.symbols.append((self.string(section[6], name), value, info, shndx))
+
+    def string(self, section, offset):
+        start = self.sections[section][4] + offset
+        return self.data[start:self.data.index(b"\0", start)].decode()
+
+    def contents(self, index):
+        section = self.sections[index]
+        return self.data[section[4]:section[4] + section[5]]
+
+    def relocations(self, index):
+        """(offset, type, symbol) of the REL section that applies to section index."""
+        for section in self.sections:
+            if section[1] == 9 and section[7] == index:  # SHT_REL
+                for i in range(section[5] // 8):
+                    offset, info = struct.unpack_from("<II", self.data, section[4] + i * 8)
+                    yield offset, info & 0xFF, self.symbols[info >> 8]
+
+
+class Thumb:
+    """ARMv6-M Thumb interpreter over a flat memory, with Python helpers."""
+
+    def __init__(self):
+        self.memory = bytearray(MEMORY_BYTES)
+        self.r = [0] * 16
+        self.n = self.z = self.c = self.v = 0
+        self.symbols = {}
+        self.helpers = {}
+        self.code_end = CODE_BASE
+        self.data_end = DATA_BASE
+        for name, function in (("memset", self.memset), ("__aeabi_lmul", self.lmul), ("__aeabi_i2f", self.i2f),
+                               ("__aeabi_fmul", self.fmul), ("__aeabi_f2iz", self.f2iz)):
+            address = HELPER_BASE + 4 * len(self.helpers)
+            self.helpers[address] = function
+            self.symbols[name] = address
+
+    # Loading
+
+    def load(self, elf):
+        """Places the text and data sections of an object and applies its relocations."""
+        bases = {}
+        for index, section in enumerate(elf.sections):
+            if section[1] == 1 and section[2] & 2 and section[5]:  # PROGBITS, SHF_ALLOC
+                base = (self.code_end + 3) & ~3
+                self.memory[base:base + section[5]] = elf.contents(index)
+                bases[index] = base
+                self.code_end = base + section[5]
+        for name, value, info, shndx in elf.symbols:
+            if shndx in bases and info >> 4 == 1:  # STB_GLOBAL
+                self.symbols[name] = bases[shndx] + value
+        for index, base in bases.items():
+            for offset, kind, (name, value, info, shndx) in elf.relocations(index):
+                target = bases[shndx] + value if shndx in bases else self.symbols[name]
+                place = base + offset
+                if kind == 10:  # R_ARM_THM_CALL
+                    self.write_bl(place, target)
+                elif kind == 2:  # R_ARM_ABS32
+                    self.write32(place, (self.read32(place) + target) & MASK)
+                else:
+                    raise SystemExit("relocation type %d of %s not handled" % (kind, name))
+
+    def write_bl(self, place, target):
+        offset = (target & ~1) - (place + 4)
+        s = (offset >> 24) & 1
+        i1, i2 = (offset >> 23) & 1, (offset >> 22) & 1
+        j1, j2 = (1 - i1) ^ s, (1 - i2) ^ s
+        self.write16(place, 0xF000 | (s << 10) | ((offset >> 12) & 0x3FF))
+        self.write16(place + 2, 0xD000 | (j1 << 13) | (j2 << 11) | ((offset >> 1) & 0x7FF))
+
+    # Memory
+
+    def read8(self, address):
+        return self.memory[address]
+
+    def read16(self, address):
+        return struct.unpack_from("<H", self.memory, address)[0]
+
+    def read32(self, address):
+        return struct.unpack_from("<I", self.memory, address)[0]
+
+    def write8(self, address, value):
+        self.memory[address] = value & 0xFF
+
+    def write16(self, address, value):
+        struct.pack_into("<H", self.memory, address, value & 0xFFFF)
+
+    def write32(self, address, value):
+        struct.pack_into("<I", self.memory, address, value & MASK)
+
+    def allocate(self, size):
+        address = (self.data_end + 7) & ~7
+        self.data_end = address + size
+        if self.data_end > STACK_TOP - 0x1000:
+            raise SystemExit("out of interpreter memory")
+        return address
+
+    def array(self, fmt, values):
+        """Copies values into fresh memory, as fmt elements."""
+        size = struct.calcsize("<" + fmt)
+        address = self.allocate(max(1, size * len(values)))
+        for i, value in enumerate(values):
+            struct.pack_into("<" + fmt, self.memory, address + i * size, value)
+        return address
+
+    def values(self, fmt, address, count):
+        size = struct.calcsize("<" + fmt)
+        return [struct.unpack_from("<" + fmt, self.memory, address + i * size)[0] for i in range(count)]
+
+    # Calls
+
+    def call(self, name, *args):
+        """Runs a library function to its return. Returns r0."""
+        # The AAPCS passes four arguments in r0 to r3, the rest on the stack
+        self.r[13] = STACK_TOP - 4 * max(0, len(args) - 4)
+        for i, arg in enumerate(args):
+            if i < 4:
+                self.r[i] = arg & MASK
+            else:
+                self.write32(self.r[13] + 4 * (i - 4), arg)
+        self.r[14] = RETURN | 1
+        self.r[15] = self.symbols[name] & ~1
+        for _ in range(MAX_STEPS):
+            pc = self.r[15]
+            if pc == RETURN:
+                return self.r[0]
+            if pc in self.helpers:
+                self.helpers[pc]()
+                self.r[15] = self.r[14] & ~1
+            else:
+                self.step(pc)
+        raise SystemExit("%s: no return after %d instructions" % (name, MAX_STEPS))
+
+    def memset(self):
+        address, value, count = self.r[0], self.r[1] & 0xFF, self.r[2]
+        self.memory[address:address + count] = bytes([value]) * count
+
+    def lmul(self):
+        product = ((self.r[1] << 32) | self.r[0]) * ((self.r[3] << 32) | self.r[2])
+        self.r[0], self.r[1] = product & MASK, (product >> 32) & MASK
+
+    def i2f(self):
+        # A 32-bit integer is exact in a double; the pack rounds it to nearest even
+        self.r[0] = struct.unpack("<I", struct.pack("<f", float(signed(self.r[0]))))[0]
+
+    def fmul(self):
+        # The product of two singles is exact in a double, so packing it rounds once, as libgcc does
+        a, = struct.unpack("<f", struct.pack("<I", self.r[0]))
+        b, = struct.unpack("<f", struct.pack("<I", self.r[1]))
+        self.r[0] = struct.unpack("<I", struct.pack("<f", a * b))[0]
+
+    def f2iz(self):
+        value, = struct.unpack("<f", struct.pack("<I", self.r[0]))
+        self.r[0] = max(-0x80000000, min(0x7FFFFFFF, int(value))) & MASK
+
+    # Execution
+
+    def flags_nz(self, result):
+        self.n = result >> 31
+        self.z = int(result == 0)
+
+    def add_with_carry(self, x, y, carry):
+        unsigned = x + y + carry
+        result = unsigned & MASK
+        self.flags_nz(result)
+        self.c = int(unsigned > MASK)
+        self.v = int(signed(x) + signed(y) + carry != signed(result))
+        return result
+
+    def condition(self, cond):
+        n, z, c, v = self.n, self.z, self.c, self.v
+        return [z, not z, c, not c, n, not n, v, not v, c and not z, not c or z, n == v, n != v,
+                not z and n == v, z or n != v][cond]
+
+    def shift(self, kind, value, amount):
+        """LSL, LSR, ASR or ROR by a register amount, with the carry out."""
+        if amount == 0:
+            return value
+        if kind == 0:
+            self.c = (value >> (32 - amount)) & 1 if amount <= 32 else 0
+            return (value << amount) & MASK if amount < 32 else 0
+        if kind == 1:
+            self.c = (value >> (amount - 1)) & 1 if amount <= 32 else 0
+            return value >> amount if amount < 32 else 0
+        if kind == 2:
+            if amount >= 32:
+                self.c = value >> 31
+                return MASK if value >> 31 else 0
+            self.c = (value >> (amount - 1)) & 1
+            return (signed(value) >> amount) & MASK
+        amount &= 31
+        result = ((value >> amount) | (value << (32 - amount))) & MASK if amount else value
+        self.c = result >> 31
+        return result
+
+    def reg(self, index, pc):
+        return (pc + 4) if index == 15 else self.r[index]
+
+    def branch(self, target):
+        self.r[15] = target & ~1 & MASK
+
+    def step(self, pc):
+        r = self.r
+        hw = self.read16(pc)
+        r[15] = pc + 2
+        top = hw >> 11
+
+        if top <= 2:  # LSL, LSR, ASR immediate
+            rm, rd, imm = (hw >> 3) & 7, hw & 7, (hw >> 6) & 31
+            if top == 0 and imm == 0:
+                result = r[rm]
+            else:
+                result = self.shift(top, r[rm], imm or 32)
+            r[rd] = result
+            self.flags_nz(result)
+        elif top == 3:  # ADD, SUB register or 3-bit immediate
+            operand = (hw >> 6) & 7 if hw & 0x400 else r[(hw >> 6) & 7]
+            rn, rd = (hw >> 3) & 7, hw & 7
+            if hw & 0x200:
+                r[rd] = self.add_with_carry(r[rn], ~operand & MASK, 1)
+            else:
+                r[rd] = self.add_with_carry(r[rn], operand, 0)
+        elif top <= 7:  # MOV, CMP, ADD, SUB 8-bit immediate
+            rd, imm = (hw >> 8) & 7, hw & 0xFF
+            if top == 4:
+                r[rd] = imm
+                self.flags_nz(imm)
+            elif top == 5:
+                self.add_with_carry(r[rd], ~imm & MASK, 1)
+            elif top == 6:
+                r[rd] = self.add_with_carry(r[rd], imm, 0)
+            else:
+                r[rd] = self.add_with_carry(r[rd], ~imm & MASK, 1)
+        elif hw >> 10 == 0x10:  # Data processing
+            self.data_processing((hw >> 6) & 15, (hw >> 3) & 7, hw & 7)
+        elif hw >> 10 == 0x11:  # High register operations and branch exchange
+            op, rm = (hw >> 8) & 3, (hw >> 3) & 15
+            rd = ((hw >> 4) & 8) | (hw & 7)
+            if op == 0:
+                result = (self.reg(rd, pc) + self.reg(rm, pc)) & MASK
+                if rd == 15:
+                    self.branch(result)
+                else:
+                    r[rd] = result
+            elif op == 1:
+                self.add_with_carry(self.reg(rd, pc), ~self.reg(rm, pc) & MASK, 1)
+            elif op == 2:
+                if rd == 15:
+                    self.branch(self.reg(rm, pc))
+                else:
+                    r[rd] = self.reg(rm, pc)
+            else:
+                target = self.reg(rm, pc)
+                if hw & 0x80:
+                    r[14] = (pc + 2) | 1
+                self.branch(target)
+        elif top == 9:  # LDR literal
+            r[(hw >> 8) & 7] = self.read32(((pc + 4) & ~3) + (hw & 0xFF) * 4)
+        elif hw >> 12 == 5:  # Load and store, register offset
+            op, rt = (hw >> 9) & 7, hw & 7
+            address = (r[(hw >> 3) & 7] + r[(hw >> 6) & 7]) & MASK
+            if op == 0:
+                self.write32(address, r[rt])
+            elif op == 1:
+                self.write16(address, r[rt])
+            elif op == 2:
+                self.write8(address, r[rt])
+            elif op == 3:
+                r[rt] = signed(self.read8(address), 8) & MASK
+            elif op == 4:
+                r[rt] = self.read32(address)
+            elif op == 5:
+                r[rt] = self.read16(address)
+            elif op == 6:
+                r[rt] = self.read8(address)
+            else:
+                r[rt] = signed(self.read16(address), 16) & MASK
+        elif hw >> 13 == 3:  # Load and store word or byte, immediate offset
+            rt, imm = hw & 7, (hw >> 6) & 31
+            byte, load = hw & 0x1000, hw & 0x800
+            address = (r[(hw >> 3) & 7] + (imm if byte else imm * 4)) & MASK
+            if byte:
+                if load:
+                    r[rt] = self.read8(address)
+                else:
+                    self.write8(address, r[rt])
+            elif load:
+                r[rt] = self.read32(address)
+            else:
+                self.write32(address, r[rt])
+        elif hw >> 12 == 8:  # Load and store halfword, immediate offset
+            rt = hw & 7
+            address = (r[(hw >> 3) & 7] + ((hw >> 6) & 31) * 2) & MASK
+            if hw & 0x800:
+                r[rt] = self.read16(address)
+            else:
+                self.write16(address, r[rt])
+        elif hw >> 12 == 9:  # Load and store, SP relative
+            rt = (hw >> 8) & 7
+            address = (r[13] + (hw & 0xFF) * 4) & MASK
+            if hw & 0x800:
+                r[rt] = self.read32(address)
+            else:
+                self.write32(address, r[rt])
+        elif hw >> 12 == 10:  # ADR, ADD from SP
+            base = r[13] if hw & 0x800 else (pc + 4) & ~3
+            r[(hw >> 8) & 7] = (base + (hw & 0xFF) * 4) & MASK
+        elif hw >> 12 == 11:
+            self.miscellaneous(hw)
+        elif hw >> 12 == 12:  # STM, LDM
+            rn, registers = (hw >> 8) & 7, [i for i in range(8) if hw & (1 << i)]
+            address = r[rn]
+            for i in registers:
+                if hw & 0x800:
+                    r[i] = self.read32(address)
+                else:
+                    self.write32(address, r[i])
+                address += 4
+            if not (hw & 0x800 and rn in registers):
+                r[rn] = address & MASK
+        elif hw >> 12 == 13:  # Conditional branch
+            cond = (hw >> 8) & 15
+            if cond >= 14:
+                raise SystemExit("%#x: %s" % (pc, "SVC" if cond == 15 else "UDF"))
+            if self.condition(cond):
+                self.branch(pc + 4 + signed(hw & 0xFF, 8) * 2)
+        elif top == 28:  # Unconditional branch
+            self.branch(pc + 4 + signed(hw & 0x7FF, 11) * 2)
+        elif top == 30:  # BL
+            hw2 = self.read16(pc + 2)
+            if hw2 & 0xD000 != 0xD000:
+                raise SystemExit("%#x: 32-bit instruction %04x %04x not handled" % (pc, hw, hw2))
+            s = (hw >> 10) & 1
+            i1, i2 = 1 - (((hw2 >> 13) & 1) ^ s), 1 - (((hw2 >> 11) & 1) ^ s)
+            offset = signed((s << 24) | (i1 << 23) | (i2 << 22) | ((hw & 0x3FF) << 12) | ((hw2 & 0x7FF) << 1), 25)
+            r[14] = (pc + 4) | 1
+            self.branch(pc + 4 + offset)
+        else:
+            raise SystemExit("%#x: instruction %04x not handled" % (pc, hw))
+
+    def data_processing(self, op, rm, rdn):
+        r = self.r
+        x, y = r[rdn], r[rm]
+        if op in (8, 10, 11):  # TST, CMP, CMN only set the flags
+            if op == 8:
+                self.flags_nz(x & y)
+            elif op == 10:
+                self.add_with_carry(x, ~y & MASK, 1)
+            else:
+                self.add_with_carry(x, y, 0)
+            return
+        if op == 0:
+            result = x & y
+        elif op == 1:
+            result = x ^ y
+        elif op in (2, 3, 4):
+            result = self.shift(op - 2, x, y & 0xFF)
+        elif op == 7:
+            result = self.shift(3, x, y & 0xFF)
+        elif op == 5:
+            result = self.add_with_carry(x, y, self.c)
+        elif op == 6:
+            result = self.add_with_carry(x, ~y & MASK, self.c)
+        elif op == 9:
+            result = self.add_with_carry(0, ~y & MASK, 1)
+        elif op == 12:
+            result = x | y
+        elif op == 13:
+            result = (x * y) & MASK
+        elif op == 14:
+            result = x & ~y & MASK
+        else:
+            result = ~y & MASK
+        r[rdn] = result
+        self.flags_nz(result)
+
+    def miscellaneous(self, hw):
+        r = self.r
+        rm, rd = (hw >> 3) & 7, hw & 7
+        if hw & 0xFF00 == 0xB000:  # ADD, SUB SP immediate
+            offset = (hw & 0x7F) * 4
+            r[13] = (r[13] - offset if hw & 0x80 else r[13] + offset) & MASK
+        elif hw & 0xFF00 == 0xB200:  # SXTH, SXTB, UXTH, UXTB
+            op = (hw >> 6) & 3
+            r[rd] = [signed(r[rm], 16) & MASK, signed(r[rm], 8) & MASK, r[rm] & 0xFFFF, r[rm] & 0xFF][op]
+        elif hw & 0xFE00 == 0xB400:  # PUSH
+            registers = [i for i in range(8) if hw & (1 << i)] + ([14] if hw & 0x100 else [])
+            r[13] -= 4 * len(registers)
+            for i, register in enumerate(registers):
+                self.write32(r[13] + 4 * i, r[register])
+        elif hw & 0xFE00 == 0xBC00:  # POP
+            registers = [i for i in range(8) if hw & (1 << i)] + ([15] if hw & 0x100 else [])
+            for i, register in enumerate(registers):
+                value = self.read32(r[13] + 4 * i)
+                if register == 15:
+                    self.branch(value)
+                else:
+                    r[register] = value
+            r[13] += 4 * len(registers)
+        elif hw & 0xFFC0 == 0xBA00:  # REV
+            r[rd] = int.from_bytes(r[rm].to_bytes(4, "little"), "big")
+        elif hw & 0xFFC0 == 0xBA40:  # REV16
+            value = r[rm]
+            r[rd] = ((value & 0x00FF00FF) << 8) | ((value >> 8) & 0x00FF00FF)
+        elif hw & 0xFFC0 == 0xBAC0:  # REVSH
+            value = r[rm]
+            r[rd] = signed(((value & 0xFF) << 8) | ((value >> 8) & 0xFF), 16) & MASK
+        elif hw & 0xFF00 == 0xBF00:  # NOP and the other hints
+            pass
+        else:
+            raise SystemExit("%#x: instruction %04x not handled" % (self.r[15] - 2, hw))
+
+
+def high_pass():
+    """The sHighPass rows of HitDetect.c and HIT_POST_SHIFT."""
+    with open(HIT_DETECT) as source:
+        text = source.read()
+    table = re.search(r"sHighPass\[[^=]*=\s*\{(.*?)\};", text, re.S).group(1)
+    rows = [[int(v) for v in row.split(",")] for row in re.findall(r"\{([-\d,\s]+)\}", table)]
+    post_shift = int(re.search(r"#define HIT_POST_SHIFT (\d+)", text).group(1))
+    return rows, post_shift
+
+
+def biquad_cases(rng):
+    """(name, stages, post shift, coefficients, initial state, blocks of input) of each filter case."""
+    rows, post_shift = high_pass()
+    cases = []
+    for shift, row in zip(range(-2, 2), rows):
+        # Magnitude at rest, motion, and a hit of several g, in blocks of a watermark and a partial one
+        samples = []
+        level = HIT_LSB_PER_G
+        for i in range(25):
+            level = max(0, min(32767, level + rng.randint(-300, 300)))
+            samples.append(min(32767, level + (rng.randint(6, 30) * HIT_LSB_PER_G if i in (8, 17) else 0)))
+        cases.append(("hit %d Hz" % (100 * 2 ** shift), 1, post_shift, row,
+                      [HIT_LSB_PER_G, HIT_LSB_PER_G, 0, 0], [samples[:10], samples[10:20], samples[20:]]))
+    coefficients = []
+    for _ in range(2):
+        coefficients += [rng.randint(-32768, 32767), 0, rng.randint(-32768, 32767), rng.randint(-32768, 32767),
+                         rng.randint(-32768, 32767), rng.randint(-16384, 16383)]
+    extremes = [32767, -32768, 32767, 32767, -32768, 0, -1, 1]
+    samples = extremes + [rng.randint(-32768, 32767) for _ in range(16)]
+    cases.append(("saturating", 2, 0, coefficients, [rng.randint(-32768, 32767) for _ in range(8)],
+                  [samples[:1], samples[1:8], samples[8:]]))
+    return cases
+
+
+def sqrt_inputs(rng):
+    inputs = [0, -1, -0x80000000, 1, 2, 3, 4, 0x7FFFFFFF]
+    for bit in range(1, 31):
+        inputs += [(1 << bit) - 1, 1 << bit, (1 << bit) + 1]
+    inputs += [int(2 ** rng.uniform(0, 31)) for _ in range(100)]
+    # The detector's range, 3 * 2^29 at most after its shift
+    inputs += [rng.randint(0, 3 << 29) for _ in range(60)]
+    return [min(v, 0x7FFFFFFF) for v in inputs]
+
+
+def c_array(kind, name, values, per_line=12):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("\t" + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return "static const %s %s[%d] = {\n%s\n};\n" % (kind, name, len(values), "\n".join(lines))
+
+
+HEADER = """/**************************************************************************/ /**
+ * @file      cmsis_golden.h
+ * @brief     Outputs of the linked CMSIS-DSP library, for cmsis_check.c.
+ * @details   Generated by tools/replay/cmsis_golden.py from the Thumb code of
+ *            libarm_cortexM0l_math.a. Do not edit; run the script again.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef CMSIS_GOLDEN_H
+#define CMSIS_GOLDEN_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <arm_math.h>
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A filter run: an instance set up with the coefficients, its state
+ *        preset, then fed the input in blocks.
+ */
+typedef struct
+{
+	const char *pcName;
+	uint8_t ucStages;
+	int8_t cPostShift;
+	const q15_t *psCoeffs;
+	const q15_t *psStateIn;	 ///< 4 per stage, before the first block
+	const q15_t *psStateOut; ///< After the last block
+	const uint16_t *pusBlocks;
+	uint16_t usBlocks;
+	const q15_t *psIn;	 ///< All blocks back to back
+	const q15_t *psOut;
+} GoldenBiquad_t;
+
+/**
+ * @brief A dot product.
+ */
+typedef struct
+{
+	const q7_t *pcA;
+	const q7_t *pcB;
+	uint16_t usLength;
+	q31_t lResult;
+} GoldenDot_t;
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--output", default=os.path.join(HERE, "cmsis_golden.h"))
+    args = parser.parse_args()
+
+    members = read_archive(LIBRARY)
+    cpu = Thumb()
+    for name in OBJECTS:
+        cpu.load(Elf(members[name]))
+    rng = random.Random(1)
+    out = [HEADER]
+
+    # Filters, with the init function of the library and the state carried across blocks
+    entries = []
+    for index, (name, stages, post_shift, coefficients, state, blocks) in enumerate(biquad_cases(rng)):
+        instance = cpu.allocate(16)
+        coeffs = cpu.array("h", coefficients)
+        state_address = cpu.allocate(8 * stages)
+        cpu.call("arm_biquad_cascade_df1_init_q15", instance, stages, coeffs, state_address, post_shift)
+        for i, value in enumerate(state):
+            cpu.write16(state_address + 2 * i, value)
+        inputs, outputs = [], []
+        for block in blocks:
+            source = cpu.array("h", block)
+            destination = cpu.allocate(2 * len(block))
+            cpu.call("arm_biquad_cascade_df1_q15", instance, source, destination, len(block))
+            inputs += block
+            outputs += cpu.values("h", destination, len(block))
+        prefix = "sBiquad%d" % index
+        out.append(c_array("q15_t", prefix + "Coeffs", coefficients))
+        out.append(c_array("q15_t", prefix + "StateIn", state))
+        out.append(c_array("q15_t", prefix + "StateOut", cpu.values("h", state_address, 4 * stages)))
+        out.append(c_array("uint16_t", "us%sBlocks" % prefix[1:], [len(b) for b in blocks]))
+        out.append(c_array("q15_t", prefix + "In", inputs))
+        out.append(c_array("q15_t", prefix + "Out", outputs))
+        entries.append('\t{"%s", %d, %d, %sCoeffs, %sStateIn, %sStateOut, us%sBlocks, %d, %sIn, %sOut},'
+                       % (name, stages, post_shift, prefix, prefix, prefix, prefix[1:], len(blocks), prefix, prefix))
+    out.append("static const GoldenBiquad_t xGoldenBiquads[%d] = {\n%s\n};\n" % (len(entries), "\n".join(entries)))
+
+    # Absolute values, in place as HitDetect calls it
+    values = [0, 1, -1, 32767, -32767, -32768, 2, -2] + [rng.randint(-32768, 32767) for _ in range(59)]
+    buffer = cpu.array("h", values)
+    cpu.call("arm_abs_q15", buffer, buffer, len(values))
+    out.append(c_array("q15_t", "sGoldenAbsIn", values))
+    out.append(c_array("q15_t", "sGoldenAbsOut", cpu.values("h", buffer, len(values))))
+
+    # Square roots and their status
+    inputs = sqrt_inputs(rng)
+    results, statuses = [], []
+    result = cpu.allocate(4)
+    for value in inputs:
+        cpu.write32(result, 0x5A5A5A5A)
+        statuses.append(signed(cpu.call("arm_sqrt_q31", value, result), 8))
+        results.append(signed(cpu.read32(result)))
+    out.append(c_array("q31_t", "lGoldenSqrtIn", inputs, 6))
+    out.append(c_array("q31_t", "lGoldenSqrtOut", results, 6))
+    out.append(c_array("int8_t", "cGoldenSqrtStatus", statuses, 16))
+
+    # Dot products of the layer sizes of the stroke model and others, all of q7 included
+    entries = []
+    for index, length in enumerate([1, 2, 3, 4, 5, 7, 16, 22, 64, 255]):
+        a = [rng.randint(-128, 127) for _ in range(length)]
+        b = [rng.randint(-128, 127) for _ in range(length)]
+        if length >= 4:
+            a[:2], b[:2] = [-128, -128], [-128, 127]
+        product = cpu.allocate(4)
+        cpu.call("arm_dot_prod_q7", cpu.array("b", a), cpu.array("b", b), length, product)
+        out.append(c_array("q7_t", "cDot%dA" % index, a, 16))
+        out.append(c_array("q7_t", "cDot%dB" % index, b, 16))
+        entries.append("\t{cDot%dA, cDot%dB, %d, %d}," % (index, index, length, signed(cpu.read32(product))))
+    out.append("static const GoldenDot_t xGoldenDots[%d] = {\n%s\n};\n" % (len(entries), "\n".join(entries)))
+
+    out.append("#endif /* CMSIS_GOLDEN_H */\n")
+    with open(args.output, "w") as header:
+        header.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
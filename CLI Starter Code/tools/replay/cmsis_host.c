@@ -0,0 +1,173 @@
+/**************************************************************************/ /**
+ * @file      cmsis_host.c
+ * @brief     Host versions of the CMSIS-DSP functions the processing modules
+ *            call, for the replay and pipeline harnesses. See arm_math.h.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <arm_math.h>
+#include <string.h>
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static q31_t prvSsat16(q63_t llValue);
+static uint32_t prvClz(uint32_t ulValue);
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Sets up the instance and zeroes the state, as CMSIS does.
+ */
+void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages, q15_t *pCoeffs, q15_t *pState, int8_t postShift)
+{
+	S->numStages = (int8_t)numStages;
+	S->postShift = postShift;
+	S->pCoeffs = pCoeffs;
+	memset(pState, 0, 4u * numStages * sizeof(q15_t));
+	S->pState = pState;
+}
+
+/**
+ * @brief Direct form I, 64-bit accumulator, saturated to q15 after the shift.
+ */
+void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+	q15_t *pIn = pSrc;
+	q15_t *pOut = pDst;
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	int32_t lShift = 15 - S->postShift;
+	uint32_t ulStage = (uint32_t)S->numStages;
+
+	do
+	{
+		q15_t b0 = pCoeffs[0], b1 = pCoeffs[2], b2 = pCoeffs[3], a1 = pCoeffs[4], a2 = pCoeffs[5];
+		q15_t Xn1 = pState[0], Xn2 = pState[1], Yn1 = pState[2], Yn2 = pState[3];
+
+		pCoeffs += 6;
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			q15_t in = pIn[i];
+			q63_t acc = (q31_t)b0 * in;
+
+			acc += (q31_t)b1 * Xn1;
+			acc += (q31_t)b2 * Xn2;
+			acc += (q31_t)a1 * Yn1;
+			acc += (q31_t)a2 * Yn2;
+			acc = prvSsat16(acc >> lShift);
+
+			Xn2 = Xn1;
+			Xn1 = in;
+			Yn2 = Yn1;
+			Yn1 = (q15_t)acc;
+			pOut[i] = (q15_t)acc;
+		}
+
+		// The next stage filters this one's output
+		pIn = pDst;
+		pOut = pDst;
+		pState[0] = Xn1;
+		pState[1] = Xn2;
+		pState[2] = Yn1;
+		pState[3] = Yn2;
+		pState += 4;
+	} while (--ulStage > 0);
+}
+
+/**
+ * @brief Absolute value, 0x8000 saturates to 0x7FFF.
+ */
+void arm_abs_q15(q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++)
+	{
+		q15_t in = pSrc[i];
+		pDst[i] = (in > 0) ? in : ((in == INT16_MIN) ? INT16_MAX : (q15_t)-in);
+	}
+}
+
+/**
+ * @brief Square root by three Newton iterations on the inverse square root,
+ *        from a float initial guess, as CMSIS does.
+ */
+arm_status arm_sqrt_q31(q31_t in, q31_t *pOut)
+{
+	q31_t number, temp1, var1, signBits1, half;
+	float32_t temp_float1;
+	union
+	{
+		q31_t fracval;
+		float32_t floatval;
+	} tempconv;
+
+	number = in;
+	if (number <= 0)
+	{
+		*pOut = 0;
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	signBits1 = (q31_t)prvClz((uint32_t)number) - 1;
+	number = (signBits1 % 2 == 0) ? number << signBits1 : number << (signBits1 - 1);
+	half = number >> 1;
+	temp1 = number;
+
+	temp_float1 = number * 4.6566128731e-010f;
+	tempconv.floatval = temp_float1;
+	tempconv.fracval = 0x5f3759df - (tempconv.fracval >> 1);
+	temp_float1 = tempconv.floatval;
+	var1 = (q31_t)(temp_float1 * 1073741824);
+
+	for (int i = 0; i < 3; i++)
+	{
+		var1 = ((q31_t)(((q63_t)var1 * (0x30000000 - ((q31_t)((((q31_t)(((q63_t)var1 * var1) >> 31)) * (q63_t)half) >> 31)))) >> 31)) << 2;
+	}
+
+	var1 = ((q31_t)(((q63_t)temp1 * var1) >> 31)) << 1;
+	var1 = (signBits1 % 2 == 0) ? var1 >> (signBits1 / 2) : var1 >> ((signBits1 - 1) / 2);
+	*pOut = var1;
+	return ARM_MATH_SUCCESS;
+}
+
+/**
+ * @brief Sum of the products in 32 bits, without saturation, as CMSIS does.
+ */
+void arm_dot_prod_q7(q7_t *pSrcA, q7_t *pSrcB, uint32_t blockSize, q31_t *result)
+{
+	q31_t sum = 0;
+
+	for (uint32_t i = 0; i < blockSize; i++)
+	{
+		sum += (q31_t)((q15_t)pSrcA[i] * pSrcB[i]);
+	}
+	*result = sum;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static q31_t prvSsat16(q63_t llValue)
+ * @brief		__SSAT(llValue, 16)
+ *****************************************************************************/
+static q31_t prvSsat16(q63_t llValue)
+{
+	return (llValue > INT16_MAX) ? INT16_MAX : (llValue < INT16_MIN) ? INT16_MIN : (q31_t)llValue;
+}
+
+/**************************************************************************/ /**
+ * @fn			static uint32_t prvClz(uint32_t ulValue)
+ * @brief		__CLZ(ulValue). The argument is never 0 here
+ *****************************************************************************/
+static uint32_t prvClz(uint32_t ulValue)
+{
+	return (uint32_t)__builtin_clz(ulValue);
+}
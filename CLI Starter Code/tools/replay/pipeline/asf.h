@@ -0,0 +1,126 @@
+/**************************************************************************/ /**
+ * @file      asf.h
+ * @brief     Host stand-in for <asf.h>, for the pipeline harness.
+ * @details   Pipeline.c and the processing stages compile unmodified against
+ *            this subset of FreeRTOS, implemented on pthreads by rtos_host.c:
+ *            --critical sections and scheduler suspension: one recursive
+ *              mutex, so the tasks of the harness exclude each other as the
+ *              interrupt mask excludes them on the SAMD21
+ *            --counting semaphores and message buffers, blocking with the
+ *              same timeouts
+ *            --software timers, run by a daemon thread that advances the
+ *              tick count every millisecond of real time
+ *            tools/replay/Makefile puts this directory first on the include
+ *            path of the pipeline harness only.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+#ifndef PIPELINE_HOST_ASF_H
+#define PIPELINE_HOST_ASF_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+// Same values as FreeRTOSConfig.h and projdefs.h
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 5
+#define tskIDLE_PRIORITY 0
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define HOST_MESSAGE_BYTES 16 ///< Longest message a message buffer carries here
+#define HOST_MESSAGES 8		  ///< Messages a message buffer holds at most here
+
+#define configASSERT(x) assert(x)
+#define taskENTER_CRITICAL() HostEnterCritical()
+#define taskEXIT_CRITICAL() HostExitCritical()
+#define vTaskSuspendAll() HostEnterCritical()
+#define xTaskResumeAll() (HostExitCritical(), pdFALSE)
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+typedef struct xHOST_TIMER *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+/**
+ * @brief A counting semaphore.
+ */
+typedef struct
+{
+	UBaseType_t uxCount;
+	UBaseType_t uxMax;
+	pthread_cond_t xChanged;
+} StaticSemaphore_t;
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+/**
+ * @brief A message buffer, as a ring of whole messages.
+ */
+typedef struct
+{
+	size_t xLengths[HOST_MESSAGES];
+	uint8_t ucMessages[HOST_MESSAGES][HOST_MESSAGE_BYTES];
+	UBaseType_t uxHead;
+	UBaseType_t uxCount;
+	size_t xSize;			 ///< Storage the firmware gave. Each message takes its length and a size_t of it
+	size_t xUsed;
+	pthread_cond_t xChanged;
+} StaticMessageBuffer_t;
+typedef StaticMessageBuffer_t *MessageBufferHandle_t;
+
+/**
+ * @brief A software timer.
+ */
+typedef struct xHOST_TIMER
+{
+	TimerCallbackFunction_t pxCallback;
+	void *pvTimerID;
+	TickType_t xPeriod;
+	TickType_t xExpiry;
+	bool bAutoReload;
+	bool bActive;
+} StaticTimer_t;
+
+/******************************************************************************
+ * Global Function Declarations
+ ******************************************************************************/
+// In rtos_host.c
+void HostEnterCritical(void);
+void HostExitCritical(void);
+void HostStartDaemon(void);
+TickType_t xTaskGetTickCount(void);
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount,
+												 StaticSemaphore_t *pxSemaphoreBuffer);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+MessageBufferHandle_t xMessageBufferCreateStatic(size_t xBufferSizeBytes, uint8_t *pucStorage,
+												 StaticMessageBuffer_t *pxStaticBuffer);
+size_t xMessageBufferSend(MessageBufferHandle_t xBuffer, const void *pvData, size_t xLength, TickType_t xTicksToWait);
+size_t xMessageBufferReceive(MessageBufferHandle_t xBuffer, void *pvData, size_t xLength, TickType_t xTicksToWait);
+
+TimerHandle_t xTimerCreateStatic(const char *pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload,
+								 void *pvTimerID, TimerCallbackFunction_t pxCallback, StaticTimer_t *pxTimerBuffer);
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+
+#endif /* PIPELINE_HOST_ASF_H */
@@ -0,0 +1,285 @@
+/**************************************************************************/ /**
+ * @file      pipeline_check.c
+ * @brief     Real-time check of Pipeline.c with the processing stages, built
+ *            for the host by tools/replay/Makefile.
+ * @details   Pipeline.c, the stages and their modules are compiled unmodified
+ *            against the pthread FreeRTOS subset of asf.h and rtos_host.c
+ *            here. The stages register as in the daemon task startup hook,
+ *            with a check stage last that follows the block numbers of every
+ *            frame, and vPipelineTask() runs in a thread of its own while the
+ *            synthetic source timer feeds blocks at PIPELINE_SYNTH_SPEEDUP
+ *            times the production rate:
+ *
+ *                pipeline_check [-n blocks] [-d ms]
+ *
+ *            The paced phase runs until the check stage has seen -n blocks.
+ *            Every block generated must have been processed, in order, with
+ *            no stall and no gap, and the detector must have found the
+ *            synthetic hits.
+ *
+ *            The overload phase then has the check stage sleep -d
+ *            milliseconds per frame, longer than two source periods, for a
+ *            third as many periods. The source must stall and skip numbers,
+ *            the pipeline must count exactly the numbers the check stage
+ *            found missing, no more than the stalls, and still process every
+ *            block that was generated.
+ *
+ *            Latencies are host nanoseconds. The exit status is 1 on any
+ *            failure.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Pipeline/Pipeline.h"
+#include "HitDetect/HitDetect.h"
+#include "Fusion/Fusion.h"
+#include "Codec/Codec.h"
+#include "Stroke/Stroke.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CHECK_SYNTH_PERIOD_MS (IMU_BLOCK_PERIOD_MS / PIPELINE_SYNTH_SPEEDUP) ///< As in Pipeline.c
+#define CHECK_DRAIN_MS 200 ///< Longest wait for the frames in flight after the source stops
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief What the check stage saw, and the pipeline counters of a phase.
+ */
+typedef struct
+{
+	const char *pcName;
+	PipelineStats_t xPipeline;
+	uint32_t ulChecked;	 ///< Frames through the check stage
+	uint32_t ulMissing;	 ///< Block numbers skipped between them
+	uint32_t ulDisorder; ///< Frames whose number went backwards
+	uint32_t ulShort;	 ///< Frames with fewer than IMU_BLOCK_SAMPLES
+} CheckPhase_t;
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvCheckStage(const ImuBlock_t *pxFrame);
+static void *prvPipelineThread(void *pvParameters);
+static void prvRun(CheckPhase_t *pxPhase, uint32_t ulBlocks, uint32_t ulPeriods);
+static int prvReport(const CheckPhase_t *pxPhase, bool bOverload);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static CheckPhase_t *pxCurrent = NULL; ///< Phase the check stage counts into
+static uint32_t ulExpected = 0;
+static bool bSeen = false;
+static volatile uint32_t ulStageDelayMs = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Sets up the pipeline as the firmware does, then runs both phases.
+ */
+int main(int argc, char **argv)
+{
+	CheckPhase_t xPaced = {.pcName = "paced"};
+	CheckPhase_t xOverload = {.pcName = "overload"};
+	HitStats_t xHits;
+	pthread_t xThread;
+	unsigned long ulBlocks = 300;
+	unsigned long ulDelayMs = 3 * CHECK_SYNTH_PERIOD_MS;
+	BaseType_t xRegistered;
+	int iOption;
+	int iFailed = 0;
+
+	while ((iOption = getopt(argc, argv, "n:d:")) != -1)
+	{
+		switch (iOption)
+		{
+			case 'n':
+				ulBlocks = strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				ulDelayMs = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-n blocks] [-d overload stage delay in ms]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (ulBlocks < 3 || ulDelayMs <= 2 * CHECK_SYNTH_PERIOD_MS)
+	{
+		fprintf(stderr, "blocks must be 3 or more, the delay over %d ms\n", 2 * CHECK_SYNTH_PERIOD_MS);
+		return 2;
+	}
+
+	PipelineInit();
+	HitDetectInit();
+	FusionInit();
+	CodecInit();
+	StrokeInit();
+	xRegistered = PipelineRegisterStage(prvCheckStage);
+	configASSERT(xRegistered == pdPASS);
+
+	HostStartDaemon();
+	if (pthread_create(&xThread, NULL, prvPipelineThread, NULL) != 0)
+	{
+		fprintf(stderr, "cannot start the pipeline thread\n");
+		return 1;
+	}
+
+	prvRun(&xPaced, (uint32_t)ulBlocks, 0);
+	HitDetectGetStats(&xHits);
+
+	ulStageDelayMs = (uint32_t)ulDelayMs;
+	prvRun(&xOverload, 0, (uint32_t)ulBlocks / 3);
+
+	printf("%-8s %7s %9s %6s %6s %7s %8s %12s %12s %8s\n", "Phase", "Frames", "Generated", "Stalls", "Gaps",
+		   "Missing", "Disorder", "Latency(ns)", "Max(ns)", "Result");
+	iFailed |= prvReport(&xPaced, false);
+	iFailed |= prvReport(&xOverload, true);
+
+	if (xHits.ulHits == 0)
+	{
+		fprintf(stderr, "paced: no synthetic hit detected\n");
+		iFailed = 1;
+	}
+	printf("%lu blocks every %d ms, %lu hits: %s\n", ulBlocks, CHECK_SYNTH_PERIOD_MS, (unsigned long)xHits.ulHits,
+		   iFailed ? "FAIL" : "pass");
+
+	return iFailed;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvCheckStage(const ImuBlock_t *pxFrame)
+ * @brief		Last stage. Follows the block numbers, then sleeps ulStageDelayMs
+ *****************************************************************************/
+static void prvCheckStage(const ImuBlock_t *pxFrame)
+{
+	if (bSeen && pxFrame->ulSequence != ulExpected)
+	{
+		if ((int32_t)(pxFrame->ulSequence - ulExpected) > 0)
+		{
+			pxCurrent->ulMissing += pxFrame->ulSequence - ulExpected;
+		}
+		else
+		{
+			pxCurrent->ulDisorder++;
+		}
+	}
+	ulExpected = pxFrame->ulSequence + 1;
+	bSeen = true;
+	pxCurrent->ulChecked++;
+	if (pxFrame->usCount != IMU_BLOCK_SAMPLES)
+	{
+		pxCurrent->ulShort++;
+	}
+
+	if (ulStageDelayMs > 0)
+	{
+		usleep(ulStageDelayMs * 1000);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void *prvPipelineThread(void *pvParameters)
+ * @brief		Runs the pipeline task
+ *****************************************************************************/
+static void *prvPipelineThread(void *pvParameters)
+{
+	vPipelineTask(NULL);
+	return NULL;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvRun(CheckPhase_t *pxPhase, uint32_t ulBlocks, uint32_t ulPeriods)
+ * @brief		Runs the synthetic source for one phase and waits for the pipeline to drain
+ * @param[in]	ulBlocks Frames the check stage must see, or 0
+ * @param[in]	ulPeriods Otherwise, source periods to run for
+ * @details		The source stops at ulBlocks frames, or after ten times their
+ *				periods if they never come
+ *****************************************************************************/
+static void prvRun(CheckPhase_t *pxPhase, uint32_t ulBlocks, uint32_t ulPeriods)
+{
+	uint32_t ulWaitedMs = 0;
+	uint32_t ulLimitMs = (ulBlocks > 0) ? 10 * ulBlocks * CHECK_SYNTH_PERIOD_MS : ulPeriods * CHECK_SYNTH_PERIOD_MS;
+
+	// The pipeline is idle between phases, so the check stage state can change hands here
+	taskENTER_CRITICAL();
+	pxCurrent = pxPhase;
+	taskEXIT_CRITICAL();
+	PipelineResetStats();
+
+	PipelineSetSynthetic(true);
+	while (ulWaitedMs < ulLimitMs && (ulBlocks == 0 || pxPhase->ulChecked < ulBlocks))
+	{
+		usleep(1000);
+		ulWaitedMs++;
+	}
+	PipelineSetSynthetic(false);
+
+	// A tick may still be in its callback; wait for the generated blocks to come through
+	ulWaitedMs = 0;
+	do
+	{
+		usleep(1000 * (CHECK_SYNTH_PERIOD_MS + ulStageDelayMs));
+		ulWaitedMs += CHECK_SYNTH_PERIOD_MS + ulStageDelayMs;
+		PipelineGetStats(&pxPhase->xPipeline);
+	} while (pxPhase->xPipeline.ulFrames != pxPhase->xPipeline.ulSynthetic && ulWaitedMs < CHECK_DRAIN_MS);
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvReport(const CheckPhase_t *pxPhase, bool bOverload)
+ * @brief		Prints the line of a phase and checks it
+ * @return		1 on failure
+ *****************************************************************************/
+static int prvReport(const CheckPhase_t *pxPhase, bool bOverload)
+{
+	const PipelineStats_t *pxStats = &pxPhase->xPipeline;
+	const char *pcFailure = NULL;
+
+	if (pxStats->ulFrames != pxStats->ulSynthetic || pxPhase->ulChecked != pxStats->ulFrames)
+	{
+		pcFailure = "a generated block was not processed";
+	}
+	else if (pxPhase->ulDisorder > 0 || pxPhase->ulShort > 0)
+	{
+		pcFailure = "frames out of order or short";
+	}
+	else if (pxStats->ulGaps != pxPhase->ulMissing)
+	{
+		pcFailure = "gaps differ from the missing block numbers";
+	}
+	else if (!bOverload && (pxStats->ulStalls > 0 || pxStats->ulGaps > 0))
+	{
+		pcFailure = "stalls or gaps at the paced rate";
+	}
+	else if (bOverload && (pxStats->ulStalls == 0 || pxStats->ulGaps > pxStats->ulStalls))
+	{
+		pcFailure = "no stall, or more gaps than stalls, under overload";
+	}
+
+	printf("%-8s %7lu %9lu %6lu %6lu %7lu %8lu %12llu %12lu %8s\n", pxPhase->pcName, (unsigned long)pxStats->ulFrames,
+		   (unsigned long)pxStats->ulSynthetic, (unsigned long)pxStats->ulStalls, (unsigned long)pxStats->ulGaps,
+		   (unsigned long)pxPhase->ulMissing, (unsigned long)pxPhase->ulDisorder,
+		   (unsigned long long)(pxStats->ulFrames ? pxStats->ullLatencyTotal / pxStats->ulFrames : 0),
+		   (unsigned long)pxStats->ulLatencyMax, pcFailure == NULL ? "ok" : "FAIL");
+	if (pcFailure != NULL)
+	{
+		fprintf(stderr, "%s: %s\n", pxPhase->pcName, pcFailure);
+		return 1;
+	}
+	return 0;
+}
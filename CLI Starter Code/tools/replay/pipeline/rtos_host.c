@@ -0,0 +1,407 @@
+/**************************************************************************/ /**
+ * @file      rtos_host.c
+ * @brief     The FreeRTOS subset of pipeline/asf.h on pthreads, for the
+ *            pipeline harness.
+ * @details   Critical sections take one recursive mutex. The kernel objects
+ *            share a second, plain mutex with their condition variables, and
+ *            always inside the first when both are held, so the two cannot
+ *            deadlock. The daemon thread counts a tick every millisecond of
+ *            real time and runs the expired timer callbacks with neither
+ *            mutex held, as the timer daemon task runs them.
+ *
+ *            BenchmarkGetCycles() gives nanoseconds here, so the latencies
+ *            the pipeline records are host nanoseconds.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "Benchmark/Benchmark.h"
+#include <string.h>
+#include <time.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define HOST_MAX_TIMERS 4 ///< Timers the harness can create
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static void prvInitCritical(void);
+static void *prvDaemon(void *pvParameters);
+static bool prvWait(pthread_cond_t *pxCond, TickType_t xTicksToWait, const struct timespec *pxDeadline);
+static void prvDeadline(TickType_t xTicksToWait, struct timespec *pxDeadline);
+static void prvInitCond(pthread_cond_t *pxCond);
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+static pthread_mutex_t xCritical;
+static pthread_mutex_t xKernel = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t xInitOnce = PTHREAD_ONCE_INIT;
+
+static volatile TickType_t xTickCount = 0;
+static TimerHandle_t pxTimers[HOST_MAX_TIMERS];
+static UBaseType_t uxTimerCount = 0;
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Masks the other tasks of the harness. Nests.
+ */
+void HostEnterCritical(void)
+{
+	pthread_once(&xInitOnce, prvInitCritical);
+	pthread_mutex_lock(&xCritical);
+}
+
+/**
+ * @brief Ends the innermost critical section.
+ */
+void HostExitCritical(void)
+{
+	pthread_mutex_unlock(&xCritical);
+}
+
+/**
+ * @brief Starts the tick and timer thread. Call once, after the timers are created.
+ */
+void HostStartDaemon(void)
+{
+	pthread_t xThread;
+	int lError;
+
+	pthread_once(&xInitOnce, prvInitCritical);
+	lError = pthread_create(&xThread, NULL, prvDaemon, NULL);
+	configASSERT(lError == 0);
+	pthread_detach(xThread);
+}
+
+/**
+ * @brief Milliseconds since HostStartDaemon().
+ */
+TickType_t xTaskGetTickCount(void)
+{
+	return xTickCount;
+}
+
+/**
+ * @brief Host nanoseconds, truncated as the cycle counter wraps.
+ */
+uint32_t BenchmarkGetCycles(void)
+{
+	struct timespec xNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &xNow);
+	return (uint32_t)((uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec);
+}
+
+/**
+ * @brief Sets up a counting semaphore in the given buffer.
+ */
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount,
+												 StaticSemaphore_t *pxSemaphoreBuffer)
+{
+	configASSERT(uxInitialCount <= uxMaxCount);
+
+	pxSemaphoreBuffer->uxCount = uxInitialCount;
+	pxSemaphoreBuffer->uxMax = uxMaxCount;
+	prvInitCond(&pxSemaphoreBuffer->xChanged);
+	return pxSemaphoreBuffer;
+}
+
+/**
+ * @brief Takes a count, waiting up to xTicksToWait milliseconds for one.
+ */
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait)
+{
+	struct timespec xDeadline;
+	BaseType_t xTaken = pdFALSE;
+
+	prvDeadline(xTicksToWait, &xDeadline);
+	pthread_mutex_lock(&xKernel);
+	while (xSemaphore->uxCount == 0 && prvWait(&xSemaphore->xChanged, xTicksToWait, &xDeadline))
+	{
+	}
+	if (xSemaphore->uxCount > 0)
+	{
+		xSemaphore->uxCount--;
+		xTaken = pdTRUE;
+	}
+	pthread_mutex_unlock(&xKernel);
+
+	return xTaken;
+}
+
+/**
+ * @brief Gives a count back. Fails at the maximum count, as FreeRTOS does.
+ */
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+	BaseType_t xGiven = pdFALSE;
+
+	pthread_mutex_lock(&xKernel);
+	if (xSemaphore->uxCount < xSemaphore->uxMax)
+	{
+		xSemaphore->uxCount++;
+		xGiven = pdTRUE;
+		pthread_cond_broadcast(&xSemaphore->xChanged);
+	}
+	pthread_mutex_unlock(&xKernel);
+
+	return xGiven;
+}
+
+/**
+ * @brief Sets up a message buffer with the capacity of xBufferSizeBytes of storage.
+ *        The storage itself is not used.
+ */
+MessageBufferHandle_t xMessageBufferCreateStatic(size_t xBufferSizeBytes, uint8_t *pucStorage,
+												 StaticMessageBuffer_t *pxStaticBuffer)
+{
+	memset(pxStaticBuffer, 0, sizeof(*pxStaticBuffer));
+	pxStaticBuffer->xSize = xBufferSizeBytes;
+	prvInitCond(&pxStaticBuffer->xChanged);
+	return pxStaticBuffer;
+}
+
+/**
+ * @brief Appends a message if it fits, in the bytes the FreeRTOS buffer would use.
+ */
+size_t xMessageBufferSend(MessageBufferHandle_t xBuffer, const void *pvData, size_t xLength, TickType_t xTicksToWait)
+{
+	struct timespec xDeadline;
+	size_t xCost = sizeof(size_t) + xLength;
+	size_t xSent = 0;
+
+	configASSERT(xLength <= HOST_MESSAGE_BYTES);
+
+	prvDeadline(xTicksToWait, &xDeadline);
+	pthread_mutex_lock(&xKernel);
+	// A stream buffer holds one byte less than its storage
+	while ((xBuffer->xUsed + xCost > xBuffer->xSize - 1 || xBuffer->uxCount == HOST_MESSAGES) &&
+		   prvWait(&xBuffer->xChanged, xTicksToWait, &xDeadline))
+	{
+	}
+	if (xBuffer->xUsed + xCost <= xBuffer->xSize - 1 && xBuffer->uxCount < HOST_MESSAGES)
+	{
+		UBaseType_t uxTail = (xBuffer->uxHead + xBuffer->uxCount) % HOST_MESSAGES;
+
+		memcpy(xBuffer->ucMessages[uxTail], pvData, xLength);
+		xBuffer->xLengths[uxTail] = xLength;
+		xBuffer->uxCount++;
+		xBuffer->xUsed += xCost;
+		xSent = xLength;
+		pthread_cond_broadcast(&xBuffer->xChanged);
+	}
+	pthread_mutex_unlock(&xKernel);
+
+	return xSent;
+}
+
+/**
+ * @brief Takes the oldest message. One longer than xLength stays, and 0 is returned.
+ */
+size_t xMessageBufferReceive(MessageBufferHandle_t xBuffer, void *pvData, size_t xLength, TickType_t xTicksToWait)
+{
+	struct timespec xDeadline;
+	size_t xReceived = 0;
+
+	prvDeadline(xTicksToWait, &xDeadline);
+	pthread_mutex_lock(&xKernel);
+	while (xBuffer->uxCount == 0 && prvWait(&xBuffer->xChanged, xTicksToWait, &xDeadline))
+	{
+	}
+	if (xBuffer->uxCount > 0 && xBuffer->xLengths[xBuffer->uxHead] <= xLength)
+	{
+		xReceived = xBuffer->xLengths[xBuffer->uxHead];
+		memcpy(pvData, xBuffer->ucMessages[xBuffer->uxHead], xReceived);
+		xBuffer->uxHead = (xBuffer->uxHead + 1) % HOST_MESSAGES;
+		xBuffer->uxCount--;
+		xBuffer->xUsed -= sizeof(size_t) + xReceived;
+		pthread_cond_broadcast(&xBuffer->xChanged);
+	}
+	pthread_mutex_unlock(&xKernel);
+
+	return xReceived;
+}
+
+/**
+ * @brief Sets up a dormant timer and hands it to the daemon thread.
+ */
+TimerHandle_t xTimerCreateStatic(const char *pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload,
+								 void *pvTimerID, TimerCallbackFunction_t pxCallback, StaticTimer_t *pxTimerBuffer)
+{
+	configASSERT(xTimerPeriod > 0);
+
+	pthread_mutex_lock(&xKernel);
+	configASSERT(uxTimerCount < HOST_MAX_TIMERS);
+	pxTimerBuffer->pxCallback = pxCallback;
+	pxTimerBuffer->pvTimerID = pvTimerID;
+	pxTimerBuffer->xPeriod = xTimerPeriod;
+	pxTimerBuffer->bAutoReload = (uxAutoReload != pdFALSE);
+	pxTimerBuffer->bActive = false;
+	pxTimers[uxTimerCount++] = pxTimerBuffer;
+	pthread_mutex_unlock(&xKernel);
+
+	return pxTimerBuffer;
+}
+
+/**
+ * @brief Starts or restarts the timer, to expire one period from now.
+ */
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait)
+{
+	pthread_mutex_lock(&xKernel);
+	xTimer->xExpiry = xTickCount + xTimer->xPeriod;
+	xTimer->bActive = true;
+	pthread_mutex_unlock(&xKernel);
+
+	return pdPASS;
+}
+
+/**
+ * @brief Stops the timer. A callback already running finishes.
+ */
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait)
+{
+	pthread_mutex_lock(&xKernel);
+	xTimer->bActive = false;
+	pthread_mutex_unlock(&xKernel);
+
+	return pdPASS;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static void prvInitCritical(void)
+ * @brief		Creates the recursive critical section mutex, once
+ *****************************************************************************/
+static void prvInitCritical(void)
+{
+	pthread_mutexattr_t xAttr;
+
+	pthread_mutexattr_init(&xAttr);
+	pthread_mutexattr_settype(&xAttr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&xCritical, &xAttr);
+	pthread_mutexattr_destroy(&xAttr);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void *prvDaemon(void *pvParameters)
+ * @brief		Tick and timer thread
+ * @details		Sleeps to absolute millisecond deadlines, so a late wakeup
+ *				does not drift the tick. Every timer due at the new tick runs,
+ *				in creation order; an auto-reload timer is due again one
+ *				period after its expiry, not after its callback returned
+ *****************************************************************************/
+static void *prvDaemon(void *pvParameters)
+{
+	struct timespec xNext;
+
+	clock_gettime(CLOCK_MONOTONIC, &xNext);
+	for (;;)
+	{
+		TimerHandle_t pxDue[HOST_MAX_TIMERS];
+		UBaseType_t uxDue = 0;
+
+		xNext.tv_nsec += 1000000L;
+		if (xNext.tv_nsec >= 1000000000L)
+		{
+			xNext.tv_nsec -= 1000000000L;
+			xNext.tv_sec++;
+		}
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &xNext, NULL) != 0)
+		{
+		}
+
+		pthread_mutex_lock(&xKernel);
+		xTickCount++;
+		for (UBaseType_t i = 0; i < uxTimerCount; i++)
+		{
+			TimerHandle_t xTimer = pxTimers[i];
+
+			if (xTimer->bActive && (int32_t)(xTickCount - xTimer->xExpiry) >= 0)
+			{
+				if (xTimer->bAutoReload)
+				{
+					xTimer->xExpiry += xTimer->xPeriod;
+				}
+				else
+				{
+					xTimer->bActive = false;
+				}
+				pxDue[uxDue++] = xTimer;
+			}
+		}
+		pthread_mutex_unlock(&xKernel);
+
+		for (UBaseType_t i = 0; i < uxDue; i++)
+		{
+			pxDue[i]->pxCallback(pxDue[i]);
+		}
+	}
+
+	return NULL;
+}
+
+/**************************************************************************/ /**
+ * @fn			static bool prvWait(pthread_cond_t *pxCond, TickType_t xTicksToWait, const struct timespec *pxDeadline)
+ * @brief		Waits on a kernel object's condition, with xKernel held
+ * @return		false once the deadline has passed, or at once for no wait
+ *****************************************************************************/
+static bool prvWait(pthread_cond_t *pxCond, TickType_t xTicksToWait, const struct timespec *pxDeadline)
+{
+	if (xTicksToWait == 0)
+	{
+		return false;
+	}
+	if (xTicksToWait == portMAX_DELAY)
+	{
+		pthread_cond_wait(pxCond, &xKernel);
+		return true;
+	}
+	return pthread_cond_timedwait(pxCond, &xKernel, pxDeadline) == 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvDeadline(TickType_t xTicksToWait, struct timespec *pxDeadline)
+ * @brief		Monotonic time xTicksToWait milliseconds from now
+ *****************************************************************************/
+static void prvDeadline(TickType_t xTicksToWait, struct timespec *pxDeadline)
+{
+	clock_gettime(CLOCK_MONOTONIC, pxDeadline);
+	if (xTicksToWait == 0 || xTicksToWait == portMAX_DELAY)
+	{
+		return;
+	}
+	pxDeadline->tv_sec += xTicksToWait / 1000;
+	pxDeadline->tv_nsec += (long)(xTicksToWait % 1000) * 1000000L;
+	if (pxDeadline->tv_nsec >= 1000000000L)
+	{
+		pxDeadline->tv_nsec -= 1000000000L;
+		pxDeadline->tv_sec++;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvInitCond(pthread_cond_t *pxCond)
+ * @brief		Creates a condition variable timed on the monotonic clock
+ *****************************************************************************/
+static void prvInitCond(pthread_cond_t *pxCond)
+{
+	pthread_condattr_t xAttr;
+
+	pthread_condattr_init(&xAttr);
+	pthread_condattr_setclock(&xAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(pxCond, &xAttr);
+	pthread_condattr_destroy(&xAttr);
+}
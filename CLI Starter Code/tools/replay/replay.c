@@ -0,0 +1,1368 @@
+/**************************************************************************/ /**
+ * @file      replay.c
+ * @brief     Offline replay of recorded IMU sessions through the processing
+ *            modules, built for the host by tools/replay/Makefile.
+ * @details   Each session is loaded into memory, cut into ImuBlock_t blocks
+ *            of IMU_BLOCK_SAMPLES as the IMU task would, and run through a
+ *            fresh HitDetector_t at full speed. The detected hits are matched
+ *            one to one against the labelled hits of the session, in time
+ *            order, within --tolerance milliseconds; the report gives the
+ *            precision, recall and F1 score, and the throughput in samples/s
+ *            and nanoseconds per block:
+ *
+ *                replay [-t ms] [-r runs] [-f Hz] [-m recall] [-v] session...
+ *
+ *            -r repeats the timed run and keeps the fastest, like the minimum
+ *            the "bench" command reports. -f gives the rate of CSV sessions,
+ *            IMU_SAMPLE_HZ by default. -v lists every hit. -m sets the lowest
+ *            recall of a session at a rate of the IMU task; the exit status is
+ *            1 if one falls below it.
+ *
+ *            A session at another rate the detector has coefficients for,
+ *            IMU_RATE_HZ() of a shift from HIT_RATE_SHIFT_MIN to
+ *            HIT_RATE_SHIFT_MAX, is cut into blocks tagged with that shift, as
+ *            the IMU task tags them. Rates below IMU_RATE_SHIFT_MIN are scored
+ *            but never checked against -m: they show what the IMU task would
+ *            miss there.
+ *
+ *            A second table checks the orientation filter. Every sample goes
+ *            through a fresh Fusion_t and through the same Madgwick filter in
+ *            double precision, with the same step, gate and alignment and the
+ *            exact gyro scale; it gives the angle between the two quaternions,
+ *            mean and largest over the session, and the fixed-point time per
+ *            update.
+ *
+ *            A third table checks the stream codec. The session is coded
+ *            block by block, as the pipeline encoder codes it, decoded again
+ *            and compared sample by sample; it gives the coded size against
+ *            the raw 18 bytes per sample, the coded bytes per second, the
+ *            share of channel blocks in each mode and the time to code a
+ *            block. The exit status is 1 if any session does not come back
+ *            exactly.
+ *
+ *            A fourth table checks the stroke classifier. A fresh
+ *            StrokeClassifier_t with the model of StrokeModel.c gets the hits
+ *            of the detector and the blocks, in the order of the pipeline
+ *            stages. Each classified hit matched to a label that names its
+ *            stroke is scored; the table gives the accuracy, the recall of
+ *            each stroke, the windows cut short (Trunc) and the time of one
+ *            inference on the features. -x writes those features with their
+ *            label, the training set of tools/stroke/train.py:
+ *
+ *                replay -x features.csv session...
+ *
+ *            A session is CSV, binary or codec packets, told apart by its
+ *            first bytes.
+ *
+ *            CSV, one sample per line at the -f rate, raw sensor values:
+ *                ax,ay,az,gx,gy,gz,lx,ly,lz[,hit]
+ *            a..g from the MPU6000, l from the LIS2DS12, hit on the sample of
+ *            a labelled hit: 1 for a hit, or REPLAY_LABEL_STROKE plus its
+ *            eStrokes for a stroke, 2 forehand, 3 backhand, 4 smash, 5 drop.
+ *            Lines that do not start with a number or sign, such as a header,
+ *            are skipped.
+ *
+ *            Binary, little endian, 19 bytes per sample after a 16 byte header:
+ *                "IMUR", uint16 version (1), uint16 sample rate in Hz,
+ *                uint32 samples, uint32 reserved (0)
+ *                int16 ax ay az gx gy gz lx ly lz, uint8 flags (bit 0: hit,
+ *                bits 3..1: 0, or the eStrokes of the hit plus 1)
+ *
+ *            Codec packets (Codec.h) back to back, from CODEC_SYNC_0, or as
+ *            hex text: the lines of hex digits of a console capture of
+ *            "codec dump", the other lines skipped. The rate comes from the
+ *            packets and must not change within the session; the blocks of
+ *            lost packets are missing from it. There are no labels.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "HitDetect/HitDetect.h"
+#include "Fusion/Fusion.h"
+#include "Codec/Codec.h"
+#include "Stroke/Stroke.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define REPLAY_MAGIC "IMUR"
+#define REPLAY_VERSION 1
+#define REPLAY_HEADER_BYTES 16
+#define REPLAY_RECORD_BYTES 19
+#define REPLAY_FLAG_HIT 0x01
+#define REPLAY_FLAG_STROKE_SHIFT 1
+#define REPLAY_FLAG_STROKE_MASK 0x07
+#define REPLAY_LABEL_STROKE 2 ///< Label of STROKE_FOREHAND, the other strokes follow
+#define REPLAY_AXES 9
+#define REPLAY_TOLERANCE_MS 50 ///< Default largest distance between a hit and its label
+#define REPLAY_LINE_MAX 256
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/**
+ * @brief A loaded session.
+ */
+typedef struct
+{
+	ImuSample_t *pxSamples;
+	uint8_t *pucLabels; ///< 0, 1 on labelled hits, REPLAY_LABEL_STROKE + eStrokes on labelled strokes
+	size_t xCount;
+	uint16_t usRate;	///< Hz
+	int8_t cRateShift;	///< usRate as an IMU rate shift
+} Session_t;
+
+/**
+ * @brief Detection score of one or more sessions.
+ */
+typedef struct
+{
+	uint32_t ulLabels;
+	uint32_t ulDetected;
+	uint32_t ulMatched;
+	uint64_t ullSamples;
+	uint64_t ullBlocks;
+	double dSeconds; ///< Fastest timed run
+} Score_t;
+
+/**
+ * @brief Orientation error of the fixed-point filter against the reference.
+ */
+typedef struct
+{
+	uint64_t ullSamples;
+	uint64_t ullCompared; ///< Samples after both filters aligned
+	uint64_t ullGated;
+	double dErrorTotal; ///< Sum of the angles, degrees
+	double dErrorMax;
+	double dSeconds; ///< Fastest timed run of the fixed-point filter
+} FusionScore_t;
+
+/**
+ * @brief Compression of the stream codec, and whether it was lossless.
+ */
+typedef struct
+{
+	uint64_t ullSamples;
+	uint64_t ullBlocks;
+	uint64_t ullBytes;					///< Packet bytes, headers included
+	uint64_t ullModes[N_CODEC_MODES];	///< Channel blocks in each mode
+	double dDuration;					///< Seconds of the session
+	bool bLossless;
+	double dSeconds;					///< Fastest timed run of the encoder
+} CodecScore_t;
+
+/**
+ * @brief Accuracy of the stroke classifier on the labelled strokes.
+ */
+typedef struct
+{
+	uint32_t ulHits;					 ///< Hits classified
+	uint32_t ulTruncated;				 ///< Of them with a window cut short
+	uint32_t ulStrokes;					 ///< Of them matched to a labelled stroke
+	uint32_t ulCorrect;
+	uint32_t ulLabelled[N_STROKES];		 ///< Labelled strokes of each kind
+	uint32_t ulRecalled[N_STROKES];		 ///< Of them classified as that stroke
+	uint64_t ullInferences;				 ///< In the fastest timed run
+	double dSeconds;					 ///< Fastest timed run of the inference
+} StrokeScore_t;
+
+/**
+ * @brief Double-precision Madgwick filter, the reference for Fusion_t.
+ */
+typedef struct
+{
+	double dQ[4];
+	bool bAligned;
+} Reference_t;
+
+typedef void (*TimedRun_t)(const Session_t *pxSession);
+
+/******************************************************************************
+ * Local Function Declarations
+ ******************************************************************************/
+static int prvLoad(const char *pcPath, Session_t *pxSession);
+static int prvLoadBinary(FILE *pxFile, const char *pcPath, Session_t *pxSession);
+static int prvLoadCsv(FILE *pxFile, const char *pcPath, Session_t *pxSession);
+static int prvLoadStream(const uint8_t *pucStream, size_t xLength, const char *pcPath, Session_t *pxSession);
+static int prvHexLine(const char *pcLine, uint8_t **ppucStream, size_t *pxLength, size_t *pxCapacity);
+static int prvAppend(Session_t *pxSession, size_t *pxCapacity, const int16_t *psAxes, uint8_t ucLabel);
+static void prvCutBlock(const Session_t *pxSession, size_t xStart, ImuBlock_t *pxBlock);
+static size_t prvRun(const Session_t *pxSession, TickType_t *pxHitTicks, size_t xMaxHits);
+static void prvScore(const Session_t *pxSession, const TickType_t *pxHitTicks, size_t xHits, TickType_t xTolerance,
+					 bool bVerbose, uint8_t *pucHitLabels, Score_t *pxScore);
+static void prvCompare(const Session_t *pxSession, FusionScore_t *pxScore);
+static void prvReferenceUpdate(Reference_t *pxReference, const ImuSample_t *pxSample, int8_t cRateShift);
+static void prvNormaliseDouble(double *pdVector, int iLength);
+static double prvTime(const Session_t *pxSession, unsigned uRuns, TimedRun_t pxRun);
+static void prvTimedHits(const Session_t *pxSession);
+static void prvTimedFusion(const Session_t *pxSession);
+static void prvCodecCheck(const Session_t *pxSession, CodecScore_t *pxScore);
+static void prvTimedCodec(const Session_t *pxSession);
+static void prvStrokeCheck(const Session_t *pxSession, const StrokeModel_t *pxModel, const TickType_t *pxHitTicks,
+						   const uint8_t *pucHitLabels, size_t xHits, unsigned uRuns, FILE *pxExport,
+						   StrokeScore_t *pxScore);
+static TickType_t prvSampleTick(const Session_t *pxSession, size_t xIndex);
+static void prvPrint(const char *pcName, const Score_t *pxScore);
+static void prvPrintFusion(const char *pcName, const FusionScore_t *pxScore);
+static void prvPrintCodec(const char *pcName, const CodecScore_t *pxScore);
+static void prvPrintStroke(const char *pcName, const StrokeScore_t *pxScore);
+static double prvRatio(uint32_t ulNumerator, uint32_t ulDenominator);
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	TickType_t xTolerance = pdMS_TO_TICKS(REPLAY_TOLERANCE_MS);
+	unsigned uRuns = 1;
+	uint16_t usCsvRate = IMU_SAMPLE_HZ;
+	double dMinRecall = 0;
+	bool bVerbose = false;
+	bool bLowRecall = false;
+	Score_t xTotal = {0};
+	FusionScore_t xFusionTotal = {0};
+	FusionScore_t *pxFusionScores;
+	CodecScore_t xCodecTotal = {.bLossless = true};
+	CodecScore_t *pxCodecScores;
+	StrokeScore_t xStrokeTotal = {0};
+	StrokeScore_t *pxStrokeScores;
+	StrokeModel_t xModel;
+	bool bModel = StrokeModelLoad(&xModel, ucStrokeModel, usStrokeModelBytes);
+	FILE *pxExport = NULL;
+	int iOption;
+
+	while ((iOption = getopt(argc, argv, "t:r:f:m:x:v")) != -1)
+	{
+		switch (iOption)
+		{
+		case 't':
+			xTolerance = pdMS_TO_TICKS(strtoul(optarg, NULL, 0));
+			break;
+		case 'r':
+			uRuns = (unsigned)strtoul(optarg, NULL, 0);
+			uRuns = (uRuns > 0) ? uRuns : 1;
+			break;
+		case 'f':
+			usCsvRate = (uint16_t)strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			dMinRecall = strtod(optarg, NULL);
+			break;
+		case 'x':
+			pxExport = fopen(optarg, "w");
+			if (pxExport == NULL)
+			{
+				fprintf(stderr, "%s: %s\n", optarg, strerror(errno));
+				return 1;
+			}
+			fprintf(pxExport, "stroke");
+			for (int iFeature = 0; iFeature < STROKE_FEATURES; iFeature++)
+			{
+				fprintf(pxExport, ",f%d", iFeature);
+			}
+			fprintf(pxExport, "\n");
+			break;
+		case 'v':
+			bVerbose = true;
+			break;
+		default:
+			fprintf(stderr,
+					"usage: %s [-t tolerance_ms] [-r runs] [-f csv_hz] [-m min_recall] [-x features.csv] [-v] session...\n",
+					argv[0]);
+			return 2;
+		}
+	}
+	if (optind >= argc)
+	{
+		fprintf(stderr,
+				"usage: %s [-t tolerance_ms] [-r runs] [-f csv_hz] [-m min_recall] [-x features.csv] [-v] session...\n",
+				argv[0]);
+		return 2;
+	}
+
+	pxFusionScores = calloc((size_t)(argc - optind), sizeof(FusionScore_t));
+	pxCodecScores = calloc((size_t)(argc - optind), sizeof(CodecScore_t));
+	pxStrokeScores = calloc((size_t)(argc - optind), sizeof(StrokeScore_t));
+	if (pxFusionScores == NULL || pxCodecScores == NULL || pxStrokeScores == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	printf("%-24s %8s %6s %6s %6s %9s %7s %7s %12s %8s\n", "Session", "Samples", "Labels", "Hits", "Match",
+		   "Precision", "Recall", "F1", "Samples/s", "ns/block");
+
+	for (int i = optind; i < argc; i++)
+	{
+		Session_t xSession = {.usRate = usCsvRate};
+		Score_t xScore = {0};
+		TickType_t *pxHitTicks;
+		uint8_t *pucHitLabels;
+		size_t xMaxHits;
+		size_t xHits;
+
+		if (prvLoad(argv[i], &xSession) != 0)
+		{
+			return 1;
+		}
+
+		// At most one hit starts per refractory period
+		xMaxHits = xSession.xCount / HIT_REFRACTORY_AT(xSession.cRateShift) + 1;
+		pxHitTicks = malloc(xMaxHits * sizeof(TickType_t));
+		pucHitLabels = malloc(xMaxHits);
+		if (pxHitTicks == NULL || pucHitLabels == NULL)
+		{
+			fprintf(stderr, "%s: out of memory\n", argv[i]);
+			return 1;
+		}
+
+		xHits = prvRun(&xSession, pxHitTicks, xMaxHits);
+		prvScore(&xSession, pxHitTicks, xHits, xTolerance, bVerbose, pucHitLabels, &xScore);
+		xScore.dSeconds = prvTime(&xSession, uRuns, prvTimedHits);
+		prvPrint(argv[i], &xScore);
+		if (xSession.cRateShift >= IMU_RATE_SHIFT_MIN && prvRatio(xScore.ulMatched, xScore.ulLabels) < dMinRecall)
+		{
+			fprintf(stderr, "%s: recall under %.3f at %u Hz\n", argv[i], dMinRecall, xSession.usRate);
+			bLowRecall = true;
+		}
+
+		prvCompare(&xSession, &pxFusionScores[i - optind]);
+		pxFusionScores[i - optind].dSeconds = prvTime(&xSession, uRuns, prvTimedFusion);
+
+		prvCodecCheck(&xSession, &pxCodecScores[i - optind]);
+		pxCodecScores[i - optind].dSeconds = prvTime(&xSession, uRuns, prvTimedCodec);
+
+		prvStrokeCheck(&xSession, bModel ? &xModel : NULL, pxHitTicks, pucHitLabels, xHits, uRuns, pxExport,
+					   &pxStrokeScores[i - optind]);
+
+		xTotal.ulLabels += xScore.ulLabels;
+		xTotal.ulDetected += xScore.ulDetected;
+		xTotal.ulMatched += xScore.ulMatched;
+		xTotal.ullSamples += xScore.ullSamples;
+		xTotal.ullBlocks += xScore.ullBlocks;
+		xTotal.dSeconds += xScore.dSeconds;
+
+		free(pxHitTicks);
+		free(pucHitLabels);
+		free(xSession.pxSamples);
+		free(xSession.pucLabels);
+	}
+
+	if (argc - optind > 1)
+	{
+		prvPrint("total", &xTotal);
+	}
+
+	printf("\n%-24s %8s %8s %9s %9s %10s\n", "Session", "Samples", "Gated", "Mean deg", "Max deg", "ns/update");
+	for (int i = optind; i < argc; i++)
+	{
+		const FusionScore_t *pxScore = &pxFusionScores[i - optind];
+
+		prvPrintFusion(argv[i], pxScore);
+		xFusionTotal.ullSamples += pxScore->ullSamples;
+		xFusionTotal.ullCompared += pxScore->ullCompared;
+		xFusionTotal.ullGated += pxScore->ullGated;
+		xFusionTotal.dErrorTotal += pxScore->dErrorTotal;
+		xFusionTotal.dErrorMax = (pxScore->dErrorMax > xFusionTotal.dErrorMax) ? pxScore->dErrorMax : xFusionTotal.dErrorMax;
+		xFusionTotal.dSeconds += pxScore->dSeconds;
+	}
+	if (argc - optind > 1)
+	{
+		prvPrintFusion("total", &xFusionTotal);
+	}
+
+	printf("\n%-24s %8s %9s %9s %6s %8s %6s %6s %8s %8s %8s\n", "Session", "Samples", "Raw B", "Coded B", "Ratio",
+		   "Bytes/s", "Delta", "Linear", "Verbatim", "ns/block", "Lossless");
+	for (int i = optind; i < argc; i++)
+	{
+		const CodecScore_t *pxScore = &pxCodecScores[i - optind];
+
+		prvPrintCodec(argv[i], pxScore);
+		xCodecTotal.ullSamples += pxScore->ullSamples;
+		xCodecTotal.ullBlocks += pxScore->ullBlocks;
+		xCodecTotal.ullBytes += pxScore->ullBytes;
+		for (int iMode = 0; iMode < N_CODEC_MODES; iMode++)
+		{
+			xCodecTotal.ullModes[iMode] += pxScore->ullModes[iMode];
+		}
+		xCodecTotal.dDuration += pxScore->dDuration;
+		xCodecTotal.bLossless = xCodecTotal.bLossless && pxScore->bLossless;
+		xCodecTotal.dSeconds += pxScore->dSeconds;
+	}
+	if (argc - optind > 1)
+	{
+		prvPrintCodec("total", &xCodecTotal);
+	}
+
+	if (bModel)
+	{
+		printf("\nstroke model: %u layers,", xModel.ucLayers);
+		printf(" %u", xModel.xLayers[0].ucInputs);
+		for (uint8_t l = 0; l < xModel.ucLayers; l++)
+		{
+			printf("-%u", xModel.xLayers[l].ucOutputs);
+		}
+		printf(", %u bytes of flash; classifier %zu bytes of RAM, arena %d of them\n", xModel.usBytes,
+			   sizeof(StrokeClassifier_t), STROKE_ARENA_BYTES);
+	}
+	else
+	{
+		printf("\nstroke model: not valid, features only\n");
+	}
+	printf("%-24s %6s %7s %7s %8s %8s %8s %6s %6s %5s %9s\n", "Session", "Hits", "Strokes", "Correct", "Accuracy",
+		   "Forehand", "Backhand", "Smash", "Drop", "Trunc", "ns/infer");
+	for (int i = optind; i < argc; i++)
+	{
+		const StrokeScore_t *pxScore = &pxStrokeScores[i - optind];
+
+		prvPrintStroke(argv[i], pxScore);
+		xStrokeTotal.ulHits += pxScore->ulHits;
+		xStrokeTotal.ulTruncated += pxScore->ulTruncated;
+		xStrokeTotal.ulStrokes += pxScore->ulStrokes;
+		xStrokeTotal.ulCorrect += pxScore->ulCorrect;
+		for (int iStroke = 0; iStroke < N_STROKES; iStroke++)
+		{
+			xStrokeTotal.ulLabelled[iStroke] += pxScore->ulLabelled[iStroke];
+			xStrokeTotal.ulRecalled[iStroke] += pxScore->ulRecalled[iStroke];
+		}
+		xStrokeTotal.ullInferences += pxScore->ullInferences;
+		xStrokeTotal.dSeconds += pxScore->dSeconds;
+	}
+	if (argc - optind > 1)
+	{
+		prvPrintStroke("total", &xStrokeTotal);
+	}
+
+	if (pxExport != NULL)
+	{
+		fclose(pxExport);
+	}
+	free(pxFusionScores);
+	free(pxCodecScores);
+	free(pxStrokeScores);
+	return (xCodecTotal.bLossless && !bLowRecall) ? 0 : 1;
+}
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/**************************************************************************/ /**
+ * @fn			static int prvLoad(const char *pcPath, Session_t *pxSession)
+ * @brief		Reads a session file, binary if it starts with REPLAY_MAGIC,
+ *				codec packets if it starts with the codec sync bytes, text
+ *				otherwise, and checks its rate is one the modules run at
+ * @return		0, or -1 after printing the error
+ *****************************************************************************/
+static int prvLoad(const char *pcPath, Session_t *pxSession)
+{
+	char cMagic[4];
+	FILE *pxFile = fopen(pcPath, "rb");
+	int iResult;
+
+	if (pxFile == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", pcPath, strerror(errno));
+		return -1;
+	}
+
+	if (fread(cMagic, 1, sizeof(cMagic), pxFile) == sizeof(cMagic) && memcmp(cMagic, REPLAY_MAGIC, sizeof(cMagic)) == 0)
+	{
+		iResult = prvLoadBinary(pxFile, pcPath, pxSession);
+	}
+	else if ((uint8_t)cMagic[0] == CODEC_SYNC_0 && (uint8_t)cMagic[1] == CODEC_SYNC_1)
+	{
+		uint8_t *pucStream = NULL;
+		size_t xLength = 0;
+		long lSize;
+
+		iResult = -1;
+		if (fseek(pxFile, 0, SEEK_END) == 0 && (lSize = ftell(pxFile)) > 0 && (pucStream = malloc((size_t)lSize)) != NULL)
+		{
+			rewind(pxFile);
+			xLength = fread(pucStream, 1, (size_t)lSize, pxFile);
+			iResult = prvLoadStream(pucStream, xLength, pcPath, pxSession);
+		}
+		else
+		{
+			fprintf(stderr, "%s: cannot read\n", pcPath);
+		}
+		free(pucStream);
+	}
+	else
+	{
+		rewind(pxFile);
+		iResult = prvLoadCsv(pxFile, pcPath, pxSession);
+	}
+	fclose(pxFile);
+
+	if (iResult == 0 && pxSession->xCount == 0)
+	{
+		fprintf(stderr, "%s: no samples\n", pcPath);
+		iResult = -1;
+	}
+	if (iResult != 0)
+	{
+		return iResult;
+	}
+
+	for (int8_t cShift = HIT_RATE_SHIFT_MIN; cShift <= HIT_RATE_SHIFT_MAX; cShift++)
+	{
+		if (IMU_RATE_HZ(cShift) == pxSession->usRate)
+		{
+			pxSession->cRateShift = cShift;
+			return 0;
+		}
+	}
+	fprintf(stderr, "%s: recorded at %u Hz, the modules run at %u Hz * 2^%d to 2^%d\n", pcPath, pxSession->usRate,
+			IMU_SAMPLE_HZ, HIT_RATE_SHIFT_MIN, HIT_RATE_SHIFT_MAX);
+	return -1;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvLoadBinary(FILE *pxFile, const char *pcPath, Session_t *pxSession)
+ * @brief		Reads the rest of the header and the records
+ *****************************************************************************/
+static int prvLoadBinary(FILE *pxFile, const char *pcPath, Session_t *pxSession)
+{
+	uint8_t ucHeader[REPLAY_HEADER_BYTES - 4];
+	uint8_t ucRecord[REPLAY_RECORD_BYTES];
+	uint16_t usVersion, usRate;
+	uint32_t ulCount;
+	size_t xCapacity = 0;
+
+	if (fread(ucHeader, 1, sizeof(ucHeader), pxFile) != sizeof(ucHeader))
+	{
+		fprintf(stderr, "%s: short header\n", pcPath);
+		return -1;
+	}
+	usVersion = (uint16_t)(ucHeader[0] | ucHeader[1] << 8);
+	usRate = (uint16_t)(ucHeader[2] | ucHeader[3] << 8);
+	ulCount = (uint32_t)ucHeader[4] | (uint32_t)ucHeader[5] << 8 | (uint32_t)ucHeader[6] << 16 | (uint32_t)ucHeader[7] << 24;
+	if (usVersion != REPLAY_VERSION)
+	{
+		fprintf(stderr, "%s: version %u, expected %u\n", pcPath, usVersion, REPLAY_VERSION);
+		return -1;
+	}
+	pxSession->usRate = usRate;
+
+	for (uint32_t i = 0; i < ulCount; i++)
+	{
+		int16_t sAxes[REPLAY_AXES];
+
+		if (fread(ucRecord, 1, sizeof(ucRecord), pxFile) != sizeof(ucRecord))
+		{
+			fprintf(stderr, "%s: %lu of %lu samples\n", pcPath, (unsigned long)i, (unsigned long)ulCount);
+			return -1;
+		}
+		for (int iAxis = 0; iAxis < REPLAY_AXES; iAxis++)
+		{
+			sAxes[iAxis] = (int16_t)(ucRecord[2 * iAxis] | ucRecord[2 * iAxis + 1] << 8);
+		}
+		uint8_t ucFlags = ucRecord[REPLAY_RECORD_BYTES - 1];
+		uint8_t ucStroke = (ucFlags >> REPLAY_FLAG_STROKE_SHIFT) & REPLAY_FLAG_STROKE_MASK;
+		uint8_t ucLabel = 0;
+
+		if (ucFlags & REPLAY_FLAG_HIT)
+		{
+			ucLabel = (ucStroke > 0 && ucStroke <= N_STROKES) ? REPLAY_LABEL_STROKE + ucStroke - 1 : 1;
+		}
+		if (prvAppend(pxSession, &xCapacity, sAxes, ucLabel) != 0)
+		{
+			fprintf(stderr, "%s: out of memory\n", pcPath);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvLoadCsv(FILE *pxFile, const char *pcPath, Session_t *pxSession)
+ * @brief		Reads ax,ay,az,gx,gy,gz,lx,ly,lz[,hit] lines, or the hex
+ *				lines of a codec dump
+ *****************************************************************************/
+static int prvLoadCsv(FILE *pxFile, const char *pcPath, Session_t *pxSession)
+{
+	char cLine[REPLAY_LINE_MAX];
+	unsigned long ulLine = 0;
+	size_t xCapacity = 0;
+	uint8_t *pucStream = NULL;
+	size_t xStreamLength = 0;
+	size_t xStreamCapacity = 0;
+	int iResult;
+
+	while (fgets(cLine, sizeof(cLine), pxFile) != NULL)
+	{
+		int16_t sAxes[REPLAY_AXES];
+		long lValue;
+		char *pcField = cLine;
+		char *pcEnd;
+		uint8_t ucLabel = 0;
+
+		ulLine++;
+		iResult = prvHexLine(cLine, &pucStream, &xStreamLength, &xStreamCapacity);
+		if (iResult != 0)
+		{
+			if (iResult < 0)
+			{
+				fprintf(stderr, "%s: out of memory\n", pcPath);
+				free(pucStream);
+				return -1;
+			}
+			continue;
+		}
+		if (!(cLine[0] == '-' || cLine[0] == '+' || (cLine[0] >= '0' && cLine[0] <= '9')))
+		{
+			continue;
+		}
+
+		for (int iAxis = 0; iAxis < REPLAY_AXES; iAxis++)
+		{
+			lValue = strtol(pcField, &pcEnd, 10);
+			if (pcEnd == pcField || lValue < INT16_MIN || lValue > INT16_MAX)
+			{
+				fprintf(stderr, "%s:%lu: expected %d values from -32768 to 32767\n", pcPath, ulLine, REPLAY_AXES);
+				free(pucStream);
+				return -1;
+			}
+			sAxes[iAxis] = (int16_t)lValue;
+			pcField = (*pcEnd == ',') ? pcEnd + 1 : pcEnd;
+		}
+		lValue = strtol(pcField, &pcEnd, 10);
+		if (pcEnd != pcField && lValue != 0)
+		{
+			ucLabel = (lValue >= REPLAY_LABEL_STROKE && lValue < REPLAY_LABEL_STROKE + N_STROKES) ? (uint8_t)lValue : 1;
+		}
+
+		if (prvAppend(pxSession, &xCapacity, sAxes, ucLabel) != 0)
+		{
+			fprintf(stderr, "%s: out of memory\n", pcPath);
+			free(pucStream);
+			return -1;
+		}
+	}
+
+	iResult = 0;
+	if (xStreamLength > 0 && pxSession->xCount > 0)
+	{
+		fprintf(stderr, "%s: both samples and codec packets\n", pcPath);
+		iResult = -1;
+	}
+	else if (xStreamLength > 0)
+	{
+		iResult = prvLoadStream(pucStream, xStreamLength, pcPath, pxSession);
+	}
+	free(pucStream);
+	return iResult;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvLoadStream(const uint8_t *pucStream, size_t xLength, const char *pcPath, Session_t *pxSession)
+ * @brief		Decodes codec packets into the session, finding the next
+ *				packet byte by byte after anything that is not one
+ * @return		0, or -1 after printing the error. Lost packets, skipped
+ *				packets and stray bytes are reported, but are not errors
+ *****************************************************************************/
+static int prvLoadStream(const uint8_t *pucStream, size_t xLength, const char *pcPath, Session_t *pxSession)
+{
+	static ImuBlock_t xBlock;
+	Codec_t xDecoder;
+	size_t xCapacity = 0;
+	size_t xOffset = 0;
+	size_t xUsed = 0;
+	unsigned long ulSkipped = 0;
+	unsigned long ulStray = 0;
+	bool bHaveRate = false;
+
+	CodecReset(&xDecoder);
+	while (xOffset < xLength)
+	{
+		switch (CodecDecode(&xDecoder, pucStream + xOffset, xLength - xOffset, &xBlock, &xUsed))
+		{
+		case CODEC_DECODED:
+			if (bHaveRate && xBlock.cRateShift != pxSession->cRateShift)
+			{
+				fprintf(stderr, "%s: the rate changes from %u Hz to %u Hz, pin it with \"imu rate\"\n", pcPath,
+						pxSession->usRate, IMU_RATE_HZ(xBlock.cRateShift));
+				return -1;
+			}
+			bHaveRate = true;
+			pxSession->cRateShift = xBlock.cRateShift;
+			pxSession->usRate = IMU_RATE_HZ(xBlock.cRateShift);
+			for (uint16_t i = 0; i < xBlock.usCount; i++)
+			{
+				const ImuSample_t *pxSample = &xBlock.xSamples[i];
+				int16_t sAxes[REPLAY_AXES];
+
+				memcpy(&sAxes[0], pxSample->sAccel, sizeof(pxSample->sAccel));
+				memcpy(&sAxes[3], pxSample->sGyro, sizeof(pxSample->sGyro));
+				memcpy(&sAxes[6], pxSample->sAccelAux, sizeof(pxSample->sAccelAux));
+				if (prvAppend(pxSession, &xCapacity, sAxes, 0) != 0)
+				{
+					fprintf(stderr, "%s: out of memory\n", pcPath);
+					return -1;
+				}
+			}
+			xOffset += xUsed;
+			break;
+
+		case CODEC_SKIPPED:
+			ulSkipped++;
+			xOffset += xUsed;
+			break;
+
+		case CODEC_NEED_MORE:
+			ulStray += xLength - xOffset;
+			xOffset = xLength;
+			break;
+
+		case CODEC_INVALID:
+		default:
+			ulStray++;
+			xOffset++;
+			break;
+		}
+	}
+
+	if (xDecoder.ulLost > 0 || ulSkipped > 0 || ulStray > 0)
+	{
+		fprintf(stderr, "%s: %lu packets, %lu lost, %lu skipped before a key packet, %lu bytes outside packets\n",
+				pcPath, (unsigned long)xDecoder.ulPackets, (unsigned long)xDecoder.ulLost, ulSkipped, ulStray);
+	}
+	return 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvHexLine(const char *pcLine, uint8_t **ppucStream, size_t *pxLength, size_t *pxCapacity)
+ * @brief		Appends the bytes of a line of hex digit pairs, growing the
+ *				buffer by doubling
+ * @return		1 if it was one, 0 if not, -1 out of memory
+ *****************************************************************************/
+static int prvHexLine(const char *pcLine, uint8_t **ppucStream, size_t *pxLength, size_t *pxCapacity)
+{
+	size_t xDigits = strspn(pcLine, "0123456789abcdefABCDEF");
+
+	if (xDigits == 0 || xDigits % 2 != 0 || strspn(pcLine + xDigits, "\r\n") != strlen(pcLine + xDigits))
+	{
+		return 0;
+	}
+	if (*pxLength + xDigits / 2 > *pxCapacity)
+	{
+		size_t xCapacity = (*pxCapacity > 0) ? 2 * *pxCapacity : 4096;
+		uint8_t *pucStream = realloc(*ppucStream, xCapacity);
+
+		if (pucStream == NULL)
+		{
+			return -1;
+		}
+		*ppucStream = pucStream;
+		*pxCapacity = xCapacity;
+	}
+	for (size_t i = 0; i < xDigits; i += 2)
+	{
+		char cByte[3] = {pcLine[i], pcLine[i + 1], '\0'};
+
+		(*ppucStream)[(*pxLength)++] = (uint8_t)strtoul(cByte, NULL, 16);
+	}
+	return 1;
+}
+
+/**************************************************************************/ /**
+ * @fn			static int prvAppend(Session_t *pxSession, size_t *pxCapacity, const int16_t *psAxes, uint8_t ucLabel)
+ * @brief		Adds a sample, growing the arrays by doubling
+ *****************************************************************************/
+static int prvAppend(Session_t *pxSession, size_t *pxCapacity, const int16_t *psAxes, uint8_t ucLabel)
+{
+	ImuSample_t *pxSample;
+
+	if (pxSession->xCount == *pxCapacity)
+	{
+		size_t xCapacity = (*pxCapacity > 0) ? 2 * *pxCapacity : 4096;
+		ImuSample_t *pxSamples = realloc(pxSession->pxSamples, xCapacity * sizeof(ImuSample_t));
+		uint8_t *pucLabels = realloc(pxSession->pucLabels, xCapacity);
+
+		if (pxSamples != NULL)
+		{
+			pxSession->pxSamples = pxSamples;
+		}
+		if (pucLabels != NULL)
+		{
+			pxSession->pucLabels = pucLabels;
+		}
+		if (pxSamples == NULL || pucLabels == NULL)
+		{
+			return -1;
+		}
+		*pxCapacity = xCapacity;
+	}
+
+	pxSample = &pxSession->pxSamples[pxSession->xCount];
+	memcpy(pxSample->sAccel, &psAxes[0], sizeof(pxSample->sAccel));
+	memcpy(pxSample->sGyro, &psAxes[3], sizeof(pxSample->sGyro));
+	memcpy(pxSample->sAccelAux, &psAxes[6], sizeof(pxSample->sAccelAux));
+	pxSession->pucLabels[pxSession->xCount++] = ucLabel;
+	return 0;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCutBlock(const Session_t *pxSession, size_t xStart, ImuBlock_t *pxBlock)
+ * @brief		The block of up to IMU_BLOCK_SAMPLES from sample xStart,
+ *				stamped the way the IMU task stamps it: the tick of its newest
+ *				sample, and consecutive sequence numbers
+ *****************************************************************************/
+static void prvCutBlock(const Session_t *pxSession, size_t xStart, ImuBlock_t *pxBlock)
+{
+	size_t xCount = pxSession->xCount - xStart;
+
+	pxBlock->ulSequence = (uint32_t)(xStart / IMU_BLOCK_SAMPLES);
+	pxBlock->cRateShift = pxSession->cRateShift;
+	pxBlock->usCount = (uint16_t)((xCount < IMU_BLOCK_SAMPLES) ? xCount : IMU_BLOCK_SAMPLES);
+	memcpy(pxBlock->xSamples, &pxSession->pxSamples[xStart], pxBlock->usCount * sizeof(ImuSample_t));
+	pxBlock->xTimestamp = prvSampleTick(pxSession, xStart + pxBlock->usCount - 1);
+}
+
+/**************************************************************************/ /**
+ * @fn			static size_t prvRun(const Session_t *pxSession, TickType_t *pxHitTicks, size_t xMaxHits)
+ * @brief		Runs the session through a fresh detector, block by block
+ * @return		Number of hits written to pxHitTicks, their start ticks in order
+ *****************************************************************************/
+static size_t prvRun(const Session_t *pxSession, TickType_t *pxHitTicks, size_t xMaxHits)
+{
+	static ImuBlock_t xBlock;
+	HitDetector_t xDetector;
+	Hit_t xHits[HIT_MAX_PER_BLOCK];
+	size_t xFound = 0;
+
+	HitDetectReset(&xDetector);
+	for (size_t xStart = 0; xStart < pxSession->xCount; xStart += IMU_BLOCK_SAMPLES)
+	{
+		uint16_t usHits;
+
+		prvCutBlock(pxSession, xStart, &xBlock);
+		usHits = HitDetectProcess(&xDetector, &xBlock, xHits);
+		for (uint16_t i = 0; i < usHits && xFound < xMaxHits; i++)
+		{
+			pxHitTicks[xFound++] = xHits[i].xTick;
+		}
+	}
+	return xFound;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvScore(const Session_t *pxSession, const TickType_t *pxHitTicks, size_t xHits, TickType_t xTolerance, bool bVerbose, uint8_t *pucHitLabels, Score_t *pxScore)
+ * @brief		Pairs each hit with the earliest unpaired label within
+ *				xTolerance, walking both lists in time order
+ * @param[out]	pucHitLabels The label paired with each hit, 0 for a false hit
+ *****************************************************************************/
+static void prvScore(const Session_t *pxSession, const TickType_t *pxHitTicks, size_t xHits, TickType_t xTolerance,
+					 bool bVerbose, uint8_t *pucHitLabels, Score_t *pxScore)
+{
+	size_t xLabel = 0;
+	size_t xHit = 0;
+
+	pxScore->ullSamples = pxSession->xCount;
+	pxScore->ullBlocks = (pxSession->xCount + IMU_BLOCK_SAMPLES - 1) / IMU_BLOCK_SAMPLES;
+	pxScore->ulDetected = (uint32_t)xHits;
+
+	for (;;)
+	{
+		while (xLabel < pxSession->xCount && !pxSession->pucLabels[xLabel])
+		{
+			xLabel++;
+		}
+		if (xLabel >= pxSession->xCount && xHit >= xHits)
+		{
+			break;
+		}
+
+		TickType_t xLabelTick = prvSampleTick(pxSession, xLabel);
+		if (xHit >= xHits || (xLabel < pxSession->xCount && xLabelTick + xTolerance < pxHitTicks[xHit]))
+		{
+			// The label is too early for this and every later hit
+			pxScore->ulLabels++;
+			if (bVerbose)
+			{
+				printf("  missed  label at %lu ms\n", (unsigned long)xLabelTick);
+			}
+			xLabel++;
+		}
+		else if (xLabel >= pxSession->xCount || pxHitTicks[xHit] + xTolerance < xLabelTick)
+		{
+			if (bVerbose)
+			{
+				printf("  false   hit at %lu ms\n", (unsigned long)pxHitTicks[xHit]);
+			}
+			pucHitLabels[xHit++] = 0;
+		}
+		else
+		{
+			pxScore->ulLabels++;
+			pxScore->ulMatched++;
+			if (bVerbose)
+			{
+				printf("  matched hit at %lu ms, label at %lu ms\n", (unsigned long)pxHitTicks[xHit], (unsigned long)xLabelTick);
+			}
+			pucHitLabels[xHit++] = pxSession->pucLabels[xLabel++];
+		}
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCompare(const Session_t *pxSession, FusionScore_t *pxScore)
+ * @brief		Runs the fixed-point filter and the reference side by side
+ *				and accumulates the angle between their quaternions
+ *****************************************************************************/
+static void prvCompare(const Session_t *pxSession, FusionScore_t *pxScore)
+{
+	Fusion_t xFusion;
+	Reference_t xReference = {{1.0, 0.0, 0.0, 0.0}, false};
+
+	FusionReset(&xFusion);
+	xFusion.cRateShift = pxSession->cRateShift;
+	pxScore->ullSamples = pxSession->xCount;
+	for (size_t x = 0; x < pxSession->xCount; x++)
+	{
+		double dDot = 0;
+		double dAngle;
+
+		FusionUpdate(&xFusion, &pxSession->pxSamples[x]);
+		prvReferenceUpdate(&xReference, &pxSession->pxSamples[x], pxSession->cRateShift);
+		if (!xFusion.bAligned || !xReference.bAligned)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			dDot += xReference.dQ[i] * ((double)xFusion.lQ[i] / FUSION_ONE);
+		}
+		dDot = fabs(dDot);
+		dAngle = 2.0 * acos((dDot < 1.0) ? dDot : 1.0) * 180.0 / M_PI;
+
+		pxScore->ullCompared++;
+		pxScore->dErrorTotal += dAngle;
+		if (dAngle > pxScore->dErrorMax)
+		{
+			pxScore->dErrorMax = dAngle;
+		}
+	}
+	pxScore->ullGated = xFusion.ulGated;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvReferenceUpdate(Reference_t *pxReference, const ImuSample_t *pxSample, int8_t cRateShift)
+ * @brief		One update of the reference filter, following FusionUpdate()
+ *****************************************************************************/
+static void prvReferenceUpdate(Reference_t *pxReference, const ImuSample_t *pxSample, int8_t cRateShift)
+{
+	const double dGyroScale = 0.5 / IMU_RATE_HZ(cRateShift) * M_PI / 180.0 * 10.0 / IMU_GYRO_LSB_PER_10_DPS;
+	const double dStep = 1.0 / (1 << (FUSION_BETA_SHIFT + cRateShift));
+	const double dGateMin = FUSION_GATE_MIN_G * IMU_ACCEL_LSB_PER_G * FUSION_GATE_MIN_G * IMU_ACCEL_LSB_PER_G;
+	const double dGateMax = FUSION_GATE_MAX_G * IMU_ACCEL_LSB_PER_G * FUSION_GATE_MAX_G * IMU_ACCEL_LSB_PER_G;
+	double *q = pxReference->dQ;
+	double a[3], w[3], d[4];
+	double dSquares = 0;
+	bool bUseAccel;
+
+	for (int i = 0; i < 3; i++)
+	{
+		a[i] = pxSample->sAccel[i];
+		w[i] = pxSample->sGyro[i] * dGyroScale;
+		dSquares += a[i] * a[i];
+	}
+	bUseAccel = dSquares >= dGateMin && dSquares <= dGateMax;
+	if (bUseAccel)
+	{
+		prvNormaliseDouble(a, 3);
+	}
+
+	if (!pxReference->bAligned)
+	{
+		if (bUseAccel)
+		{
+			if (1.0 + a[2] < 1.0 / (1 << 10))
+			{
+				q[0] = 0, q[1] = 1, q[2] = 0, q[3] = 0;
+			}
+			else
+			{
+				q[0] = 1.0 + a[2], q[1] = a[1], q[2] = -a[0], q[3] = 0;
+				prvNormaliseDouble(q, 4);
+			}
+			pxReference->bAligned = true;
+		}
+		return;
+	}
+
+	d[0] = -q[1] * w[0] - q[2] * w[1] - q[3] * w[2];
+	d[1] = q[0] * w[0] + q[2] * w[2] - q[3] * w[1];
+	d[2] = q[0] * w[1] - q[1] * w[2] + q[3] * w[0];
+	d[3] = q[0] * w[2] + q[1] * w[1] - q[2] * w[0];
+
+	if (bUseAccel)
+	{
+		double f[3], s[4];
+
+		f[0] = 2.0 * (q[1] * q[3] - q[0] * q[2]) - a[0];
+		f[1] = 2.0 * (q[0] * q[1] + q[2] * q[3]) - a[1];
+		f[2] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]) - a[2];
+		s[0] = -q[2] * f[0] + q[1] * f[1];
+		s[1] = q[3] * f[0] + q[0] * f[1] - 2.0 * q[1] * f[2];
+		s[2] = -q[0] * f[0] + q[3] * f[1] - 2.0 * q[2] * f[2];
+		s[3] = q[1] * f[0] + q[2] * f[1];
+		if (s[0] != 0 || s[1] != 0 || s[2] != 0 || s[3] != 0)
+		{
+			prvNormaliseDouble(s, 4);
+			for (int i = 0; i < 4; i++)
+			{
+				d[i] -= dStep * s[i];
+			}
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		q[i] += d[i];
+	}
+	prvNormaliseDouble(q, 4);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvNormaliseDouble(double *pdVector, int iLength)
+ * @brief		Scales a non-zero vector to unit length
+ *****************************************************************************/
+static void prvNormaliseDouble(double *pdVector, int iLength)
+{
+	double dSquares = 0;
+
+	for (int i = 0; i < iLength; i++)
+	{
+		dSquares += pdVector[i] * pdVector[i];
+	}
+	dSquares = sqrt(dSquares);
+	for (int i = 0; i < iLength; i++)
+	{
+		pdVector[i] /= dSquares;
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static double prvTime(const Session_t *pxSession, unsigned uRuns, TimedRun_t pxRun)
+ * @brief		Times uRuns runs of pxRun over the session and returns the fastest, in seconds
+ *****************************************************************************/
+static double prvTime(const Session_t *pxSession, unsigned uRuns, TimedRun_t pxRun)
+{
+	double dBest = 0;
+
+	for (unsigned u = 0; u < uRuns; u++)
+	{
+		struct timespec xStart, xEnd;
+		double dSeconds;
+
+		clock_gettime(CLOCK_MONOTONIC, &xStart);
+		pxRun(pxSession);
+		clock_gettime(CLOCK_MONOTONIC, &xEnd);
+
+		dSeconds = (double)(xEnd.tv_sec - xStart.tv_sec) + (double)(xEnd.tv_nsec - xStart.tv_nsec) * 1e-9;
+		if (u == 0 || dSeconds < dBest)
+		{
+			dBest = dSeconds;
+		}
+	}
+	return dBest;
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvTimedHits(const Session_t *pxSession)
+ * @brief		The hit detector run, for prvTime()
+ *****************************************************************************/
+static void prvTimedHits(const Session_t *pxSession)
+{
+	static TickType_t xDiscard[HIT_MAX_PER_BLOCK];
+
+	(void)prvRun(pxSession, xDiscard, HIT_MAX_PER_BLOCK);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvTimedFusion(const Session_t *pxSession)
+ * @brief		The fixed-point filter alone over the session, for prvTime()
+ *****************************************************************************/
+static void prvTimedFusion(const Session_t *pxSession)
+{
+	static Fusion_t xFusion; // Static so the updates are not optimised away
+
+	FusionReset(&xFusion);
+	xFusion.cRateShift = pxSession->cRateShift;
+	for (size_t x = 0; x < pxSession->xCount; x++)
+	{
+		FusionUpdate(&xFusion, &pxSession->pxSamples[x]);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvCodecCheck(const Session_t *pxSession, CodecScore_t *pxScore)
+ * @brief		Codes the session into one stream, decodes the stream as a
+ *				session file is decoded, and compares the two
+ *****************************************************************************/
+static void prvCodecCheck(const Session_t *pxSession, CodecScore_t *pxScore)
+{
+	static ImuBlock_t xBlock;
+	Codec_t xEncoder;
+	Session_t xDecoded = {0};
+	size_t xBlocks = (pxSession->xCount + IMU_BLOCK_SAMPLES - 1) / IMU_BLOCK_SAMPLES;
+	uint8_t *pucStream = malloc(xBlocks * CODEC_MAX_PACKET_BYTES);
+	size_t xLength = 0;
+
+	pxScore->ullSamples = pxSession->xCount;
+	pxScore->ullBlocks = xBlocks;
+	pxScore->dDuration = (double)pxSession->xCount / pxSession->usRate;
+	if (pucStream == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return;
+	}
+
+	CodecReset(&xEncoder);
+	for (size_t xStart = 0; xStart < pxSession->xCount; xStart += IMU_BLOCK_SAMPLES)
+	{
+		uint8_t ucModes[CODEC_CHANNELS];
+
+		prvCutBlock(pxSession, xStart, &xBlock);
+		xLength += CodecEncode(&xEncoder, &xBlock, pucStream + xLength, CODEC_MAX_PACKET_BYTES, ucModes);
+		for (int c = 0; c < CODEC_CHANNELS; c++)
+		{
+			pxScore->ullModes[ucModes[c]]++;
+		}
+	}
+	pxScore->ullBytes = xLength;
+
+	pxScore->bLossless = prvLoadStream(pucStream, xLength, "coded stream", &xDecoded) == 0 &&
+						 xDecoded.xCount == pxSession->xCount && xDecoded.usRate == pxSession->usRate &&
+						 memcmp(xDecoded.pxSamples, pxSession->pxSamples, pxSession->xCount * sizeof(ImuSample_t)) == 0;
+
+	free(xDecoded.pxSamples);
+	free(xDecoded.pucLabels);
+	free(pucStream);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvTimedCodec(const Session_t *pxSession)
+ * @brief		The encoder alone over the session, for prvTime()
+ *****************************************************************************/
+static void prvTimedCodec(const Session_t *pxSession)
+{
+	static ImuBlock_t xBlock;
+	static Codec_t xEncoder;
+	static uint8_t ucPacket[CODEC_MAX_PACKET_BYTES]; // Static so the coding is not optimised away
+
+	CodecReset(&xEncoder);
+	for (size_t xStart = 0; xStart < pxSession->xCount; xStart += IMU_BLOCK_SAMPLES)
+	{
+		prvCutBlock(pxSession, xStart, &xBlock);
+		(void)CodecEncode(&xEncoder, &xBlock, ucPacket, sizeof(ucPacket), NULL);
+	}
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvStrokeCheck(const Session_t *pxSession, const StrokeModel_t *pxModel, const TickType_t *pxHitTicks, const uint8_t *pucHitLabels, size_t xHits, unsigned uRuns, FILE *pxExport, StrokeScore_t *pxScore)
+ * @brief		Runs a fresh detector and classifier over the session as the
+ *				pipeline stages run them, scores each classified hit against
+ *				the label prvScore() paired with it, writes the features of
+ *				the labelled strokes to pxExport, and times the inference on
+ *				all the features, the fastest of uRuns
+ *****************************************************************************/
+static void prvStrokeCheck(const Session_t *pxSession, const StrokeModel_t *pxModel, const TickType_t *pxHitTicks,
+						   const uint8_t *pucHitLabels, size_t xHits, unsigned uRuns, FILE *pxExport,
+						   StrokeScore_t *pxScore)
+{
+	static ImuBlock_t xBlock;
+	static StrokeClassifier_t xClassifier;
+	static q7_t cScores[N_STROKES]; // Static so the timed inferences are not optimised away
+	HitDetector_t xDetector;
+	Hit_t xFound[HIT_MAX_PER_BLOCK];
+	StrokeResult_t xResult;
+	q7_t *pcFeatures = malloc((xHits + 1) * STROKE_FEATURES);
+	size_t xClassified = 0;
+	size_t xHit = 0;
+
+	if (pcFeatures == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return;
+	}
+
+	HitDetectReset(&xDetector);
+	StrokeReset(&xClassifier, pxModel);
+	for (size_t xStart = 0; xStart < pxSession->xCount; xStart += IMU_BLOCK_SAMPLES)
+	{
+		uint16_t usFound;
+
+		prvCutBlock(pxSession, xStart, &xBlock);
+		usFound = HitDetectProcess(&xDetector, &xBlock, xFound);
+		for (uint16_t i = 0; i < usFound; i++)
+		{
+			(void)StrokeAddHit(&xClassifier, &xFound[i]);
+		}
+		StrokeAddBlock(&xClassifier, &xBlock);
+
+		while (xClassified <= xHits && StrokeNext(&xClassifier, &xResult))
+		{
+			uint8_t ucLabel = 0;
+
+			pxScore->ulHits++;
+			pxScore->ulTruncated += xResult.bTruncated ? 1 : 0;
+			memcpy(&pcFeatures[xClassified++ * STROKE_FEATURES], xResult.cFeatures, STROKE_FEATURES);
+
+			// The same hit among those prvScore() paired, both lists in time order
+			while (xHit < xHits && (int32_t)(pxHitTicks[xHit] - xResult.xHit.xTick) < 0)
+			{
+				xHit++;
+			}
+			if (xHit < xHits && pxHitTicks[xHit] == xResult.xHit.xTick)
+			{
+				ucLabel = pucHitLabels[xHit];
+			}
+			if (ucLabel < REPLAY_LABEL_STROKE)
+			{
+				continue;
+			}
+
+			pxScore->ulStrokes++;
+			pxScore->ulLabelled[ucLabel - REPLAY_LABEL_STROKE]++;
+			if (xResult.ucStroke == ucLabel - REPLAY_LABEL_STROKE)
+			{
+				pxScore->ulCorrect++;
+				pxScore->ulRecalled[ucLabel - REPLAY_LABEL_STROKE]++;
+			}
+			if (pxExport != NULL)
+			{
+				fprintf(pxExport, "%d", ucLabel - REPLAY_LABEL_STROKE);
+				for (int iFeature = 0; iFeature < STROKE_FEATURES; iFeature++)
+				{
+					fprintf(pxExport, ",%d", xResult.cFeatures[iFeature]);
+				}
+				fprintf(pxExport, "\n");
+			}
+		}
+	}
+
+	for (unsigned u = 0; pxModel != NULL && u < uRuns; u++)
+	{
+		struct timespec xStartTime, xEndTime;
+		double dSeconds;
+
+		clock_gettime(CLOCK_MONOTONIC, &xStartTime);
+		for (size_t x = 0; x < xClassified; x++)
+		{
+			(void)StrokeInfer(pxModel, &pcFeatures[x * STROKE_FEATURES], xClassifier.cArena, cScores);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &xEndTime);
+
+		dSeconds = (double)(xEndTime.tv_sec - xStartTime.tv_sec) + (double)(xEndTime.tv_nsec - xStartTime.tv_nsec) * 1e-9;
+		if (u == 0 || dSeconds < pxScore->dSeconds)
+		{
+			pxScore->dSeconds = dSeconds;
+		}
+		pxScore->ullInferences = xClassified;
+	}
+	free(pcFeatures);
+}
+
+/**************************************************************************/ /**
+ * @fn			static TickType_t prvSampleTick(const Session_t *pxSession, size_t xIndex)
+ * @brief		Tick of a sample, the session starting at tick 0
+ *****************************************************************************/
+static TickType_t prvSampleTick(const Session_t *pxSession, size_t xIndex)
+{
+	return (TickType_t)((uint64_t)xIndex * configTICK_RATE_HZ / pxSession->usRate);
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPrint(const char *pcName, const Score_t *pxScore)
+ * @brief		Prints one row of the report
+ *****************************************************************************/
+static void prvPrint(const char *pcName, const Score_t *pxScore)
+{
+	double dPrecision = prvRatio(pxScore->ulMatched, pxScore->ulDetected);
+	double dRecall = prvRatio(pxScore->ulMatched, pxScore->ulLabels);
+	double dF1 = (dPrecision + dRecall > 0) ? 2 * dPrecision * dRecall / (dPrecision + dRecall) : 0;
+	double dSeconds = (pxScore->dSeconds > 0) ? pxScore->dSeconds : 1e-9;
+
+	printf("%-24s %8llu %6lu %6lu %6lu %9.3f %7.3f %7.3f %12.0f %8.0f\n", pcName,
+		   (unsigned long long)pxScore->ullSamples, (unsigned long)pxScore->ulLabels, (unsigned long)pxScore->ulDetected,
+		   (unsigned long)pxScore->ulMatched, dPrecision, dRecall, dF1, pxScore->ullSamples / dSeconds,
+		   dSeconds * 1e9 / (pxScore->ullBlocks > 0 ? pxScore->ullBlocks : 1));
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPrintFusion(const char *pcName, const FusionScore_t *pxScore)
+ * @brief		Prints one row of the orientation report
+ *****************************************************************************/
+static void prvPrintFusion(const char *pcName, const FusionScore_t *pxScore)
+{
+	double dSeconds = (pxScore->dSeconds > 0) ? pxScore->dSeconds : 1e-9;
+
+	printf("%-24s %8llu %8llu %9.4f %9.4f %10.1f\n", pcName, (unsigned long long)pxScore->ullSamples,
+		   (unsigned long long)pxScore->ullGated,
+		   (pxScore->ullCompared > 0) ? pxScore->dErrorTotal / pxScore->ullCompared : 0.0, pxScore->dErrorMax,
+		   dSeconds * 1e9 / (pxScore->ullSamples > 0 ? pxScore->ullSamples : 1));
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPrintCodec(const char *pcName, const CodecScore_t *pxScore)
+ * @brief		Prints one row of the codec report. Modes in percent of the channel blocks
+ *****************************************************************************/
+static void prvPrintCodec(const char *pcName, const CodecScore_t *pxScore)
+{
+	uint64_t ullRaw = pxScore->ullSamples * CODEC_RAW_SAMPLE_BYTES;
+	uint64_t ullChannels = pxScore->ullBlocks * CODEC_CHANNELS;
+	double dSeconds = (pxScore->dSeconds > 0) ? pxScore->dSeconds : 1e-9;
+
+	ullChannels = (ullChannels > 0) ? ullChannels : 1;
+	printf("%-24s %8llu %9llu %9llu %6.2f %8.0f %6.1f %6.1f %8.1f %8.0f %8s\n", pcName,
+		   (unsigned long long)pxScore->ullSamples, (unsigned long long)ullRaw, (unsigned long long)pxScore->ullBytes,
+		   (pxScore->ullBytes > 0) ? (double)ullRaw / pxScore->ullBytes : 0.0,
+		   (pxScore->dDuration > 0) ? pxScore->ullBytes / pxScore->dDuration : 0.0,
+		   100.0 * pxScore->ullModes[CODEC_MODE_DELTA] / ullChannels,
+		   100.0 * pxScore->ullModes[CODEC_MODE_LINEAR] / ullChannels,
+		   100.0 * pxScore->ullModes[CODEC_MODE_VERBATIM] / ullChannels,
+		   dSeconds * 1e9 / (pxScore->ullBlocks > 0 ? pxScore->ullBlocks : 1), pxScore->bLossless ? "yes" : "NO");
+}
+
+/**************************************************************************/ /**
+ * @fn			static void prvPrintStroke(const char *pcName, const StrokeScore_t *pxScore)
+ * @brief		Prints one row of the stroke report. Recall of each stroke over its labels
+ *****************************************************************************/
+static void prvPrintStroke(const char *pcName, const StrokeScore_t *pxScore)
+{
+	printf("%-24s %6lu %7lu %7lu %8.3f %8.3f %8.3f %6.3f %6.3f %5lu %9.0f\n", pcName, (unsigned long)pxScore->ulHits,
+		   (unsigned long)pxScore->ulStrokes, (unsigned long)pxScore->ulCorrect,
+		   prvRatio(pxScore->ulCorrect, pxScore->ulStrokes),
+		   prvRatio(pxScore->ulRecalled[STROKE_FOREHAND], pxScore->ulLabelled[STROKE_FOREHAND]),
+		   prvRatio(pxScore->ulRecalled[STROKE_BACKHAND], pxScore->ulLabelled[STROKE_BACKHAND]),
+		   prvRatio(pxScore->ulRecalled[STROKE_SMASH], pxScore->ulLabelled[STROKE_SMASH]),
+		   prvRatio(pxScore->ulRecalled[STROKE_DROP], pxScore->ulLabelled[STROKE_DROP]),
+		   (unsigned long)pxScore->ulTruncated,
+		   (pxScore->ullInferences > 0) ? pxScore->dSeconds * 1e9 / pxScore->ullInferences : 0.0);
+}
+
+/**************************************************************************/ /**
+ * @fn			static double prvRatio(uint32_t ulNumerator, uint32_t ulDenominator)
+ * @brief		ulNumerator / ulDenominator, 1 when there is nothing to count
+ *****************************************************************************/
+static double prvRatio(uint32_t ulNumerator, uint32_t ulDenominator)
+{
+	return (ulDenominator > 0) ? (double)ulNumerator / ulDenominator : 1.0;
+}
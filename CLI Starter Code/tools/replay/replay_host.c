@@ -0,0 +1,47 @@
+/**************************************************************************/ /**
+ * @file      replay_host.c
+ * @brief     Host versions of the firmware services the processing modules
+ *            call, for the replay harness.
+ * @details   --PipelineRegisterStage(): accepted and ignored. The harness
+ *              calls the modules' block functions itself
+ *            --BenchmarkGetCycles(): 0. The harness times the host run
+ *            --xTaskGetTickCount(): 0. Session ticks come from the samples
+ *
+ *            The CMSIS-DSP functions are in cmsis_host.c.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include "Pipeline/Pipeline.h"
+#include "Benchmark/Benchmark.h"
+
+/******************************************************************************
+ * Global Functions
+ ******************************************************************************/
+
+/**
+ * @brief Stages are run by the harness.
+ */
+BaseType_t PipelineRegisterStage(PipelineStage_t pxStage)
+{
+	return pdPASS;
+}
+
+/**
+ * @brief No cycle counter on the host.
+ */
+uint32_t BenchmarkGetCycles(void)
+{
+	return 0;
+}
+
+/**
+ * @brief No scheduler on the host.
+ */
+TickType_t xTaskGetTickCount(void)
+{
+	return 0;
+}
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Worst-case stack depth of every task and interrupt, from -fstack-usage.
+
+The build compiles with -fstack-usage, so GCC writes a .su file next to every
+object with the frame size of each function. This script takes the call graph
+from the linked ELF (arm-none-eabi-objdump -d) and walks it from each task
+entry and interrupt handler, adding up the frames along the deepest chain.
+
+Calls the disassembly shows:
+  - bl and tail-call branches to the start of a function
+  - function addresses in a caller's literal pool. The build uses -mlong-calls,
+    so most calls are "ldr rN, =func; blx rN". A function address loaded only
+    to be stored (a callback being registered) is counted as a call too, which
+    can only make the result larger
+Calls through pointers kept in tables (CLI commands, benchmarks, timer and
+work queue callbacks, ASF interrupt dispatch) are listed in stack_calls.txt.
+
+Usage:
+    python tools/stack_depth.py Debug/CLI_StarterCode.elf Debug [-v]
+    python tools/stack_depth.py tools/qemu/build/firmware.elf tools/qemu/build
+
+Functions without a .su entry (newlib, assembly) count as 0 bytes and are
+listed under the entry that reaches them. Give them a size with
+--assume name=bytes. Recursion is reported and counted once. Task results
+include the 68 bytes a context switch stores on the task stack; compare them
+with the sizes the "stacks" command shows, and with its measured peaks.
+"""
+
+import argparse
+import fnmatch
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# (task name, entry function). Names as the "stacks" command shows them
+TASKS = [
+    ("CLI_TASK", "vCommandConsoleTask"),
+    ("Tmr Svc", "prvTimerTask"),
+    ("IDLE", "prvIdleTask"),
+    ("BENCH", "prvSwitchPartnerTask"),
+    ("IMU_TASK", "vImuTask"),
+    ("PIPE_TASK", "vPipelineTask"),
+]
+
+# Exception frame (8 words, plus 4 bytes of alignment padding) and r4-r11,
+# which PendSV stacks on the task's stack when it switches away
+TASK_CONTEXT_BYTES = 68
+# Exception frame and padding stacked on the main stack by a nested interrupt
+ISR_FRAME_BYTES = 36
+
+FUNCTION = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+CALL = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{4} ?){1,2}\s+(bl|blx|b|b\.n|b\.w)\s+[0-9a-f]+ <([^>+]+)>")
+WORD = re.compile(r"^\s*[0-9a-f]+:\s+([0-9a-f]{8})\s+\.word\s+0x([0-9a-f]{8})")
+
+
+def read_frames(directories):
+    """Returns {function: (bytes, qualifier)} from every .su file under the directories.
+
+    Static functions of the same name in different files are merged, keeping the larger frame.
+    """
+    frames = {}
+    for directory in directories:
+        for root, _, files in os.walk(directory):
+            for name in files:
+                if not name.endswith(".su"):
+                    continue
+                with open(os.path.join(root, name)) as handle:
+                    for line in handle:
+                        fields = line.rstrip("\n").split("\t")
+                        if len(fields) != 3:
+                            continue
+                        function = fields[0].rsplit(":", 1)[-1]
+                        size = int(fields[1])
+                        if function not in frames or size > frames[function][0]:
+                            frames[function] = (size, fields[2])
+    return frames
+
+
+def read_calls(objdump, elf):
+    """Returns {function: set of callees} from the disassembly of the ELF."""
+    out = subprocess.run([objdump, "-d", elf], check=True, capture_output=True, text=True).stdout
+    starts = {}
+    bodies = {}
+    current = None
+    for line in out.splitlines():
+        match = FUNCTION.match(line)
+        if match:
+            current = match.group(2)
+            starts[int(match.group(1), 16)] = current
+            bodies.setdefault(current, [])
+        elif current is not None:
+            bodies[current].append(line)
+
+    calls = {}
+    for function, lines in bodies.items():
+        callees = set()
+        for line in lines:
+            match = CALL.match(line)
+            if match:
+                if match.group(2) != function:
+                    callees.add(match.group(2))
+                continue
+            match = WORD.match(line)
+            if match:
+                value = int(match.group(2), 16)
+                # Thumb function pointers have bit 0 set
+                if value & 1 and (value & ~1) in starts:
+                    callees.add(starts[value & ~1])
+        calls[function] = callees
+    return calls
+
+
+def add_indirect(calls, path):
+    """Adds the caller: callee... lines of path, both sides fnmatch patterns."""
+    with open(path) as handle:
+        for line in handle:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            caller_pattern, callee_patterns = line.split(":", 1)
+            callers = fnmatch.filter(calls, caller_pattern.strip())
+            callees = set()
+            for pattern in callee_patterns.split():
+                callees.update(fnmatch.filter(calls, pattern))
+            for caller in callers:
+                calls[caller].update(callees - {caller})
+
+
+class Walker:
+    """Deepest chain from a function, memoised."""
+
+    def __init__(self, frames, calls):
+        self.frames = frames
+        self.calls = calls
+        self.memo = {}
+        self.active = []
+        self.recursion = set()
+
+    def depth(self, function):
+        """Returns (bytes, chain, functions without a frame size, dynamic frames) for function."""
+        if function in self.memo:
+            return self.memo[function]
+        if function in self.active:
+            self.recursion.add(" -> ".join(self.active[self.active.index(function):] + [function]))
+            return 0, [], set(), set()
+
+        self.active.append(function)
+        own, qualifier = self.frames.get(function, (0, None))
+        unknown = {function} if qualifier is None else set()
+        dynamic = {function} if qualifier is not None and qualifier.startswith("dynamic") else set()
+        best, chain = 0, []
+        for callee in sorted(self.calls.get(function, ())):
+            size, callee_chain, callee_unknown, callee_dynamic = self.depth(callee)
+            unknown |= callee_unknown
+            dynamic |= callee_dynamic
+            if size > best:
+                best, chain = size, callee_chain
+        self.active.pop()
+
+        result = (own + best, [(function, own)] + chain, unknown, dynamic)
+        # A result that cut a cycle short depends on where the walk entered it
+        if not any(function in cycle for cycle in self.recursion):
+            self.memo[function] = result
+        return result
+
+
+def report(name, extra, walker, function, verbose):
+    """Prints one line for an entry, and its chain with -v. Returns its depth."""
+    if function not in walker.calls:
+        print("%-20s %7s  (%s not in the ELF)" % (name, "-", function))
+        return 0
+    size, chain, unknown, dynamic = walker.depth(function)
+    flags = ("+" if unknown else "") + ("d" if dynamic else "")
+    print("%-20s %7d%-2s %s" % (name, size + extra, flags, function))
+    if verbose:
+        for callee, frame in chain:
+            print("    %6d  %s" % (frame, callee))
+        if unknown:
+            print("    no frame size: %s" % ", ".join(sorted(unknown)))
+        if dynamic:
+            print("    dynamic frame: %s" % ", ".join(sorted(dynamic)))
+    return size + extra
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="linked firmware")
+    parser.add_argument("su_dirs", nargs="+", help="directories searched for .su files (the build directory)")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--indirect", default=os.path.join(HERE, "stack_calls.txt"), help="calls through pointers")
+    parser.add_argument("--assume", action="append", default=[], metavar="NAME=BYTES",
+                        help="frame size of a function without a .su entry, may be repeated")
+    parser.add_argument("-v", "--verbose", action="store_true", help="show the deepest chain of each entry")
+    args = parser.parse_args()
+
+    frames = read_frames(args.su_dirs)
+    if not frames:
+        sys.exit("no .su files under %s. Was the build compiled with -fstack-usage?" % ", ".join(args.su_dirs))
+    for assumption in args.assume:
+        function, size = assumption.split("=", 1)
+        frames[function] = (int(size), "assumed")
+
+    calls = read_calls(args.objdump, args.elf)
+    add_indirect(calls, args.indirect)
+    walker = Walker(frames, calls)
+
+    print("%-20s %9s  %s" % ("Stack", "Bytes", "Entry"))
+    for name, function in TASKS:
+        report(name, TASK_CONTEXT_BYTES, walker, function, args.verbose)
+
+    deepest = 0
+    for function in sorted(f for f in calls if f.endswith("_Handler") and f != "Reset_Handler"):
+        if calls[function] or frames.get(function, (0,))[0]:
+            deepest = max(deepest, report(function, ISR_FRAME_BYTES, walker, function, args.verbose))
+    print("%-20s %7d   deepest handler; each level of nesting adds its own" % ("main/ISR", deepest))
+
+    for cycle in sorted(walker.recursion):
+        print("recursion, counted once: %s" % cycle)
+    print("+ reaches functions without a frame size, d has dynamic frames (-v lists them)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Synthetic labelled stroke sessions, for tools/replay and train.py until
+enough recorded sessions are labelled.
+
+Each stroke is a swing, a turn of the wrist about one main axis whose rate
+rises and falls over a few hundred milliseconds, an impact at its fastest
+point, and a follow-through. The four strokes differ the way they do on court:
+
+    forehand  fast turn about +Z, arm level, firm impact
+    backhand  fast turn about -Z with some +X, arm level, firm impact
+    smash     fastest turn about +Y, arm raised, hardest impact
+    drop      slow turn about +Y, arm raised, light impact
+
+Every stroke is drawn with its own speed, timing, tilt of the turn axis and
+impact, and the session adds the wobble of the player between strokes, so the
+classes overlap somewhat. Output is the CSV of tools/replay, raw MPU6000 and
+LIS2DS12 values, the stroke label (2 + eStrokes) on the impact sample.
+
+Usage:
+    python3 tools/stroke/synth.py session.csv [--rate 100] [--strokes 200] [--seed 1]
+"""
+
+import argparse
+import math
+import random
+
+ACCEL_LSB_PER_G = 2048
+GYRO_LSB_PER_DPS = 16.4
+LABEL_STROKE = 2
+
+# Per stroke: main turn axis, peak turn rate (dps), swing length (s), gravity
+# in the sensor frame at rest (g), impact (g)
+STROKES = [
+    ("forehand", (0.15, 0.0, 1.0), 950, 0.30, (0.0, -0.9, 0.3), 8.0),
+    ("backhand", (0.45, 0.0, -1.0), 850, 0.28, (0.0, -0.9, -0.3), 7.0),
+    ("smash", (0.0, 1.0, 0.2), 1200, 0.25, (0.9, 0.1, 0.3), 10.0),
+    ("drop", (0.1, 1.0, 0.3), 450, 0.35, (0.85, 0.2, 0.4), 5.0),
+]
+
+
+def unit(vector):
+    norm = math.sqrt(sum(v * v for v in vector))
+    return [v / norm for v in vector]
+
+
+def jitter(vector, spread, rng):
+    return unit([v + rng.gauss(0, spread) for v in vector])
+
+
+def clip(value):
+    return max(-32768, min(32767, int(round(value))))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("output")
+    parser.add_argument("--rate", type=int, default=100, help="sample rate, Hz")
+    parser.add_argument("--strokes", type=int, default=200)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    period = 1.0 / args.rate
+
+    # Stroke impacts 1.5 to 3 s apart, after 2 s of rest
+    events = []
+    t = 2.0
+    for _ in range(args.strokes):
+        t += rng.uniform(1.5, 3.0)
+        events.append((t, rng.randrange(len(STROKES))))
+    samples = int((t + 2.0) * args.rate)
+
+    # Parameters of each stroke, drawn once
+    drawn = []
+    for impact, kind in events:
+        _, axis, rate, length, gravity, force = STROKES[kind]
+        drawn.append({
+            "impact": impact,
+            "kind": kind,
+            "axis": jitter(axis, 0.5, rng),
+            "rate": rate * rng.uniform(0.6, 1.4),
+            "length": length * rng.uniform(0.8, 1.2),
+            "gravity": jitter(gravity, 0.5, rng),
+            "force": force * rng.uniform(0.7, 1.3),
+            "direction": jitter((1.0, 0.2, 0.1), 0.3, rng),
+            "centre": jitter((0.1, -1.0, 0.1), 0.2, rng),
+        })
+
+    rest = unit((0.0, -0.2, 1.0))
+    with open(args.output, "w") as out:
+        out.write("ax,ay,az,gx,gy,gz,lx,ly,lz,hit\n")
+        current = 0
+        for n in range(samples):
+            t = n * period
+            while current + 1 < len(drawn) and t > drawn[current]["impact"] + 0.75:
+                current += 1
+            stroke = drawn[current]
+            dt = t - stroke["impact"]
+            label = 0
+
+            # Wobble between strokes
+            gyro = [30 * math.sin(0.9 * t + k) + rng.gauss(0, 3) for k in range(3)]
+            gravity = rest
+            accel = [0.0, 0.0, 0.0]
+
+            if -stroke["length"] - 0.5 < dt < 0.75:
+                # Turn rate: rises over the swing to its peak at the impact,
+                # falls over the follow-through, twice as fast
+                if -stroke["length"] <= dt <= 0:
+                    shape = math.sin(0.5 * math.pi * (dt + stroke["length"]) / stroke["length"])
+                elif 0 < dt <= stroke["length"] / 2:
+                    shape = math.cos(math.pi * dt / stroke["length"])
+                else:
+                    shape = 0.0
+                gyro = [g + stroke["rate"] * shape * a for g, a in zip(gyro, stroke["axis"])]
+
+                # Arm position, blended in over the 0.5 s before the swing
+                blend = min(1.0, max(0.0, (dt + stroke["length"] + 0.5) / 0.5)) if dt < 0 else \
+                    max(0.0, 1.0 - (dt - 0.25) / 0.5) if dt > 0.25 else 1.0
+                gravity = unit([r + blend * (s - r) for r, s in zip(rest, stroke["gravity"])])
+
+                # Centripetal acceleration of the wrist, 0.05 m from the turn,
+                # towards the elbow
+                omega = stroke["rate"] * shape * math.pi / 180
+                accel = [0.05 * omega * omega / 9.81 * c for c in stroke["centre"]]
+
+                # Impact: a damped ring of 10 Hz, across the racket face
+                if 0 <= dt < 0.1:
+                    ring = stroke["force"] * math.exp(-dt / 0.03) * math.cos(2 * math.pi * 10 * dt)
+                    accel = [a + ring * d for a, d in zip(accel, stroke["direction"])]
+                if abs(dt) < period / 2:
+                    label = LABEL_STROKE + stroke["kind"]
+
+            mpu = [(g + a) * ACCEL_LSB_PER_G + rng.gauss(0, 10) for g, a in zip(gravity, accel)]
+            rates = [g * GYRO_LSB_PER_DPS + rng.gauss(0, 3) for g in gyro]
+            lis = [(g + a) * ACCEL_LSB_PER_G + rng.gauss(0, 20) for g, a in zip(gravity, accel)]
+            out.write(",".join(str(clip(v)) for v in mpu + rates + lis) + ",%d\n" % label)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+"""Trains the stroke classifier and writes its model blob, src/Stroke/StrokeModel.c.
+
+The training set is the features tools/replay exports for the labelled strokes
+of recorded sessions, the same int8 features the firmware computes:
+
+    make -C tools/replay
+    tools/replay/build/replay -x features.csv session.csv ...
+    python3 tools/stroke/train.py features.csv
+
+The network is one hidden layer with ReLU, STROKE_FEATURES inputs and one
+output per stroke, trained in floating point by mini-batch gradient descent on
+the cross entropy, with no dependency beyond the standard library. A share of
+the strokes, --holdout, is kept out of training to measure the accuracy.
+
+It is then quantised the way StrokeInfer() runs it: int8 weights with one
+scale per layer, int32 biases at the scale of the accumulator, and each layer's
+output scaled back to int8 by a 16-bit multiplier and a shift, from the largest
+activation over the training set. The quantised network is run here with the
+same integer arithmetic, so the accuracy printed for it is the accuracy on the
+device. The blob layout is in Stroke.h.
+"""
+
+import argparse
+import math
+import random
+import struct
+import sys
+
+FEATURES = 22           # STROKE_FEATURES
+STROKES = ["forehand", "backhand", "smash", "drop"]
+MAX_WIDTH = 32          # STROKE_MAX_WIDTH
+MODEL_VERSION = 1       # STROKE_MODEL_VERSION
+FEATURE_VERSION = 1     # STROKE_FEATURE_VERSION
+FLAG_RELU = 0x01
+INPUT_SCALE = 1 / 32.0  # Real value of one feature LSB for training, the features reach about +-4
+
+HEADER = """/**************************************************************************/ /**
+ * @file      StrokeModel.c
+ * @brief     The stroke classifier model blob, loaded by StrokeInit().
+ * @details   Generated by tools/stroke/train.py, do not edit. {shape},
+ *            {macs} multiply-accumulates per inference, trained on {train}
+ *            strokes; {holdout} held out, {accuracy:.1f} % of them right after
+ *            quantisation.
+ * @date      2026-10-19
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "Stroke.h"
+
+/******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/** Aligned so the biases are read in place */
+const uint8_t ucStrokeModel[{length}] __attribute__((aligned(4))) = {{
+{body}
+}};
+
+const uint16_t usStrokeModelBytes = sizeof(ucStrokeModel);
+"""
+
+
+def load(paths):
+    rows = []
+    for path in paths:
+        with open(path) as handle:
+            for line in handle:
+                fields = line.strip().split(",")
+                if not fields[0].lstrip("-").isdigit():
+                    continue
+                values = [int(v) for v in fields]
+                if len(values) != FEATURES + 1 or not 0 <= values[0] < len(STROKES):
+                    sys.exit("%s: expected a stroke and %d features per line" % (path, FEATURES))
+                rows.append((values[0], values[1:]))
+    return rows
+
+
+def forward(layers, x):
+    """Float network. Returns the activations of every layer, input first."""
+    activations = [x]
+    for index, (weights, biases) in enumerate(layers):
+        out = [b + sum(w * v for w, v in zip(row, x)) for row, b in zip(weights, biases)]
+        if index + 1 < len(layers):
+            out = [max(0.0, v) for v in out]
+        activations.append(out)
+        x = out
+    return activations
+
+
+def softmax(logits):
+    top = max(logits)
+    exps = [math.exp(v - top) for v in logits]
+    total = sum(exps)
+    return [e / total for e in exps]
+
+
+def train(rows, hidden, epochs, rate, rng):
+    sizes = [FEATURES, hidden, len(STROKES)]
+    layers = []
+    for inputs, outputs in zip(sizes, sizes[1:]):
+        bound = math.sqrt(6.0 / (inputs + outputs))
+        layers.append(([[rng.uniform(-bound, bound) for _ in range(inputs)] for _ in range(outputs)],
+                       [0.0] * outputs))
+
+    data = [(label, [v * INPUT_SCALE for v in features]) for label, features in rows]
+    batch = 16
+    for epoch in range(epochs):
+        rng.shuffle(data)
+        step = rate * (1.0 - 0.9 * epoch / epochs)
+        for start in range(0, len(data), batch):
+            grads = [([[0.0] * len(row) for row in weights], [0.0] * len(biases)) for weights, biases in layers]
+            for label, x in data[start:start + batch]:
+                activations = forward(layers, x)
+                delta = softmax(activations[-1])
+                delta[label] -= 1.0
+                for index in range(len(layers) - 1, -1, -1):
+                    weights, _ = layers[index]
+                    inputs = activations[index]
+                    grad_w, grad_b = grads[index]
+                    for j, d in enumerate(delta):
+                        if d == 0.0:
+                            continue
+                        grad_b[j] += d
+                        row = grad_w[j]
+                        for i, v in enumerate(inputs):
+                            row[i] += d * v
+                    if index > 0:
+                        delta = [sum(weights[j][i] * delta[j] for j in range(len(delta))) if inputs[i] > 0 else 0.0
+                                 for i in range(len(inputs))]
+            count = len(data[start:start + batch])
+            for (weights, biases), (grad_w, grad_b) in zip(layers, grads):
+                for j in range(len(biases)):
+                    biases[j] -= step * grad_b[j] / count
+                    row = weights[j]
+                    grad = grad_w[j]
+                    for i in range(len(row)):
+                        row[i] -= step * grad[i] / count
+        if (epoch + 1) % 50 == 0:
+            print("epoch %d: float accuracy %.3f" % (epoch + 1, float_accuracy(layers, rows)))
+    return layers
+
+
+def float_accuracy(layers, rows):
+    right = 0
+    for label, features in rows:
+        logits = forward(layers, [v * INPUT_SCALE for v in features])[-1]
+        right += logits.index(max(logits)) == label
+    return right / max(1, len(rows))
+
+
+def multiplier(scale):
+    """scale as multiplier * 2^-shift, the multiplier in [2^15, 2^16)."""
+    shift = 0
+    while scale * (1 << shift) < 32768:
+        shift += 1
+    while scale * (1 << shift) >= 65536:
+        shift -= 1
+    mult = int(round(scale * (1 << shift)))
+    if mult == 65536:
+        mult, shift = 32768, shift - 1
+    if not 1 <= shift <= 47:
+        sys.exit("layer scale %g is out of range" % scale)
+    return mult, shift
+
+
+def quantise(layers, rows):
+    quantised = []
+    in_scale = INPUT_SCALE
+    data = [[v * INPUT_SCALE for v in features] for _, features in rows]
+    for index, (weights, biases) in enumerate(layers):
+        w_scale = max(abs(w) for row in weights for w in row) / 127.0
+        acc_scale = in_scale * w_scale
+        q_weights = [[max(-127, min(127, int(round(w / w_scale)))) for w in row] for row in weights]
+        q_biases = [int(round(b / acc_scale)) for b in biases]
+        outputs = [forward(layers, x)[index + 1] for x in data]
+        out_scale = max(abs(v) for out in outputs for v in out) / 127.0
+        mult, shift = multiplier(acc_scale / out_scale)
+        quantised.append({"weights": q_weights, "biases": q_biases, "mult": mult, "shift": shift,
+                          "relu": index + 1 < len(layers)})
+        in_scale = out_scale
+    return quantised
+
+
+def infer(quantised, features):
+    """StrokeInfer(), integer for integer."""
+    x = features
+    for layer in quantised:
+        out = []
+        for row, bias in zip(layer["weights"], layer["biases"]):
+            acc = sum(w * v for w, v in zip(row, x)) + bias
+            value = (acc * layer["mult"] + (1 << (layer["shift"] - 1))) >> layer["shift"]
+            if layer["relu"]:
+                value = max(0, value)
+            out.append(max(-128, min(127, value)))
+        x = out
+    return x.index(max(x))
+
+
+def report(quantised, rows, name):
+    confusion = [[0] * len(STROKES) for _ in STROKES]
+    for label, features in rows:
+        confusion[label][infer(quantised, features)] += 1
+    right = sum(confusion[i][i] for i in range(len(STROKES)))
+    print("%s: int8 accuracy %.3f over %d strokes" % (name, right / max(1, len(rows)), len(rows)))
+    print("    %-10s" % "labelled" + "".join("%10s" % s for s in STROKES))
+    for label, counts in zip(STROKES, confusion):
+        print("    %-10s" % label + "".join("%10d" % c for c in counts))
+    return right / max(1, len(rows))
+
+
+def blob(quantised):
+    layers = b""
+    payload = b""
+    inputs = FEATURES
+    for layer in quantised:
+        outputs = len(layer["biases"])
+        layers += struct.pack("<BBBBHH", inputs, outputs, FLAG_RELU if layer["relu"] else 0, layer["shift"],
+                              layer["mult"], 0)
+        payload += struct.pack("<%di" % outputs, *layer["biases"])
+        payload += struct.pack("<%db" % (outputs * inputs), *[w for row in layer["weights"] for w in row])
+        payload += b"\0" * (-len(payload) % 4)
+        inputs = outputs
+    length = 12 + len(layers) + len(payload) + 2
+    data = b"STRK" + struct.pack("<BBBBHH", MODEL_VERSION, FEATURE_VERSION, len(quantised), len(STROKES), length, 0)
+    data += layers + payload
+    return data + struct.pack("<H", crc16(data))
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as Stroke.c checks it."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("features", nargs="+", help="CSV from replay -x")
+    parser.add_argument("-o", "--output", default="src/Stroke/StrokeModel.c")
+    parser.add_argument("--hidden", type=int, default=16, help="hidden layer width, up to %d" % MAX_WIDTH)
+    parser.add_argument("--epochs", type=int, default=200)
+    parser.add_argument("--rate", type=float, default=0.05, help="learning rate")
+    parser.add_argument("--holdout", type=float, default=0.2, help="share of strokes kept for validation")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if not 1 <= args.hidden <= MAX_WIDTH:
+        sys.exit("--hidden must be 1 to %d" % MAX_WIDTH)
+    rng = random.Random(args.seed)
+    rows = load(args.features)
+    rng.shuffle(rows)
+    split = int(len(rows) * (1.0 - args.holdout))
+    train_rows, holdout_rows = rows[:split], rows[split:]
+    if not train_rows:
+        sys.exit("no strokes to train on")
+
+    layers = train(train_rows, args.hidden, args.epochs, args.rate, rng)
+    quantised = quantise(layers, train_rows)
+    print("float accuracy: train %.3f, holdout %.3f" % (float_accuracy(layers, train_rows),
+                                                         float_accuracy(layers, holdout_rows)))
+    report(quantised, train_rows, "train")
+    accuracy = report(quantised, holdout_rows, "holdout") if holdout_rows else 0.0
+
+    data = blob(quantised)
+    shape = "-".join(str(n) for n in [FEATURES, args.hidden, len(STROKES)])
+    macs = FEATURES * args.hidden + args.hidden * len(STROKES)
+    body = "\n".join("\t" + " ".join("0x%02X," % b for b in data[i:i + 16]) for i in range(0, len(data), 16))
+    with open(args.output, "w") as out:
+        out.write(HEADER.format(shape=shape, macs=macs, train=len(train_rows), holdout=len(holdout_rows),
+                                accuracy=100.0 * accuracy, length=len(data), body=body))
+    print("%s: %s, %d bytes of flash, %d MACs per inference" % (args.output, shape, len(data), macs))
+
+
+if __name__ == "__main__":
+    main()
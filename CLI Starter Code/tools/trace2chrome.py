@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Converts a "trace dump" capture into Chrome trace event JSON.
+
+Capture the console output of "trace dump" to a file (terminal log, or
+"python -m serial.tools.miniterm --raw ... > dump.txt"). Lines that are not
+part of the dump are ignored, so the log may include the prompt and other
+output. The JSON opens in chrome://tracing or https://ui.perfetto.dev:
+
+    python tools/trace2chrome.py dump.txt -o trace.json
+
+Tracks:
+    one per task      running slices, scheduler suspended sections, queue
+                      and semaphore operations
+    ISR <name>        console interrupt callbacks
+    low power         idle task sleeping with ticks suppressed
+
+Timestamps are 32-bit CPU cycle counts. They are unwrapped on the assumption
+that consecutive events are less than one wrap apart (89 s at 48 MHz), and
+scaled by the clock events the firmware records. The cycle counter stops in
+STANDBY, so STANDBY sleeps appear shorter than they were.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+FORMAT_VERSION = 1
+
+# Must match enum eTraceEvents in src/Trace/Trace.h
+TASK_CREATE = 1
+TASK_SWITCHED_IN = 2
+TASK_SWITCHED_OUT = 3
+TASK_DELAY = 4
+QUEUE_CREATE = 5
+QUEUE_SEND = 6
+QUEUE_RECEIVE = 7
+QUEUE_BLOCK_SEND = 8
+QUEUE_BLOCK_RECEIVE = 9
+QUEUE_SEND_FROM_ISR = 10
+QUEUE_RECEIVE_FROM_ISR = 11
+ISR_ENTER = 12
+ISR_EXIT = 13
+SECTION_BEGIN = 14
+SECTION_END = 15
+LOW_POWER_BEGIN = 16
+LOW_POWER_END = 17
+CLOCK = 18
+
+QUEUE_EVENTS = {
+    QUEUE_CREATE: "create",
+    QUEUE_SEND: "send",
+    QUEUE_RECEIVE: "receive",
+    QUEUE_BLOCK_SEND: "block on send",
+    QUEUE_BLOCK_RECEIVE: "block on receive",
+    QUEUE_SEND_FROM_ISR: "send from ISR",
+    QUEUE_RECEIVE_FROM_ISR: "receive from ISR",
+}
+
+# queueQUEUE_TYPE_* in queue.h
+QUEUE_TYPES = {0: "queue", 1: "mutex", 2: "counting sem", 3: "binary sem", 4: "recursive mutex"}
+
+# enum eTraceIsrs and enum eTraceSections
+ISR_NAMES = {0: "USART RX", 1: "USART TX"}
+SECTION_NAMES = {0: "console read (scheduler suspended)", 1: "CLI command"}
+
+PID = 1
+ISR_TID_BASE = 100
+LOW_POWER_TID = 99
+DEFAULT_KHZ = 48000
+
+HEADER = re.compile(r"^# trace v(\d+) events (\d+) lost (\d+)")
+TASK = re.compile(r"^# task (\d+) (\S+)")
+EVENT_LINE = re.compile(r"^[0-9a-fA-F]{16}( [0-9a-fA-F]{16})*$")
+
+
+def parse_dump(lines):
+    """Returns (task names, [(cycles, event, aux, param)], lost) from the last dump in lines."""
+    tasks, events, lost = {}, [], 0
+    in_dump = False
+    for line in lines:
+        line = line.strip()
+        header = HEADER.match(line)
+        if header:
+            if int(header.group(1)) != FORMAT_VERSION:
+                sys.exit("trace format v%s, this script reads v%d" % (header.group(1), FORMAT_VERSION))
+            tasks, events, lost = {}, [], int(header.group(3))
+            in_dump = True
+        elif not in_dump:
+            continue
+        elif line.startswith("# end"):
+            in_dump = False
+        elif TASK.match(line):
+            number, name = TASK.match(line).groups()
+            tasks[int(number)] = name
+        elif EVENT_LINE.match(line):
+            for word in line.split():
+                events.append((int(word[0:8], 16), int(word[8:10], 16), int(word[10:12], 16), int(word[12:16], 16)))
+    return tasks, events, lost
+
+
+def convert(tasks, events):
+    """Returns the Chrome trace event list."""
+    out = []
+
+    def meta(tid, name, sort):
+        out.append({"ph": "M", "pid": PID, "tid": tid, "name": "thread_name", "args": {"name": name}})
+        out.append({"ph": "M", "pid": PID, "tid": tid, "name": "thread_sort_index", "args": {"sort_index": sort}})
+
+    out.append({"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "SAMD21"}})
+    for number, name in sorted(tasks.items()):
+        meta(number, name, number)
+    for isr, name in ISR_NAMES.items():
+        meta(ISR_TID_BASE + isr, "ISR " + name, -10 + isr)
+    meta(LOW_POWER_TID, "low power", 1000)
+
+    khz = DEFAULT_KHZ
+    time_us = 0.0
+    last_cycles = None
+    running = None  # Task number whose slice is open
+
+    for cycles, event, aux, param in events:
+        if last_cycles is not None:
+            time_us += ((cycles - last_cycles) & 0xFFFFFFFF) * 1000.0 / khz
+        last_cycles = cycles
+        ts = round(time_us, 3)
+
+        if event == CLOCK:
+            khz = param or DEFAULT_KHZ
+            out.append({"ph": "i", "s": "g", "pid": PID, "tid": 0, "ts": ts, "name": "clock %d kHz" % khz})
+        elif event == TASK_SWITCHED_IN:
+            if running != aux:
+                if running is not None:
+                    out.append({"ph": "E", "pid": PID, "tid": running, "ts": ts})
+                out.append({"ph": "B", "pid": PID, "tid": aux, "ts": ts, "name": tasks.get(aux, "task %d" % aux)})
+                running = aux
+        elif event == TASK_SWITCHED_OUT:
+            # The switch may pick the same task again, so slices are closed on the next SWITCHED_IN
+            pass
+        elif event == TASK_CREATE:
+            out.append({"ph": "i", "s": "t", "pid": PID, "tid": aux, "ts": ts, "name": "created"})
+        elif event == TASK_DELAY:
+            out.append({"ph": "i", "s": "t", "pid": PID, "tid": aux, "ts": ts, "name": "vTaskDelay"})
+        elif event in QUEUE_EVENTS:
+            from_isr = event in (QUEUE_SEND_FROM_ISR, QUEUE_RECEIVE_FROM_ISR)
+            tid = ISR_TID_BASE if from_isr or running is None else running
+            name = "%s %s 0x%04x" % (QUEUE_TYPES.get(aux, "queue"), QUEUE_EVENTS[event], param)
+            out.append({"ph": "i", "s": "t", "pid": PID, "tid": tid, "ts": ts, "name": name})
+        elif event in (ISR_ENTER, ISR_EXIT):
+            out.append({"ph": "B" if event == ISR_ENTER else "E", "pid": PID, "tid": ISR_TID_BASE + aux, "ts": ts,
+                        "name": ISR_NAMES.get(aux, "ISR %d" % aux)})
+        elif event in (SECTION_BEGIN, SECTION_END):
+            tid = running if running is not None else 0
+            out.append({"ph": "B" if event == SECTION_BEGIN else "E", "pid": PID, "tid": tid, "ts": ts,
+                        "name": SECTION_NAMES.get(aux, "section %d" % aux)})
+        elif event in (LOW_POWER_BEGIN, LOW_POWER_END):
+            out.append({"ph": "B" if event == LOW_POWER_BEGIN else "E", "pid": PID, "tid": LOW_POWER_TID, "ts": ts,
+                        "name": "tickless sleep"})
+
+    if running is not None:
+        out.append({"ph": "E", "pid": PID, "tid": running, "ts": round(time_us, 3)})
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", help="console capture containing the output of 'trace dump'")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.dump, errors="replace") as f:
+        tasks, events, lost = parse_dump(f)
+
+    if not events:
+        sys.exit("no trace dump found in %s" % args.dump)
+
+    trace = {"traceEvents": convert(tasks, events), "displayTimeUnit": "ns"}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+    print("%d events, %d tasks, %d lost before the oldest event" % (len(events), len(tasks), lost), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())